@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <inttypes.h>
 #include <string.h>
@@ -12,6 +13,9 @@
 
 #define FontxDebug 0 // for Debug
 
+#define FontxAnkOffset 17	// ANK header size
+#define FontxAnkGlyphs 256
+
 // フォントファイルパスを構造体に保存
 void AddFontx(FontxFile *fx, const char *path)
 {
@@ -27,16 +31,50 @@ void InitFontx(FontxFile *fxs, const char *f0, const char *f1)
 	AddFontx(&fxs[1], f1);
 }
 
+// 埋め込みフォントでフォント構造体を初期化
+// The font is ready at once: no file system, nothing to open or read.
+void InitFontxEmbedded(FontxFile *fxs, const FontxFont *font)
+{
+	AddFontx(&fxs[0], font->name);
+	AddFontx(&fxs[1], "");
+	fxs[1].missing = true;
+
+	FontxFile *fx = &fxs[0];
+	strncpy(fx->fxname, font->name, sizeof(fx->fxname)-1);
+	fx->w = font->w;
+	fx->h = font->h;
+	fx->fsz = font->fsz;
+	fx->is_ank = true;
+	fx->glyphs = font->glyphs;
+	fx->embedded = true;
+	fx->opened = true;
+	fx->valid = true;
+}
+
+// A file that is not a usable FONTX is treated like a missing one:
+// closed once and not reopened for every glyph.
+static bool RejectFontx(FontxFile *fx)
+{
+	fclose(fx->file);
+	fx->file = NULL;
+	fx->opened = false;
+	fx->missing = true;
+	fx->valid = false;
+	return fx->valid;
+}
+
 // フォントファイルをOPEN
 bool OpenFontx(FontxFile *fx)
 {
 	FILE *f;
 	if(!fx->opened){
+		if(fx->missing) return false;
 		if(FontxDebug)printf("[openFont]fx->path=[%s]\n",fx->path);
 		f = fopen(fx->path, "r");
 		if(FontxDebug)printf("[openFont]fopen=%p\n",f);
 		if (f == NULL) {
 			fx->valid = false;
+			fx->missing = true;
 			printf("Fontx:%s not found.\n",fx->path);
 			return fx->valid ;
 		}
@@ -44,10 +82,8 @@ bool OpenFontx(FontxFile *fx)
 		fx->file = f;
 		char buf[18];
 		if (fread(buf, 1, sizeof(buf), fx->file) != sizeof(buf)) {
-			fx->valid = false;
 			printf("Fontx:%s not FONTX format.\n",fx->path);
-			fclose(fx->file);
-			return fx->valid ;
+			return RejectFontx(fx);
 		}
 
 		if(FontxDebug) {
@@ -63,11 +99,24 @@ bool OpenFontx(FontxFile *fx)
 		fx->fsz = (fx->w + 7)/8 * fx->h;
 		if(fx->fsz > FontxGlyphBufSize){
 			printf("Fontx:%s is too big font size.\n",fx->path);
-			fx->valid = false;
-			fclose(fx->file);
-			return fx->valid ;
+			return RejectFontx(fx);
 		}
 		fx->valid = true;
+
+		// ANK table is small (4 KB for 8x16), keep it in RAM so drawing
+		// does no file I/O. Without memory the glyphs are read from the file.
+		if (fx->is_ank) {
+			size_t size = FontxAnkGlyphs * fx->fsz;
+			uint8_t *glyphs = malloc(size);
+			if (glyphs != NULL &&
+				(fseek(fx->file, FontxAnkOffset, SEEK_SET) ||
+				 fread(glyphs, 1, size, fx->file) != size)) {
+				printf("Fontx:%s glyph table not loaded.\n",fx->path);
+				free(glyphs);
+				glyphs = NULL;
+			}
+			fx->glyphs = glyphs;
+		}
 	}
 	return fx->valid;
 }
@@ -75,10 +124,15 @@ bool OpenFontx(FontxFile *fx)
 // フォントファイルをCLOSE
 void CloseFontx(FontxFile *fx)
 {
+	// An embedded font has nothing to close
+	if(fx->embedded) return;
 	if(fx->opened){
 		fclose(fx->file);
 		fx->opened = false;
 	}
+	free((void *)fx->glyphs);
+	fx->glyphs = NULL;
+	fx->missing = false;
 }
 
 // フォント構造体の表示
@@ -197,9 +251,11 @@ uint8_t getFortHeight(FontxFile *fx) {
 
 */
 
-bool GetFontx(FontxFile *fxs, uint8_t ascii , uint8_t *pGlyph, uint8_t *pw, uint8_t *ph)
+// Returns the glyph pattern of ascii. From the RAM table the pointer points
+// into it and nothing is copied; otherwise the glyph is read into pGlyph
+// (FontxGlyphBufSize bytes) and pGlyph is returned. NULL if there is no glyph.
+const uint8_t *GetFontxGlyph(FontxFile *fxs, uint8_t ascii, uint8_t *pGlyph, uint8_t *pw, uint8_t *ph)
 {
-  
 	int i;
 	uint32_t offset;
 
@@ -212,23 +268,37 @@ bool GetFontx(FontxFile *fxs, uint8_t ascii , uint8_t *pGlyph, uint8_t *pw, uint
 		//if(ascii < 0xFF){
 			if(fxs[i].is_ank){
 				if(FontxDebug)printf("[GetFontx]fxs.is_ank fxs.fsz=%d\n",fxs[i].fsz);
-				offset = 17 + ascii * fxs[i].fsz;
+				if(pw) *pw = fxs[i].w;
+				if(ph) *ph = fxs[i].h;
+				if(fxs[i].glyphs) {
+					return &fxs[i].glyphs[ascii * fxs[i].fsz];
+				}
+				offset = FontxAnkOffset + ascii * fxs[i].fsz;
 				if(FontxDebug)printf("[GetFontx]offset=%"PRIu32"\n",offset);
 				if(fseek(fxs[i].file, offset, SEEK_SET)) {
 					printf("Fontx:seek(%"PRIu32") failed.\n",offset);
-					return false;
+					return NULL;
 				}
 				if(fread(pGlyph, 1, fxs[i].fsz, fxs[i].file) != fxs[i].fsz) {
 					printf("Fontx:fread failed.\n");
-					return false;
+					return NULL;
 				}
-				if(pw) *pw = fxs[i].w;
-				if(ph) *ph = fxs[i].h;
-				return true;
+				return pGlyph;
 			}
 		//}
 	}
-	return false;
+	return NULL;
+}
+
+bool GetFontx(FontxFile *fxs, uint8_t ascii , uint8_t *pGlyph, uint8_t *pw, uint8_t *ph)
+{
+	uint8_t w, h;
+	const uint8_t *glyph = GetFontxGlyph(fxs, ascii, pGlyph, &w, &h);
+	if (glyph == NULL) return false;
+	if (glyph != pGlyph) memcpy(pGlyph, glyph, (w + 7)/8 * h);
+	if(pw) *pw = w;
+	if(ph) *ph = h;
+	return true;
 }
 
 
@@ -2,6 +2,15 @@
 #define MAIN_FONTX_H_
 #define FontxGlyphBufSize (32*32/8)
 
+// ANK font compiled into the firmware by fontx2c.py
+typedef struct {
+	const char *name;
+	uint8_t w;
+	uint8_t h;
+	uint16_t fsz;
+	const uint8_t *glyphs;	// 256 glyphs, fsz bytes each
+} FontxFont;
+
 typedef struct {
 	const char *path;
 	char  fxname[10];
@@ -13,16 +22,21 @@ typedef struct {
 	uint16_t fsz;
 	uint8_t bc;
 	FILE *file;
+	bool missing;		// open failed, not retried until AddFontx/CloseFontx
+	const uint8_t *glyphs;	// ANK table in RAM or flash, NULL - read from the file
+	bool embedded;		// glyphs come from a FontxFont, there is no file
 } FontxFile;
 
 void AaddFontx(FontxFile *fx, const char *path);
 void InitFontx(FontxFile *fxs, const char *f0, const char *f1);
+void InitFontxEmbedded(FontxFile *fxs, const FontxFont *font);
 bool OpenFontx(FontxFile *fx);
 void CloseFontx(FontxFile *fx);
 void DumpFontx(FontxFile *fxs);
 uint8_t getFortWidth(FontxFile *fx);
 uint8_t getFortHeight(FontxFile *fx);
 bool GetFontx(FontxFile *fxs, uint8_t ascii , uint8_t *pGlyph, uint8_t *pw, uint8_t *ph);
+const uint8_t *GetFontxGlyph(FontxFile *fxs, uint8_t ascii, uint8_t *pGlyph, uint8_t *pw, uint8_t *ph);
 void Font2Bitmap(uint8_t *fonts, uint8_t *line, uint8_t w, uint8_t h, uint8_t inverse);
 void UnderlineBitmap(uint8_t *line, uint8_t w, uint8_t h);
 void ReversBitmap(uint8_t *line, uint8_t w, uint8_t h);
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Convert a FONTX ANK font into a C source with a const FontxFont descriptor.
+
+The glyph table is emitted as a const array, so it stays in flash and
+is drawn without SPIFFS. The symbol is fontx_<NAME>, NAME being the file
+name without extension, e.g. ILGH16XB.FNT -> fontx_ILGH16XB.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER_SIZE = 17
+GLYPHS = 256
+GLYPH_BUF_SIZE = 32 * 32 // 8   # FontxGlyphBufSize
+
+
+def symbol_name(path):
+    # Same as CMake string(MAKE_C_IDENTIFIER)
+    stem = re.sub(r'[^0-9A-Za-z_]', '_', os.path.splitext(os.path.basename(path))[0])
+    return '_' + stem if stem[:1].isdigit() else stem
+
+
+def convert(src, dst):
+    with open(src, 'rb') as f:
+        data = f.read()
+
+    if len(data) < HEADER_SIZE or data[:5] != b'FONTX':
+        sys.exit(f'{src}: not a FONTX file')
+    width, height, code_type = data[14], data[15], data[16]
+    if code_type != 0:
+        sys.exit(f'{src}: double-byte FONTX fonts are not supported')
+    fsz = (width + 7) // 8 * height
+    if fsz > GLYPH_BUF_SIZE:
+        sys.exit(f'{src}: {width}x{height} glyphs are too big')
+    table = data[HEADER_SIZE:HEADER_SIZE + GLYPHS * fsz]
+    if len(table) != GLYPHS * fsz:
+        sys.exit(f'{src}: truncated glyph table')
+
+    name = symbol_name(src)
+    fxname = data[6:14].decode('ascii', 'replace').rstrip(' \0')
+    lines = [
+        f'// Generated by fontx2c.py from {os.path.basename(src)}, do not edit',
+        '#include <stdio.h>',
+        '#include <stdint.h>',
+        '#include <stdbool.h>',
+        '#include "fontx.h"',
+        '',
+        f'static const uint8_t glyphs[{len(table)}] = {{',
+    ]
+    # One glyph per line
+    for i in range(GLYPHS):
+        glyph = table[i * fsz:(i + 1) * fsz]
+        lines.append('\t' + ', '.join(f'0x{b:02x}' for b in glyph) + f', // 0x{i:02x}')
+    lines += [
+        '};',
+        '',
+        f'const FontxFont fontx_{name} = {{',
+        f'\t.name = "{fxname}",',
+        f'\t.w = {width},',
+        f'\t.h = {height},',
+        f'\t.fsz = {fsz},',
+        '\t.glyphs = glyphs,',
+        '};',
+        '',
+    ]
+    with open(dst, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('fontx', help='FONTX font file')
+    parser.add_argument('output', help='C source to write')
+    args = parser.parse_args()
+    convert(args.fontx, args.output)
+
+
+if __name__ == '__main__':
+    main()
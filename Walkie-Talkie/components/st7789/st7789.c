@@ -1,6 +1,8 @@
 #include <string.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <math.h>
+#include <sys/param.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -8,6 +10,7 @@
 #include <driver/spi_master.h>
 #include <driver/gpio.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "st7789.h"
 
@@ -34,6 +37,11 @@
 
 #define SPI_DEFAULT_FREQUENCY SPI_MASTER_FREQ_20M; // 20MHz
 
+// Pixels per transaction of spi_master_write_color(s)
+#define FLUSH_CHUNK 512
+// CASET + 4 address bytes, RASET + 4 address bytes, RAMWR
+#define FLUSH_WINDOW_OVERHEAD 11
+
 static const int SPI_Command_Mode = 0;
 static const int SPI_Data_Mode = 1;
 //static const int SPI_Frequency = SPI_MASTER_FREQ_20M;
@@ -185,29 +193,42 @@ bool spi_master_write_addr(TFT_t * dev, uint16_t addr1, uint16_t addr2)
 	return spi_master_write_byte( dev->_SPIHandle, Byte, 4);
 }
 
+// Sizes above FLUSH_CHUNK are sent in several transactions,
+// so the staging buffer is never overrun
 bool spi_master_write_color(TFT_t * dev, uint16_t color, uint16_t size)
 {
-	static uint8_t Byte[1024];
-	int index = 0;
-	for(int i=0;i<size;i++) {
-		Byte[index++] = (color >> 8) & 0xFF;
-		Byte[index++] = color & 0xFF;
-	}
+	static uint8_t Byte[FLUSH_CHUNK*2];
 	gpio_set_level( dev->_dc, SPI_Data_Mode );
-	return spi_master_write_byte( dev->_SPIHandle, Byte, size*2);
+	while (size > 0) {
+		uint16_t bs = (size > FLUSH_CHUNK) ? FLUSH_CHUNK : size;
+		int index = 0;
+		for(int i=0;i<bs;i++) {
+			Byte[index++] = (color >> 8) & 0xFF;
+			Byte[index++] = color & 0xFF;
+		}
+		spi_master_write_byte( dev->_SPIHandle, Byte, bs*2);
+		size -= bs;
+	}
+	return true;
 }
 
 // Add 202001
 bool spi_master_write_colors(TFT_t * dev, uint16_t * colors, uint16_t size)
 {
-	static uint8_t Byte[1024];
-	int index = 0;
-	for(int i=0;i<size;i++) {
-		Byte[index++] = (colors[i] >> 8) & 0xFF;
-		Byte[index++] = colors[i] & 0xFF;
-	}
+	static uint8_t Byte[FLUSH_CHUNK*2];
 	gpio_set_level( dev->_dc, SPI_Data_Mode );
-	return spi_master_write_byte( dev->_SPIHandle, Byte, size*2);
+	while (size > 0) {
+		uint16_t bs = (size > FLUSH_CHUNK) ? FLUSH_CHUNK : size;
+		int index = 0;
+		for(int i=0;i<bs;i++) {
+			Byte[index++] = (colors[i] >> 8) & 0xFF;
+			Byte[index++] = colors[i] & 0xFF;
+		}
+		spi_master_write_byte( dev->_SPIHandle, Byte, bs*2);
+		size -= bs;
+		colors += bs;
+	}
+	return true;
 }
 
 void delayMS(int ms) {
@@ -267,6 +288,20 @@ void lcdInit(TFT_t * dev, int width, int height, int offsetx, int offsety)
 	}
 
 	dev->_use_frame_buffer = false;
+	dev->_dirty_x1 = NULL;
+	dev->_dirty_x2 = NULL;
+	dev->_row_hash = NULL;
+	memset(&dev->_flush_stats, 0, sizeof(dev->_flush_stats));
+	dev->_flush_stats.full_bytes = FLUSH_WINDOW_OVERHEAD + width*height*2;
+	dev->_flush_count = 0;
+	dev->_flush_queued = 0;
+	dev->_flush_busy = false;
+	dev->_flush_task = NULL;
+	dev->_flush_core = tskNO_AFFINITY;
+	dev->_flush_idle = NULL;
+	for (int i=0;i<FLUSH_BUFFERS;i++) {
+		dev->_dma_buffer[i] = NULL;
+	}
 #if CONFIG_FRAME_BUFFER
 	dev->_frame_buffer = heap_caps_malloc(sizeof(uint16_t)*width*height, MALLOC_CAP_DMA);
 	if (dev->_frame_buffer == NULL) {
@@ -276,10 +311,100 @@ void lcdInit(TFT_t * dev, int width, int height, int offsetx, int offsety)
 		dev->_use_frame_buffer = true;
 	}
 
+	// Without damage tracking every lcdDrawFinish pushes the whole screen
+	if (dev->_use_frame_buffer) {
+		dev->_dirty_x1 = malloc(sizeof(uint16_t)*height);
+		dev->_dirty_x2 = malloc(sizeof(uint16_t)*height);
+		if (dev->_dirty_x1 == NULL || dev->_dirty_x2 == NULL) {
+			ESP_LOGW(TAG, "damage tracking disabled");
+			free(dev->_dirty_x1);
+			free(dev->_dirty_x2);
+			dev->_dirty_x1 = NULL;
+			dev->_dirty_x2 = NULL;
+		} else {
+			// Panel contents are unknown, so the first flush sends everything
+			for (int y=0;y<height;y++) {
+				dev->_dirty_x1[y] = 0;
+				dev->_dirty_x2[y] = width-1;
+			}
+			// Optional, without it rows that were changed and changed back are sent again
+			dev->_row_hash = calloc(height, sizeof(uint64_t));
+		}
+	}
+
+	// Staging buffers for the queued DMA flush; without them lcdDrawFinish
+	// falls back to blocking transactions
+	if (dev->_use_frame_buffer) {
+		for (int i=0;i<FLUSH_BUFFERS;i++) {
+			dev->_dma_buffer[i] = heap_caps_malloc(FLUSH_DMA_CHUNK*2, MALLOC_CAP_DMA);
+			if (dev->_dma_buffer[i] == NULL) {
+				ESP_LOGW(TAG, "DMA flush disabled");
+				for (int j=0;j<i;j++) {
+					free(dev->_dma_buffer[j]);
+					dev->_dma_buffer[j] = NULL;
+				}
+				break;
+			}
+		}
+		dev->_flush_idle = xSemaphoreCreateBinary();
+		assert(dev->_flush_idle != NULL);
+		xSemaphoreGive(dev->_flush_idle);
+	}
 #endif
 }
 
 
+// Frame buffer damage tracking.
+// Drawing records, per row, the span of pixels whose value actually changed.
+// Repainting a pixel with the color it already has is not damage, and rows
+// that end up as the panel shows them are dropped by lcdDropUnchangedRows,
+// so redrawing the whole screen to change one word only sends its rows.
+static void lcdMarkDirty(TFT_t * dev, uint16_t y, uint16_t x1, uint16_t x2) {
+	if (dev->_dirty_x1 == NULL) return;
+	// The flush task may have sent this row before or after the change
+	if (dev->_flush_busy && dev->_row_hash) dev->_row_hash[y] = 0;
+	if (x1 < dev->_dirty_x1[y]) dev->_dirty_x1[y] = x1;
+	if (x2 > dev->_dirty_x2[y]) dev->_dirty_x2[y] = x2;
+}
+
+// Damaged span of row y, false if the row is clean
+static bool lcdDirtySpan(TFT_t * dev, uint16_t y, uint16_t *x1, uint16_t *x2) {
+	if (dev->_dirty_x1 == NULL) {
+		*x1 = 0;
+		*x2 = dev->_width-1;
+		return true;
+	}
+	*x1 = dev->_dirty_x1[y];
+	*x2 = dev->_dirty_x2[y];
+	return *x1 <= *x2;
+}
+
+static void lcdMarkClean(TFT_t * dev) {
+	if (dev->_dirty_x1 == NULL) return;
+	for (int y=0;y<dev->_height;y++) {
+		dev->_dirty_x1[y] = UINT16_MAX;
+		dev->_dirty_x2[y] = 0;
+	}
+}
+
+// Write size pixels of row y starting at x into the frame buffer.
+// colors==NULL fills the span with color.
+static void lcdWriteSpan(TFT_t * dev, uint16_t x, uint16_t y, uint16_t size, const uint16_t * colors, uint16_t color) {
+	uint16_t *row = &dev->_frame_buffer[y*dev->_width+x];
+	int first = -1;
+	int last = -1;
+	for (int i=0;i<size;i++) {
+		uint16_t c = colors ? colors[i] : color;
+		if (row[i] != c) {
+			row[i] = c;
+			if (first < 0) first = i;
+			last = i;
+		}
+	}
+	if (first >= 0) lcdMarkDirty(dev, y, x+first, x+last);
+}
+
+
 // Draw pixel
 // x:X coordinate
 // y:Y coordinate
@@ -289,7 +414,7 @@ void lcdDrawPixel(TFT_t * dev, uint16_t x, uint16_t y, uint16_t color){
 	if (y >= dev->_height) return;
 
 	if (dev->_use_frame_buffer) {
-		dev->_frame_buffer[y*dev->_width+x] = color;
+		lcdWriteSpan(dev, x, y, 1, NULL, color);
 	} else {
 		uint16_t _x = x + dev->_offsetx;
 		uint16_t _y = y + dev->_offsety;
@@ -315,16 +440,7 @@ void lcdDrawMultiPixels(TFT_t * dev, uint16_t x, uint16_t y, uint16_t size, uint
 	if (y >= dev->_height) return;
 
 	if (dev->_use_frame_buffer) {
-		uint16_t _x1 = x;
-		uint16_t _x2 = _x1 + (size-1);
-		uint16_t _y1 = y;
-		uint16_t _y2 = _y1;
-		int16_t index = 0;
-		for (int16_t j = _y1; j <= _y2; j++){
-			for(int16_t i = _x1; i <= _x2; i++){
-				 dev->_frame_buffer[j*dev->_width+i] = colors[index++];
-			}
-		}
+		lcdWriteSpan(dev, x, y, size, colors, 0);
 	} else {
 		uint16_t _x1 = x + dev->_offsetx;
 		uint16_t _x2 = _x1 + (size-1);
@@ -355,10 +471,8 @@ void lcdDrawFillRect(TFT_t * dev, uint16_t x1, uint16_t y1, uint16_t x2, uint16_
 	ESP_LOGD(TAG,"offset(x)=%d offset(y)=%d",dev->_offsetx,dev->_offsety);
 
 	if (dev->_use_frame_buffer) {
-		for (int16_t j = y1; j <= y2; j++){
-			for(int16_t i = x1; i <= x2; i++){
-				dev->_frame_buffer[j*dev->_width+i] = color;
-			}
+		for (int16_t j = y1; j <= y2 && x1 <= x2; j++){
+			lcdWriteSpan(dev, x1, j, x2-x1+1, NULL, color);
 		}
 	} else {
 		uint16_t _x1 = x1 + dev->_offsetx;
@@ -735,6 +849,120 @@ void lcdDrawFillArrow(TFT_t * dev, uint16_t x0,uint16_t y0,uint16_t x1,uint16_t
 }
 
 
+// Glyph tile: a character cell expanded to RGB565, the fill box and the
+// quirks of the rotated directions included. Drawn pixels are opaque,
+// the rest keep what is already on the panel.
+#define GLYPH_TILE_MAX ((32+2)*(32+2))
+static uint16_t glyph_tile[GLYPH_TILE_MAX];
+static uint8_t glyph_opaque[GLYPH_TILE_MAX];
+
+// Send colors to the panel window x1..x2, y1..y2, row by row
+static void lcdSendWindow(TFT_t * dev, int x1, int y1, int x2, int y2, uint16_t * colors) {
+	spi_master_write_command(dev, 0x2A);	// set column(x) address
+	spi_master_write_addr(dev, x1+dev->_offsetx, x2+dev->_offsetx);
+	spi_master_write_command(dev, 0x2B);	// set Page(y) address
+	spi_master_write_addr(dev, y1+dev->_offsety, y2+dev->_offsety);
+	spi_master_write_command(dev, 0x2C);	// Memory Write
+	spi_master_write_colors(dev, colors, (x2-x1+1)*(y2-y1+1));
+}
+
+// Send the opaque pixels of the tile at x,y.
+// The core cx0,cy0..cx1,cy1 (the fill box, empty if cx0 > cx1) is opaque
+// throughout and goes out as one address window. The rest - the whole glyph
+// without fill, or the part the rotated directions draw outside the fill
+// box - goes as runs along the axis that gives fewer of them. A filled
+// character costs a handful of transactions instead of five per pixel; an
+// unfilled one costs a few per run, about half of the per-pixel writes.
+static void lcdDrawTile(TFT_t * dev, int x, int y, int w, int h, int cx0, int cy0, int cx1, int cy1) {
+	int sx0 = MAX(x, 0);
+	int sy0 = MAX(y, 0);
+	int sx1 = MIN(x+w-1, dev->_width-1);
+	int sy1 = MIN(y+h-1, dev->_height-1);
+	if (sx0 > sx1 || sy0 > sy1) return;
+
+	// Writes to the frame buffer cost no transactions, rows are enough
+	if (dev->_use_frame_buffer) {
+		for (int j=sy0;j<=sy1;j++) {
+			int i = sx0;
+			while (i <= sx1) {
+				if (!glyph_opaque[(j-y)*w + (i-x)]) {
+					i++;
+					continue;
+				}
+				int start = i;
+				while (i <= sx1 && glyph_opaque[(j-y)*w + (i-x)]) i++;
+				lcdDrawMultiPixels(dev, start, j, i-start, &glyph_tile[(j-y)*w + (start-x)]);
+			}
+		}
+		return;
+	}
+
+	cx0 = MAX(cx0, sx0);
+	cy0 = MAX(cy0, sy0);
+	cx1 = MIN(cx1, sx1);
+	cy1 = MIN(cy1, sy1);
+	bool core = cx0 <= cx1 && cy0 <= cy1;
+	if (core) {
+		for (int j=cy0;j<=cy1;j++) {
+			memset(&glyph_opaque[(j-y)*w + (cx0-x)], 0, cx1-cx0+1);
+		}
+	}
+
+	int hruns = 0;
+	int vruns = 0;
+	for (int j=sy0;j<=sy1;j++) {
+		for (int i=sx0;i<=sx1;i++) {
+			if (!glyph_opaque[(j-y)*w + (i-x)]) continue;
+			if (i == sx0 || !glyph_opaque[(j-y)*w + (i-1-x)]) hruns++;
+			if (j == sy0 || !glyph_opaque[(j-1-y)*w + (i-x)]) vruns++;
+		}
+	}
+
+	if (vruns < hruns) {
+		uint16_t column[32+2];
+		for (int i=sx0;i<=sx1;i++) {
+			int j = sy0;
+			while (j <= sy1) {
+				if (!glyph_opaque[(j-y)*w + (i-x)]) {
+					j++;
+					continue;
+				}
+				int start = j;
+				int n = 0;
+				while (j <= sy1 && glyph_opaque[(j-y)*w + (i-x)]) {
+					column[n++] = glyph_tile[(j-y)*w + (i-x)];
+					j++;
+				}
+				lcdSendWindow(dev, i, start, i, j-1, column);
+			}
+		}
+	} else {
+		for (int j=sy0;j<=sy1;j++) {
+			int i = sx0;
+			while (i <= sx1) {
+				if (!glyph_opaque[(j-y)*w + (i-x)]) {
+					i++;
+					continue;
+				}
+				int start = i;
+				while (i <= sx1 && glyph_opaque[(j-y)*w + (i-x)]) i++;
+				lcdSendWindow(dev, start, j, i-1, j, &glyph_tile[(j-y)*w + (start-x)]);
+			}
+		}
+	}
+
+	// Last, as packing the rows of the core overwrites the tile
+	if (core) {
+		int cw = cx1-cx0+1;
+		uint16_t *dst = glyph_tile;
+		for (int j=cy0;j<=cy1;j++) {
+			memmove(dst, &glyph_tile[(j-y)*w + (cx0-x)], cw*2);
+			dst += cw;
+		}
+		lcdSendWindow(dev, cx0, cy0, cx1, cy1, glyph_tile);
+	}
+}
+
 // Draw ASCII character
 // x:X coordinate
 // y:Y coordinate
@@ -742,16 +970,17 @@ void lcdDrawFillArrow(TFT_t * dev, uint16_t x0,uint16_t y0,uint16_t x1,uint16_t
 // color:color
 int lcdDrawChar(TFT_t * dev, FontxFile *fxs, uint16_t x, uint16_t y, uint8_t ascii, uint16_t color) {
 	uint16_t xx,yy,bit,ofs;
-	unsigned char fonts[128]; // font pattern
+	unsigned char buffer[FontxGlyphBufSize]; // font pattern read from the file
+	const uint8_t *fonts;
 	unsigned char pw, ph;
 	int h,w;
 	uint16_t mask;
-	bool rc;
 
 	if(_DEBUG_)printf("_font_direction=%d\n",dev->_font_direction);
-	rc = GetFontx(fxs, ascii, fonts, &pw, &ph);
-	if(_DEBUG_)printf("GetFontx rc=%d pw=%d ph=%d\n",rc,pw,ph);
-	if (!rc) return 0;
+	// Points into the RAM glyph table when the font is cached
+	fonts = GetFontxGlyph(fxs, ascii, buffer, &pw, &ph);
+	if(_DEBUG_)printf("GetFontxGlyph rc=%d pw=%d ph=%d\n",fonts != NULL,pw,ph);
+	if (fonts == NULL) return 0;
 
 	int16_t xd1 = 0;
 	int16_t yd1 = 0;
@@ -828,7 +1057,46 @@ int lcdDrawChar(TFT_t * dev, FontxFile *fxs, uint16_t x, uint16_t y, uint8_t asc
 		y1	= y;
 	}
 
-	if (dev->_font_fill) lcdDrawFillRect(dev, x0, y0, x1, y1, dev->_font_fill_color);
+	// The cell is expanded into a tile covering the fill box and every glyph
+	// position, then sent as bursts by lcdDrawTile. Glyph positions follow
+	// the stepping above: xd1/yd2 per bit, yd1/xd2 per row. Coordinates left
+	// of or above the screen have wrapped around, int16_t brings them back.
+	int tx0 = (int16_t)xss + MIN(0, (pw-1)*xd1) + MIN(0, (ph-1)*xd2);
+	int tx1 = (int16_t)xss + MAX(0, (pw-1)*xd1) + MAX(0, (ph-1)*xd2);
+	int ty0 = (int16_t)yss + MIN(0, (pw-1)*yd2) + MIN(0, (ph-1)*yd1);
+	int ty1 = (int16_t)yss + MAX(0, (pw-1)*yd2) + MAX(0, (ph-1)*yd1);
+	if (dev->_font_fill) {
+		tx0 = MIN(tx0, (int16_t)x0);
+		tx1 = MAX(tx1, (int16_t)x1);
+		ty0 = MIN(ty0, (int16_t)y0);
+		ty1 = MAX(ty1, (int16_t)y1);
+	}
+	int tw = tx1-tx0+1;
+	int th = ty1-ty0+1;
+	if (tw*th > GLYPH_TILE_MAX) {
+		ESP_LOGE(TAG, "glyph %dx%d too large", pw, ph);
+		return 0;
+	}
+	memset(glyph_opaque, 0, tw*th);
+
+	// Same clipping as lcdDrawFillRect
+	int fx0 = 0;
+	int fy0 = 0;
+	int fx1 = -1;
+	int fy1 = -1;
+	if (dev->_font_fill && x0 < dev->_width && y0 < dev->_height) {
+		fx0 = x0;
+		fy0 = y0;
+		fx1 = (x1 >= dev->_width) ? dev->_width-1 : x1;
+		fy1 = (y1 >= dev->_height) ? dev->_height-1 : y1;
+		for (int j=y0;j<=fy1;j++) {
+			for (int i=x0;i<=fx1;i++) {
+				int index = (j-ty0)*tw + (i-tx0);
+				glyph_tile[index] = dev->_font_fill_color;
+				glyph_opaque[index] = 1;
+			}
+		}
+	}
 
 	int bits;
 	if(_DEBUG_)printf("xss=%d yss=%d\n",xss,yss);
@@ -845,16 +1113,18 @@ int lcdDrawChar(TFT_t * dev, FontxFile *fxs, uint16_t x, uint16_t y, uint8_t asc
 			for(bit=0;bit<8;bit++) {
 				bits--;
 				if (bits < 0) continue;
-				//if(_DEBUG_)printf("xx=%d yy=%d mask=%02x fonts[%d]=%02x\n",xx,yy,mask,ofs,fonts[ofs]);
-				if (fonts[ofs] & mask) {
-					lcdDrawPixel(dev, xx, yy, color);
-				} else {
-					//if (dev->_font_fill) lcdDrawPixel(dev, xx, yy, dev->_font_fill_color);
+				// Positions off the screen wrap around to large values, as in lcdDrawPixel
+				if (xx < dev->_width && yy < dev->_height) {
+					int index = ((int)yy-ty0)*tw + ((int)xx-tx0);
+					if (fonts[ofs] & mask) {
+						glyph_tile[index] = color;
+						glyph_opaque[index] = 1;
+					}
+					if ((h == (ph-2) || h == (ph-1)) && dev->_font_underline) {
+						glyph_tile[index] = dev->_font_underline_color;
+						glyph_opaque[index] = 1;
+					}
 				}
-				if (h == (ph-2) && dev->_font_underline)
-					lcdDrawPixel(dev, xx, yy, dev->_font_underline_color);
-				if (h == (ph-1) && dev->_font_underline)
-					lcdDrawPixel(dev, xx, yy, dev->_font_underline_color);
 				xx = xx + xd1;
 				yy = yy + yd2;
 				mask = mask >> 1;
@@ -864,6 +1134,7 @@ int lcdDrawChar(TFT_t * dev, FontxFile *fxs, uint16_t x, uint16_t y, uint8_t asc
 		yy = yy + yd1;
 		xx = xx + xd2;
 	}
+	lcdDrawTile(dev, tx0, ty0, tw, th, fx0, fy0, fx1, fy1);
 
 	if (next < 0) next = 0;
 	return next;
@@ -966,6 +1237,8 @@ void lcdSetFontDirection(TFT_t * dev, uint16_t dir) {
 
 // Set font filling
 // color:fill color
+// A filled cell is opaque and goes out as one address window. Without fill
+// only the set bits are drawn, because what lies behind them is unknown.
 void lcdSetFontFill(TFT_t * dev, uint16_t color) {
 	dev->_font_fill = true;
 	dev->_font_fill_color = color;
@@ -1063,28 +1336,291 @@ void lcdWrapArround(TFT_t * dev, SCROLL_TYPE_t scroll, int start, int end) {
 			dev->_frame_buffer[i] = wk;
 		}
 	}
+
+	// Scrolling moves whole rows or columns, mark them without comparing
+	if (scroll == SCROLL_RIGHT || scroll == SCROLL_LEFT) {
+		for (int i=start;i<end && i<_height;i++) {
+			lcdMarkDirty(dev, i, 0, _width-1);
+		}
+	} else if (scroll == SCROLL_UP || scroll == SCROLL_DOWN) {
+		uint16_t x2 = (end < _width) ? end : _width-1;
+		for (int j=0;j<_height;j++) {
+			lcdMarkDirty(dev, j, start, x2);
+		}
+	}
 }
 
-// Draw Frame Buffer
-void lcdDrawFinish(TFT_t *dev)
+// Queue the pixels of a window through the DMA staging buffers.
+// While one buffer is on the bus the next one is filled and byte-swapped,
+// so the CPU only waits when all FLUSH_BUFFERS are in flight.
+// Returns CPU time spent filling buffers.
+static int64_t lcdQueueWindow(TFT_t *dev, const FLUSH_WINDOW_t *w)
 {
-	if (dev->_use_frame_buffer == false) return;
+	uint32_t width = w->x2-w->x1+1;
+	uint32_t total = width*(w->y2-w->y1+1);
+	uint32_t x = 0;
+	uint32_t y = w->y1;
+	int inflight = 0;
+	int next = 0;
+	int64_t busy_us = 0;
+	esp_err_t ret;
+
+	gpio_set_level( dev->_dc, SPI_Data_Mode );
+	while (total > 0) {
+		if (inflight == FLUSH_BUFFERS) {
+			// Results come back in order, so this frees buffer next
+			spi_transaction_t *done;
+			ret = spi_device_get_trans_result(dev->_SPIHandle, &done, portMAX_DELAY);
+			assert(ret==ESP_OK);
+			inflight--;
+		}
 
+		int64_t start_us = esp_timer_get_time();
+		uint8_t *buf = dev->_dma_buffer[next];
+		uint32_t n = 0;
+		while (n < FLUSH_DMA_CHUNK && total > 0) {
+			uint32_t run = width - x;
+			if (run > FLUSH_DMA_CHUNK - n) run = FLUSH_DMA_CHUNK - n;
+			const uint16_t *src = &dev->_frame_buffer[y*dev->_width + w->x1 + x];
+			for (uint32_t i=0;i<run;i++) {
+				buf[(n+i)*2] = (src[i] >> 8) & 0xFF;
+				buf[(n+i)*2+1] = src[i] & 0xFF;
+			}
+			n += run;
+			total -= run;
+			x += run;
+			if (x == width) {
+				x = 0;
+				y++;
+			}
+		}
+		busy_us += esp_timer_get_time() - start_us;
+
+		spi_transaction_t *t = &dev->_dma_trans[next];
+		memset(t, 0, sizeof(*t));
+		t->length = n*2*8;
+		t->tx_buffer = buf;
+		ret = spi_device_queue_trans(dev->_SPIHandle, t, portMAX_DELAY);
+		assert(ret==ESP_OK);
+		inflight++;
+		next = (next+1) % FLUSH_BUFFERS;
+	}
+
+	// The next window starts with commands, which need an idle queue
+	while (inflight > 0) {
+		spi_transaction_t *done;
+		ret = spi_device_get_trans_result(dev->_SPIHandle, &done, portMAX_DELAY);
+		assert(ret==ESP_OK);
+		inflight--;
+	}
+	return busy_us;
+}
+
+// Send one window of the frame buffer, returns bytes pushed
+static uint32_t lcdFlushWindow(TFT_t *dev, const FLUSH_WINDOW_t *w, int64_t *busy_us)
+{
 	spi_master_write_command(dev, 0x2A); // set column(x) address
-	spi_master_write_addr(dev, dev->_offsetx, dev->_offsetx+dev->_width-1);
+	spi_master_write_addr(dev, dev->_offsetx+w->x1, dev->_offsetx+w->x2);
 	spi_master_write_command(dev, 0x2B); // set Page(y) address
-	spi_master_write_addr(dev, dev->_offsety, dev->_offsety+dev->_height-1);
+	spi_master_write_addr(dev, dev->_offsety+w->y1, dev->_offsety+w->y2);
 	spi_master_write_command(dev, 0x2C); // Memory Write
 
-	//uint16_t size = dev->_width*dev->_height;
-	uint32_t size = dev->_width*dev->_height;
-	uint16_t *image = dev->_frame_buffer;
-	while (size > 0) {
-		// 1024 bytes per time.
-		uint16_t bs = (size > 1024) ? 1024 : size;
-		spi_master_write_colors(dev, image, bs);
-		size -= bs;
-		image += bs;
+	uint32_t width = w->x2-w->x1+1;
+	uint32_t height = w->y2-w->y1+1;
+	if (dev->_dma_buffer[0] != NULL) {
+		*busy_us += lcdQueueWindow(dev, w);
+	} else {
+		int64_t start_us = esp_timer_get_time();
+		for (int y=w->y1;y<=w->y2;y++) {
+			spi_master_write_colors(dev, &dev->_frame_buffer[y*dev->_width+w->x1], width);
+		}
+		*busy_us += esp_timer_get_time() - start_us;
+	}
+	return FLUSH_WINDOW_OVERHEAD + width*height*2;
+}
+
+// FNV-1a over the pixels of row y, never 0
+static uint64_t lcdRowHash(TFT_t *dev, uint16_t y)
+{
+	const uint16_t *row = &dev->_frame_buffer[y*dev->_width];
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (int x=0;x<dev->_width;x++) {
+		hash = (hash ^ row[x]) * 0x100000001b3ULL;
+	}
+	return hash ? hash : 1;
+}
+
+// Drop damaged rows that are back to what the panel already shows.
+// Clearing the screen and drawing the same text again changes every pixel
+// of the text twice, so per-write comparison alone marks all of it.
+static void lcdDropUnchangedRows(TFT_t *dev)
+{
+	if (dev->_row_hash == NULL) return;
+	for (int y=0;y<dev->_height;y++) {
+		if (dev->_dirty_x1[y] > dev->_dirty_x2[y]) continue;
+		uint64_t hash = lcdRowHash(dev, y);
+		if (hash == dev->_row_hash[y]) {
+			dev->_dirty_x1[y] = UINT16_MAX;
+			dev->_dirty_x2[y] = 0;
+		} else {
+			dev->_row_hash[y] = hash;
+		}
+	}
+}
+
+// Turn the damage into windows and clear it, returns the window count.
+// A run of consecutive damaged rows becomes one window spanning the union
+// of their columns; a clean row ends the window. Windows beyond
+// FLUSH_MAX_WINDOWS are merged into the last one.
+static uint16_t lcdCollectWindows(TFT_t *dev)
+{
+	uint16_t count = 0;
+	uint16_t y = 0;
+	lcdDropUnchangedRows(dev);
+	while (y < dev->_height) {
+		uint16_t x1, x2;
+		if (!lcdDirtySpan(dev, y, &x1, &x2)) {
+			y++;
+			continue;
+		}
+		uint16_t y1 = y;
+		uint16_t nx1, nx2;
+		while (y+1 < dev->_height && lcdDirtySpan(dev, y+1, &nx1, &nx2)) {
+			if (nx1 < x1) x1 = nx1;
+			if (nx2 > x2) x2 = nx2;
+			y++;
+		}
+		if (count < FLUSH_MAX_WINDOWS) {
+			FLUSH_WINDOW_t *w = &dev->_flush_windows[count++];
+			w->x1 = x1;
+			w->y1 = y1;
+			w->x2 = x2;
+			w->y2 = y;
+		} else {
+			FLUSH_WINDOW_t *w = &dev->_flush_windows[count-1];
+			if (x1 < w->x1) w->x1 = x1;
+			if (x2 > w->x2) w->x2 = x2;
+			w->y2 = y;
+		}
+		y++;
+	}
+	lcdMarkClean(dev);
+	dev->_flush_count = count;
+	return count;
+}
+
+// Send the collected windows and update the statistics
+static void lcdFlushWindows(TFT_t *dev)
+{
+	if (dev->_flush_count == 0) return;
+
+	int64_t start_us = esp_timer_get_time();
+	int64_t busy_us = 0;
+	uint32_t bytes = 0;
+	for (int i=0;i<dev->_flush_count;i++) {
+		bytes += lcdFlushWindow(dev, &dev->_flush_windows[i], &busy_us);
+	}
+
+	dev->_flush_stats.frames++;
+	dev->_flush_stats.windows += dev->_flush_count;
+	dev->_flush_stats.last_bytes = bytes;
+	dev->_flush_stats.total_bytes += bytes;
+	dev->_flush_stats.last_us = esp_timer_get_time() - start_us;
+	dev->_flush_stats.last_busy_us = busy_us;
+	ESP_LOGD(TAG, "flush: %d windows, %"PRIu32" of %"PRIu32" bytes in %"PRId64" us, CPU %"PRId64" us",
+		dev->_flush_count, bytes, dev->_flush_stats.full_bytes, dev->_flush_stats.last_us, busy_us);
+}
+
+// Draw Frame Buffer
+// Only damaged rows are sent, see lcdCollectWindows
+void lcdDrawFinish(TFT_t *dev)
+{
+	if (dev->_use_frame_buffer == false) return;
+
+	if (dev->_flush_idle == NULL) {
+		lcdCollectWindows(dev);
+		lcdFlushWindows(dev);
+		return;
+	}
+	xSemaphoreTake(dev->_flush_idle, portMAX_DELAY);
+	lcdCollectWindows(dev);
+	lcdFlushWindows(dev);
+	xSemaphoreGive(dev->_flush_idle);
+}
+
+// The idle semaphore is taken by lcdDrawFinishAsync and given back here
+// once the windows are on the panel; it is the only completion signal
+static void lcdFlushTask(void *arg)
+{
+	TFT_t *dev = (TFT_t *)arg;
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		lcdFlushWindows(dev);
+		dev->_flush_busy = false;
+		xSemaphoreGive(dev->_flush_idle);
 	}
-	return;
+}
+
+// Core for the flush task, tskNO_AFFINITY by default.
+// Takes effect if called before the first lcdDrawFinishAsync.
+void lcdSetFlushCore(TFT_t *dev, BaseType_t core)
+{
+	dev->_flush_core = core;
+}
+
+// Draw Frame Buffer without waiting for the bus.
+// The damage is collected here and sent by a flush task created on first use
+// with the caller's priority on the core set by lcdSetFlushCore. Drawing may
+// continue at once: pixels changed during the flush are marked again and go
+// out with the next one. Blocks only while the previous asynchronous flush is
+// still running. Commands that talk to the panel directly (lcdDisplayOff,
+// lcdInversionOn, ...) must wait for lcdFlushWait first.
+// Returns a handle for lcdFlushWait.
+FLUSH_HANDLE_t lcdDrawFinishAsync(TFT_t *dev)
+{
+	if (dev->_use_frame_buffer == false) return dev->_flush_queued;
+	if (dev->_flush_idle == NULL) {
+		lcdDrawFinish(dev);
+		return dev->_flush_queued;
+	}
+
+	xSemaphoreTake(dev->_flush_idle, portMAX_DELAY);
+	if (lcdCollectWindows(dev) == 0) {
+		xSemaphoreGive(dev->_flush_idle);
+		return dev->_flush_queued;
+	}
+
+	if (dev->_flush_task == NULL &&
+		xTaskCreatePinnedToCore(lcdFlushTask, "lcd_flush", 3072, dev, uxTaskPriorityGet(NULL),
+			&dev->_flush_task, dev->_flush_core) != pdPASS) {
+		ESP_LOGW(TAG, "flush task not created, flushing synchronously");
+		dev->_flush_task = NULL;
+		lcdFlushWindows(dev);
+		xSemaphoreGive(dev->_flush_idle);
+		return dev->_flush_queued;
+	}
+
+	dev->_flush_queued++;
+	dev->_flush_busy = true;
+	xTaskNotifyGive(dev->_flush_task);
+	return dev->_flush_queued;
+}
+
+// Wait until the flush identified by handle has completed.
+// Returns false on timeout.
+bool lcdFlushWait(TFT_t *dev, FLUSH_HANDLE_t handle, TickType_t ticks)
+{
+	if (dev->_flush_idle == NULL) return true;
+	// Only one asynchronous flush runs at a time: a newer handle means
+	// this one is done, otherwise it is done once the flush task is idle
+	if (handle != dev->_flush_queued) return true;
+	if (xSemaphoreTake(dev->_flush_idle, ticks) != pdTRUE) return false;
+	xSemaphoreGive(dev->_flush_idle);
+	return true;
+}
+
+// Frame buffer flush statistics
+void lcdGetFlushStats(TFT_t *dev, FLUSH_STATS_t *stats)
+{
+	*stats = dev->_flush_stats;
 }
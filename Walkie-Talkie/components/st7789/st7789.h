@@ -1,6 +1,9 @@
 #ifndef MAIN_ST7789_H_
 #define MAIN_ST7789_H_
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/spi_master.h"
 #include "fontx.h"
 
@@ -25,6 +28,31 @@ typedef enum {
 	SCROLL_UP = 4,
 } SCROLL_TYPE_t;
 
+#define FLUSH_BUFFERS 2			// DMA staging buffers in flight
+#define FLUSH_DMA_CHUNK 1024	// pixels per queued DMA transaction
+#define FLUSH_MAX_WINDOWS 16	// windows per flush, the rest is merged into the last one
+
+typedef struct {
+	uint16_t x1;
+	uint16_t y1;
+	uint16_t x2;
+	uint16_t y2;
+} FLUSH_WINDOW_t;
+
+// Returned by lcdDrawFinishAsync, passed to lcdFlushWait
+typedef uint32_t FLUSH_HANDLE_t;
+
+// Frame buffer flush statistics
+typedef struct {
+	uint32_t frames;		// lcdDrawFinish calls that pushed something
+	uint32_t windows;		// CASET/RASET windows sent
+	uint32_t last_bytes;	// bytes pushed by the last frame, commands included
+	uint64_t total_bytes;
+	uint32_t full_bytes;	// bytes a full-screen push would take
+	int64_t last_us;		// duration of the last flush
+	int64_t last_busy_us;	// CPU time of the last flush spent filling staging buffers
+} FLUSH_STATS_t;
+
 typedef struct {
 	uint16_t _width;
 	uint16_t _height;
@@ -40,6 +68,19 @@ typedef struct {
 	spi_device_handle_t _SPIHandle;
 	bool _use_frame_buffer;
 	uint16_t *_frame_buffer;
+	uint16_t *_dirty_x1;	// per-row damage in the frame buffer, row is clean if x1 > x2
+	uint16_t *_dirty_x2;
+	uint64_t *_row_hash;	// per-row hash of what the panel shows, 0 - unknown
+	FLUSH_STATS_t _flush_stats;
+	uint8_t *_dma_buffer[FLUSH_BUFFERS];	// NULL - blocking flush through spi_master_write_colors
+	spi_transaction_t _dma_trans[FLUSH_BUFFERS];
+	FLUSH_WINDOW_t _flush_windows[FLUSH_MAX_WINDOWS];
+	uint16_t _flush_count;
+	volatile FLUSH_HANDLE_t _flush_queued;	// handle of the last flush handed to the flush task
+	volatile bool _flush_busy;	// the flush task is reading the frame buffer
+	TaskHandle_t _flush_task;
+	BaseType_t _flush_core;		// core the flush task is pinned to
+	SemaphoreHandle_t _flush_idle;	// held from collecting the damage until the flush completes
 } TFT_t;
 
 void spi_clock_speed(int speed);
@@ -86,5 +127,9 @@ void lcdInversionOff(TFT_t * dev);
 void lcdInversionOn(TFT_t * dev);
 void lcdWrapArround(TFT_t * dev, SCROLL_TYPE_t scroll, int start, int end);
 void lcdDrawFinish(TFT_t *dev);
+void lcdSetFlushCore(TFT_t *dev, BaseType_t core);
+FLUSH_HANDLE_t lcdDrawFinishAsync(TFT_t *dev);
+bool lcdFlushWait(TFT_t *dev, FLUSH_HANDLE_t handle, TickType_t ticks);
+void lcdGetFlushStats(TFT_t *dev, FLUSH_STATS_t *stats);
 #endif /* MAIN_ST7789_H_ */
 
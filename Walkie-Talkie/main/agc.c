@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <string.h>
+#include "agc.h"
+
+#define AGC_Q15_ONE 32768
+#define AGC_LEVEL_ATTACK_Q15 16384  // Оцінка рівня швидко наздоганяє гучніший сигнал
+#define AGC_LEVEL_RELEASE_Q15 3277  // і повільно спадає в паузах між словами
+#define AGC_LIMITER_DECAY 4710      // ln(100) * 1024: спад до 1% за час попереднього перегляду
+
+// Крок до цілі щонайменше на одиницю, інакше згладжування застрягає біля неї
+static inline int32_t smooth_q15(int32_t value, int32_t target, int16_t rate_q15) {
+    int32_t diff = target - value;
+    int32_t step = (int32_t)(((int64_t)diff * rate_q15) >> 15);
+    if (step == 0 && diff != 0) {
+        step = diff > 0 ? 1 : -1;
+    }
+    return value + step;
+}
+
+bool agc_init(agc_t *agc, const agc_config_t *config) {
+    memset(agc, 0, sizeof(*agc));
+    if (config->lookahead == 0 || config->lookahead > AGC_MAX_LOOKAHEAD || config->limit <= 0 ||
+        config->min_gain_q15 <= 0 || config->max_gain_q15 < config->min_gain_q15) {
+        return false;
+    }
+
+    agc->delay = (int32_t *)calloc(config->lookahead, sizeof(int32_t));
+    agc->min_gain = (int32_t *)calloc(config->lookahead + 1, sizeof(int32_t));
+    agc->min_index = (uint32_t *)calloc(config->lookahead + 1, sizeof(uint32_t));
+    if (!agc->delay || !agc->min_gain || !agc->min_index) {
+        agc_free(agc);
+        return false;
+    }
+
+    agc->config = *config;
+    // Обмежувач має встигнути знизити підсилення за час попереднього перегляду
+    int32_t attack = (AGC_LIMITER_DECAY * 32) / config->lookahead;
+    agc->limiter_attack_q15 = attack > 32767 ? 32767 : (int16_t)attack;
+    agc->limiter_release_q15 = agc->limiter_attack_q15 / 32 > 0 ? agc->limiter_attack_q15 / 32 : 1;
+    agc_reset(agc);
+    return true;
+}
+
+void agc_free(agc_t *agc) {
+    free(agc->delay);
+    free(agc->min_gain);
+    free(agc->min_index);
+    agc->delay = NULL;
+    agc->min_gain = NULL;
+    agc->min_index = NULL;
+}
+
+void agc_reset(agc_t *agc) {
+    memset(agc->delay, 0, agc->config.lookahead * sizeof(int32_t));
+    agc->delay_pos = 0;
+    agc->min_head = 0;
+    agc->min_count = 0;
+    agc->sample_index = 0;
+    agc->gain_q15 = agc->config.min_gain_q15;
+    agc->limiter_gain_q15 = AGC_Q15_ONE;
+    agc->level = 0;
+    agc->gated = true;
+}
+
+// Повільний контур: нове підсилення наприкінці кадру за середнім модулем сигналу
+static int32_t update_gain(agc_t *agc, const int16_t *buf, size_t len) {
+    const agc_config_t *cfg = &agc->config;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += buf[i] < 0 ? -(int32_t)buf[i] : buf[i];
+    }
+    int32_t frame_level = (int32_t)(sum / len);
+
+    agc->level = smooth_q15(agc->level, frame_level,
+                            frame_level > agc->level ? AGC_LEVEL_ATTACK_Q15 : AGC_LEVEL_RELEASE_Q15);
+    agc->gated = agc->level < cfg->gate_level;
+
+    int32_t desired = cfg->min_gain_q15;
+    if (!agc->gated && agc->level > 0) {
+        int64_t gain = ((int64_t)cfg->target_level << 15) / agc->level;
+        desired = gain > cfg->max_gain_q15 ? cfg->max_gain_q15 : (gain < cfg->min_gain_q15 ? cfg->min_gain_q15 : (int32_t)gain);
+    }
+    return smooth_q15(agc->gain_q15, desired, desired < agc->gain_q15 ? cfg->attack_q15 : cfg->release_q15);
+}
+
+// Підсилення обмежувача для семпла: 1.0, якщо амплітуда в межах ліміту
+static inline int32_t limiter_target(int32_t value, int16_t limit) {
+    int32_t amplitude = value < 0 ? -value : value;
+    if (amplitude <= limit) {
+        return AGC_Q15_ONE;
+    }
+    return (int32_t)(((int64_t)limit << 15) / amplitude);
+}
+
+void agc_process(agc_t *agc, int16_t *buf, size_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    const agc_config_t *cfg = &agc->config;
+    const uint16_t lookahead = cfg->lookahead;
+    const uint16_t queue_size = lookahead + 1;
+
+    // Підсилення змінюється лінійно протягом кадру, щоб не було сходинок
+    int32_t gain_from = agc->gain_q15;
+    int32_t gain_to = update_gain(agc, buf, len);
+    int64_t gain_q23 = (int64_t)gain_from << 8;
+    // Множення, а не зсув: різниця при зменшенні підсилення від'ємна
+    int64_t gain_step = (int64_t)(gain_to - gain_from) * 256 / (int64_t)len;
+
+    for (size_t i = 0; i < len; i++) {
+        gain_q23 += gain_step;
+        int32_t value = (int32_t)(((int64_t)buf[i] * (gain_q23 >> 8)) >> 15);
+        uint32_t n = agc->sample_index++;
+
+        // Ковзний мінімум цільового підсилення за вікно [n - lookahead, n]
+        int32_t target = limiter_target(value, cfg->limit);
+        while (agc->min_count > 0) {
+            uint16_t back = (agc->min_head + agc->min_count - 1) % queue_size;
+            if (agc->min_gain[back] < target) {
+                break;
+            }
+            agc->min_count--;
+        }
+        uint16_t tail = (agc->min_head + agc->min_count) % queue_size;
+        agc->min_gain[tail] = target;
+        agc->min_index[tail] = n;
+        agc->min_count++;
+        if (n - agc->min_index[agc->min_head] > lookahead) {
+            agc->min_head = (agc->min_head + 1) % queue_size;
+            agc->min_count--;
+        }
+        int32_t window_min = agc->min_gain[agc->min_head];
+
+        agc->limiter_gain_q15 = smooth_q15(agc->limiter_gain_q15, window_min,
+                                           window_min < agc->limiter_gain_q15 ? agc->limiter_attack_q15 : agc->limiter_release_q15);
+
+        // Вихід - семпл, що надійшов lookahead семплів тому
+        int32_t delayed = agc->delay[agc->delay_pos];
+        agc->delay[agc->delay_pos] = value;
+        agc->delay_pos = agc->delay_pos + 1 < lookahead ? agc->delay_pos + 1 : 0;
+
+        int32_t out = (int32_t)(((int64_t)delayed * agc->limiter_gain_q15) >> 15);
+        // Запобіжник на випадок, якщо згладжування не встигло за піком
+        if (out > cfg->limit) {
+            out = cfg->limit;
+        } else if (out < -cfg->limit) {
+            out = -cfg->limit;
+        }
+        buf[i] = (int16_t)out;
+    }
+
+    agc->gain_q15 = gain_to;
+}
+
+void agc_get_stats(const agc_t *agc, agc_stats_t *stats) {
+    stats->gain_q15 = agc->gain_q15;
+    stats->limiter_gain_q15 = agc->limiter_gain_q15;
+    stats->level = agc->level;
+    stats->gated = agc->gated;
+}
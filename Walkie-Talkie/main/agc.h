@@ -0,0 +1,60 @@
+#ifndef MAIN_AGC_H_
+#define MAIN_AGC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Автоматичне регулювання підсилення у фіксованій точці.
+// Повільний контур раз на кадр оцінює рівень мови і плавно веде підсилення до цільової
+// гучності; нижче порога шумового шлюзу підсилення опускається до мінімального.
+// Обмежувач з попереднім переглядом затримує сигнал на lookahead семплів і знижує
+// підсилення ще до піку, тому на виході немає жорсткого обрізання.
+// Вартість - сталий обсяг роботи на семпл. Модуль не залежить від FreeRTOS.
+
+#define AGC_MAX_LOOKAHEAD 128       // Найбільша затримка обмежувача (семпли)
+
+typedef struct {
+    int32_t target_level;       // Цільовий середній модуль сигналу
+    int32_t gate_level;         // Рівень, нижче якого сигнал вважається шумом
+    int32_t min_gain_q15;       // Підсилення в паузах і найменше підсилення
+    int32_t max_gain_q15;       // Найбільше підсилення
+    int16_t attack_q15;         // Швидкість зменшення підсилення за кадр
+    int16_t release_q15;        // Швидкість збільшення підсилення за кадр
+    int16_t limit;              // Найбільша амплітуда на виході
+    uint16_t lookahead;         // Затримка обмежувача (семпли)
+} agc_config_t;
+
+typedef struct {
+    int32_t gain_q15;           // Підсилення повільного контуру
+    int32_t limiter_gain_q15;   // Поточне підсилення обмежувача (не більше 1.0)
+    int32_t level;              // Оцінка рівня сигналу
+    bool gated;                 // Сигнал нижче порога шлюзу
+} agc_stats_t;
+
+typedef struct {
+    agc_config_t config;
+    int32_t gain_q15;
+    int32_t level;
+    bool gated;
+    int32_t limiter_gain_q15;
+    int16_t limiter_attack_q15;  // Швидкість спаду підсилення обмежувача за семпл
+    int16_t limiter_release_q15; // Швидкість відновлення обмежувача за семпл
+    // Лінія затримки підсилених семплів
+    int32_t *delay;
+    uint16_t delay_pos;
+    // Черга мінімумів цільового підсилення обмежувача у вікні попереднього перегляду
+    int32_t *min_gain;
+    uint32_t *min_index;
+    uint16_t min_head;
+    uint16_t min_count;
+    uint32_t sample_index;
+} agc_t;
+
+bool agc_init(agc_t *agc, const agc_config_t *config);
+void agc_free(agc_t *agc);
+void agc_reset(agc_t *agc);
+void agc_process(agc_t *agc, int16_t *buf, size_t len);
+void agc_get_stats(const agc_t *agc, agc_stats_t *stats);
+
+#endif /* MAIN_AGC_H_ */
@@ -0,0 +1,197 @@
+#include <string.h>
+#include "codec.h"
+
+// --- PCM16 без стиснення ---
+
+static size_t pcm16_max_encoded_size(size_t samples) {
+    return samples * sizeof(int16_t);
+}
+
+static void pcm16_reset(codec_state_t *state) {
+}
+
+static size_t pcm16_encode(codec_state_t *state, const int16_t *pcm, size_t samples, uint8_t *out) {
+    memcpy(out, pcm, samples * sizeof(int16_t));
+    return samples * sizeof(int16_t);
+}
+
+static size_t pcm16_decode(codec_state_t *state, const uint8_t *in, size_t len, int16_t *pcm, size_t max_samples) {
+    size_t samples = len / sizeof(int16_t);
+    if (samples > max_samples) {
+        samples = max_samples;
+    }
+    memcpy(pcm, in, samples * sizeof(int16_t));
+    return samples;
+}
+
+const codec_t codec_pcm16 = {
+    .id = PACKET_CODEC_PCM16,
+    .name = "PCM16",
+    .max_encoded_size = pcm16_max_encoded_size,
+    .reset = pcm16_reset,
+    .encode = pcm16_encode,
+    .decode = pcm16_decode,
+};
+
+// --- IMA-ADPCM ---
+// Кодер зберігає стан між кадрами, а кожен блок починається зі стану на початку кадру
+// (predictor LE16, index, 0), тому декодер відновлюється після втрати пакета.
+
+static const int16_t adpcm_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static inline uint8_t adpcm_encode_sample(adpcm_state_t *st, int16_t sample) {
+    int step = adpcm_step_table[st->index];
+    int diff = sample - st->predictor;
+    int vpdiff = step >> 3;
+    uint8_t nibble = 0;
+
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        vpdiff += step;
+    }
+
+    int predictor = st->predictor + ((nibble & 8) ? -vpdiff : vpdiff);
+    if (predictor > 32767) {
+        predictor = 32767;
+    } else if (predictor < -32768) {
+        predictor = -32768;
+    }
+    st->predictor = (int16_t)predictor;
+
+    int index = st->index + adpcm_index_table[nibble];
+    st->index = index < 0 ? 0 : (index > 88 ? 88 : index);
+    return nibble;
+}
+
+static inline int16_t adpcm_decode_sample(adpcm_state_t *st, uint8_t nibble) {
+    int step = adpcm_step_table[st->index];
+    int vpdiff = step >> 3;
+
+    if (nibble & 4) {
+        vpdiff += step;
+    }
+    if (nibble & 2) {
+        vpdiff += step >> 1;
+    }
+    if (nibble & 1) {
+        vpdiff += step >> 2;
+    }
+
+    int predictor = st->predictor + ((nibble & 8) ? -vpdiff : vpdiff);
+    if (predictor > 32767) {
+        predictor = 32767;
+    } else if (predictor < -32768) {
+        predictor = -32768;
+    }
+    st->predictor = (int16_t)predictor;
+
+    int index = st->index + adpcm_index_table[nibble];
+    st->index = index < 0 ? 0 : (index > 88 ? 88 : index);
+    return st->predictor;
+}
+
+static size_t adpcm_max_encoded_size(size_t samples) {
+    return ADPCM_BLOCK_SIZE(samples);
+}
+
+static void adpcm_reset(codec_state_t *state) {
+    state->adpcm.predictor = 0;
+    state->adpcm.index = 0;
+}
+
+static size_t adpcm_encode(codec_state_t *state, const int16_t *pcm, size_t samples, uint8_t *out) {
+    adpcm_state_t *st = &state->adpcm;
+
+    out[0] = (uint16_t)st->predictor & 0xFF;
+    out[1] = ((uint16_t)st->predictor >> 8) & 0xFF;
+    out[2] = st->index;
+    out[3] = 0;
+
+    // Молодший напівбайт - перший семпл, як у WAV IMA-ADPCM
+    uint8_t *p = out + ADPCM_BLOCK_HEADER_SIZE;
+    for (size_t i = 0; i < samples; i += 2) {
+        uint8_t lo = adpcm_encode_sample(st, pcm[i]);
+        uint8_t hi = (i + 1 < samples) ? adpcm_encode_sample(st, pcm[i + 1]) : 0;
+        *p++ = lo | (hi << 4);
+    }
+    return ADPCM_BLOCK_SIZE(samples);
+}
+
+static size_t adpcm_decode(codec_state_t *state, const uint8_t *in, size_t len, int16_t *pcm, size_t max_samples) {
+    adpcm_state_t *st = &state->adpcm;
+    if (len < ADPCM_BLOCK_HEADER_SIZE || in[2] > 88) {
+        return 0;
+    }
+
+    st->predictor = (int16_t)(in[0] | (in[1] << 8));
+    st->index = in[2];
+
+    size_t samples = (len - ADPCM_BLOCK_HEADER_SIZE) * 2;
+    if (samples > max_samples) {
+        samples = max_samples;
+    }
+
+    const uint8_t *p = in + ADPCM_BLOCK_HEADER_SIZE;
+    for (size_t i = 0; i < samples; i += 2) {
+        uint8_t byte = *p++;
+        pcm[i] = adpcm_decode_sample(st, byte & 0x0F);
+        if (i + 1 < samples) {
+            pcm[i + 1] = adpcm_decode_sample(st, byte >> 4);
+        }
+    }
+    return samples;
+}
+
+const codec_t codec_ima_adpcm = {
+    .id = PACKET_CODEC_IMA_ADPCM,
+    .name = "IMA-ADPCM",
+    .max_encoded_size = adpcm_max_encoded_size,
+    .reset = adpcm_reset,
+    .encode = adpcm_encode,
+    .decode = adpcm_decode,
+};
+
+static const codec_t *const codecs[] = {
+    &codec_pcm16,
+    &codec_ima_adpcm,
+};
+
+const codec_t *codec_find(uint8_t id) {
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+        if (codecs[i]->id == id) {
+            return codecs[i];
+        }
+    }
+    return NULL;
+}
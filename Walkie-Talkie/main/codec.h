@@ -0,0 +1,38 @@
+#ifndef MAIN_CODEC_H_
+#define MAIN_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "packet.h"
+
+// Змінний кодек між підсиленням сигналу та шифруванням.
+// Кодек обирається відправником, ідентифікатор передається в заголовку пакета.
+
+// Блок IMA-ADPCM: стан кодера на початку кадру + по 4 біти на семпл
+#define ADPCM_BLOCK_HEADER_SIZE 4
+#define ADPCM_BLOCK_SIZE(samples) (ADPCM_BLOCK_HEADER_SIZE + ((samples) + 1) / 2)
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;
+} adpcm_state_t;
+
+typedef union {
+    adpcm_state_t adpcm;
+} codec_state_t;
+
+typedef struct {
+    packet_codec_t id;
+    const char *name;
+    size_t (*max_encoded_size)(size_t samples);
+    void (*reset)(codec_state_t *state);
+    size_t (*encode)(codec_state_t *state, const int16_t *pcm, size_t samples, uint8_t *out);
+    size_t (*decode)(codec_state_t *state, const uint8_t *in, size_t len, int16_t *pcm, size_t max_samples);
+} codec_t;
+
+extern const codec_t codec_pcm16;
+extern const codec_t codec_ima_adpcm;
+
+const codec_t *codec_find(uint8_t id);
+
+#endif /* MAIN_CODEC_H_ */
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include "conference.h"
+
+void conference_init(conference_t *conf, const conference_config_t *config) {
+    memset(conf, 0, sizeof(*conf));
+    conf->config = *config;
+}
+
+// Пір, якому можна передавати кадри; станції, що відключаються, вже не враховуються
+conference_peer_t *conference_find(conference_t *conf, uint32_t addr) {
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        conference_peer_t *peer = &conf->peers[i];
+        if (peer->used && !peer->closing && peer->addr == addr) {
+            return peer;
+        }
+    }
+    return NULL;
+}
+
+static void peer_free(conference_peer_t *peer) {
+    stream_rx_free(&peer->rx);
+    stream_tx_free(&peer->tx);
+    free(peer->input);
+    memset(peer, 0, sizeof(*peer));
+}
+
+// Виділяє потоки для нового піра без м'ютекса. Кожен пір отримує власну сесію,
+// щоб nonce його потоку не збігався з nonce інших пірів
+conference_streams_t *conference_streams_alloc(const conference_t *conf, uint32_t session) {
+    const conference_config_t *cfg = &conf->config;
+    conference_streams_t *streams = (conference_streams_t *)calloc(1, sizeof(conference_streams_t));
+    if (streams == NULL) {
+        return NULL;
+    }
+    streams->input = (int16_t *)calloc(cfg->frame_samples, sizeof(int16_t));
+    if (!streams->input ||
+        !stream_rx_init(&streams->rx, cfg->jb_slots, cfg->frame_samples * sizeof(int16_t), cfg->frame_period_us) ||
+        !stream_tx_init(&streams->tx, cfg->codec, cfg->rate, cfg->tx_filter, cfg->frame_samples, session, cfg->fec_group)) {
+        conference_streams_free(streams);
+        return NULL;
+    }
+    return streams;
+}
+
+// Звільняє потоки, які conference_join() не забрала; NULL допускається
+void conference_streams_free(conference_streams_t *streams) {
+    if (streams == NULL) {
+        return;
+    }
+    stream_rx_free(&streams->rx);
+    stream_tx_free(&streams->tx);
+    free(streams->input);
+    free(streams);
+}
+
+// Додає станцію за адресою або повертає наявний запис. mac може бути NULL, якщо
+// пір відомий лише з маяка. Новий запис забирає *streams і обнуляє вказівник,
+// інакше викликач звільняє їх conference_streams_free() після виходу з м'ютекса
+conference_peer_t *conference_join(conference_t *conf, uint32_t addr, const uint8_t *mac,
+                                   conference_streams_t **streams, int64_t now_us) {
+    conference_peer_t *peer = conference_find(conf, addr);
+    if (peer != NULL) {
+        if (mac) {
+            memcpy(peer->mac, mac, CONF_MAC_SIZE);
+        }
+        peer->last_us = now_us;
+        return peer;
+    }
+    if (*streams == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        if (!conf->peers[i].used) {
+            peer = &conf->peers[i];
+            break;
+        }
+    }
+    if (peer == NULL) {
+        return NULL;
+    }
+
+    memset(peer, 0, sizeof(*peer));
+    peer->rx = (*streams)->rx;
+    peer->tx = (*streams)->tx;
+    peer->input = (*streams)->input;
+    free(*streams);
+    *streams = NULL;
+
+    peer->addr = addr;
+    if (mac) {
+        memcpy(peer->mac, mac, CONF_MAC_SIZE);
+    }
+    peer->last_us = now_us;
+    peer->used = true;
+    return peer;
+}
+
+// Відмічає автентифікований трафік піра (пакет потоку або маяк)
+void conference_touch(conference_t *conf, uint32_t addr, int64_t now_us) {
+    conference_peer_t *peer = conference_find(conf, addr);
+    if (peer != NULL) {
+        peer->last_us = now_us;
+    }
+}
+
+// Позначає станцію відключеною; потоки звільняються пізніше в conference_collect()
+void conference_leave(conference_t *conf, const uint8_t *mac) {
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        conference_peer_t *peer = &conf->peers[i];
+        if (peer->used && memcmp(peer->mac, mac, CONF_MAC_SIZE) == 0) {
+            peer->closing = true;
+        }
+    }
+}
+
+// Те саме за адресою: станція зникла з виявлення або отримала іншу адресу
+void conference_leave_addr(conference_t *conf, uint32_t addr) {
+    conference_peer_t *peer = conference_find(conf, addr);
+    if (peer != NULL) {
+        peer->closing = true;
+    }
+}
+
+// Відключає пірів без автентифікованого трафіку довше за idle_timeout_us; повертає їх кількість
+size_t conference_expire(conference_t *conf, int64_t now_us) {
+    size_t count = 0;
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        conference_peer_t *peer = &conf->peers[i];
+        if (peer->used && !peer->closing && now_us - peer->last_us > conf->config.idle_timeout_us) {
+            peer->closing = true;
+            count++;
+        }
+    }
+    return count;
+}
+
+// Звільняє відключені станції; викликає задача мікшера між тактами
+void conference_collect(conference_t *conf) {
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        if (conf->peers[i].used && conf->peers[i].closing) {
+            peer_free(&conf->peers[i]);
+        }
+    }
+}
+
+uint16_t conference_count(const conference_t *conf) {
+    uint16_t count = 0;
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        count += conf->peers[i].used && !conf->peers[i].closing;
+    }
+    return count;
+}
@@ -0,0 +1,72 @@
+#ifndef MAIN_CONFERENCE_H_
+#define MAIN_CONFERENCE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stream.h"
+
+// Таблиця учасників конференції на сервері. Кожен пір має власні потоки прийому
+// та передачі (stream.h) і кадр для мікшера поточного такту. Фільтри перетворювача
+// частоти спільні, пір тримає лише історію відліків. Пам'ять під потоки виділяє
+// conference_streams_alloc() до входу в м'ютекс, conference_join() лише переносить
+// їх у запис, а звільняються вони після відключення станції.
+// До конференції потрапляють лише станції, відомі з асоціації з точкою доступу або
+// з автентифікованого маяка; пір без автентифікованого трафіку довше за
+// idle_timeout_us відключається conference_expire().
+// Модуль не залежить від FreeRTOS: таблицю змінюють під м'ютексом викликача,
+// а звільнення відкладене до conference_collect(), щоб задача мікшера могла
+// працювати з потоками піра без м'ютекса.
+
+#define CONF_MAX_PEERS 8            // Найбільша кількість станцій на точці доступу
+#define CONF_MAC_SIZE 6
+
+typedef struct {
+    const codec_t *codec;       // Кодек потоків до пірів
+    packet_rate_t rate;
+    const resampler_filter_t *tx_filter; // Спільний фільтр частота мікшера -> rate
+    size_t frame_samples;
+    uint32_t frame_period_us;
+    uint16_t jb_slots;          // Глибина джитер-буфера кожного піра
+    uint8_t fec_group;
+    int64_t idle_timeout_us;    // Пір без автентифікованих пакетів і маяків відключається
+} conference_config_t;
+
+// Потоки нового піра, підготовлені поза м'ютексом
+typedef struct {
+    stream_rx_t rx;
+    stream_tx_t tx;
+    int16_t *input;
+} conference_streams_t;
+
+typedef struct {
+    bool used;
+    bool closing;               // Станцію відключено, пам'ять звільнить conference_collect()
+    uint32_t addr;              // IPv4 адреса в мережевому порядку
+    uint8_t mac[CONF_MAC_SIZE];
+    stream_rx_t rx;
+    stream_tx_t tx;
+    int16_t *input;             // Кадр піра в поточному такті (frame_samples)
+    bool talking;               // Кадр піра додано до суми такту
+    int64_t last_us;            // Час приєднання або останнього автентифікованого трафіку
+} conference_peer_t;
+
+typedef struct {
+    conference_config_t config;
+    conference_peer_t peers[CONF_MAX_PEERS];
+} conference_t;
+
+void conference_init(conference_t *conf, const conference_config_t *config);
+conference_peer_t *conference_find(conference_t *conf, uint32_t addr);
+conference_streams_t *conference_streams_alloc(const conference_t *conf, uint32_t session);
+void conference_streams_free(conference_streams_t *streams);
+conference_peer_t *conference_join(conference_t *conf, uint32_t addr, const uint8_t *mac,
+                                   conference_streams_t **streams, int64_t now_us);
+void conference_touch(conference_t *conf, uint32_t addr, int64_t now_us);
+void conference_leave(conference_t *conf, const uint8_t *mac);
+void conference_leave_addr(conference_t *conf, uint32_t addr);
+size_t conference_expire(conference_t *conf, int64_t now_us);
+void conference_collect(conference_t *conf);
+uint16_t conference_count(const conference_t *conf);
+
+#endif /* MAIN_CONFERENCE_H_ */
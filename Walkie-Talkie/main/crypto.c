@@ -0,0 +1,74 @@
+#include <string.h>
+#include "crypto.h"
+
+esp_err_t crypto_session_init(crypto_session_t *s, crypto_mode_t mode, const uint8_t *key, unsigned int key_bits) {
+    memset(s, 0, sizeof(*s));
+    s->mode = mode;
+
+    if (mode == CRYPTO_MODE_GCM) {
+        mbedtls_gcm_init(&s->gcm);
+        if (mbedtls_gcm_setkey(&s->gcm, MBEDTLS_CIPHER_ID_AES, key, key_bits) != 0) {
+            mbedtls_gcm_free(&s->gcm);
+            return ESP_FAIL;
+        }
+    } else {
+        // CTR використовує лише пряме перетворення AES в обох напрямках
+        mbedtls_aes_init(&s->aes);
+        if (mbedtls_aes_setkey_enc(&s->aes, key, key_bits) != 0) {
+            mbedtls_aes_free(&s->aes);
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+void crypto_session_free(crypto_session_t *s) {
+    if (s->mode == CRYPTO_MODE_GCM) {
+        mbedtls_gcm_free(&s->gcm);
+    } else {
+        mbedtls_aes_free(&s->aes);
+    }
+}
+
+// Довжина тегу в пакеті: CTR не автентифікує і тегу не має
+size_t crypto_tag_size(const crypto_session_t *s) {
+    return s->mode == CRYPTO_MODE_GCM ? CRYPTO_TAG_SIZE : 0;
+}
+
+// Лічильниковий блок CTR: nonce (12 байт) + 32-бітний лічильник блоків з нуля
+static esp_err_t ctr_crypt(crypto_session_t *s, const uint8_t *nonce, const uint8_t *in, uint8_t *out, size_t len) {
+    uint8_t counter[16] = { 0 };
+    uint8_t stream_block[16];
+    size_t offset = 0;
+
+    memcpy(counter, nonce, CRYPTO_NONCE_SIZE);
+    if (mbedtls_aes_crypt_ctr(&s->aes, len, &offset, counter, stream_block, in, out) != 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t crypto_encrypt(crypto_session_t *s, const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+                         const uint8_t *in, uint8_t *out, size_t len, uint8_t *tag) {
+    if (s->mode == CRYPTO_MODE_GCM) {
+        if (mbedtls_gcm_crypt_and_tag(&s->gcm, MBEDTLS_GCM_ENCRYPT, len, nonce, CRYPTO_NONCE_SIZE,
+                                      aad, aad_len, in, out, CRYPTO_TAG_SIZE, tag) != 0) {
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+    return ctr_crypt(s, nonce, in, out, len);
+}
+
+esp_err_t crypto_decrypt(crypto_session_t *s, const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+                         const uint8_t *in, uint8_t *out, size_t len, const uint8_t *tag) {
+    if (s->mode == CRYPTO_MODE_GCM) {
+        int ret = mbedtls_gcm_auth_decrypt(&s->gcm, len, nonce, CRYPTO_NONCE_SIZE,
+                                           aad, aad_len, tag, CRYPTO_TAG_SIZE, in, out);
+        if (ret == MBEDTLS_ERR_GCM_AUTH_FAILED) {
+            return ESP_ERR_INVALID_CRC;
+        }
+        return ret == 0 ? ESP_OK : ESP_FAIL;
+    }
+    return ctr_crypt(s, nonce, in, out, len);
+}
@@ -0,0 +1,40 @@
+#ifndef MAIN_CRYPTO_H_
+#define MAIN_CRYPTO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/gcm.h"
+
+// Криптографічна сесія: ключ розгортається один раз при ініціалізації,
+// кадр шифрується одним викликом у потоковому режимі (без вирівнювання на 16 байт).
+// З CONFIG_MBEDTLS_HARDWARE_AES mbedtls використовує апаратний AES, а на чипах
+// з AES-DMA великі буфери автоматично передаються через DMA.
+// Вхідний і вихідний буфери можуть збігатися (шифрування на місці).
+// GCM автентифікує додаткові дані (заголовок) і шифротекст тегом; CTR дає лише
+// конфіденційність: тегу немає, і будь-який шифротекст розшифровується успішно.
+
+#define CRYPTO_NONCE_SIZE 12
+#define CRYPTO_TAG_SIZE 16
+
+typedef enum {
+    CRYPTO_MODE_CTR,
+    CRYPTO_MODE_GCM,
+} crypto_mode_t;
+
+typedef struct {
+    crypto_mode_t mode;
+    mbedtls_aes_context aes;
+    mbedtls_gcm_context gcm;
+} crypto_session_t;
+
+esp_err_t crypto_session_init(crypto_session_t *s, crypto_mode_t mode, const uint8_t *key, unsigned int key_bits);
+void crypto_session_free(crypto_session_t *s);
+size_t crypto_tag_size(const crypto_session_t *s);
+esp_err_t crypto_encrypt(crypto_session_t *s, const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+                         const uint8_t *in, uint8_t *out, size_t len, uint8_t *tag);
+esp_err_t crypto_decrypt(crypto_session_t *s, const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+                         const uint8_t *in, uint8_t *out, size_t len, const uint8_t *tag);
+
+#endif /* MAIN_CRYPTO_H_ */
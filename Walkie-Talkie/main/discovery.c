@@ -0,0 +1,173 @@
+#include <string.h>
+#include "discovery.h"
+
+void discovery_init(discovery_t *d, uint32_t node, uint16_t epoch, discovery_role_t role, int64_t timeout_us) {
+    memset(d, 0, sizeof(*d));
+    d->node = node;
+    d->epoch = epoch;
+    d->role = role;
+    d->timeout_us = timeout_us;
+}
+
+// Заповнює заголовок і навантаження чергового маяка, повертає довжину навантаження.
+// Лічильник маяків росте з кожним викликом, а епоха - з кожним запуском, тому
+// nonce маяків не повторюється
+size_t discovery_write_beacon(discovery_t *d, packet_header_t *hdr, uint8_t *payload) {
+    uint32_t counter = d->counter++;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->flags = PACKET_FLAG_BEACON | PACKET_FLAG_ENCRYPTED;
+    hdr->session = d->node;
+    hdr->seq = d->epoch;
+    hdr->timestamp = counter;
+    hdr->payload_len = DISCOVERY_BEACON_SIZE;
+    hdr->talkgroup = PACKET_TALKGROUP_NONE;
+    payload[0] = d->role;
+    return DISCOVERY_BEACON_SIZE;
+}
+
+static discovery_peer_t *find_node(discovery_t *d, uint32_t node) {
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+        if (d->peers[i].used && d->peers[i].node == node) {
+            return &d->peers[i];
+        }
+    }
+    return NULL;
+}
+
+// Запис останнього маяка вузла; за відсутності - найдавніший запис для заміни
+static discovery_seen_t *find_seen(discovery_t *d, uint32_t node) {
+    discovery_seen_t *oldest = &d->seen[0];
+    for (int i = 0; i < DISCOVERY_MAX_SEEN; i++) {
+        discovery_seen_t *seen = &d->seen[i];
+        if (seen->used && seen->node == node) {
+            return seen;
+        }
+        if (oldest->used && (!seen->used || seen->last_seen_us < oldest->last_seen_us)) {
+            oldest = seen;
+        }
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->node = node;
+    return oldest;
+}
+
+// Маяк новіший за останній прийнятий: більша епоха або більший лічильник у тій самій
+static bool beacon_newer(const discovery_seen_t *seen, uint16_t epoch, uint32_t counter) {
+    if (!seen->used) {
+        return true;
+    }
+    return epoch > seen->epoch || (epoch == seen->epoch && counter > seen->counter);
+}
+
+// Адресу, яку отримав інший вузол, попередній власник уже не має
+static void release_addr(discovery_t *d, uint32_t addr, const discovery_peer_t *keep) {
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+        discovery_peer_t *peer = &d->peers[i];
+        if (peer->used && peer != keep && peer->addr == addr) {
+            peer->used = false;
+        }
+    }
+}
+
+// Обробляє автентифікований маяк від addr. Маяк з парою (епоха, лічильник), не більшою
+// за вже прийняту від цього вузла, відкидається. Для DISCOVERY_MOVED у prev_addr
+// повертається попередня адреса вузла
+discovery_result_t discovery_update(discovery_t *d, const packet_header_t *hdr, const uint8_t *payload,
+                                    uint32_t addr, int64_t now_us, uint32_t *prev_addr) {
+    if (hdr->payload_len < DISCOVERY_BEACON_SIZE || hdr->session == d->node ||
+        (payload[0] != DISCOVERY_ROLE_SERVER && payload[0] != DISCOVERY_ROLE_CLIENT)) {
+        d->stats.rejected++;
+        return DISCOVERY_INVALID;
+    }
+
+    uint16_t epoch = hdr->seq;
+    discovery_seen_t *seen = find_seen(d, hdr->session);
+    if (!beacon_newer(seen, epoch, hdr->timestamp)) {
+        d->stats.rejected++;
+        return DISCOVERY_INVALID;
+    }
+    seen->used = true;
+    seen->epoch = epoch;
+    seen->counter = hdr->timestamp;
+    seen->last_seen_us = now_us;
+
+    discovery_result_t result;
+    discovery_peer_t *peer = find_node(d, hdr->session);
+    if (peer != NULL) {
+        result = DISCOVERY_REFRESH;
+        if (peer->addr != addr) {
+            *prev_addr = peer->addr;
+            result = DISCOVERY_MOVED;
+            d->stats.moved++;
+        }
+    } else {
+        // Адресу міг займати інший вузол, що вже зник
+        release_addr(d, addr, NULL);
+        for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+            if (!d->peers[i].used) {
+                peer = &d->peers[i];
+                break;
+            }
+        }
+        if (peer == NULL) {
+            return DISCOVERY_FULL;
+        }
+        memset(peer, 0, sizeof(*peer));
+        peer->used = true;
+        peer->node = hdr->session;
+        result = DISCOVERY_NEW;
+        d->stats.joined++;
+    }
+
+    if (result == DISCOVERY_MOVED) {
+        release_addr(d, addr, peer);
+    }
+    peer->addr = addr;
+    peer->role = (discovery_role_t)payload[0];
+    peer->epoch = epoch;
+    peer->counter = hdr->timestamp;
+    peer->last_seen_us = now_us;
+    d->stats.beacons++;
+    return result;
+}
+
+// Вилучає пірів без маяка довше за тайм-аут і копіює до max з них у expired,
+// щоб викликач міг закрити їхні потоки. Повертає кількість скопійованих
+size_t discovery_expire(discovery_t *d, int64_t now_us, discovery_peer_t *expired, size_t max) {
+    size_t count = 0;
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+        discovery_peer_t *peer = &d->peers[i];
+        if (peer->used && now_us - peer->last_seen_us > d->timeout_us) {
+            if (count < max) {
+                expired[count++] = *peer;
+            }
+            peer->used = false;
+            d->stats.expired++;
+        }
+    }
+    return count;
+}
+
+// Пір заданої ролі з найсвіжішим маяком або NULL
+const discovery_peer_t *discovery_find(const discovery_t *d, discovery_role_t role) {
+    const discovery_peer_t *best = NULL;
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+        const discovery_peer_t *peer = &d->peers[i];
+        if (peer->used && peer->role == role && (best == NULL || peer->last_seen_us > best->last_seen_us)) {
+            best = peer;
+        }
+    }
+    return best;
+}
+
+uint16_t discovery_count(const discovery_t *d) {
+    uint16_t count = 0;
+    for (int i = 0; i < DISCOVERY_MAX_PEERS; i++) {
+        count += d->peers[i].used;
+    }
+    return count;
+}
+
+void discovery_get_stats(const discovery_t *d, discovery_stats_t *stats) {
+    *stats = d->stats;
+}
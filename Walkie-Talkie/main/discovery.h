@@ -0,0 +1,87 @@
+#ifndef MAIN_DISCOVERY_H_
+#define MAIN_DISCOVERY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "packet.h"
+
+// Виявлення пристроїв: кожна станція періодично надсилає маяк на адресу розмовних
+// груп, а приймачі ведуть таблицю пірів з часом останнього маяка. Маяк - пакет
+// з прапорцем PACKET_FLAG_BEACON: сесія заголовка - постійний ідентифікатор вузла
+// (з MAC), номер - епоха запуску зі збереженого в NVS лічильника, мітка часу -
+// 32-бітний лічильник маяків у межах епохи, навантаження - роль вузла.
+// Маяк завжди шифрується, щоб сторонній вузол не міг перенаправити потоки на себе.
+// Пара (епоха, лічильник) автентифікується разом із заголовком і росте навіть між
+// перезапусками, тому приймач відкидає маяки, не новіші за останній прийнятий від
+// вузла. Останні значення зберігаються і після вилучення піра з таблиці, щоб
+// записаний маяк не можна було повторити, коли вузол тимчасово зник.
+// Пір, від якого давно не було маяка, вилучається з таблиці; зміна адреси вузла
+// (нова оренда DHCP, перехід між мережами) підхоплюється з першого ж маяка.
+// Модуль не залежить від FreeRTOS, синхронізацію виконує викликач.
+
+#define DISCOVERY_MAX_PEERS 10      // Усі станції конференції та запас
+#define DISCOVERY_BEACON_SIZE 1     // Навантаження маяка: роль
+#define DISCOVERY_MAX_SEEN 16       // Вузлів, для яких пам'ятається останній маяк
+
+typedef enum {
+    DISCOVERY_ROLE_SERVER = 0,  // Точка доступу і мікшер конференції
+    DISCOVERY_ROLE_CLIENT = 1,
+} discovery_role_t;
+
+typedef enum {
+    DISCOVERY_INVALID,          // Пошкоджений маяк або повтор уже прийнятого
+    DISCOVERY_FULL,             // Новий вузол, але таблиця заповнена
+    DISCOVERY_REFRESH,          // Відомий вузол за тією ж адресою
+    DISCOVERY_NEW,              // Новий вузол
+    DISCOVERY_MOVED,            // Відомий вузол з'явився за іншою адресою
+} discovery_result_t;
+
+typedef struct {
+    bool used;
+    uint32_t node;              // Ідентифікатор вузла (сесія маяка)
+    uint32_t addr;              // IPv4 адреса в мережевому порядку
+    discovery_role_t role;
+    uint16_t epoch;             // Епоха останнього прийнятого маяка
+    uint32_t counter;           // Лічильник останнього прийнятого маяка
+    int64_t last_seen_us;
+} discovery_peer_t;
+
+// Останній прийнятий маяк вузла, переживає вилучення піра з таблиці
+typedef struct {
+    bool used;
+    uint32_t node;
+    uint16_t epoch;
+    uint32_t counter;
+    int64_t last_seen_us;
+} discovery_seen_t;
+
+typedef struct {
+    uint32_t beacons;           // Прийнято маяків
+    uint32_t rejected;          // Відкинуто пошкоджених і повторених маяків
+    uint32_t joined;
+    uint32_t moved;
+    uint32_t expired;
+} discovery_stats_t;
+
+typedef struct {
+    uint32_t node;
+    uint16_t epoch;             // Епоха власних маяків, новий запуск - більша епоха
+    discovery_role_t role;
+    uint32_t counter;           // Лічильник власних маяків
+    int64_t timeout_us;         // Пір без маяка довше за цей час вилучається
+    discovery_peer_t peers[DISCOVERY_MAX_PEERS];
+    discovery_seen_t seen[DISCOVERY_MAX_SEEN];
+    discovery_stats_t stats;
+} discovery_t;
+
+void discovery_init(discovery_t *d, uint32_t node, uint16_t epoch, discovery_role_t role, int64_t timeout_us);
+size_t discovery_write_beacon(discovery_t *d, packet_header_t *hdr, uint8_t *payload);
+discovery_result_t discovery_update(discovery_t *d, const packet_header_t *hdr, const uint8_t *payload,
+                                    uint32_t addr, int64_t now_us, uint32_t *prev_addr);
+size_t discovery_expire(discovery_t *d, int64_t now_us, discovery_peer_t *expired, size_t max);
+const discovery_peer_t *discovery_find(const discovery_t *d, discovery_role_t role);
+uint16_t discovery_count(const discovery_t *d);
+void discovery_get_stats(const discovery_t *d, discovery_stats_t *stats);
+
+#endif /* MAIN_DISCOVERY_H_ */
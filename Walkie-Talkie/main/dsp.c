@@ -0,0 +1,108 @@
+#include <math.h>
+#include "dsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Підсилення з округленням і насиченням; добуток 16x32 біт потребує 64-бітного акумулятора
+void dsp_gain_q15(int16_t *buf, size_t len, int32_t gain_q15) {
+    for (size_t i = 0; i < len; i++) {
+        int64_t y = ((int64_t)buf[i] * gain_q15 + (1 << 14)) >> 15;
+        if (y > INT16_MAX) {
+            y = INT16_MAX;
+        } else if (y < INT16_MIN) {
+            y = INT16_MIN;
+        }
+        buf[i] = (int16_t)y;
+    }
+}
+
+// R = 1 - 2*pi*fc/fs; коефіцієнти рахуються один раз при ініціалізації
+void dsp_dc_blocker_init(dsp_dc_blocker_t *dc, uint32_t sample_rate, uint32_t cutoff_hz) {
+    float r = 1.0f - 2.0f * (float)M_PI * cutoff_hz / sample_rate;
+    if (r < 0.5f) {
+        r = 0.5f;
+    }
+    dc->r_q15 = dsp_sat16((int32_t)lrintf(r * DSP_Q15_ONE));
+    dc->x1 = 0;
+    dc->y1_q15 = 0;
+}
+
+// Вихід зберігається з 15 дробовими бітами, щоб похибка округлення не накопичувалась у постійну складову
+void dsp_dc_blocker_process(dsp_dc_blocker_t *dc, int16_t *buf, size_t len) {
+    int32_t x1 = dc->x1;
+    int64_t y1 = dc->y1_q15;
+
+    for (size_t i = 0; i < len; i++) {
+        int32_t x = buf[i];
+        int64_t y = (int64_t)(x - x1) * DSP_Q15_ONE + ((y1 * dc->r_q15) >> 15);
+        // Насичення стану, щоб після перевантаження фільтр не переповнювався
+        if (y > (int64_t)INT16_MAX * DSP_Q15_ONE) {
+            y = (int64_t)INT16_MAX * DSP_Q15_ONE;
+        } else if (y < (int64_t)INT16_MIN * DSP_Q15_ONE) {
+            y = (int64_t)INT16_MIN * DSP_Q15_ONE;
+        }
+        buf[i] = (int16_t)((y + (1 << 14)) >> 15);
+        x1 = x;
+        y1 = y;
+    }
+
+    dc->x1 = (int16_t)x1;
+    dc->y1_q15 = (int32_t)y1;
+}
+
+// Коефіцієнти за RBJ Audio EQ Cookbook, нормовані на a0 і переведені в Q14
+static void biquad_set(dsp_biquad_t *bq, float b0, float b1, float b2, float a0, float a1, float a2) {
+    bq->b0 = dsp_sat16((int32_t)lrintf(b0 / a0 * DSP_Q14_ONE));
+    bq->b1 = dsp_sat16((int32_t)lrintf(b1 / a0 * DSP_Q14_ONE));
+    bq->b2 = dsp_sat16((int32_t)lrintf(b2 / a0 * DSP_Q14_ONE));
+    bq->a1 = dsp_sat16((int32_t)lrintf(a1 / a0 * DSP_Q14_ONE));
+    bq->a2 = dsp_sat16((int32_t)lrintf(a2 / a0 * DSP_Q14_ONE));
+    dsp_biquad_reset(bq);
+}
+
+void dsp_biquad_init_highpass(dsp_biquad_t *bq, uint32_t sample_rate, uint32_t cutoff_hz, float q) {
+    float w0 = 2.0f * (float)M_PI * cutoff_hz / sample_rate;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cw = cosf(w0);
+    biquad_set(bq, (1.0f + cw) / 2.0f, -(1.0f + cw), (1.0f + cw) / 2.0f, 1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void dsp_biquad_init_lowpass(dsp_biquad_t *bq, uint32_t sample_rate, uint32_t cutoff_hz, float q) {
+    float w0 = 2.0f * (float)M_PI * cutoff_hz / sample_rate;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cw = cosf(w0);
+    biquad_set(bq, (1.0f - cw) / 2.0f, 1.0f - cw, (1.0f - cw) / 2.0f, 1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void dsp_biquad_reset(dsp_biquad_t *bq) {
+    bq->x1 = 0;
+    bq->x2 = 0;
+    bq->y1 = 0;
+    bq->y2 = 0;
+}
+
+void dsp_biquad_process(dsp_biquad_t *bq, int16_t *buf, size_t len) {
+    int32_t x1 = bq->x1, x2 = bq->x2;
+    int32_t y1 = bq->y1, y2 = bq->y2;
+
+    for (size_t i = 0; i < len; i++) {
+        int32_t x = buf[i];
+        // Сума п'яти добутків 16x16 біт при повній амплітуді може вийти за int32
+        int64_t acc = (int64_t)bq->b0 * x + (int64_t)bq->b1 * x1 + (int64_t)bq->b2 * x2
+                    - (int64_t)bq->a1 * y1 - (int64_t)bq->a2 * y2;
+        int64_t out = (acc + (1 << 13)) >> 14;
+        int16_t y = out > INT16_MAX ? INT16_MAX : (out < INT16_MIN ? INT16_MIN : (int16_t)out);
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        buf[i] = y;
+    }
+
+    bq->x1 = (int16_t)x1;
+    bq->x2 = (int16_t)x2;
+    bq->y1 = (int16_t)y1;
+    bq->y2 = (int16_t)y2;
+}
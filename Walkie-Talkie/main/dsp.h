@@ -0,0 +1,52 @@
+#ifndef MAIN_DSP_H_
+#define MAIN_DSP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Ядра обробки звуку у фіксованій точці (Q15) над 16-бітними семплами.
+// Усі ядра працюють на місці та насичують результат замість переповнення.
+// Модуль не залежить від FreeRTOS.
+
+#define DSP_Q15_ONE 32768
+#define DSP_Q14_ONE 16384
+
+// Коефіцієнт підсилення в Q15 з константи часу компіляції; значення понад 1.0 дозволені
+#define DSP_GAIN_Q15(x) ((int32_t)((x) * DSP_Q15_ONE + 0.5))
+
+// Фільтр постійної складової: y[n] = x[n] - x[n-1] + R * y[n-1]
+typedef struct {
+    int16_t r_q15;              // Полюс фільтра, ближче до 1.0 - нижча частота зрізу
+    int16_t x1;
+    int32_t y1_q15;             // Попередній вихід з дробовими бітами
+} dsp_dc_blocker_t;
+
+// Біквадратна секція, пряма форма I; коефіцієнти в Q14, щоб |a1| до 2 вміщувався в int16
+typedef struct {
+    int16_t b0, b1, b2;
+    int16_t a1, a2;
+    int16_t x1, x2;
+    int16_t y1, y2;
+} dsp_biquad_t;
+
+static inline int16_t dsp_sat16(int32_t x) {
+    if (x > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (x < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)x;
+}
+
+void dsp_gain_q15(int16_t *buf, size_t len, int32_t gain_q15);
+
+void dsp_dc_blocker_init(dsp_dc_blocker_t *dc, uint32_t sample_rate, uint32_t cutoff_hz);
+void dsp_dc_blocker_process(dsp_dc_blocker_t *dc, int16_t *buf, size_t len);
+
+void dsp_biquad_init_highpass(dsp_biquad_t *bq, uint32_t sample_rate, uint32_t cutoff_hz, float q);
+void dsp_biquad_init_lowpass(dsp_biquad_t *bq, uint32_t sample_rate, uint32_t cutoff_hz, float q);
+void dsp_biquad_reset(dsp_biquad_t *bq);
+void dsp_biquad_process(dsp_biquad_t *bq, int16_t *buf, size_t len);
+
+#endif /* MAIN_DSP_H_ */
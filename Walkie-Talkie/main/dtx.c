@@ -0,0 +1,144 @@
+#include <string.h>
+#include "dtx.h"
+
+#define DTX_MIN_LEVEL 16            // Нижче цього рівня кадр завжди тиша
+#define DTX_FLOOR_RISE_SHIFT 6      // Рівень шуму росте на 1/64 різниці за кадр тиші
+#define DTX_FLOOR_SPEECH_SHIFT 10   // і на 1/1024 під час мови
+#define DTX_SPEECH_RATIO 3          // Мова: рівень утричі вищий за шум (близько 10 дБ)
+#define DTX_FRICATIVE_RATIO 2       // Шиплячі: рівень удвічі вищий за шум і
+#define DTX_ZCR_MIN_PERMILLE 100    // частота перетинів нуля в межах 0.1..0.45
+#define DTX_ZCR_MAX_PERMILLE 450    // (білий шум дає близько 0.5)
+#define DTX_FLOOR_FRAC_BITS 8       // Дробові біти рівня шуму, щоб повільний ріст не губився в округленні
+
+int32_t dtx_level(const int16_t *pcm, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += pcm[i] < 0 ? -(int32_t)pcm[i] : pcm[i];
+    }
+    return (int32_t)(sum / len);
+}
+
+void dtx_init(dtx_t *dtx) {
+    memset(dtx, 0, sizeof(*dtx));
+}
+
+// Енергія відносно адаптивного рівня шуму плюс частота перетинів нуля для шиплячих
+static bool detect_speech(dtx_t *dtx, const int16_t *pcm, size_t len) {
+    int32_t level = dtx_level(pcm, len);
+    uint32_t crossings = 0;
+    for (size_t i = 1; i < len; i++) {
+        crossings += (pcm[i - 1] ^ pcm[i]) < 0;
+    }
+    uint32_t zcr = len > 1 ? crossings * 1000 / (len - 1) : 0;
+
+    int32_t scaled = level << DTX_FLOOR_FRAC_BITS;
+    if (!dtx->started) {
+        dtx->started = true;
+        dtx->noise_floor = scaled;
+    }
+
+    bool speech = level > DTX_MIN_LEVEL &&
+                  (scaled > dtx->noise_floor * DTX_SPEECH_RATIO ||
+                   (scaled > dtx->noise_floor * DTX_FRICATIVE_RATIO &&
+                    zcr >= DTX_ZCR_MIN_PERMILLE && zcr <= DTX_ZCR_MAX_PERMILLE));
+
+    // Рівень шуму швидко спадає до мінімумів і повільно росте пропорційно різниці,
+    // тому мова його майже не зсуває
+    if (scaled < dtx->noise_floor) {
+        dtx->noise_floor = (dtx->noise_floor + scaled) / 2;
+    } else {
+        int shift = speech ? DTX_FLOOR_SPEECH_SHIFT : DTX_FLOOR_RISE_SHIFT;
+        dtx->noise_floor += (scaled - dtx->noise_floor) >> shift;
+    }
+    return speech;
+}
+
+dtx_action_t dtx_process(dtx_t *dtx, const int16_t *pcm, size_t len) {
+    dtx->stats.frames++;
+
+    if (detect_speech(dtx, pcm, len)) {
+        dtx->hangover = DTX_HANGOVER_FRAMES;
+    } else if (dtx->hangover > 0) {
+        dtx->hangover--;
+    }
+
+    if (dtx->hangover > 0) {
+        dtx->silent = false;
+        dtx->stats.speech++;
+        return DTX_SEND;
+    }
+
+    // Перший кадр тиші одразу дає SID, далі SID оновлює рівень шуму періодично
+    if (!dtx->silent || ++dtx->since_sid >= DTX_SID_INTERVAL) {
+        dtx->silent = true;
+        dtx->since_sid = 0;
+        dtx->stats.sid++;
+        return DTX_SID;
+    }
+    dtx->stats.suppressed++;
+    return DTX_SUPPRESS;
+}
+
+void dtx_get_stats(const dtx_t *dtx, dtx_stats_t *stats) {
+    *stats = dtx->stats;
+}
+
+size_t dtx_write_sid(uint8_t *buf, int32_t level) {
+    if (level > UINT16_MAX) {
+        level = UINT16_MAX;
+    } else if (level < 0) {
+        level = 0;
+    }
+    buf[0] = (level >> 8) & 0xFF;
+    buf[1] = level & 0xFF;
+    return DTX_SID_SIZE;
+}
+
+bool dtx_parse_sid(const uint8_t *buf, size_t len, int32_t *level) {
+    if (len != DTX_SID_SIZE) {
+        return false;
+    }
+    *level = ((int32_t)buf[0] << 8) | buf[1];
+    return true;
+}
+
+void cng_init(cng_t *cng, uint32_t seed) {
+    memset(cng, 0, sizeof(*cng));
+    cng->seed = seed ? seed : 1;
+}
+
+// Новий рівень з SID; перший SID після мови вмикає генератор одразу з цим рівнем
+void cng_update(cng_t *cng, int32_t level) {
+    if (!cng->active) {
+        cng->level = level;
+    }
+    cng->target_level = level;
+    cng->age = 0;
+    cng->active = true;
+}
+
+// Рівномірний шум [-2L, 2L] має середній модуль L; рівень змінюється плавно між SID.
+// Викликається раз на кадр відтворення
+void cng_generate(cng_t *cng, int16_t *pcm, size_t len) {
+    cng->level += (cng->target_level - cng->level) / 4;
+    int32_t amplitude = cng->level * 2;
+    if (amplitude > INT16_MAX) {
+        amplitude = INT16_MAX;
+    }
+
+    uint32_t seed = cng->seed;
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        // Старші 16 біт генератора як число зі знаком в діапазоні [-1, 1) у Q15
+        int32_t r = (int16_t)(seed >> 16);
+        pcm[i] = (int16_t)((r * amplitude) >> 15);
+    }
+    cng->seed = seed;
+
+    if (++cng->age >= CNG_TIMEOUT_FRAMES) {
+        cng->active = false;
+    }
+}
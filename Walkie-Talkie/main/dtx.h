@@ -0,0 +1,61 @@
+#ifndef MAIN_DTX_H_
+#define MAIN_DTX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Детектор голосової активності з переривчастою передачею (DTX) та генератор
+// комфортного шуму. Під час тиші передавач замість кадрів періодично шле короткі
+// дескриптори тиші (SID) з рівнем шуму, а приймач синтезує шум того ж рівня.
+// Модуль не залежить від FreeRTOS.
+
+#define DTX_HANGOVER_FRAMES 20      // Кадрів мови після останнього активного (200 мс)
+#define DTX_SID_INTERVAL 10         // Період дескрипторів тиші (кадри)
+#define DTX_SID_SIZE 2              // Навантаження SID: рівень шуму, 16 біт
+#define CNG_TIMEOUT_FRAMES (DTX_SID_INTERVAL * 3) // Без нових SID шум вимикається (передачу завершено)
+
+typedef enum {
+    DTX_SEND,           // Мова: передати кадр
+    DTX_SID,            // Тиша: передати дескриптор тиші замість кадру
+    DTX_SUPPRESS,       // Тиша: нічого не передавати
+} dtx_action_t;
+
+typedef struct {
+    uint32_t frames;            // Усього кадрів
+    uint32_t speech;            // Кадрів, визнаних мовою (разом з утриманням)
+    uint32_t sid;               // Надіслано дескрипторів тиші
+    uint32_t suppressed;        // Пропущено кадрів
+} dtx_stats_t;
+
+typedef struct {
+    int32_t noise_floor;        // Оцінка рівня фонового шуму (середній модуль, Q8)
+    uint16_t hangover;          // Залишок кадрів утримання рішення "мова"
+    uint16_t since_sid;         // Кадрів від останнього SID
+    bool started;
+    bool silent;                // Передавач у режимі тиші
+    dtx_stats_t stats;
+} dtx_t;
+
+// Генератор комфортного шуму на боці приймача
+typedef struct {
+    bool active;
+    int32_t level;              // Поточний рівень, плавно наближається до цільового
+    int32_t target_level;       // Рівень з останнього SID
+    uint16_t age;               // Кадрів шуму від останнього SID
+    uint32_t seed;
+} cng_t;
+
+void dtx_init(dtx_t *dtx);
+dtx_action_t dtx_process(dtx_t *dtx, const int16_t *pcm, size_t len);
+int32_t dtx_level(const int16_t *pcm, size_t len);
+void dtx_get_stats(const dtx_t *dtx, dtx_stats_t *stats);
+
+size_t dtx_write_sid(uint8_t *buf, int32_t level);
+bool dtx_parse_sid(const uint8_t *buf, size_t len, int32_t *level);
+
+void cng_init(cng_t *cng, uint32_t seed);
+void cng_update(cng_t *cng, int32_t level);
+void cng_generate(cng_t *cng, int16_t *pcm, size_t len);
+
+#endif /* MAIN_DTX_H_ */
@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fec.h"
+
+static void xor_bytes(uint8_t *dst, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+static void encoder_start(fec_encoder_t *enc, uint16_t seq) {
+    enc->base_seq = seq;
+    enc->count = 0;
+    enc->mask = 0;
+    enc->len_xor = 0;
+    enc->max_len = 0;
+    memset(enc->parity, 0, enc->max_payload);
+}
+
+// Група - степінь двійки від 2 до FEC_MAX_GROUP; надлишок дорівнює 1/group
+bool fec_encoder_init(fec_encoder_t *enc, uint8_t group, size_t max_payload) {
+    memset(enc, 0, sizeof(*enc));
+    if (group < 2 || group > FEC_MAX_GROUP || (group & (group - 1)) != 0 || max_payload > UINT16_MAX) {
+        return false;
+    }
+    enc->parity = (uint8_t *)calloc(1, max_payload);
+    if (!enc->parity) {
+        return false;
+    }
+    enc->group = group;
+    enc->max_payload = max_payload;
+    return true;
+}
+
+void fec_encoder_free(fec_encoder_t *enc) {
+    free(enc->parity);
+    enc->parity = NULL;
+}
+
+// Враховує черговий номер; payload == NULL для номера без аудіокадру (SID чи пропуск DTX).
+// Повертає true, коли група завершена і можна записати пакет парності
+bool fec_encoder_add(fec_encoder_t *enc, uint16_t seq, const uint8_t *payload, size_t len) {
+    // Нова група після завершеної або після розриву послідовності (незавершена відкидається)
+    if (enc->count == 0 || enc->count == enc->group || seq != (uint16_t)(enc->base_seq + enc->count)) {
+        encoder_start(enc, seq);
+    }
+
+    if (payload && len <= enc->max_payload) {
+        xor_bytes(enc->parity, payload, len);
+        enc->len_xor ^= (uint16_t)len;
+        if (len > enc->max_len) {
+            enc->max_len = (uint16_t)len;
+        }
+        enc->mask |= 1 << enc->count;
+        enc->stats.frames++;
+        enc->stats.data_bytes += len;
+    }
+    enc->count++;
+    return enc->count == enc->group;
+}
+
+// Записує навантаження парності завершеної групи; наступний номер почне нову групу.
+// Повертає 0, якщо в групі не було жодного аудіокадру
+size_t fec_encoder_write(fec_encoder_t *enc, uint8_t *out) {
+    size_t len = 0;
+    if (enc->mask != 0) {
+        out[0] = enc->count;
+        out[1] = enc->mask;
+        out[2] = (enc->len_xor >> 8) & 0xFF;
+        out[3] = enc->len_xor & 0xFF;
+        memcpy(out + FEC_HEADER_SIZE, enc->parity, enc->max_len);
+        len = FEC_HEADER_SIZE + enc->max_len;
+        enc->stats.parity++;
+        enc->stats.parity_bytes += len;
+    }
+    return len;
+}
+
+void fec_encoder_get_stats(const fec_encoder_t *enc, fec_encoder_stats_t *stats) {
+    *stats = enc->stats;
+}
+
+bool fec_decoder_init(fec_decoder_t *dec, size_t max_payload) {
+    memset(dec, 0, sizeof(*dec));
+    dec->data = (uint8_t *)calloc(FEC_MAX_GROUP, max_payload);
+    dec->recovered = (uint8_t *)calloc(1, max_payload);
+    if (!dec->data || !dec->recovered) {
+        fec_decoder_free(dec);
+        return false;
+    }
+    dec->max_payload = max_payload;
+    return true;
+}
+
+void fec_decoder_free(fec_decoder_t *dec) {
+    free(dec->data);
+    free(dec->recovered);
+    dec->data = NULL;
+    dec->recovered = NULL;
+}
+
+// Після перезапуску передавача старі копії не належать до його груп
+static void decoder_check_session(fec_decoder_t *dec, uint32_t session) {
+    if (session != dec->session) {
+        memset(dec->valid, 0, sizeof(dec->valid));
+        dec->session = session;
+    }
+}
+
+static void decoder_store(fec_decoder_t *dec, uint16_t seq, const uint8_t *payload, size_t len) {
+    uint8_t idx = seq & (FEC_MAX_GROUP - 1);
+    memcpy(dec->data + (size_t)idx * dec->max_payload, payload, len);
+    dec->len[idx] = (uint16_t)len;
+    dec->seq[idx] = seq;
+    dec->valid[idx] = true;
+}
+
+// Зберігає копію отриманого аудіокадру для можливого відновлення сусіда
+void fec_decoder_add(fec_decoder_t *dec, uint32_t session, uint16_t seq, const uint8_t *payload, size_t len) {
+    decoder_check_session(dec, session);
+    if (len <= dec->max_payload) {
+        decoder_store(dec, seq, payload, len);
+    }
+}
+
+// Обробляє пакет парності з номером seq (останній номер групи). Якщо в групі
+// бракує рівно одного кадру, повертає його навантаження, номер і довжину
+const uint8_t *fec_decoder_recover(fec_decoder_t *dec, uint32_t session, uint16_t seq,
+                                   const uint8_t *parity, size_t parity_len,
+                                   uint16_t *lost_seq, size_t *lost_len) {
+    decoder_check_session(dec, session);
+    if (parity_len < FEC_HEADER_SIZE) {
+        return NULL;
+    }
+    uint8_t count = parity[0];
+    uint8_t mask = parity[1];
+    uint16_t len = ((uint16_t)parity[2] << 8) | parity[3];
+    size_t data_len = parity_len - FEC_HEADER_SIZE;
+    if (count == 0 || count > FEC_MAX_GROUP || data_len > dec->max_payload) {
+        return NULL;
+    }
+    dec->stats.parity++;
+
+    uint16_t base = (uint16_t)(seq - count + 1);
+    int missing = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        uint16_t s = (uint16_t)(base + i);
+        uint8_t idx = s & (FEC_MAX_GROUP - 1);
+        if (dec->valid[idx] && dec->seq[idx] == s) {
+            continue;
+        }
+        if (missing >= 0) {
+            dec->stats.unrecoverable++;
+            return NULL;
+        }
+        missing = i;
+    }
+    if (missing < 0) {
+        return NULL;
+    }
+
+    memcpy(dec->recovered, parity + FEC_HEADER_SIZE, data_len);
+    for (uint8_t i = 0; i < count; i++) {
+        if (i == missing || !(mask & (1 << i))) {
+            continue;
+        }
+        uint8_t idx = (uint16_t)(base + i) & (FEC_MAX_GROUP - 1);
+        // Довший за парність кадр означає пошкоджену групу
+        if (dec->len[idx] > data_len) {
+            return NULL;
+        }
+        xor_bytes(dec->recovered, dec->data + (size_t)idx * dec->max_payload, dec->len[idx]);
+        len ^= dec->len[idx];
+    }
+    if (len > data_len) {
+        return NULL;
+    }
+
+    *lost_seq = (uint16_t)(base + missing);
+    *lost_len = len;
+    decoder_store(dec, *lost_seq, dec->recovered, len);
+    dec->stats.recovered++;
+    return dec->recovered;
+}
+
+void fec_decoder_get_stats(const fec_decoder_t *dec, fec_decoder_stats_t *stats) {
+    *stats = dec->stats;
+}
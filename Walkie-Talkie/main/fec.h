@@ -0,0 +1,74 @@
+#ifndef MAIN_FEC_H_
+#define MAIN_FEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Пряма корекція помилок XOR-парністю. Після кожної групи з N послідовних номерів
+// передавач шле пакет парності (прапорець PACKET_FLAG_FEC) з XOR навантажень
+// аудіокадрів групи, а приймач відновлює з нього одну втрату в групі.
+// Пакет парності має номер і мітку часу останнього кадру групи, тому не займає
+// місця в послідовності аудіокадрів. Модуль не залежить від FreeRTOS.
+//
+// Навантаження пакета парності:
+//  0      кількість номерів у групі
+//  1      маска захищених кадрів (біт i - номер першого кадру + i)
+//  2..3   XOR довжин навантажень
+//  4..    XOR навантажень, доповнених нулями до найдовшого
+
+#define FEC_MAX_GROUP 8             // Найбільша група, ширина маски
+#define FEC_HEADER_SIZE 4           // Службові поля на початку навантаження парності
+
+typedef struct {
+    uint32_t frames;            // Захищено кадрів
+    uint32_t parity;            // Надіслано пакетів парності
+    uint32_t data_bytes;        // Байтів навантаження захищених кадрів
+    uint32_t parity_bytes;      // Байтів навантаження пакетів парності
+} fec_encoder_stats_t;
+
+typedef struct {
+    uint8_t *parity;            // Накопичений XOR навантажень
+    size_t max_payload;
+    uint8_t group;              // Кількість номерів у групі
+    uint8_t count;              // Номерів, уже врахованих у поточній групі
+    uint8_t mask;
+    uint16_t base_seq;          // Номер першого кадру групи
+    uint16_t len_xor;
+    uint16_t max_len;
+    fec_encoder_stats_t stats;
+} fec_encoder_t;
+
+typedef struct {
+    uint32_t parity;            // Отримано пакетів парності
+    uint32_t recovered;         // Відновлено кадрів
+    uint32_t unrecoverable;     // Груп з двома і більше втратами
+} fec_decoder_stats_t;
+
+// Копії останніх отриманих кадрів, слот за молодшими бітами номера
+typedef struct {
+    uint8_t *data;              // FEC_MAX_GROUP * max_payload
+    uint16_t len[FEC_MAX_GROUP];
+    uint16_t seq[FEC_MAX_GROUP];
+    bool valid[FEC_MAX_GROUP];
+    uint8_t *recovered;         // Відновлене навантаження
+    size_t max_payload;
+    uint32_t session;
+    fec_decoder_stats_t stats;
+} fec_decoder_t;
+
+bool fec_encoder_init(fec_encoder_t *enc, uint8_t group, size_t max_payload);
+void fec_encoder_free(fec_encoder_t *enc);
+bool fec_encoder_add(fec_encoder_t *enc, uint16_t seq, const uint8_t *payload, size_t len);
+size_t fec_encoder_write(fec_encoder_t *enc, uint8_t *out);
+void fec_encoder_get_stats(const fec_encoder_t *enc, fec_encoder_stats_t *stats);
+
+bool fec_decoder_init(fec_decoder_t *dec, size_t max_payload);
+void fec_decoder_free(fec_decoder_t *dec);
+void fec_decoder_add(fec_decoder_t *dec, uint32_t session, uint16_t seq, const uint8_t *payload, size_t len);
+const uint8_t *fec_decoder_recover(fec_decoder_t *dec, uint32_t session, uint16_t seq,
+                                   const uint8_t *parity, size_t parity_len,
+                                   uint16_t *lost_seq, size_t *lost_len);
+void fec_decoder_get_stats(const fec_decoder_t *dec, fec_decoder_stats_t *stats);
+
+#endif /* MAIN_FEC_H_ */
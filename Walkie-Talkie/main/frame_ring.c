@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame_ring.h"
+
+bool frame_ring_init(frame_ring_t *ring, uint16_t slots, size_t frame_bytes) {
+    memset(ring, 0, sizeof(*ring));
+
+    // Степінь двійки дозволяє рахувати індекси вільно до переповнення uint32
+    if (slots < 2 || slots > FRAME_RING_MAX_SLOTS || (slots & (slots - 1)) != 0 || frame_bytes == 0) {
+        return false;
+    }
+
+    ring->data = (uint8_t *)calloc(slots, frame_bytes);
+    ring->len = (uint16_t *)calloc(slots, sizeof(uint16_t));
+    if (!ring->data || !ring->len) {
+        frame_ring_free(ring);
+        return false;
+    }
+
+    ring->slots = slots;
+    ring->frame_bytes = frame_bytes;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->pushed, 0);
+    atomic_init(&ring->overruns, 0);
+    return true;
+}
+
+void frame_ring_free(frame_ring_t *ring) {
+    free(ring->data);
+    free(ring->len);
+    ring->data = NULL;
+    ring->len = NULL;
+}
+
+uint8_t *frame_ring_acquire(frame_ring_t *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if ((uint32_t)(head - tail) >= ring->slots) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+        return NULL;
+    }
+    return ring->data + (size_t)(head & (ring->slots - 1)) * ring->frame_bytes;
+}
+
+void frame_ring_commit(frame_ring_t *ring, size_t len) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (len > ring->frame_bytes) {
+        len = ring->frame_bytes;
+    }
+    ring->len[head & (ring->slots - 1)] = (uint16_t)len;
+
+    // Release публікує вміст слота разом з новим індексом
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+
+    uint16_t count = (uint16_t)(head + 1 - tail);
+    if (count > ring->max_count) {
+        ring->max_count = count;
+    }
+}
+
+uint8_t *frame_ring_peek(frame_ring_t *ring, size_t *len) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        *len = 0;
+        return NULL;
+    }
+    uint16_t idx = tail & (ring->slots - 1);
+    *len = ring->len[idx];
+    return ring->data + (size_t)idx * ring->frame_bytes;
+}
+
+void frame_ring_release(frame_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+uint16_t frame_ring_count(frame_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return (uint16_t)(head - tail);
+}
+
+// Знімок лічильників; може викликатися з будь-якої задачі
+void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats) {
+    stats->count = frame_ring_count(ring);
+    stats->max_count = ring->max_count;
+    stats->pushed = atomic_load_explicit(&ring->pushed, memory_order_relaxed);
+    stats->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+}
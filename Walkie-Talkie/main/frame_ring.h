@@ -0,0 +1,50 @@
+#ifndef MAIN_FRAME_RING_H_
+#define MAIN_FRAME_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Кільце кадрів без блокувань для одного виробника та одного споживача.
+// Пам'ять під кадри виділяється при ініціалізації, виробник пише кадр прямо у слот,
+// споживач читає його на місці. Індекси атомарні, тому задачі можуть працювати
+// на різних ядрах без м'ютекса. Модуль не залежить від FreeRTOS.
+
+#define FRAME_RING_MAX_SLOTS 64
+
+typedef struct {
+    uint16_t count;             // Поточна кількість кадрів у кільці
+    uint16_t max_count;         // Найбільша зафіксована кількість
+    uint32_t pushed;            // Записано кадрів
+    uint32_t overruns;          // Відкинуто кадрів через заповнене кільце
+} frame_ring_stats_t;
+
+typedef struct {
+    uint8_t *data;              // Пам'ять під кадри (slots * frame_bytes)
+    uint16_t *len;
+    size_t frame_bytes;
+    uint16_t slots;
+    atomic_uint_fast32_t head;  // Змінює лише виробник
+    atomic_uint_fast32_t tail;  // Змінює лише споживач
+    // Лічильники виробника
+    uint16_t max_count;
+    atomic_uint_fast32_t pushed;
+    atomic_uint_fast32_t overruns;
+} frame_ring_t;
+
+bool frame_ring_init(frame_ring_t *ring, uint16_t slots, size_t frame_bytes);
+void frame_ring_free(frame_ring_t *ring);
+
+// Виробник: слот для наступного кадру або NULL, якщо кільце заповнене (кадр відкидається)
+uint8_t *frame_ring_acquire(frame_ring_t *ring);
+void frame_ring_commit(frame_ring_t *ring, size_t len);
+
+// Споживач: найстаріший кадр або NULL, якщо кільце порожнє; слот належить споживачу до release
+uint8_t *frame_ring_peek(frame_ring_t *ring, size_t *len);
+void frame_ring_release(frame_ring_t *ring);
+
+uint16_t frame_ring_count(frame_ring_t *ring);
+void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats);
+
+#endif /* MAIN_FRAME_RING_H_ */
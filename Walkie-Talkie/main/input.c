@@ -0,0 +1,175 @@
+#include <string.h>
+#include "input.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "Input";
+
+// Переривання лише фіксує час фронту і будить задачу служби бітом кнопки
+static void IRAM_ATTR input_isr(void *arg)
+{
+    input_button_t *button = (input_button_t *)arg;
+    input_t *in = button->input;
+    button->edge_us = esp_timer_get_time();
+    in->stats.edges++;
+
+    TaskHandle_t task = in->task;
+    if (task != NULL) {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(task, 1u << (button - in->buttons), eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+esp_err_t input_init(input_t *in, const input_button_config_t *buttons, size_t count, uint32_t debounce_ms) {
+    if (count > INPUT_MAX_BUTTONS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(in, 0, sizeof(*in));
+    in->count = count;
+    in->debounce_us = (int64_t)debounce_ms * 1000;
+
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Unable to install GPIO ISR service: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        input_button_t *button = &in->buttons[i];
+        button->input = in;
+        button->config = buttons[i];
+
+        gpio_config_t io = {
+            .pin_bit_mask = 1ULL << buttons[i].gpio,
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_ANYEDGE,
+        };
+        ret = gpio_config(&io);
+        if (ret == ESP_OK) {
+            ret = gpio_isr_handler_add(buttons[i].gpio, input_isr, button);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Unable to configure GPIO %d: %s", buttons[i].gpio, esp_err_to_name(ret));
+            return ret;
+        }
+
+        // Кнопка, утримана під час запуску, не дає ні натискання, ні довгого натискання
+        button->pressed = gpio_get_level(buttons[i].gpio) == 0;
+        button->long_fired = button->pressed;
+    }
+    return ESP_OK;
+}
+
+// Підписка задачі на події за маскою INPUT_EVENT_BIT(); викликається до запуску служби.
+// Дескриптор читається під час розсилки, тож задача може бути створена пізніше
+esp_err_t input_subscribe(input_t *in, TaskHandle_t *task, uint32_t mask) {
+    if (in->subscriber_count >= INPUT_MAX_SUBSCRIBERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    in->subscribers[in->subscriber_count].task = task;
+    in->subscribers[in->subscriber_count].mask = mask;
+    in->subscriber_count++;
+    return ESP_OK;
+}
+
+static void emit(input_t *in, size_t button, input_event_t event) {
+    uint32_t bit = INPUT_EVENT_BIT(button, event);
+    for (size_t i = 0; i < in->subscriber_count; i++) {
+        TaskHandle_t task = *in->subscribers[i].task;
+        if ((in->subscribers[i].mask & bit) && task != NULL) {
+            xTaskNotify(task, bit, eSetBits);
+        }
+    }
+    in->stats.events++;
+}
+
+// Порівнює рівень виводу зі станом кнопки. Перший фронт змінює стан одразу, наступні
+// протягом debounce_us ігноруються; після цього рівень перевіряється ще раз, щоб
+// не пропустити відпускання, яке збіглося з брязкотом
+static void poll_button(input_t *in, size_t index, int64_t now_us) {
+    input_button_t *button = &in->buttons[index];
+    bool pressed = gpio_get_level(button->config.gpio) == 0;
+
+    if (pressed != button->pressed && now_us >= button->settle_us) {
+        button->pressed = pressed;
+        button->settle_us = now_us + in->debounce_us;
+        if (pressed) {
+            // Відлік натискання - від фронту в перериванні, а не від пробудження задачі
+            int64_t edge_us = button->edge_us;
+            button->press_us = edge_us > 0 && edge_us <= now_us ? edge_us : now_us;
+            button->long_fired = false;
+            emit(in, index, INPUT_PRESS);
+            uint32_t double_ms = button->config.double_press_ms;
+            if (double_ms > 0 && button->release_us > 0 &&
+                button->press_us - button->release_us <= (int64_t)double_ms * 1000) {
+                emit(in, index, INPUT_DOUBLE_PRESS);
+                button->release_us = 0;     // Третє натискання починає нову пару
+            }
+        } else {
+            button->release_us = now_us;
+            emit(in, index, INPUT_RELEASE);
+            if (!button->long_fired) {
+                emit(in, index, INPUT_CLICK);
+            }
+        }
+    }
+
+    uint32_t long_ms = button->config.long_press_ms;
+    if (button->pressed && !button->long_fired && long_ms > 0 &&
+        now_us - button->press_us >= (int64_t)long_ms * 1000) {
+        button->long_fired = true;
+        emit(in, index, INPUT_LONG_PRESS);
+    }
+}
+
+// Тіло задачі служби: спить до переривання або до найближчого терміну - кінця
+// антибрязкоту чи спрацювання довгого натискання
+void input_run(input_t *in) {
+    in->task = xTaskGetCurrentTaskHandle();
+    TickType_t wait = portMAX_DELAY;
+
+    while (1) {
+        uint32_t pending = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &pending, wait);
+        int64_t now_us = esp_timer_get_time();
+        int64_t next_us = INT64_MAX;
+
+        for (size_t i = 0; i < in->count; i++) {
+            input_button_t *button = &in->buttons[i];
+            if ((pending & (1u << i)) && now_us < button->settle_us) {
+                in->stats.bounces++;
+            }
+            poll_button(in, i, now_us);
+
+            if (now_us < button->settle_us && button->settle_us < next_us) {
+                next_us = button->settle_us;
+            }
+            if (button->pressed && !button->long_fired && button->config.long_press_ms > 0) {
+                int64_t long_us = button->press_us + (int64_t)button->config.long_press_ms * 1000;
+                if (long_us < next_us) {
+                    next_us = long_us;
+                }
+            }
+        }
+
+        // Зайвий тік гарантує, що задача не прокинеться раніше за термін
+        wait = next_us == INT64_MAX ? portMAX_DELAY
+                                    : pdMS_TO_TICKS((next_us - now_us + 999) / 1000) + 1;
+    }
+}
+
+bool input_is_pressed(const input_t *in, size_t button) {
+    return in->buttons[button].pressed;
+}
+
+// Час фронту, з якого почалося останнє натискання кнопки
+int64_t input_press_time(const input_t *in, size_t button) {
+    return in->buttons[button].press_us;
+}
+
+void input_get_stats(const input_t *in, input_stats_t *stats) {
+    *stats = in->stats;
+}
@@ -0,0 +1,81 @@
+#ifndef MAIN_INPUT_H_
+#define MAIN_INPUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+// Служба кнопок на перериваннях GPIO замість задач опитування. Переривання лише
+// запам'ятовує час фронту і будить задачу служби, а та відкидає брязкіт контактів,
+// розпізнає довге та подвійне натискання і розсилає події підписаним задачам
+// бітами сповіщення (eSetBits). Натискання видається за першим фронтом без очікування
+// кінця брязкоту, тож затримка кнопки передачі не залежить від часу антибрязкоту.
+// Кнопки активні низьким рівнем з підтягуванням до живлення.
+
+#define INPUT_MAX_BUTTONS 4
+#define INPUT_MAX_SUBSCRIBERS 4
+
+typedef enum {
+    INPUT_PRESS,                // Кнопку натиснуто
+    INPUT_RELEASE,              // Кнопку відпущено
+    INPUT_CLICK,                // Відпущено до спрацювання довгого натискання
+    INPUT_LONG_PRESS,           // Кнопку утримано довше за long_press_ms
+    INPUT_DOUBLE_PRESS,         // Друге натискання протягом double_press_ms після відпускання
+    INPUT_EVENT_COUNT,
+} input_event_t;
+
+// Біт події кнопки у значенні сповіщення підписника
+#define INPUT_EVENT_BIT(button, event) (1u << ((button) * INPUT_EVENT_COUNT + (event)))
+
+typedef struct {
+    gpio_num_t gpio;
+    uint32_t long_press_ms;     // 0 вимикає довге натискання
+    uint32_t double_press_ms;   // 0 вимикає подвійне натискання
+} input_button_config_t;
+
+typedef struct input input_t;
+
+typedef struct {
+    input_t *input;             // Для обробника переривання
+    input_button_config_t config;
+    volatile int64_t edge_us;   // Час останнього фронту, записує переривання
+    bool pressed;               // Стан після антибрязкоту
+    bool long_fired;
+    int64_t press_us;           // Час фронту, з якого почалося поточне натискання
+    int64_t release_us;
+    int64_t settle_us;          // До цього часу нові фронти вважаються брязкотом
+} input_button_t;
+
+typedef struct {
+    TaskHandle_t *task;         // Дескриптор задачі, може бути ще не створена
+    uint32_t mask;
+} input_subscriber_t;
+
+typedef struct {
+    uint32_t edges;             // Переривань від кнопок
+    uint32_t bounces;           // Фронтів, відкинутих антибрязкотом
+    uint32_t events;            // Розіслано подій
+} input_stats_t;
+
+struct input {
+    input_button_t buttons[INPUT_MAX_BUTTONS];
+    size_t count;
+    int64_t debounce_us;
+    input_subscriber_t subscribers[INPUT_MAX_SUBSCRIBERS];
+    size_t subscriber_count;
+    volatile TaskHandle_t task;
+    input_stats_t stats;
+};
+
+esp_err_t input_init(input_t *in, const input_button_config_t *buttons, size_t count, uint32_t debounce_ms);
+esp_err_t input_subscribe(input_t *in, TaskHandle_t *task, uint32_t mask);
+void input_run(input_t *in);
+bool input_is_pressed(const input_t *in, size_t button);
+int64_t input_press_time(const input_t *in, size_t button);
+void input_get_stats(const input_t *in, input_stats_t *stats);
+
+#endif /* MAIN_INPUT_H_ */
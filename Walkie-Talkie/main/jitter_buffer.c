@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <string.h>
+#include "jitter_buffer.h"
+
+// Порівняння номерів з урахуванням переповнення 16-бітного лічильника
+static inline int16_t seq_diff(uint16_t a, uint16_t b) {
+    return (int16_t)(uint16_t)(a - b);
+}
+
+static void update_target(jitter_buffer_t *jb) {
+    uint32_t jitter_us = jb->jitter_q4 >> 4;
+    uint32_t margin = (JB_JITTER_MULT * jitter_us + jb->frame_period_us - 1) / jb->frame_period_us;
+    uint32_t target = margin + 1;
+
+    if (target < JB_MIN_DEPTH) {
+        target = JB_MIN_DEPTH;
+    }
+    if (target > jb->max_depth) {
+        target = jb->max_depth;
+    }
+    jb->target_depth = (uint16_t)target;
+}
+
+// Оцінка джитера за RFC 3550: J += (|D| - J) / 16
+static void update_jitter(jitter_buffer_t *jb, uint16_t seq, int64_t now_us) {
+    int64_t expected = (int64_t)seq_diff(seq, jb->last_seq) * jb->frame_period_us;
+    int64_t d = (now_us - jb->last_arrival_us) - expected;
+    if (d < 0) {
+        d = -d;
+    }
+    if (d > 0x0FFFFFFF) {
+        d = 0x0FFFFFFF;
+    }
+    jb->jitter_q4 += (uint32_t)d - ((jb->jitter_q4 + 8) >> 4);
+    update_target(jb);
+}
+
+static void drop_slot(jitter_buffer_t *jb, uint16_t seq) {
+    uint16_t idx = seq & (jb->slots - 1);
+    if (jb->valid[idx] && jb->seq[idx] == seq) {
+        jb->valid[idx] = false;
+        jb->depth--;
+    }
+}
+
+// Розміщення кадру в слоті за номером; спільне для отриманих і відновлених кадрів
+static void store_frame(jitter_buffer_t *jb, uint16_t seq, const uint8_t *data, size_t len) {
+    int16_t ahead = seq_diff(seq, jb->play_seq);
+    if (ahead < 0) {
+        // До початку відтворення можна зсунути початок черги назад, якщо вистачає слотів
+        if (jb->started || seq_diff(jb->high_seq, seq) >= jb->slots) {
+            jb->stats.late_drops++;
+            return;
+        }
+        jb->play_seq = seq;
+        ahead = 0;
+    }
+
+    if (ahead >= jb->slots) {
+        // Кадр занадто далеко попереду: звільняємо місце, відкидаючи найстаріші кадри
+        uint16_t new_start = (uint16_t)(seq - jb->slots + 1);
+        while (jb->play_seq != new_start) {
+            uint16_t before = jb->depth;
+            drop_slot(jb, jb->play_seq);
+            if (jb->depth != before) {
+                jb->stats.overflow_drops++;
+            }
+            jb->play_seq++;
+        }
+    }
+
+    uint16_t idx = seq & (jb->slots - 1);
+    if (jb->valid[idx] && jb->seq[idx] == seq) {
+        jb->stats.duplicates++;
+        return;
+    }
+
+    memcpy(jb->data + (size_t)idx * jb->frame_bytes, data, len);
+    jb->len[idx] = (uint16_t)len;
+    jb->seq[idx] = seq;
+    jb->valid[idx] = true;
+    jb->depth++;
+
+    if (seq_diff(seq, jb->high_seq) > 0) {
+        jb->high_seq = seq;
+    }
+}
+
+bool jitter_buffer_init(jitter_buffer_t *jb, uint16_t slots, size_t frame_bytes, uint32_t frame_period_us) {
+    memset(jb, 0, sizeof(*jb));
+
+    // Кількість слотів має бути степенем двійки, щоб індекс не ламався при переповненні номера
+    if (slots < 4 || slots > JB_MAX_SLOTS || (slots & (slots - 1)) != 0 || frame_period_us == 0) {
+        return false;
+    }
+
+    jb->data = (uint8_t *)calloc(slots, frame_bytes);
+    jb->len = (uint16_t *)calloc(slots, sizeof(uint16_t));
+    jb->seq = (uint16_t *)calloc(slots, sizeof(uint16_t));
+    jb->valid = (bool *)calloc(slots, sizeof(bool));
+    if (!jb->data || !jb->len || !jb->seq || !jb->valid) {
+        jitter_buffer_free(jb);
+        return false;
+    }
+
+    jb->slots = slots;
+    jb->frame_bytes = frame_bytes;
+    jb->frame_period_us = frame_period_us;
+    jb->max_depth = slots / 2;
+    jitter_buffer_reset(jb);
+    return true;
+}
+
+void jitter_buffer_free(jitter_buffer_t *jb) {
+    free(jb->data);
+    free(jb->len);
+    free(jb->seq);
+    free(jb->valid);
+    jb->data = NULL;
+    jb->len = NULL;
+    jb->seq = NULL;
+    jb->valid = NULL;
+}
+
+void jitter_buffer_reset(jitter_buffer_t *jb) {
+    memset(jb->valid, 0, jb->slots * sizeof(bool));
+    jb->depth = 0;
+    jb->started = false;
+    jb->playing = false;
+    jb->starved = false;
+    jb->have_ref = false;
+    jb->jitter_q4 = 0;
+    update_target(jb);
+    memset(&jb->stats, 0, sizeof(jb->stats));
+}
+
+void jitter_buffer_push(jitter_buffer_t *jb, uint16_t seq, const uint8_t *data, size_t len, int64_t now_us) {
+    if (len > jb->frame_bytes) {
+        len = jb->frame_bytes;
+    }
+
+    // Після тривалої паузи з порожнім буфером починається новий потік (нове натискання PTT)
+    bool new_stream = !jb->have_ref || (jb->depth == 0 && now_us - jb->last_arrival_us > JB_IDLE_US);
+    if (new_stream) {
+        jb->started = false;
+        jb->playing = false;
+        jb->starved = false;
+        jb->play_seq = seq;
+        jb->high_seq = seq;
+    } else {
+        if (jb->starved) {
+            // Потік продовжився після спустошення буфера, отже це був справжній провал звуку
+            jb->stats.underruns++;
+            jb->starved = false;
+        }
+        update_jitter(jb, seq, now_us);
+    }
+    jb->have_ref = true;
+    jb->last_seq = seq;
+    jb->last_arrival_us = now_us;
+
+    store_frame(jb, seq, data, len);
+}
+
+// Кадр, відновлений приймачем (наприклад, з парності): час його появи не
+// відображає мережу, тому оцінка джитера і межі потоку не змінюються
+void jitter_buffer_insert(jitter_buffer_t *jb, uint16_t seq, const uint8_t *data, size_t len) {
+    if (!jb->have_ref) {
+        return;
+    }
+    if (len > jb->frame_bytes) {
+        len = jb->frame_bytes;
+    }
+    store_frame(jb, seq, data, len);
+}
+
+jb_status_t jitter_buffer_pop(jitter_buffer_t *jb, uint8_t *out, size_t *len) {
+    *len = 0;
+
+    if (!jb->playing) {
+        if (jb->depth == 0 || jb->depth < jb->target_depth) {
+            return JB_BUFFERING;
+        }
+        // Старт відтворення з найстарішого наявного кадру
+        while (!jb->valid[jb->play_seq & (jb->slots - 1)]) {
+            jb->play_seq++;
+        }
+        jb->started = true;
+        jb->playing = true;
+    }
+
+    if (jb->depth == 0) {
+        jb->playing = false;
+        jb->starved = true;
+        return JB_UNDERRUN;
+    }
+
+    // Буфер переповнений відносно цілі: скидаємо найстаріший кадр, щоб зменшити затримку
+    if (jb->depth > jb->target_depth + JB_DRAIN_SLACK) {
+        uint16_t before = jb->depth;
+        drop_slot(jb, jb->play_seq);
+        if (jb->depth != before) {
+            jb->stats.drained++;
+        }
+        jb->play_seq++;
+    }
+
+    uint16_t idx = jb->play_seq & (jb->slots - 1);
+    uint16_t seq = jb->play_seq;
+    jb->play_seq++;
+
+    if (jb->valid[idx] && jb->seq[idx] == seq) {
+        memcpy(out, jb->data + (size_t)idx * jb->frame_bytes, jb->len[idx]);
+        *len = jb->len[idx];
+        jb->valid[idx] = false;
+        jb->depth--;
+        jb->stats.played++;
+        return JB_FRAME;
+    }
+
+    jb->stats.lost++;
+    return JB_LOST;
+}
+
+void jitter_buffer_get_stats(const jitter_buffer_t *jb, jb_stats_t *stats) {
+    *stats = jb->stats;
+    stats->depth = jb->depth;
+    stats->target_depth = jb->target_depth;
+    stats->jitter_us = jb->jitter_q4 >> 4;
+}
@@ -0,0 +1,69 @@
+#ifndef MAIN_JITTER_BUFFER_H_
+#define MAIN_JITTER_BUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Адаптивний джитер-буфер: черга перевпорядкування за номером послідовності,
+// з якої задача відтворення забирає кадри з частотою I2S.
+// Модуль не залежить від FreeRTOS, синхронізацію виконує викликач.
+
+#define JB_MAX_SLOTS 32             // Максимальна кількість кадрів у буфері
+#define JB_MIN_DEPTH 2              // Мінімальна цільова глибина (кадри)
+#define JB_JITTER_MULT 3            // Запас глибини у кількості оцінок джитера
+#define JB_IDLE_US 200000           // Пауза, після якої потік вважається новим
+#define JB_DRAIN_SLACK 2            // Перевищення цілі, після якого кадри скидаються
+
+typedef enum {
+    JB_FRAME,           // Повернуто кадр
+    JB_LOST,            // Кадр з черговим номером втрачено, потрібне маскування
+    JB_UNDERRUN,        // Буфер спорожнів під час відтворення
+    JB_BUFFERING,       // Буфер заповнюється до цільової глибини
+} jb_status_t;
+
+typedef struct {
+    uint16_t depth;             // Поточна кількість кадрів у буфері
+    uint16_t target_depth;      // Поточна цільова глибина
+    uint32_t jitter_us;         // Оцінка джитера надходження (мкс)
+    uint32_t played;            // Відтворено кадрів
+    uint32_t lost;              // Пропущено кадрів під час відтворення
+    uint32_t late_drops;        // Відкинуто кадрів, що прийшли запізно
+    uint32_t duplicates;        // Відкинуто дублікатів
+    uint32_t overflow_drops;    // Відкинуто кадрів через переповнення
+    uint32_t drained;           // Скинуто кадрів для зменшення затримки
+    uint32_t underruns;         // Кількість спустошень буфера
+} jb_stats_t;
+
+typedef struct {
+    uint8_t *data;              // Пам'ять під кадри (slots * frame_bytes)
+    uint16_t *len;
+    uint16_t *seq;
+    bool *valid;
+    size_t frame_bytes;
+    uint16_t slots;
+    uint16_t depth;
+    uint16_t max_depth;
+    uint16_t target_depth;
+    uint16_t play_seq;          // Номер наступного кадру для відтворення
+    uint16_t high_seq;          // Найбільший отриманий номер
+    uint16_t last_seq;          // Номер останнього отриманого кадру
+    bool started;               // Відтворення потоку почалося, play_seq зафіксовано
+    bool playing;
+    bool starved;
+    bool have_ref;
+    int64_t last_arrival_us;
+    uint32_t frame_period_us;
+    uint32_t jitter_q4;         // Джитер у мкс з 4 дробовими бітами (RFC 3550)
+    jb_stats_t stats;
+} jitter_buffer_t;
+
+bool jitter_buffer_init(jitter_buffer_t *jb, uint16_t slots, size_t frame_bytes, uint32_t frame_period_us);
+void jitter_buffer_free(jitter_buffer_t *jb);
+void jitter_buffer_reset(jitter_buffer_t *jb);
+void jitter_buffer_push(jitter_buffer_t *jb, uint16_t seq, const uint8_t *data, size_t len, int64_t now_us);
+void jitter_buffer_insert(jitter_buffer_t *jb, uint16_t seq, const uint8_t *data, size_t len);
+jb_status_t jitter_buffer_pop(jitter_buffer_t *jb, uint8_t *out, size_t *len);
+void jitter_buffer_get_stats(const jitter_buffer_t *jb, jb_stats_t *stats);
+
+#endif /* MAIN_JITTER_BUFFER_H_ */
@@ -4,25 +4,46 @@
 #include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 #include "lwip/sockets.h"
 #include "driver/gpio.h"
 #include "driver/i2s_std.h"
 #include "math.h"
-#include "mbedtls/aes.h"
 #include "esp_err.h"
 #include "esp_system.h"
+#include "esp_random.h"
+#include "esp_mac.h"
 #include "esp_vfs.h"
 #include "esp_spiffs.h"
+#include "esp_timer.h"
 #include "st7789.h"
 #include "fontx.h"
-
-// Визначаємо пристрій сервер чи клієнт
-#define IS_SERVER
-//#define IS_CLIENT
+#include "jitter_buffer.h"
+#include "packet.h"
+#include "transport.h"
+#include "codec.h"
+#include "resampler.h"
+#include "crypto.h"
+#include "frame_ring.h"
+#include "rt_sched.h"
+#include "packet_pool.h"
+#include "dsp.h"
+#include "agc.h"
+#include "dtx.h"
+#include "plc.h"
+#include "fec.h"
+#include "stream.h"
+#include "stream_io.h"
+#include "mixer.h"
+#include "conference.h"
+#include "discovery.h"
+#include "input.h"
+#include "state_bus.h"
 
 #define I2S_NUM_TX 0
 #define I2S_NUM_RX 1
@@ -41,14 +62,85 @@
 #define EXAMPLE_ESP_WIFI_SSID "esp32_ap"
 #define EXAMPLE_ESP_WIFI_PASS "password"
 #define PORT 1234
-#define CLIENT_IP_ADDR "192.168.4.2"
-#define SERVER_IP_ADDR "192.168.4.1"
-
-#define UDP_BUFFER_SIZE 1024
-#define SAMPLE_RATE 44100 // Аудіо стандарт, частота дискретизації
+#define TALKGROUP_ADDR "239.255.0.1"    // Multicast-група розмовних груп; підходить і широкомовна адреса підмережі
+#define TALKGROUP_COUNT 4               // Розмовні групи 1..3, 0 - адресний режим через сервер
+#define TALKGROUP_HOLD_MS 1000          // Утримання кнопки шифрування перемикає розмовну групу
+#define PTT_DOUBLE_PRESS_MS 400         // Подвійне натискання кнопки передачі фіксує передачу
+#define INPUT_DEBOUNCE_MS 30            // Брязкіт контактів кнопок
+
+// Роль пристрою зберігається в NVS, тож усі плати працюють з однаковою прошивкою.
+// Утримання кнопки передачі під час запуску перемикає роль і зберігає її
+#define DEFAULT_ROLE DISCOVERY_ROLE_SERVER
+#define ROLE_NVS_NAMESPACE "walkie"
+#define ROLE_NVS_KEY "role"
+#define EPOCH_NVS_KEY "epoch"           // Лічильник запусків для маяків виявлення
+
+#define DISCOVERY_INTERVAL_MS 1000      // Період маяків виявлення
+#define DISCOVERY_TIMEOUT_MS 3500       // Пір без маяка довше за цей час вважається втраченим
+
+#define SAMPLE_RATE 44100 // Аудіо стандарт, частота дискретизації I2S
+#define FRAME_MS 10 // Тривалість кадру; 10 мс тримає кадр PCM16 44.1 кГц у межах MTU
+#define FRAME_SAMPLES (SAMPLE_RATE * FRAME_MS / 1000)
+#define FRAME_PERIOD_US (FRAME_MS * 1000)
+#define UDP_BUFFER_SIZE (FRAME_SAMPLES * 2)
+#define UDP_PACKET_SIZE (PACKET_HEADER_SIZE + FEC_HEADER_SIZE + UDP_BUFFER_SIZE + CRYPTO_TAG_SIZE) // Кадр або парність разом із заголовком і тегом
+
+#define JITTER_BUFFER_SLOTS 16
+#define CONF_JITTER_BUFFER_SLOTS 8  // Джитер-буфер кожного піра конференції на сервері
+#define CONF_IDLE_TIMEOUT_MS 10000  // Пір без автентифікованого трафіку відключається від конференції
+#define STATS_INTERVAL_MS 5000  // Період виводу статистики
+#define RX_TIMEOUT_MS 100
+#define CAPTURE_RING_SLOTS 8      // Запас кадрів мікрофона на час затримок мережі
+#define PACKET_POOL_BUFFERS 8     // Буфери пакетів для відправки та прийому
+
+#define DC_BLOCK_CUTOFF_HZ 20       // Частота зрізу фільтра постійної складової
+#define FEC_GROUP 4                 // Кадрів на один пакет парності (2, 4 або 8); 0 вимикає FEC
+
+// Автоматичне регулювання підсилення мікрофона
+static const agc_config_t agc_config = {
+    .target_level = 3000,                   // Середній модуль мови на виході (близько -20 дБ)
+    .gate_level = 40,                       // Рівень шуму мікрофона до підсилення
+    .min_gain_q15 = DSP_GAIN_Q15(1.0),
+    .max_gain_q15 = DSP_GAIN_Q15(20.0),
+    .attack_q15 = DSP_GAIN_Q15(0.25),       // Близько 40 мс на зменшення
+    .release_q15 = DSP_GAIN_Q15(0.03),      // Близько 300 мс на збільшення
+    .limit = 29000,
+    .lookahead = SAMPLE_RATE / 500,         // 2 мс попереднього перегляду
+};
 
 #define AES_KEY_SIZE 16
 
+// Режим шифрування навантаження: AES-GCM автентифікує заголовок і навантаження.
+// CTR лише приховує звук: тегу немає, тож підроблений чи змінений у дорозі пакет
+// відтворюється як шум, а перемикач шифрування не гарантує, що кадр від своїх
+#define CRYPTO_MODE CRYPTO_MODE_GCM
+// Маяки визначають склад конференції, тому завжди автентифікуються незалежно від CRYPTO_MODE
+#define BEACON_CRYPTO_MODE CRYPTO_MODE_GCM
+
+// Кодек для відправки; приймач декодує за ідентифікатором із заголовка
+#define AUDIO_CODEC codec_ima_adpcm
+
+// Голосові профілі: частота, на якій працює кодек. Перетворювач частоти
+// узгоджує її з частотою I2S в обох напрямках
+typedef enum {
+    VOICE_NARROWBAND,
+    VOICE_WIDEBAND,
+    VOICE_FULLBAND,
+} voice_profile_id_t;
+
+typedef struct {
+    const char *name;
+    packet_rate_t rate;
+} voice_profile_t;
+
+static const voice_profile_t voice_profiles[] = {
+    [VOICE_NARROWBAND] = { "narrowband", PACKET_RATE_8000 },
+    [VOICE_WIDEBAND] = { "wideband", PACKET_RATE_16000 },
+    [VOICE_FULLBAND] = { "fullband", PACKET_RATE_44100 },
+};
+
+#define VOICE_PROFILE VOICE_WIDEBAND
+
 uint8_t aes_key[AES_KEY_SIZE] = {
     0x3d, 0xf2, 0x67, 0xf0, 0x34, 0xa9, 0xbc, 0x0b, 
     0x8e, 0xac, 0xe5, 0x8f, 0x12, 0x3c, 0x56, 0x78
@@ -58,30 +150,133 @@ static i2s_chan_handle_t    rx_chan;
 static i2s_chan_handle_t    tx_chan;
 
 static const char *TAG = "Walkie_Talkie"; 
-#ifdef IS_CLIENT
 static bool got_ip = false;
-#endif
-volatile bool transmit_data = false;
-volatile bool receiving_data = false;
-volatile bool encryption_enabled = true;
+// Роль читається з NVS під час запуску і далі не змінюється
+static discovery_role_t role = DEFAULT_ROLE;
+// Передача, прийом, шифрування та розмовна група; зміни будять інтерфейс
+static state_bus_t state;
+
+static transport_t transport;
+// Адреса розмовних груп; кадр групі відправляється один раз для всіх слухачів
+static struct sockaddr_in talkgroup_addr;
+// Власна адреса: широкомовні кадри повертаються й відправнику
+static volatile uint32_t local_addr;
+// Адреса сервера для клієнта: з маяка виявлення, до нього - шлюз з оренди DHCP
+static volatile uint32_t server_addr;
+static uint32_t gateway_addr;
+
+// Таблиця пірів виявлення під власним м'ютексом, бо її змінюють задачі прийому і маяків
+static discovery_t discovery;
+static SemaphoreHandle_t discovery_mutex;
+
+// М'ютекс потоків: джитер-буфери, стан прийому, комфортний шум і таблиця конференції
+static SemaphoreHandle_t stream_mutex;
+
+// Сервер мікшує всіх підключених пірів і кожному відправляє суму без його власного голосу
+static conference_t conference;
+static mixer_t mixer;
+// Потік мікрофона сервера до розмовної групи
+static stream_tx_t group_stream;
+// Оброблені кадри мікрофона сервера від задачі відправки до мікшера
+static frame_ring_t talk_ring;
+
+// Потоки клієнта до сервера і від нього; потік прийому також несе кадри розмовної
+// групи від будь-якої станції і закріплюється за одним мовцем (stream.h)
+static stream_tx_t tx_stream;
+static stream_rx_t rx_stream;
+
+// Фільтри перетворювача частоти рахуються один раз під час запуску, потоки лише
+// посилаються на них: передача з частоти I2S у частоту профілю, прийом - з кожної
+// частоти профілів у частоту I2S, тож зміна профілю відправника не виділяє пам'ять
+static resampler_filter_t tx_filter;
+static resampler_filter_t rx_filters[PACKET_RATE_COUNT];
+
+// Кадри мікрофона від задачі захоплення до задачі відправки
+static frame_ring_t capture_ring;
+static TaskHandle_t udp_send_task_handle;
+
+// Кнопки на перериваннях; події приходять сповіщеннями задачам захоплення та дисплея
+enum {
+    BUTTON_PTT,
+    BUTTON_ENCRYPTION,
+    BUTTON_COUNT,
+};
+static input_t input;
+static TaskHandle_t capture_task_handle;
+static TaskHandle_t display_task_handle;
+
+// Затримка від фронту кнопки передачі до першого кадру, відданого в мережу чи мікшеру
+typedef struct {
+    int64_t last_us;
+    int64_t max_us;
+    uint32_t count;
+    portMUX_TYPE lock;
+} ptt_latency_t;
+static volatile int64_t ptt_down_us;
+static ptt_latency_t ptt_latency = { .lock = portMUX_INITIALIZER_UNLOCKED };
+
+// Стан АРП мікрофона; поточне підсилення читає задача статистики
+static agc_t agc;
+
+// Переривчаста передача на боці відправника
+static dtx_t dtx;
+
+// Комфортний шум на боці приймача клієнта, захищений м'ютексом потоків
+static cng_t comfort_noise;
+
+// Маскування втрат; використовує лише задача відтворення клієнта
+static plc_t plc;
+
+// Спільний пул буферів пакетів: виділяється один раз, без купи в гарячому шляху
+static packet_pool_t packet_pool;
+
+// Облік часу оброблення кадрів для звіту планувальника
+static rt_timing_t send_timing;
+static rt_timing_t receive_timing;
+static rt_timing_t playout_timing;
+
+// Адреса сервера для клієнта: найсвіжіший сервер з таблиці виявлення або шлюз.
+// Викликається під discovery_mutex
+static void update_server_addr(void)
+{
+    const discovery_peer_t *server = discovery_find(&discovery, DISCOVERY_ROLE_SERVER);
+    server_addr = server ? server->addr : gateway_addr;
+}
 
-// Обробник подій Wi-Fi
-static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+// Обробник подій Wi-Fi точки доступу (сервер)
+static void ap_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {   
-#ifdef IS_SERVER
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) 
     {
         ESP_LOGI(TAG, "Station connected");
     } 
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED) 
     {
+        wifi_event_ap_stadisconnected_t* event = (wifi_event_ap_stadisconnected_t*) event_data;
         ESP_LOGI(TAG, "Station disconnected");
+
+        // Потоки станції звільнить мікшер між тактами
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        conference_leave(&conference, event->mac);
+        xSemaphoreGive(stream_mutex);
     } 
     else if (event_base == IP_EVENT && event_id == IP_EVENT_AP_STAIPASSIGNED) 
     {
         ip_event_ap_staipassigned_t* event = (ip_event_ap_staipassigned_t*) event_data;
         ESP_LOGI(TAG, "Assigned IP to station: " IPSTR, IP2STR(&event->ip));
 
+        // Станція отримує суміш конференції одразу, навіть якщо ще не говорила.
+        // Потоки виділяються до входу в м'ютекс, під ним запис лише заповнюється
+        conference_streams_t *streams = conference_streams_alloc(&conference, esp_random());
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        conference_peer_t *peer = conference_join(&conference, event->ip.addr, event->mac, &streams,
+                                                  esp_timer_get_time());
+        xSemaphoreGive(stream_mutex);
+        conference_streams_free(streams);
+        if (peer == NULL) {
+            ESP_LOGE(TAG, "Conference is full");
+        }
+
         esp_netif_ip_info_t ip_info;
         esp_netif_t *ap_netif = esp_netif_get_handle_from_ifkey("WIFI_AP_DEF");
         if (ap_netif == NULL) 
@@ -100,7 +295,11 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
             }
         }
     }
-#else
+}
+
+// Обробник подій Wi-Fi станції (клієнт)
+static void sta_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{   
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) 
     {
         esp_wifi_connect();
@@ -115,30 +314,30 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
     {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
+        local_addr = event->ip_info.ip.addr;
         got_ip = true;
+
+        // Сервер - точка доступу, тож до першого маяка звук іде на шлюз з оренди
+        xSemaphoreTake(discovery_mutex, portMAX_DELAY);
+        gateway_addr = event->ip_info.gw.addr;
+        update_server_addr();
+        xSemaphoreGive(discovery_mutex);
     }
-#endif
 }
 
-void wifi_init(void)
+// Сервер піднімає точку доступу з фіксованою адресою і DHCP сервером
+static void wifi_init_softap(void)
 {
-    // Ініціалізація стеку WiFi
-    ESP_ERROR_CHECK(esp_netif_init());
-
-    // Ініціалізація бібліотеки WiFi з налаштуваннями за замовчуванням
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
     // Створення обробника подій WiFi
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
-#ifdef IS_SERVER
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &ap_event_handler, NULL, &instance_any_id));
+
     // Створення мережевого інтерфейсу для точки доступу (AP)
     esp_netif_t *ap_netif = esp_netif_create_default_wifi_ap();
 
     // Реєстрація обробника подій IP для AP
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, &wifi_event_handler, NULL, &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, &ap_event_handler, NULL, &instance_got_ip));
 
     wifi_config_t wifi_config = 
     {
@@ -147,7 +346,7 @@ void wifi_init(void)
             .ssid = EXAMPLE_ESP_WIFI_SSID,
             .ssid_len = strlen(EXAMPLE_ESP_WIFI_SSID),
             .password = EXAMPLE_ESP_WIFI_PASS,
-            .max_connection = 1,
+            .max_connection = CONF_MAX_PEERS,
             .authmode = WIFI_AUTH_WPA_WPA2_PSK      // Режим автентифікації
         },
     };
@@ -176,17 +375,27 @@ void wifi_init(void)
 
     // Встановлення IP-інформації для інтерфейсу AP
     ESP_ERROR_CHECK(esp_netif_set_ip_info(ap_netif, &ip_info));
+    local_addr = ip_info.ip.addr;
 
     // Запуск DHCP сервера для AP
     ESP_ERROR_CHECK(esp_netif_dhcps_start(ap_netif));
 
     ESP_LOGI(TAG, "wifi_init_softap finished. SSID:%s password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-#else
+}
+
+// Клієнт підключається до точки доступу сервера і отримує адресу від DHCP
+static void wifi_init_sta(void)
+{
+    // Створення обробника подій WiFi
+    esp_event_handler_instance_t instance_any_id;
+    esp_event_handler_instance_t instance_got_ip;
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &sta_event_handler, NULL, &instance_any_id));
+
     // Створення нового мережевого інтерфейсу STA (клієнт)
     esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta();
 
     // Реєстрація обробника подій IP для STA
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &sta_event_handler, NULL, &instance_got_ip));
 
     wifi_config_t wifi_config = 
     {
@@ -210,245 +419,532 @@ void wifi_init(void)
     ESP_ERROR_CHECK(esp_netif_dhcpc_start(sta_netif));
 
     ESP_LOGI(TAG, "wifi_init_sta finished.");
-#endif
 }
 
-void encryption_button_task(void* arg)
+void wifi_init(void)
 {
-    esp_rom_gpio_pad_select_gpio(ENCRYPTION_BUTTON_GPIO);
-
-    // Встановлення напрямку GPIO як вхід
-    gpio_set_direction(ENCRYPTION_BUTTON_GPIO, GPIO_MODE_INPUT);
+    // Ініціалізація стеку WiFi
+    ESP_ERROR_CHECK(esp_netif_init());
 
-    // Встановлення режиму підтягування до живлення
-    gpio_set_pull_mode(ENCRYPTION_BUTTON_GPIO, GPIO_PULLUP_ONLY);
+    // Ініціалізація бібліотеки WiFi з налаштуваннями за замовчуванням
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
-    int last_state = 1;
-    while(1) 
-    {
-        int state = gpio_get_level(ENCRYPTION_BUTTON_GPIO);
-        if(state != last_state)     // Перевірка на зміну стану кнопки
-        {
-            last_state = state;
-            if(state == 0) 
-            {
-                encryption_enabled = !encryption_enabled;
-                ESP_LOGI(TAG, "Encryption %s", encryption_enabled ? "enabled" : "disabled");
-            }
-        }
-        vTaskDelay(10 / portTICK_PERIOD_MS);     // Затримка для запобігання багаторазового натискання кнопки
+    if (role == DISCOVERY_ROLE_SERVER) {
+        wifi_init_softap();
+    } else {
+        wifi_init_sta();
     }
 }
 
-void button_task(void* arg)
+// Задача захоплення: лише читає I2S у кільце, щоб затримки мережі не губили семпли.
+// Кнопка передачі приходить подіями служби кнопок: поки передача вимкнена, задача
+// спить до натискання, а під час передачі перевіряє події між кадрами без очікування.
+// Подвійне натискання фіксує передачу до наступного натискання
+void capture_task(void *pvParameters)
 {
-    esp_rom_gpio_pad_select_gpio(BUTTON_GPIO);
-
-    // Встановлення напрямку GPIO як вхід
-    gpio_set_direction(BUTTON_GPIO, GPIO_MODE_INPUT);
+    uint8_t *discard_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
+    assert(discard_buf);
+    size_t read_bytes = 0;
+    bool latched = false;
+    bool transmit = false;
 
-    // Встановлення режиму підтягування до живлення
-    gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLUP_ONLY);
+    while (1) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, transmit ? 0 : portMAX_DELAY);
+
+        bool pressed = (events & INPUT_EVENT_BIT(BUTTON_PTT, INPUT_PRESS)) != 0;
+        if (events & INPUT_EVENT_BIT(BUTTON_PTT, INPUT_DOUBLE_PRESS)) {
+            latched = true;
+            ESP_LOGI(TAG, "Transmit latched");
+        } else if (pressed && latched) {
+            latched = false;
+        }
+        if (pressed && !transmit) {
+            ptt_down_us = input_press_time(&input, BUTTON_PTT);
+            transmit = true;
+            state_bus_set(&state, STATE_TRANSMIT, true);
+            ESP_LOGI(TAG, "Button Pressed");
+        }
+        if ((events & INPUT_EVENT_BIT(BUTTON_PTT, INPUT_RELEASE)) && !latched &&
+            !input_is_pressed(&input, BUTTON_PTT)) {
+            transmit = false;
+            state_bus_set(&state, STATE_TRANSMIT, false);
+            ESP_LOGI(TAG, "Button Released");
+        }
 
-    int last_state = 1;
-    while(1) 
-    {
-        int state = gpio_get_level(BUTTON_GPIO);
-        if(state != last_state)     // Перевірка на зміну стану кнопки
-        {
-            last_state = state;
-            if(state == 0) 
-            {
-                ESP_LOGI(TAG, "Button Pressed");
-                 transmit_data = true; 
-            } 
-            else 
-            {
-                ESP_LOGI(TAG, "Button Released");
-               transmit_data = false; 
+        if (transmit) {
+            // Якщо кільце заповнене, кадр все одно вичитується з I2S і відкидається
+            uint8_t *slot = frame_ring_acquire(&capture_ring);
+            uint8_t *buf = slot ? slot : discard_buf;
+            if (i2s_channel_read(rx_chan, buf, FRAME_SAMPLES * 2, &read_bytes, 1000) == ESP_OK && slot) {
+                frame_ring_commit(&capture_ring, read_bytes);
+                xTaskNotifyGive(udp_send_task_handle);
             }
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS);    // Затримка для запобігання багаторазового натискання кнопки
     }
+
+    free(discard_buf);
 }
 
-// Функція підсилення сигналу
-void amplify_signal(int16_t *buffer, size_t length, float gain) {
-    for (size_t i = 0; i < length; i++) {
-        buffer[i] = (int16_t) fminf(fmaxf(buffer[i] * gain, -32768.0f), 32767.0f);
+static void ptt_latency_record(int64_t latency_us)
+{
+    portENTER_CRITICAL(&ptt_latency.lock);
+    ptt_latency.last_us = latency_us;
+    if (latency_us > ptt_latency.max_us) {
+        ptt_latency.max_us = latency_us;
     }
+    ptt_latency.count++;
+    portEXIT_CRITICAL(&ptt_latency.lock);
 }
 
-// Функція фільтрації сигналу
-void high_pass_filter(int16_t *buffer, size_t length, float alpha) {
-    int16_t prev = buffer[0];
-    for (size_t i = 1; i < length; i++) {
-        int16_t current = buffer[i];
-        buffer[i] = (int16_t) (alpha * (buffer[i] - prev) + prev);
-        prev = current;
+// Задача відправки: обробка кадрів мікрофона. Клієнт кодує їх у свій потік до сервера,
+// сервер передає мікшеру конференції як голос ще одного учасника
+void udp_send_task(void *pvParameters)
+{
+    size_t read_bytes = 0;
+
+    // Фільтр постійної складової мікрофона
+    dsp_dc_blocker_t dc_blocker;
+    dsp_dc_blocker_init(&dc_blocker, SAMPLE_RATE, DC_BLOCK_CUTOFF_HZ);
+
+    // Кадр на частоті кодека обраного профілю
+    int16_t *codec_pcm = (int16_t *)calloc(FRAME_SAMPLES, sizeof(int16_t));
+    assert(codec_pcm);
+
+    // Ключ розгортається один раз; кожна задача має власний контекст
+    crypto_session_t crypto;
+    if (crypto_session_init(&crypto, CRYPTO_MODE, aes_key, AES_KEY_SIZE * 8) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize crypto session");
+        vTaskDelete(NULL);
     }
-}
+    const stream_link_t link = { &transport, &packet_pool, &crypto };
+
+    // Сокет відправки клієнта перепідключається, лише коли виявлення змінює адресу сервера
+    uint32_t connected_addr = 0;
 
-void my_aes_encrypt(uint8_t *input, uint8_t *output, size_t length, uint8_t *key) {
-    mbedtls_aes_context aes;
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_enc(&aes, key, 128);
+    while (1) {
+        // Задача захоплення будить відправку після кожного кадру
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        uint8_t *read_buf;
+        while ((read_buf = frame_ring_peek(&capture_ring, &read_bytes)) != NULL) {
+            int64_t start_us = esp_timer_get_time();
+
+            // Прибираємо постійну складову до підсилення, щоб зсув не з'їдав запас до насичення
+            dsp_dc_blocker_process(&dc_blocker, (int16_t *)read_buf, read_bytes / 2);
+            // Рішення про тишу приймається до АРП, яка в паузах змінює підсилення
+            dtx_action_t action = dtx_process(&dtx, (int16_t *)read_buf, read_bytes / 2);
+            agc_process(&agc, (int16_t *)read_buf, read_bytes / 2);
+            bool sent = false;
+
+            if (role == DISCOVERY_ROLE_SERVER) {
+                // Пауза DTX означає, що ведучий мовчить і не додається до суми
+                uint8_t *slot = action == DTX_SEND ? frame_ring_acquire(&talk_ring) : NULL;
+                if (slot) {
+                    memcpy(slot, read_buf, read_bytes);
+                    frame_ring_commit(&talk_ring, read_bytes);
+                }
+                sent = slot != NULL;
+            } else {
+                // У розмовній групі кадр іде один раз на адресу групи, інакше - серверу.
+                // Доки адреса сервера невідома, адресні кадри не відправляються
+                uint16_t group = state_bus_get(&state, STATE_TALKGROUP);
+                uint32_t server = server_addr;
+                bool reachable = group != PACKET_TALKGROUP_NONE;
+                if (!reachable && server != 0) {
+                    if (server != connected_addr) {
+                        struct sockaddr_in dest_addr = {
+                            .sin_family = AF_INET,
+                            .sin_port = htons(PORT),
+                            .sin_addr.s_addr = server,
+                        };
+                        if (transport_connect(&transport, &dest_addr)) {
+                            connected_addr = server;
+                        }
+                    }
+                    reachable = connected_addr == server;
+                }
+                if (reachable) {
+                    size_t samples = resampler_process(&tx_stream.resampler, (int16_t *)read_buf, read_bytes / 2, codec_pcm, FRAME_SAMPLES);
+                    stream_send_frame(&tx_stream, &link, group != PACKET_TALKGROUP_NONE ? &talkgroup_addr : NULL,
+                                      group, state_bus_get(&state, STATE_ENCRYPTION), codec_pcm, samples, action);
+                    sent = action != DTX_SUPPRESS;
+                }
+            }
+
+            // Перший відданий кадр після натискання закриває вимір затримки кнопки передачі
+            int64_t down_us = ptt_down_us;
+            if (sent && down_us != 0) {
+                ptt_down_us = 0;
+                ptt_latency_record(esp_timer_get_time() - down_us);
+            }
 
-    // Шифрування даних блочним методом ECB
-    for (size_t i = 0; i < length; i += 16) {
-        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, input + i, output + i);
+            frame_ring_release(&capture_ring);
+            rt_timing_record(&send_timing, start_us, esp_timer_get_time());
+        }
     }
 
-    mbedtls_aes_free(&aes);
+    // Звільнення виділеної пам'яті
+    free(codec_pcm);
+    crypto_session_free(&crypto);
 }
 
-void my_aes_decrypt(uint8_t *input, uint8_t *output, size_t length, uint8_t *key) {
-    mbedtls_aes_context aes;
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_dec(&aes, key, 128);
+// Маяк виявлення автентифікується тим самим ключем, що й потоки, і оновлює таблицю
+// пірів. Сервер одразу додає нову станцію до конференції, клієнт оновлює адресу сервера
+static void receive_beacon(crypto_session_t *crypto, const packet_header_t *hdr, uint8_t *buf, int len,
+                           uint32_t addr, int64_t now_us)
+{
+    uint8_t *payload = PACKET_PAYLOAD(buf);
+    bool valid = (hdr->flags & PACKET_FLAG_ENCRYPTED) &&
+                 len >= PACKET_HEADER_SIZE + hdr->payload_len + crypto_tag_size(crypto);
+    if (valid) {
+        uint8_t nonce[PACKET_NONCE_SIZE];
+        packet_nonce(hdr, nonce);
+        valid = crypto_decrypt(crypto, nonce, buf, PACKET_HEADER_SIZE, payload,
+                               payload, hdr->payload_len, payload + hdr->payload_len) == ESP_OK;
+    }
 
-    // Дешифрування даних блочним методом ECB
-    for (size_t i = 0; i < length; i += 16) {
-        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_DECRYPT, input + i, output + i);
+    discovery_result_t result = DISCOVERY_INVALID;
+    uint32_t prev_addr = 0;
+    xSemaphoreTake(discovery_mutex, portMAX_DELAY);
+    if (valid) {
+        result = discovery_update(&discovery, hdr, payload, addr, now_us, &prev_addr);
+        update_server_addr();
+    } else {
+        discovery.stats.rejected++;
+    }
+    xSemaphoreGive(discovery_mutex);
+
+    struct in_addr in = { .s_addr = addr };
+    bool client = valid && payload[0] == DISCOVERY_ROLE_CLIENT;
+    if (result == DISCOVERY_NEW) {
+        ESP_LOGI(TAG, "Discovered %s at %s", client ? "client" : "server", inet_ntoa(in));
+    } else if (result == DISCOVERY_MOVED) {
+        ESP_LOGI(TAG, "Peer moved to %s", inet_ntoa(in));
+    } else if (result == DISCOVERY_FULL) {
+        ESP_LOGW(TAG, "Peer table is full, ignoring %s", inet_ntoa(in));
     }
 
-    mbedtls_aes_free(&aes);
+    // Станція з новою адресою отримує суміш одразу, старий запис звільнить мікшер.
+    // Автентифікований маяк відомої станції продовжує її участь у конференції
+    if (role == DISCOVERY_ROLE_SERVER && client && (result == DISCOVERY_NEW || result == DISCOVERY_MOVED)) {
+        conference_streams_t *streams = conference_streams_alloc(&conference, esp_random());
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        if (result == DISCOVERY_MOVED) {
+            conference_leave_addr(&conference, prev_addr);
+        }
+        conference_peer_t *peer = conference_join(&conference, addr, NULL, &streams, now_us);
+        xSemaphoreGive(stream_mutex);
+        conference_streams_free(streams);
+        if (peer == NULL) {
+            ESP_LOGE(TAG, "Conference is full");
+        }
+    } else if (role == DISCOVERY_ROLE_SERVER && client && result == DISCOVERY_REFRESH) {
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        conference_touch(&conference, addr, now_us);
+        xSemaphoreGive(stream_mutex);
+    }
 }
 
-void udp_send_task(void *pvParameters)
+void udp_receive_task(void *pvParameters)
 {
-    int addr_family = AF_INET;
-    int ip_protocol = IPPROTO_IP;
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(PORT);
-
-    // Виділення пам'яті для буфера даних та шифрованого буфера
-    uint8_t *read_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
-    uint8_t *encrypted_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
-    assert(read_buf); // Перевірка на успішне виділення пам'яті
-    assert(encrypted_buf);
-    size_t read_bytes = 0;
-
-#ifdef IS_SERVER
-    dest_addr.sin_addr.s_addr = inet_addr(CLIENT_IP_ADDR);
-#else
-    dest_addr.sin_addr.s_addr = inet_addr(SERVER_IP_ADDR);
-#endif
+    // Буфер прийому береться з пулу і дешифрується на місці
+    packet_buf_t *pkt = packet_buf_alloc(&packet_pool, 0);
+    int16_t *pcm_buf = (int16_t *)calloc(1, UDP_BUFFER_SIZE);
+    int16_t *play_pcm = (int16_t *)calloc(1, UDP_BUFFER_SIZE);
+    assert(pkt); // Перевірка на успішне виділення пам'яті
+    uint8_t *write_buf = packet_buf_data(pkt);
+    assert(pcm_buf);
+    assert(play_pcm);
+
+    crypto_session_t crypto;
+    crypto_session_t beacon_crypto;
+    if (crypto_session_init(&crypto, CRYPTO_MODE, aes_key, AES_KEY_SIZE * 8) != ESP_OK ||
+        crypto_session_init(&beacon_crypto, BEACON_CRYPTO_MODE, aes_key, AES_KEY_SIZE * 8) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize crypto session");
+        vTaskDelete(NULL);
+    }
 
     while (1) {
-        if (transmit_data) {
-            if (i2s_channel_read(rx_chan, read_buf, UDP_BUFFER_SIZE, &read_bytes, 1000) == ESP_OK) {
-                // Підсилюємо сигнал
-                amplify_signal((int16_t *)read_buf, read_bytes / 2, 10.0f); // Підсилюємо в 10 разів
-
-                // Фільтруємо сигнал
-                //high_pass_filter((int16_t *)read_buf, read_bytes / 2, 0.9f);
-
-                // Шифрування даних, якщо увімкнено шифрування
-               if (encryption_enabled) {
-                    my_aes_encrypt(read_buf, encrypted_buf, read_bytes, aes_key);
-                } else {
-                    memcpy(encrypted_buf, read_buf, read_bytes);
-                }
+        struct sockaddr_in source_addr;
 
-                // Відправка даних по UDP
-                int sock = socket(addr_family, SOCK_DGRAM, ip_protocol);
-                int err = sendto(sock, encrypted_buf, read_bytes, 0, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-                if (err < 0) {
-                    ESP_LOGE(TAG, "Error occurred during sending: errno %d", errno);
+        // Отримання даних по UDP
+        int len = transport_recv(&transport, write_buf, pkt->capacity, &source_addr);
+
+        if (len < 0) {
+            state_bus_set(&state, STATE_RECEIVING, false);
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
+            }
+        } else if (source_addr.sin_addr.s_addr != local_addr) {
+            int64_t now_us = esp_timer_get_time();
+
+            // Перевірка заголовка пакета; маяки виявлення не належать жодному потоку
+            packet_header_t hdr;
+            bool parsed = packet_parse(write_buf, len, &hdr);
+            if (parsed && (hdr.flags & PACKET_FLAG_BEACON)) {
+                receive_beacon(&beacon_crypto, &hdr, write_buf, len, source_addr.sin_addr.s_addr, now_us);
+                continue;
+            }
+
+            // Стан потоку спільний із задачею відтворення (мікшером), а запис піра сервер
+            // може звільнити після відключення станції, тому пакет обробляється під м'ютексом
+            xSemaphoreTake(stream_mutex, portMAX_DELAY);
+            stream_rx_t *rx = &rx_stream;
+            conference_peer_t *peer = NULL;
+            if (role == DISCOVERY_ROLE_SERVER) {
+                // Потік шукається за адресою відправника. Невідомі станції відкидаються:
+                // до конференції додають лише асоціація з точкою доступу та маяк виявлення
+                peer = conference_find(&conference, source_addr.sin_addr.s_addr);
+                rx = peer ? &peer->rx : NULL;
+            }
+            if (rx && !parsed) {
+                rx->stats.invalid++;
+            } else if (rx) {
+                // Умови прийому беруться з поточного стану: група і перемикач шифрування змінюються кнопкою
+                const stream_rx_config_t cfg = {
+                    .crypto = &crypto,
+                    .filters = rx_filters,
+                    .talkgroup = state_bus_get(&state, STATE_TALKGROUP),
+                    .accept_direct = role == DISCOVERY_ROLE_SERVER,
+                    .require_encryption = state_bus_get(&state, STATE_ENCRYPTION),
+                    .frame_samples = FRAME_SAMPLES,
+                    .pcm = pcm_buf,
+                    .play_pcm = play_pcm,
+                };
+                int32_t level;
+                stream_rx_result_t result = stream_receive_packet(rx, &cfg, &hdr, write_buf, len, now_us, &level);
+                if (result != STREAM_RX_DROPPED && peer) {
+                    peer->last_us = now_us;
+                }
+                // Шина будить інтерфейс лише на першому пакеті після паузи
+                if (result == STREAM_RX_AUDIO || result == STREAM_RX_SID) {
+                    state_bus_set(&state, STATE_RECEIVING, true);
+                }
+                // Мікшер сервера комфортний шум не додає
+                if (result == STREAM_RX_SID && role == DISCOVERY_ROLE_CLIENT) {
+                    cng_update(&comfort_noise, level);
                 }
-                close(sock);
             }
-        } 
-        vTaskDelay(10 / portTICK_PERIOD_MS);        // Для запобігання watch dog
+            xSemaphoreGive(stream_mutex);
+            rt_timing_record(&receive_timing, now_us, esp_timer_get_time());
+        }
     }
 
     // Звільнення виділеної пам'яті
-    free(read_buf);
-    free(encrypted_buf);
+    packet_buf_release(pkt);
+    free(pcm_buf);
+    free(play_pcm);
+    crypto_session_free(&crypto);
+    crypto_session_free(&beacon_crypto);
 }
 
-void udp_receive_task(void *pvParameters)
+// Мікшер конференції в темпі I2S: забирає по кадру з джитер-буфера кожного піра та
+// кадр мікрофона сервера, відтворює суму всіх пірів, а кожному піру відправляє
+// суму без його власного голосу (mix-minus). Пір, що говорить у розмовній групі,
+// чує групу напряму, тож суму отримують лише станції в адресному режимі; мікрофон
+// сервера в розмовній групі відправляється групі одним потоком
+void mixer_task(void *pvParameters)
 {
-    int addr_family = AF_INET;
-    int ip_protocol = IPPROTO_IP;
-    struct sockaddr_in source_addr;
-    source_addr.sin_family = AF_INET;
-    source_addr.sin_port = htons(PORT);
-    source_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-
-    // Створення UDP сокету
-    int sock = socket(addr_family, SOCK_DGRAM, ip_protocol);
-    bind(sock, (struct sockaddr *)&source_addr, sizeof(source_addr));
-
-    // Налаштування таймауту для recvfrom
-    struct timeval timeout;
-    timeout.tv_sec = 0; // 0 секунд
-    timeout.tv_usec = 100000; // 100 мілісекунд
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
-    // Виділення пам'яті для буфера даних та дешифрованого буфера
-    uint8_t *write_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
-    uint8_t *decrypted_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
-    assert(write_buf); // Перевірка на успішне виділення пам'яті
-    assert(decrypted_buf);
-    size_t write_bytes = 0;     
-
-    TickType_t last_receive_time = xTaskGetTickCount(); // Час останнього отримання даних
-    const TickType_t timeout_ticks = pdMS_TO_TICKS(100); // 100 мілісекунд таймаут
+    int16_t *play_buf = (int16_t *)calloc(FRAME_SAMPLES, sizeof(int16_t));
+    int16_t *mix_buf = (int16_t *)calloc(FRAME_SAMPLES, sizeof(int16_t));
+    int16_t *codec_pcm = (int16_t *)calloc(FRAME_SAMPLES, sizeof(int16_t));
+    assert(play_buf && mix_buf && codec_pcm);
+    size_t write_bytes = 0;
+    bool active[CONF_MAX_PEERS];
+
+    crypto_session_t crypto;
+    if (crypto_session_init(&crypto, CRYPTO_MODE, aes_key, AES_KEY_SIZE * 8) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize crypto session");
+        vTaskDelete(NULL);
+    }
+    const stream_link_t link = { &transport, &packet_pool, &crypto };
 
     while (1) {
-        ESP_LOGI(TAG, "Receiving");
-
-        struct sockaddr_in dest_addr;
-        socklen_t socklen = sizeof(dest_addr);
+        int64_t start_us = esp_timer_get_time();
+        mixer_begin(&mixer);
+
+        // Під м'ютексом лише звільнення відключених пірів і вибірка кадрів;
+        // потоки передачі пірів використовує тільки ця задача
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        conference_collect(&conference);
+        for (int i = 0; i < CONF_MAX_PEERS; i++) {
+            conference_peer_t *peer = &conference.peers[i];
+            active[i] = peer->used && !peer->closing;
+            peer->talking = false;
+            size_t bytes = 0;
+            if (active[i] && jitter_buffer_pop(&peer->rx.jb, (uint8_t *)peer->input, &bytes) == JB_FRAME) {
+                memset((uint8_t *)peer->input + bytes, 0, UDP_BUFFER_SIZE - bytes);
+                mixer_add(&mixer, peer->input, FRAME_SAMPLES);
+                peer->talking = true;
+            }
+        }
+        xSemaphoreGive(stream_mutex);
+
+        // Мікрофон сервера - ще один учасник, у власний динамік він не потрапляє
+        size_t talk_bytes = 0;
+        int16_t *talk = (int16_t *)frame_ring_peek(&talk_ring, &talk_bytes);
+        if (talk) {
+            memset((uint8_t *)talk + talk_bytes, 0, UDP_BUFFER_SIZE - talk_bytes);
+            mixer_add(&mixer, talk, FRAME_SAMPLES);
+        }
+        mixer_output(&mixer, talk, play_buf);
 
-        // Отримання даних по UDP   
-        int len = recvfrom(sock, write_buf, UDP_BUFFER_SIZE, 0, (struct sockaddr *)&dest_addr, &socklen);
+        uint16_t group = state_bus_get(&state, STATE_TALKGROUP);
+        bool encrypted = state_bus_get(&state, STATE_ENCRYPTION);
+        if (talk && group != PACKET_TALKGROUP_NONE) {
+            size_t samples = resampler_process(&group_stream.resampler, talk, FRAME_SAMPLES, codec_pcm, FRAME_SAMPLES);
+            stream_send_frame(&group_stream, &link, &talkgroup_addr, group, encrypted, codec_pcm, samples, DTX_SEND);
+        }
 
-        if (len < 0) {
-            receiving_data = false;
-            if (errno == EWOULDBLOCK || errno == EAGAIN) {
-                // Таймаут recvfrom, продовжуємо цикл
-                if (xTaskGetTickCount() - last_receive_time > timeout_ticks) {
-                    memset(write_buf, 0, UDP_BUFFER_SIZE); // Очищення буфера звуку при таймауті
-                    for (int i = 0; i < 5; i++) {
-                        if (i2s_channel_write(tx_chan, write_buf, UDP_BUFFER_SIZE, &write_bytes, 1000) != ESP_OK) {
-                            ESP_LOGE(TAG, "i2s write failed");
-                            break; // Виходимо з циклу, якщо запис не вдається
-                        }
-                    }
-                    last_receive_time = xTaskGetTickCount(); // Оновлюємо час останнього очищення буфера
-                }
-            } else {
-                ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
+        // Пір отримує кадр, лише якщо в сумі є хтось, крім нього самого
+        for (int i = 0; i < CONF_MAX_PEERS; i++) {
+            conference_peer_t *peer = &conference.peers[i];
+            if (!active[i] || peer->rx.talkgroup != PACKET_TALKGROUP_NONE ||
+                mixer.inputs == (peer->talking ? 1 : 0)) {
+                continue;
             }
-        } else {
-            last_receive_time = xTaskGetTickCount(); // Оновлюємо час останнього отримання даних
+            mixer_output(&mixer, peer->talking ? peer->input : NULL, mix_buf);
+            size_t samples = resampler_process(&peer->tx.resampler, mix_buf, FRAME_SAMPLES, codec_pcm, FRAME_SAMPLES);
+            struct sockaddr_in dest = {
+                .sin_family = AF_INET,
+                .sin_port = htons(PORT),
+                .sin_addr.s_addr = peer->addr,
+            };
+            stream_send_frame(&peer->tx, &link, &dest, PACKET_TALKGROUP_NONE, encrypted, codec_pcm, samples, DTX_SEND);
+        }
+        if (talk) {
+            frame_ring_release(&talk_ring);
+        }
+        rt_timing_record(&playout_timing, start_us, esp_timer_get_time());
 
-            // Дешифрування даних, якщо увімкнено шифрування
-            if (encryption_enabled) {
-                my_aes_decrypt(write_buf, decrypted_buf, len, aes_key);
-            } else {
-                memcpy(decrypted_buf, write_buf, len);
-            }
+        // Блокуючий запис задає темп мікшера частотою I2S
+        if (i2s_channel_write(tx_chan, play_buf, UDP_BUFFER_SIZE, &write_bytes, 1000) != ESP_OK) {
+            ESP_LOGE(TAG, "i2s write failed");
+        }
+    }
 
-            receiving_data = true;
+    free(play_buf);
+    free(mix_buf);
+    free(codec_pcm);
+    crypto_session_free(&crypto);
+}
 
-            // Запис даних у I2S канал
-            if (i2s_channel_write(tx_chan, decrypted_buf, len, &write_bytes, 1000) != ESP_OK) {
-                ESP_LOGE(TAG, "i2s write failed");
+// Задача відтворення: забирає кадри з джитер-буфера у темпі I2S
+void playout_task(void *pvParameters)
+{
+    uint8_t *play_buf = (uint8_t *)calloc(1, UDP_BUFFER_SIZE);
+    assert(play_buf);
+    size_t play_bytes = 0;
+    size_t write_bytes = 0;
+
+    while (1) {
+        int64_t start_us = esp_timer_get_time();
+
+        xSemaphoreTake(stream_mutex, portMAX_DELAY);
+        jb_status_t status = jitter_buffer_pop(&rx_stream.jb, play_buf, &play_bytes);
+        bool comfort = status != JB_FRAME && comfort_noise.active;
+        if (status == JB_FRAME) {
+            // Мова відновилась, комфортний шум вимикається до наступного SID
+            comfort_noise.active = false;
+        } else if (comfort) {
+            // Пауза у переривчастій передачі: заповнюємо її шумом рівня з SID
+            cng_generate(&comfort_noise, (int16_t *)play_buf, FRAME_SAMPLES);
+            play_bytes = UDP_BUFFER_SIZE;
+        }
+        xSemaphoreGive(stream_mutex);
+
+        if (status == JB_FRAME) {
+            // Після втрат початок кадру зшивається з маскуванням, щоб не було клацання
+            plc_good_frame(&plc, (int16_t *)play_buf, play_bytes / 2);
+        } else if (!comfort && status != JB_BUFFERING && plc_can_conceal(&plc)) {
+            // Втрачений кадр чи спустошення під час мови: повторюємо період основного тону із згасанням
+            plc_conceal(&plc, (int16_t *)play_buf, FRAME_SAMPLES);
+            play_bytes = UDP_BUFFER_SIZE;
+        } else if (!comfort) {
+            // Заповнення буфера або тривала втрата - відтворюємо тишу, щоб годинник I2S не зупинявся
+            memset(play_buf, 0, UDP_BUFFER_SIZE);
+            play_bytes = UDP_BUFFER_SIZE;
+        }
+        rt_timing_record(&playout_timing, start_us, esp_timer_get_time());
+
+        // Блокуючий запис задає темп відтворення частотою I2S
+        if (i2s_channel_write(tx_chan, play_buf, play_bytes, &write_bytes, 1000) != ESP_OK) {
+            ESP_LOGE(TAG, "i2s write failed");
+        }
+    }
+
+    free(play_buf);
+}
+
+// Вихід звуку за роллю: сервер мікшує конференцію, клієнт відтворює свій потік
+void audio_out_task(void *pvParameters)
+{
+    if (role == DISCOVERY_ROLE_SERVER) {
+        mixer_task(pvParameters);
+    } else {
+        playout_task(pvParameters);
+    }
+}
+
+// Задача виявлення: періодично оголошує пристрій на адресі розмовних груп і вилучає
+// пірів, від яких давно не було маяка. Сервер закриває потоки втраченої станції
+void discovery_task(void *pvParameters)
+{
+    crypto_session_t crypto;
+    if (crypto_session_init(&crypto, BEACON_CRYPTO_MODE, aes_key, AES_KEY_SIZE * 8) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize crypto session");
+        vTaskDelete(NULL);
+    }
+    const stream_link_t link = { &transport, &packet_pool, &crypto };
+    discovery_peer_t expired[DISCOVERY_MAX_PEERS];
+
+    while (1) {
+        // Маяк шифрується завжди, незалежно від перемикача шифрування звуку
+        packet_buf_t *pkt = packet_buf_alloc(&packet_pool, PACKET_HEADER_SIZE);
+        if (pkt) {
+            packet_header_t hdr;
+            xSemaphoreTake(discovery_mutex, portMAX_DELAY);
+            size_t len = discovery_write_beacon(&discovery, &hdr, packet_buf_data(pkt));
+            xSemaphoreGive(discovery_mutex);
+            packet_buf_put(pkt, len);
+            stream_send_packet(&link, pkt, &hdr, &talkgroup_addr);
+        }
+
+        xSemaphoreTake(discovery_mutex, portMAX_DELAY);
+        size_t count = discovery_expire(&discovery, esp_timer_get_time(), expired, DISCOVERY_MAX_PEERS);
+        if (count > 0) {
+            update_server_addr();
+        }
+        xSemaphoreGive(discovery_mutex);
+
+        for (size_t i = 0; i < count; i++) {
+            struct in_addr addr = { .s_addr = expired[i].addr };
+            ESP_LOGW(TAG, "Lost %s at %s", expired[i].role == DISCOVERY_ROLE_SERVER ? "server" : "client", inet_ntoa(addr));
+            if (role == DISCOVERY_ROLE_SERVER) {
+                xSemaphoreTake(stream_mutex, portMAX_DELAY);
+                conference_leave_addr(&conference, expired[i].addr);
+                xSemaphoreGive(stream_mutex);
             }
         }
+
+        // Станції, що асоціювалися, але не надсилають автентифікованого трафіку
+        if (role == DISCOVERY_ROLE_SERVER) {
+            xSemaphoreTake(stream_mutex, portMAX_DELAY);
+            size_t idle = conference_expire(&conference, esp_timer_get_time());
+            xSemaphoreGive(stream_mutex);
+            if (idle > 0) {
+                ESP_LOGW(TAG, "Dropped %u idle conference peers", (unsigned)idle);
+            }
+        }
+
+        vTaskDelay(DISCOVERY_INTERVAL_MS / portTICK_PERIOD_MS);
     }
 
-    // Звільнення виділеної пам'яті
-    free(write_buf);
-    free(decrypted_buf);
+    crypto_session_free(&crypto);
 }
 
-// Конфігурація I2S каналу для приймання (RX) даних
 void microphone_init(void)  
 {
     i2s_chan_config_t rx_chan_cfg  = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_RX, I2S_ROLE_MASTER);
@@ -503,6 +999,10 @@ void speaker_init(void)
     ESP_ERROR_CHECK(i2s_channel_enable(tx_chan));
 }
 
+#if FONTX_EMBED_ILGH16XB
+extern const FontxFont fontx_ILGH16XB;
+#endif
+
 // Функція для відображення тексту на дисплеї
 void DrawText(TFT_t * dev, FontxFile *fx, int width, int height, const char* text1, const char* text2, const char* text3, const char* text4, uint16_t bgColor, uint16_t textColor) {
     uint16_t xpos1, ypos1, xpos2, ypos2, xpos3, ypos3, xpos4, ypos4;
@@ -537,8 +1037,10 @@ void DrawText(TFT_t * dev, FontxFile *fx, int width, int height, const char* tex
     xpos4 = (width - (strlen((char *)ascii4) * fontWidth)) / 2;
     ypos4 = (height / 2) + fontHeight * 3;
 
-    // Встановлюємо напрямок шрифту та колір
+    // Встановлюємо напрямок шрифту та колір. Заливка кольором фону не змінює
+    // зображення, але робить клітинку символу суцільною, і вона йде одним пакетом SPI
     lcdSetFontDirection(dev, DIRECTION0);
+    lcdSetFontFill(dev, bgColor);
     lcdDrawString(dev, fx, xpos1, ypos1, ascii1, textColor);
     lcdDrawString(dev, fx, xpos2, ypos2, ascii2, textColor);
     if (strlen((char *)ascii3) > 0) {
@@ -547,89 +1049,300 @@ void DrawText(TFT_t * dev, FontxFile *fx, int width, int height, const char* tex
     if (strlen((char *)ascii4) > 0) {
         lcdDrawString(dev, fx, xpos4, ypos4, ascii4, textColor);
     }
-    lcdDrawFinish(dev);
+    // Кадровий буфер відправляється через DMA у фоні, задача інтерфейсу одразу
+    // повертається до очікування подій
+    lcdDrawFinishAsync(dev);
 }
 
 // Функція для управління дисплеєм ST7789
 void ST7789(void *pvParameters)
 {
-    // Ініціалізація файлу шрифту
+    // Ініціалізація шрифту: вбудований у прошивку, якщо ILGH16XB.FNT лежить у
+    // components/st7789/fonts під час збірки, інакше - файл на SPIFFS
     FontxFile fx16G[2];
+#if FONTX_EMBED_ILGH16XB
+    InitFontxEmbedded(fx16G, &fontx_ILGH16XB); // 8x16Dot Gothic
+#else
     InitFontx(fx16G,"/spiffs/ILGH16XB.FNT",""); // 8x16Dot Gothic
+#endif
 
     TFT_t dev;
 
     // Ініціалізація дисплея
     spi_master_init(&dev, CONFIG_MOSI_GPIO, CONFIG_SCLK_GPIO, CONFIG_CS_GPIO, CONFIG_DC_GPIO, CONFIG_RESET_GPIO, CONFIG_BL_GPIO);
     lcdInit(&dev, CONFIG_WIDTH, CONFIG_HEIGHT, CONFIG_OFFSETX, CONFIG_OFFSETY);
-
-    esp_rom_gpio_pad_select_gpio(BUTTON_GPIO);
-    gpio_set_direction(BUTTON_GPIO, GPIO_MODE_INPUT);
-    gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLUP_ONLY);
+    // Задача передачі кадру на дисплей - на ядрі інтерфейсу, поза аудіоядром
+    lcdSetFlushCore(&dev, RT_CORE_NETWORK);
 
     char encryption_status[24];
+    char role_text[24];
+    const char *role_name = role == DISCOVERY_ROLE_SERVER ? "SERVER" : "CLIENT";
     
-    bool last_transmit_state = false;
-    bool last_receive_state = false;
-    bool last_encryption_state = encryption_enabled;
-
-    // Стартове оновлення дисплея
-    snprintf(encryption_status, sizeof(encryption_status), "Encryption: %s", encryption_enabled ? "ON" : "OFF");
-#ifdef IS_SERVER
-    DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "SERVER", "", encryption_status, BLUE, WHITE);
-#else
-    DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "CLIENT", "", encryption_status, BLUE, WHITE);
-#endif
+    // Останній намальований стан; перше перемальовування відбувається безумовно
+    state_value_t shown[STATE_COUNT];
+    bool drawn = false;
 
     while (1) {
-        bool update_display = false;
+        state_value_t now[STATE_COUNT];
+        state_bus_snapshot(&state, now);
 
-        // Перевірка на зміну станів передавання/прийому/шифрування
-        if (transmit_data != last_transmit_state) {
-            last_transmit_state = transmit_data;
-            update_display = true;
+        bool update_display = !drawn;
+        for (int i = 0; i < STATE_COUNT; i++) {
+            update_display = update_display || now[i].value != shown[i].value;
         }
 
-        if (receiving_data != last_receive_state) {
-            last_receive_state = receiving_data;
-            update_display = true;
+        // Оновлення дисплея, якщо змінився якийсь стан. Стан, що встиг змінитися й
+        // повернутися до пробудження, перемальовування не потребує
+        if (update_display) {
+            memcpy(shown, now, sizeof(shown));
+            drawn = true;
+
+            bool transmit = now[STATE_TRANSMIT].value;
+            bool receiving = now[STATE_RECEIVING].value;
+            uint16_t group = now[STATE_TALKGROUP].value;
+            snprintf(encryption_status, sizeof(encryption_status), "Encryption: %s", now[STATE_ENCRYPTION].value ? "ON" : "OFF");
+            // Роль із номером розмовної групи, наприклад "CLIENT TG2"
+            if (group != PACKET_TALKGROUP_NONE) {
+                snprintf(role_text, sizeof(role_text), "%s TG%u", role_name, group);
+            } else {
+                snprintf(role_text, sizeof(role_text), "%s", role_name);
+            }
+
+            if (transmit && receiving) { // Повний дуплекс
+                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", role_text, "Full-Duplex", encryption_status, PURPLE, WHITE);
+            } else if (transmit) { // Передача даних
+                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", role_text, "Transmitting", encryption_status, RED, WHITE);
+            } else if (receiving) { // Прийом даних
+                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", role_text, "Receiving", encryption_status, GREEN, WHITE);
+            } else { // Бездіяльність
+                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", role_text, "", encryption_status, BLUE, WHITE);
+            }
         }
 
-        if (encryption_enabled != last_encryption_state) {
-            last_encryption_state = encryption_enabled;
-            update_display = true;
+        // Задача спить до події кнопки шифрування або зміни стану на шині
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+        if (events & INPUT_EVENT_BIT(BUTTON_ENCRYPTION, INPUT_CLICK)) {
+            bool encryption = !state_bus_get(&state, STATE_ENCRYPTION);
+            state_bus_set(&state, STATE_ENCRYPTION, encryption);
+            ESP_LOGI(TAG, "Encryption %s", encryption ? "enabled" : "disabled");
         }
+        if (events & INPUT_EVENT_BIT(BUTTON_ENCRYPTION, INPUT_LONG_PRESS)) {
+            // Утримання: наступна розмовна група, після останньої - адресний режим
+            uint16_t group = (state_bus_get(&state, STATE_TALKGROUP) + 1) % TALKGROUP_COUNT;
+            state_bus_set(&state, STATE_TALKGROUP, group);
+            if (group == PACKET_TALKGROUP_NONE) {
+                ESP_LOGI(TAG, "Talkgroup off, unicast mode");
+            } else {
+                ESP_LOGI(TAG, "Talkgroup %u", group);
+            }
+        }
+    }
+}
 
-        snprintf(encryption_status, sizeof(encryption_status), "Encryption: %s", encryption_enabled ? "ON" : "OFF");
+void stats_task(void *pvParameters);
 
-        // Оновлення дисплея, якщо змінився якийсь стан
-        if (update_display) {
-#ifdef IS_SERVER
-            if (transmit_data && receiving_data) { // Повний дуплекс
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "SERVER", "Full-Duplex", encryption_status, PURPLE, WHITE);
-            } else if (transmit_data) { // Передача даних
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "SERVER", "Transmitting", encryption_status, RED, WHITE);
-            } else if (receiving_data) { // Прийом даних
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "SERVER", "Receiving", encryption_status, GREEN, WHITE);
-            } else { // Бездіяльність
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "SERVER", "", encryption_status, BLUE, WHITE);
+// Задача служби кнопок: прокидається лише від переривань GPIO та термінів антибрязкоту
+void input_task(void *pvParameters)
+{
+    input_run(&input);
+}
+
+// Розкладка задач: звук на окремому ядрі з пріоритетом вище за решту застосунку,
+// мережа та інтерфейс - на ядрі Wi-Fi/lwIP (пріоритети 18-23 у цих системних задач).
+// Відправка створюється перед захопленням, бо захоплення будить її за дескриптором
+static const rt_task_t app_tasks[] = {
+    { udp_send_task, "udp_send_task", 4096, 20, RT_CORE_AUDIO, true, &udp_send_task_handle, &send_timing },
+    { capture_task, "capture_task", 3072, 22, RT_CORE_AUDIO, true, &capture_task_handle, NULL },
+    { audio_out_task, "audio_out_task", 6144, 22, RT_CORE_AUDIO, true, NULL, &playout_timing },
+    { udp_receive_task, "udp_receive_task", 4096, 10, RT_CORE_NETWORK, false, NULL, &receive_timing },
+    { discovery_task, "discovery_task", 3072, 5, RT_CORE_NETWORK, false, NULL, NULL },
+    { input_task, "input_task", 2560, 15, RT_CORE_NETWORK, false, NULL, NULL },
+    { ST7789, "ST7789", 4096, 2, RT_CORE_NETWORK, false, &display_task_handle, NULL },
+    { stats_task, "stats_task", 3072, 1, RT_CORE_NETWORK, false, NULL, NULL },
+};
+
+#define APP_TASK_COUNT (sizeof(app_tasks) / sizeof(app_tasks[0]))
+
+// Звіт пари потоків: джитер-буфер, втрати на лінії, FEC та відкинуті пакети
+static void log_stream_stats(const char *name, const stream_stats_t *stats)
+{
+    const jb_stats_t *jb = &stats->jb;
+    const packet_rx_stats_t *link = &stats->link;
+    ESP_LOGI(TAG, "%s jitter buffer: depth %u/%u, jitter %" PRIu32 " us, late %" PRIu32 ", lost %" PRIu32 ", underruns %" PRIu32,
+             name, jb->depth, jb->target_depth, jb->jitter_us, jb->late_drops, jb->lost, jb->underruns);
+    ESP_LOGI(TAG, "%s link: received %" PRIu32 ", expected %" PRIu32 ", lost %" PRIu32 ", reordered %" PRIu32,
+             name, link->received, packet_rx_stats_expected(link), packet_rx_stats_lost(link), link->reordered);
+    ESP_LOGI(TAG, "%s FEC: group %d, overhead %" PRIu32 "%%, parity rx %" PRIu32 ", recovered %" PRIu32 ", unrecoverable %" PRIu32,
+             name, FEC_GROUP,
+             stats->fec_tx.data_bytes ? (uint32_t)((uint64_t)stats->fec_tx.parity_bytes * 100 / stats->fec_tx.data_bytes) : 0,
+             stats->fec_rx.parity, stats->fec_rx.recovered, stats->fec_rx.unrecoverable);
+    ESP_LOGI(TAG, "%s drops: invalid %" PRIu32 ", replayed %" PRIu32 ", auth failed %" PRIu32 ", other talkgroup %" PRIu32 ", other talker %" PRIu32,
+             name, link->invalid, link->replayed, link->auth_failed, link->other_group, link->other_talker);
+    // Кадр, що не вмістився в буфер перетворювача, - помилка розмірів, а не мережі
+    const resampler_stats_t *rs_rx = &stats->resampler_rx;
+    const resampler_stats_t *rs_tx = &stats->resampler_tx;
+    if (rs_rx->truncated || rs_rx->overflowed || rs_tx->truncated || rs_tx->overflowed) {
+        ESP_LOGW(TAG, "%s resampler: rx truncated %" PRIu32 ", overflowed %" PRIu32 ", tx truncated %" PRIu32 ", overflowed %" PRIu32,
+                 name, rs_rx->truncated, rs_rx->overflowed, rs_tx->truncated, rs_tx->overflowed);
+    }
+}
+
+// Задача статистики на мережевому ядрі, щоб вивід логів не забирав час аудіозадач
+void stats_task(void *pvParameters)
+{
+    while (1) {
+        vTaskDelay(STATS_INTERVAL_MS / portTICK_PERIOD_MS);
+
+        if (role == DISCOVERY_ROLE_SERVER) {
+            // Знімок під м'ютексом, вивід логів - без нього
+            stream_stats_t peer_stats[CONF_MAX_PEERS];
+            uint32_t peer_addr[CONF_MAX_PEERS];
+            int peers = 0;
+            xSemaphoreTake(stream_mutex, portMAX_DELAY);
+            for (int i = 0; i < CONF_MAX_PEERS; i++) {
+                conference_peer_t *peer = &conference.peers[i];
+                if (peer->used && !peer->closing) {
+                    stream_get_stats(&peer->rx, &peer->tx, &peer_stats[peers]);
+                    peer_addr[peers++] = peer->addr;
+                }
             }
-#else
-            if (transmit_data && receiving_data) { // Повний дуплекс    
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "CLIENT", "Full-Duplex", encryption_status, PURPLE, WHITE);
-            } else if (transmit_data) { // Передача даних
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "CLIENT", "Transmitting", encryption_status, RED, WHITE);
-            } else if (receiving_data) { // Прийом даних
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "CLIENT", "Receiving", encryption_status, GREEN, WHITE);
-            } else { // Бездіяльність
-                DrawText(&dev, fx16G, CONFIG_WIDTH, CONFIG_HEIGHT, "Walkie-Talkie", "CLIENT", "", encryption_status, BLUE, WHITE);
+            xSemaphoreGive(stream_mutex);
+            ESP_LOGI(TAG, "Conference: %d/%d peers", peers, CONF_MAX_PEERS);
+            for (int i = 0; i < peers; i++) {
+                struct in_addr addr = { .s_addr = peer_addr[i] };
+                log_stream_stats(inet_ntoa(addr), &peer_stats[i]);
             }
-#endif
+        } else {
+            stream_stats_t stream_stats;
+            xSemaphoreTake(stream_mutex, portMAX_DELAY);
+            stream_get_stats(&rx_stream, &tx_stream, &stream_stats);
+            xSemaphoreGive(stream_mutex);
+            log_stream_stats("Stream", &stream_stats);
         }
+        discovery_stats_t discovery_stats;
+        xSemaphoreTake(discovery_mutex, portMAX_DELAY);
+        uint16_t discovered = discovery_count(&discovery);
+        discovery_get_stats(&discovery, &discovery_stats);
+        xSemaphoreGive(discovery_mutex);
+        struct in_addr server = { .s_addr = server_addr };
+        ESP_LOGI(TAG, "Discovery: %u peers, server %s, beacons %" PRIu32 ", rejected %" PRIu32 ", joined %" PRIu32 ", moved %" PRIu32 ", expired %" PRIu32,
+                 discovered, role == DISCOVERY_ROLE_SERVER ? "self" : inet_ntoa(server), discovery_stats.beacons,
+                 discovery_stats.rejected, discovery_stats.joined, discovery_stats.moved, discovery_stats.expired);
+        transport_log_stats(&transport);
+        frame_ring_stats_t ring_stats;
+        frame_ring_get_stats(&capture_ring, &ring_stats);
+        ESP_LOGI(TAG, "Capture ring: %u/%u frames (max %u), pushed %" PRIu32 ", overruns %" PRIu32,
+                 ring_stats.count, CAPTURE_RING_SLOTS, ring_stats.max_count, ring_stats.pushed, ring_stats.overruns);
+        packet_pool_stats_t pool_stats;
+        packet_pool_get_stats(&packet_pool, &pool_stats);
+        ESP_LOGI(TAG, "Packet pool: %u/%u free (min %u), allocs %" PRIu32 ", exhausted %" PRIu32,
+                 pool_stats.available, PACKET_POOL_BUFFERS, pool_stats.min_available, pool_stats.allocs, pool_stats.exhausted);
+        agc_stats_t agc_stats;
+        agc_get_stats(&agc, &agc_stats);
+        ESP_LOGI(TAG, "AGC: gain %" PRId32 ".%02" PRId32 ", limiter %" PRId32 ".%02" PRId32 ", level %" PRId32 "%s",
+                 agc_stats.gain_q15 >> 15, ((agc_stats.gain_q15 & 0x7FFF) * 100) >> 15,
+                 agc_stats.limiter_gain_q15 >> 15, ((agc_stats.limiter_gain_q15 & 0x7FFF) * 100) >> 15,
+                 agc_stats.level, agc_stats.gated ? ", gated" : "");
+        if (role == DISCOVERY_ROLE_CLIENT) {
+            plc_stats_t plc_stats;
+            plc_get_stats(&plc, &plc_stats);
+            ESP_LOGI(TAG, "PLC: concealed %" PRIu32 " frames in %" PRIu32 " bursts, pitch %u samples",
+                     plc_stats.concealed, plc_stats.bursts, plc_stats.pitch);
+        }
+        dtx_stats_t dtx_stats;
+        dtx_get_stats(&dtx, &dtx_stats);
+        ESP_LOGI(TAG, "DTX: frames %" PRIu32 ", speech %" PRIu32 ", SID %" PRIu32 ", suppressed %" PRIu32 " (%" PRIu32 "%%)",
+                 dtx_stats.frames, dtx_stats.speech, dtx_stats.sid, dtx_stats.suppressed,
+                 dtx_stats.frames ? (uint32_t)((uint64_t)dtx_stats.suppressed * 100 / dtx_stats.frames) : 0);
+        input_stats_t input_stats;
+        input_get_stats(&input, &input_stats);
+        portENTER_CRITICAL(&ptt_latency.lock);
+        ptt_latency_t latency = ptt_latency;
+        portEXIT_CRITICAL(&ptt_latency.lock);
+        ESP_LOGI(TAG, "PTT latency: last %" PRId64 " us, max %" PRId64 " us over %" PRIu32 " presses; buttons: edges %" PRIu32 ", bounces %" PRIu32 ", events %" PRIu32 "; state changes %" PRIu32,
+                 latency.last_us, latency.max_us, latency.count, input_stats.edges, input_stats.bounces, input_stats.events,
+                 state_bus_changes(&state));
+        rt_sched_report(app_tasks, APP_TASK_COUNT);
+    }
+}
 
-        // Перевірка станів кожні 200 мс
-        vTaskDelay(200 / portTICK_PERIOD_MS);
+// Фільтри для частоти профілю передачі та для прийому з кожної частоти
+static bool resampler_filters_init(packet_rate_t tx_rate)
+{
+    if (!resampler_filter_init(&tx_filter, SAMPLE_RATE, packet_rate_hz(tx_rate))) {
+        return false;
     }
+    for (int rate = 0; rate < PACKET_RATE_COUNT; rate++) {
+        if (!resampler_filter_init(&rx_filters[rate], packet_rate_hz(rate), SAMPLE_RATE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Роль з NVS; кнопка передачі, утримана під час запуску, перемикає роль і зберігає її
+static discovery_role_t load_role(void)
+{
+    discovery_role_t loaded = DEFAULT_ROLE;
+    nvs_handle_t nvs;
+    if (nvs_open(ROLE_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS, using default role");
+        return loaded;
+    }
+
+    uint8_t value;
+    if (nvs_get_u8(nvs, ROLE_NVS_KEY, &value) == ESP_OK &&
+        (value == DISCOVERY_ROLE_SERVER || value == DISCOVERY_ROLE_CLIENT)) {
+        loaded = (discovery_role_t)value;
+    }
+
+    esp_rom_gpio_pad_select_gpio(BUTTON_GPIO);
+    gpio_set_direction(BUTTON_GPIO, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLUP_ONLY);
+    if (gpio_get_level(BUTTON_GPIO) == 0) {
+        loaded = loaded == DISCOVERY_ROLE_SERVER ? DISCOVERY_ROLE_CLIENT : DISCOVERY_ROLE_SERVER;
+        if (nvs_set_u8(nvs, ROLE_NVS_KEY, loaded) != ESP_OK || nvs_commit(nvs) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to save role");
+        }
+        ESP_LOGI(TAG, "Role switched by button");
+    }
+    nvs_close(nvs);
+    return loaded;
+}
+
+// Епоха маяків виявлення: лічильник запусків у NVS, щоб маяки попереднього запуску
+// не можна було повторити. Зберігається до першого маяка цього запуску
+static uint16_t load_epoch(void)
+{
+    nvs_handle_t nvs;
+    uint16_t epoch = 0;
+    if (nvs_open(ROLE_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        // Перший запуск: ключа ще немає, епоха починається з 1
+        esp_err_t err = nvs_get_u16(nvs, EPOCH_NVS_KEY, &epoch);
+        if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+            epoch++;
+            err = nvs_set_u16(nvs, EPOCH_NVS_KEY, epoch);
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+        if (err == ESP_OK) {
+            return epoch;
+        }
+    }
+    // Без NVS епоха випадкова: піри, що пам'ятають більшу, приймуть вузол після перезапуску
+    ESP_LOGE(TAG, "Failed to save discovery epoch, using a random one");
+    return esp_random() & 0xFFFF;
+}
+
+// Постійний ідентифікатор вузла з молодших байтів заводської MAC-адреси
+static uint32_t node_id(void)
+{
+    uint8_t mac[6];
+    ESP_ERROR_CHECK(esp_read_mac(mac, ESP_MAC_WIFI_STA));
+    return ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5];
 }
 
 void app_main(void)
@@ -637,16 +1350,51 @@ void app_main(void)
     // Ініціалізація NVS (Non-Volatile Storage)
     ESP_ERROR_CHECK(nvs_flash_init());
 
+    role = load_role();
+    ESP_LOGI(TAG, "Role: %s", role == DISCOVERY_ROLE_SERVER ? "server" : "client");
+    if (CRYPTO_MODE == CRYPTO_MODE_CTR) {
+        ESP_LOGW(TAG, "AES-CTR: audio is encrypted but not authenticated, forged packets are played");
+    }
+
     // Ініціалізація мережевого інтерфейсу
     ESP_ERROR_CHECK(esp_netif_init());
 
     // Створення циклу обробки подій за замовчуванням
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
+    // Потоки мають бути готові до першої події Wi-Fi: сервер додає станції до конференції
+    const voice_profile_t *profile = &voice_profiles[VOICE_PROFILE];
+    stream_mutex = xSemaphoreCreateMutex();
+    assert(stream_mutex);
+    if (!resampler_filters_init(profile->rate)) {
+        ESP_LOGE(TAG, "Failed to initialize resampler filters");
+        return;
+    }
+    const conference_config_t conference_config = {
+        .codec = &AUDIO_CODEC,
+        .rate = profile->rate,
+        .tx_filter = &tx_filter,
+        .frame_samples = FRAME_SAMPLES,
+        .frame_period_us = FRAME_PERIOD_US,
+        .jb_slots = CONF_JITTER_BUFFER_SLOTS,
+        .fec_group = FEC_GROUP,
+        .idle_timeout_us = (int64_t)CONF_IDLE_TIMEOUT_MS * 1000,
+    };
+    conference_init(&conference, &conference_config);
+
+    // Ідентифікатор вузла постійний, а епоха росте з кожним запуском
+    discovery_mutex = xSemaphoreCreateMutex();
+    assert(discovery_mutex);
+    uint16_t epoch = load_epoch();
+    discovery_init(&discovery, node_id(), epoch, role, (int64_t)DISCOVERY_TIMEOUT_MS * 1000);
+    ESP_LOGI(TAG, "Discovery node %08" PRIx32 ", epoch %u", discovery.node, epoch);
+
     wifi_init();
     microphone_init();
     speaker_init();
     
+#if !FONTX_EMBED_ILGH16XB
+    // SPIFFS потрібна лише для файлу шрифту; з вбудованим шрифтом не монтується
     ESP_LOGI(TAG, "Initializing SPIFFS");
 
     esp_vfs_spiffs_conf_t conf = {
@@ -669,15 +1417,107 @@ void app_main(void)
         }
         return;
     }
+#endif
 
     // Затримка для стабілізації системи перед запуском задач
     vTaskDelay(5000 / portTICK_PERIOD_MS);
 
-    xTaskCreate(udp_send_task, "udp_send_task", 4096, NULL, 2, NULL); 
-    xTaskCreate(udp_receive_task, "udp_receive_task", 4096, NULL, 2, NULL);
+    // Ініціалізація джитер-буфера для прийому; пам'ять виділяється лише для своєї ролі
+    if (role == DISCOVERY_ROLE_SERVER) {
+        if (!mixer_init(&mixer, FRAME_SAMPLES)) {
+            ESP_LOGE(TAG, "Failed to initialize mixer");
+            return;
+        }
 
-    xTaskCreate(button_task, "button_task", 4096, NULL, 3, NULL);
-    xTaskCreate(encryption_button_task, "encryption_button_task", 4096, NULL, 3, NULL);
+        if (!frame_ring_init(&talk_ring, CAPTURE_RING_SLOTS, UDP_BUFFER_SIZE)) {
+            ESP_LOGE(TAG, "Failed to initialize talk ring");
+            return;
+        }
 
-    xTaskCreate(ST7789, "ST7789", 4096, NULL, 1, NULL);
+        if (!stream_tx_init(&group_stream, &AUDIO_CODEC, profile->rate, &tx_filter, FRAME_SAMPLES, esp_random(), FEC_GROUP)) {
+            ESP_LOGE(TAG, "Failed to initialize talkgroup stream");
+            return;
+        }
+    } else {
+        // Випадкова сесія не дає повторити nonce після перезапуску
+        if (!stream_tx_init(&tx_stream, &AUDIO_CODEC, profile->rate, &tx_filter, FRAME_SAMPLES, esp_random(), FEC_GROUP) ||
+            !stream_rx_init(&rx_stream, JITTER_BUFFER_SLOTS, UDP_BUFFER_SIZE, FRAME_PERIOD_US)) {
+            ESP_LOGE(TAG, "Failed to initialize streams");
+            return;
+        }
+
+        if (!plc_init(&plc, SAMPLE_RATE, FRAME_SAMPLES)) {
+            ESP_LOGE(TAG, "Failed to initialize PLC");
+            return;
+        }
+
+        cng_init(&comfort_noise, esp_random());
+    }
+    ESP_LOGI(TAG, "Voice profile: %s, %s at %" PRIu32 " Hz", profile->name, AUDIO_CODEC.name, packet_rate_hz(profile->rate));
+
+    dtx_init(&dtx);
+
+    if (!agc_init(&agc, &agc_config)) {
+        ESP_LOGE(TAG, "Failed to initialize AGC");
+        return;
+    }
+
+    if (!packet_pool_init(&packet_pool, PACKET_POOL_BUFFERS, UDP_PACKET_SIZE)) {
+        ESP_LOGE(TAG, "Failed to initialize packet pool");
+        return;
+    }
+
+    if (!frame_ring_init(&capture_ring, CAPTURE_RING_SLOTS, UDP_BUFFER_SIZE)) {
+        ESP_LOGE(TAG, "Failed to initialize capture ring");
+        return;
+    }
+
+    // Відкриття довготривалих сокетів для відправки та прийому
+    if (!transport_open(&transport, &transport_socket_backend, PORT, RX_TIMEOUT_MS)) {
+        ESP_LOGE(TAG, "Failed to open transport");
+        return;
+    }
+
+    // Сокет прийому одразу чує розмовні групи; номер групи обирається кнопкою під час роботи
+    talkgroup_addr.sin_family = AF_INET;
+    talkgroup_addr.sin_port = htons(PORT);
+    talkgroup_addr.sin_addr.s_addr = inet_addr(TALKGROUP_ADDR);
+    if (!transport_join_group(&transport, &talkgroup_addr)) {
+        ESP_LOGE(TAG, "Talkgroups unavailable, unicast only");
+    }
+
+    // Шифрування ввімкнене з запуску, розмовна група - ні. Підписка до створення задач
+    const uint32_t initial_state[STATE_COUNT] = {
+        [STATE_TRANSMIT] = false,
+        [STATE_RECEIVING] = false,
+        [STATE_ENCRYPTION] = true,
+        [STATE_TALKGROUP] = PACKET_TALKGROUP_NONE,
+    };
+    state_bus_init(&state, initial_state);
+    state_bus_subscribe(&state, &display_task_handle, STATE_BUS_ALL);
+
+    // Кнопки: передача з фіксацією подвійним натисканням, шифрування з утриманням для розмовних груп
+    const input_button_config_t buttons[BUTTON_COUNT] = {
+        [BUTTON_PTT] = { .gpio = BUTTON_GPIO, .long_press_ms = 0, .double_press_ms = PTT_DOUBLE_PRESS_MS },
+        [BUTTON_ENCRYPTION] = { .gpio = ENCRYPTION_BUTTON_GPIO, .long_press_ms = TALKGROUP_HOLD_MS, .double_press_ms = 0 },
+    };
+    if (input_init(&input, buttons, BUTTON_COUNT, INPUT_DEBOUNCE_MS) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize buttons");
+        return;
+    }
+    input_subscribe(&input, &capture_task_handle,
+                    INPUT_EVENT_BIT(BUTTON_PTT, INPUT_PRESS) | INPUT_EVENT_BIT(BUTTON_PTT, INPUT_RELEASE) |
+                    INPUT_EVENT_BIT(BUTTON_PTT, INPUT_DOUBLE_PRESS));
+    input_subscribe(&input, &display_task_handle,
+                    INPUT_EVENT_BIT(BUTTON_ENCRYPTION, INPUT_CLICK) | INPUT_EVENT_BIT(BUTTON_ENCRYPTION, INPUT_LONG_PRESS));
+
+    // Бюджет кожного аудіокадру - один період кадру
+    rt_timing_init(&send_timing, FRAME_PERIOD_US);
+    rt_timing_init(&receive_timing, FRAME_PERIOD_US);
+    rt_timing_init(&playout_timing, FRAME_PERIOD_US);
+
+    // Таблиця перевіряється перед створенням задач
+    if (rt_sched_start(app_tasks, APP_TASK_COUNT) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start tasks");
+    }
 }
@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mixer.h"
+#include "dsp.h"
+
+bool mixer_init(mixer_t *mixer, size_t frame_samples) {
+    memset(mixer, 0, sizeof(*mixer));
+    mixer->sum = (int32_t *)calloc(frame_samples, sizeof(int32_t));
+    if (!mixer->sum) {
+        return false;
+    }
+    mixer->frame_samples = frame_samples;
+    return true;
+}
+
+void mixer_free(mixer_t *mixer) {
+    free(mixer->sum);
+    mixer->sum = NULL;
+}
+
+void mixer_begin(mixer_t *mixer) {
+    memset(mixer->sum, 0, mixer->frame_samples * sizeof(int32_t));
+    mixer->inputs = 0;
+}
+
+// Короткий кадр доповнюється тишею. 32-бітна сума не переповнюється
+// для будь-якої реальної кількості учасників (до 65536 кадрів)
+void mixer_add(mixer_t *mixer, const int16_t *pcm, size_t len) {
+    if (len > mixer->frame_samples) {
+        len = mixer->frame_samples;
+    }
+    int32_t *sum = mixer->sum;
+    for (size_t i = 0; i < len; i++) {
+        sum[i] += pcm[i];
+    }
+    mixer->inputs++;
+}
+
+// Вихід для учасника: сума без його кадру (own == NULL - учасник мовчить).
+// Насичення виконується один раз на виході, а не на кожному додаванні
+void mixer_output(const mixer_t *mixer, const int16_t *own, int16_t *out) {
+    const int32_t *sum = mixer->sum;
+    size_t len = mixer->frame_samples;
+    if (own) {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = dsp_sat16(sum[i] - own[i]);
+        }
+    } else {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = dsp_sat16(sum[i]);
+        }
+    }
+}
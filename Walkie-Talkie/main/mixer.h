@@ -0,0 +1,26 @@
+#ifndef MAIN_MIXER_H_
+#define MAIN_MIXER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Мікшер конференції з виходами "усі, крім себе" (mix-minus). Усі кадри такту
+// додаються в 32-бітну суму один раз, а вихід для учасника - це сума мінус його
+// власний кадр з насиченням до 16 біт. Вартість такту - O(N) додавань на семпл
+// для входів і по одному відніманню на кожен вихід, а не O(N^2).
+// Модуль не залежить від FreeRTOS.
+
+typedef struct {
+    int32_t *sum;               // Сума входів поточного такту
+    size_t frame_samples;
+    uint16_t inputs;            // Кількість доданих кадрів
+} mixer_t;
+
+bool mixer_init(mixer_t *mixer, size_t frame_samples);
+void mixer_free(mixer_t *mixer);
+void mixer_begin(mixer_t *mixer);
+void mixer_add(mixer_t *mixer, const int16_t *pcm, size_t len);
+void mixer_output(const mixer_t *mixer, const int16_t *own, int16_t *out);
+
+#endif /* MAIN_MIXER_H_ */
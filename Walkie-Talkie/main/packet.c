@@ -0,0 +1,196 @@
+#include <string.h>
+#include "packet.h"
+
+// Записує заголовок на початок буфера, навантаження вже має лежати за ним
+void packet_write_header(uint8_t *buf, const packet_header_t *hdr) {
+    buf[0] = PACKET_VERSION;
+    buf[1] = hdr->flags;
+    buf[2] = hdr->codec;
+    buf[3] = hdr->rate;
+    buf[4] = (hdr->session >> 24) & 0xFF;
+    buf[5] = (hdr->session >> 16) & 0xFF;
+    buf[6] = (hdr->session >> 8) & 0xFF;
+    buf[7] = hdr->session & 0xFF;
+    buf[8] = (hdr->seq >> 8) & 0xFF;
+    buf[9] = hdr->seq & 0xFF;
+    buf[10] = (hdr->timestamp >> 24) & 0xFF;
+    buf[11] = (hdr->timestamp >> 16) & 0xFF;
+    buf[12] = (hdr->timestamp >> 8) & 0xFF;
+    buf[13] = hdr->timestamp & 0xFF;
+    buf[14] = (hdr->payload_len >> 8) & 0xFF;
+    buf[15] = hdr->payload_len & 0xFF;
+    buf[16] = (hdr->talkgroup >> 8) & 0xFF;
+    buf[17] = hdr->talkgroup & 0xFF;
+}
+
+// Розбирає заголовок і перевіряє, що навантаження вміщується в датаграму
+bool packet_parse(const uint8_t *buf, size_t len, packet_header_t *hdr) {
+    if (len < PACKET_HEADER_SIZE) {
+        return false;
+    }
+
+    hdr->version = buf[0];
+    hdr->flags = buf[1];
+    hdr->codec = buf[2];
+    hdr->rate = buf[3];
+    hdr->session = ((uint32_t)buf[4] << 24) | ((uint32_t)buf[5] << 16) | ((uint32_t)buf[6] << 8) | buf[7];
+    hdr->seq = ((uint16_t)buf[8] << 8) | buf[9];
+    hdr->timestamp = ((uint32_t)buf[10] << 24) | ((uint32_t)buf[11] << 16) | ((uint32_t)buf[12] << 8) | buf[13];
+    hdr->payload_len = ((uint16_t)buf[14] << 8) | buf[15];
+    hdr->talkgroup = ((uint16_t)buf[16] << 8) | buf[17];
+
+    if (hdr->version != PACKET_VERSION) {
+        return false;
+    }
+    if (hdr->payload_len > len - PACKET_HEADER_SIZE) {
+        return false;
+    }
+    if (packet_rate_hz(hdr->rate) == 0) {
+        return false;
+    }
+    return true;
+}
+
+// Частота дискретизації в Гц за ідентифікатором, 0 для невідомого
+uint32_t packet_rate_hz(uint8_t rate) {
+    switch (rate) {
+    case PACKET_RATE_44100:
+        return 44100;
+    case PACKET_RATE_16000:
+        return 16000;
+    case PACKET_RATE_8000:
+        return 8000;
+    default:
+        return 0;
+    }
+}
+
+// Nonce = сесія | мітка часу | номер | потік | 0. Мітка часу росте монотонно в межах сесії,
+// а сесія змінюється після перезапуску, тому пара (ключ, nonce) не повторюється.
+// Пакет парності повторює номер і мітку аудіокадру, тож має окремий байт потоку;
+// маяк виявлення має свій байт потоку, бо його сесія - ідентифікатор вузла
+void packet_nonce(const packet_header_t *hdr, uint8_t *nonce) {
+    nonce[0] = (hdr->session >> 24) & 0xFF;
+    nonce[1] = (hdr->session >> 16) & 0xFF;
+    nonce[2] = (hdr->session >> 8) & 0xFF;
+    nonce[3] = hdr->session & 0xFF;
+    nonce[4] = (hdr->timestamp >> 24) & 0xFF;
+    nonce[5] = (hdr->timestamp >> 16) & 0xFF;
+    nonce[6] = (hdr->timestamp >> 8) & 0xFF;
+    nonce[7] = hdr->timestamp & 0xFF;
+    nonce[8] = (hdr->seq >> 8) & 0xFF;
+    nonce[9] = hdr->seq & 0xFF;
+    nonce[10] = (hdr->flags & PACKET_FLAG_BEACON) ? 2 : (hdr->flags & PACKET_FLAG_FEC) ? 1 : 0;
+    nonce[11] = 0;
+}
+
+// Забуває всі сесії
+void packet_replay_reset(packet_replay_t *window) {
+    memset(window, 0, sizeof(*window));
+}
+
+// Індекс вікна сесії, -1 для невідомої
+static int replay_find(const packet_replay_t *window, uint32_t session) {
+    for (int i = 0; i < PACKET_REPLAY_SESSIONS; i++) {
+        if (window->sessions[i].used && window->sessions[i].session == session) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Дешева перевірка до дешифрування; вікно не змінюється, доки пакет не автентифіковано
+bool packet_replay_check(const packet_replay_t *window, const packet_header_t *hdr, int64_t now_us) {
+    int index = replay_find(window, hdr->session);
+    if (index < 0) {
+        // Новий передавач чи перезапуск лише після тиші відомих сесій;
+        // рішення остаточно приймає перевірка тегу
+        return !window->started || now_us - window->last_us >= PACKET_SESSION_HOLDOFF_US;
+    }
+    const packet_replay_session_t *s = &window->sessions[index];
+
+    int16_t seq_delta = (int16_t)(uint16_t)(hdr->seq - s->top_seq);
+    int32_t ts_delta = (int32_t)(hdr->timestamp - s->top_timestamp);
+    if (seq_delta > 0) {
+        return ts_delta > 0;
+    }
+    if (ts_delta > 0 || -seq_delta >= PACKET_REPLAY_WINDOW) {
+        return false;
+    }
+    return (s->bitmap & ((uint64_t)1 << -seq_delta)) == 0;
+}
+
+// Позначає пакет прийнятим; викликається лише після успішної перевірки і автентифікації
+void packet_replay_update(packet_replay_t *window, const packet_header_t *hdr, int64_t now_us) {
+    window->started = true;
+    window->last_us = now_us;
+    int index = replay_find(window, hdr->session);
+    packet_replay_session_t *s = &window->sessions[index < 0 ? 0 : index];
+    if (index < 0) {
+        // Вільний запис або найдовше неактивний
+        for (int i = 0; i < PACKET_REPLAY_SESSIONS && s->used; i++) {
+            packet_replay_session_t *candidate = &window->sessions[i];
+            if (!candidate->used || candidate->last_us < s->last_us) {
+                s = candidate;
+            }
+        }
+        s->used = true;
+        s->session = hdr->session;
+        s->top_seq = hdr->seq;
+        s->top_timestamp = hdr->timestamp;
+        s->bitmap = 1;
+        s->last_us = now_us;
+        return;
+    }
+
+    s->last_us = now_us;
+    int16_t seq_delta = (int16_t)(uint16_t)(hdr->seq - s->top_seq);
+    if (seq_delta > 0) {
+        s->bitmap = seq_delta < PACKET_REPLAY_WINDOW ? (s->bitmap << seq_delta) | 1 : 1;
+        s->top_seq = hdr->seq;
+        s->top_timestamp = hdr->timestamp;
+    } else if (-seq_delta < PACKET_REPLAY_WINDOW) {
+        s->bitmap |= (uint64_t)1 << -seq_delta;
+    }
+}
+
+// Облік отриманих номерів, як для RTP: розширений номер з лічильником циклів
+void packet_rx_stats_update(packet_rx_stats_t *stats, uint16_t seq) {
+    if (!stats->started) {
+        stats->started = true;
+        stats->max_seq = seq;
+        stats->cycles = 0;
+        stats->base_seq = seq;
+        stats->received++;
+        return;
+    }
+
+    stats->received++;
+    int16_t delta = (int16_t)(uint16_t)(seq - stats->max_seq);
+    if (delta > 0) {
+        if (seq < stats->max_seq) {
+            stats->cycles += 65536;
+        }
+        stats->max_seq = seq;
+    } else {
+        stats->reordered++;
+    }
+}
+
+// Новий потік з власним простором номерів (інший мовець); лічильники зберігаються
+void packet_rx_stats_restart(packet_rx_stats_t *stats) {
+    stats->prior_expected = packet_rx_stats_expected(stats);
+    stats->started = false;
+}
+
+uint32_t packet_rx_stats_expected(const packet_rx_stats_t *stats) {
+    if (!stats->started) {
+        return stats->prior_expected;
+    }
+    return stats->prior_expected + stats->cycles + stats->max_seq - stats->base_seq + 1;
+}
+
+uint32_t packet_rx_stats_lost(const packet_rx_stats_t *stats) {
+    uint32_t expected = packet_rx_stats_expected(stats);
+    return expected > stats->received ? expected - stats->received : 0;
+}
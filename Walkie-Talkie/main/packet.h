@@ -0,0 +1,121 @@
+#ifndef MAIN_PACKET_H_
+#define MAIN_PACKET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Заголовок аудіопакета (18 байт, мережевий порядок байтів):
+//  0      версія
+//  1      прапорці
+//  2      ідентифікатор кодека/формату
+//  3      ідентифікатор частоти дискретизації
+//  4..7   випадковий ідентифікатор сесії передавача (новий після кожного запуску)
+//  8..9   номер послідовності
+//  10..13 мітка часу в семплах
+//  14..15 довжина корисного навантаження
+//  16..17 розмовна група (0 - адресний потік без групи)
+// Корисне навантаження йде одразу після заголовка в тому ж буфері. Зашифроване
+// навантаження (AES-GCM, заголовок - додаткові автентифіковані дані) закінчується
+// тегом автентифікації, який не входить у довжину навантаження.
+// Приймач відтворює лише пакети своєї розмовної групи; оскільки заголовок
+// автентифікується, номер групи не можна підмінити в дорозі.
+// Пакети парності мають номер останнього кадру групи, тому ведуть окреме вікно
+// повторів і окремий простір nonce. Маяки виявлення також мають власний простір nonce.
+
+#define PACKET_VERSION 3
+#define PACKET_HEADER_SIZE 18
+#define PACKET_NONCE_SIZE 12        // Розмір nonce для шифрування навантаження
+#define PACKET_REPLAY_WINDOW 64     // Ширина вікна захисту від повторів (пакети)
+#define PACKET_TALKGROUP_NONE 0     // Адресний потік, не розмовна група
+#define PACKET_SESSION_HOLDOFF_US 1000000 // Невідома сесія приймається лише після тиші всіх відомих
+#define PACKET_REPLAY_SESSIONS 8    // Сесій, для яких вікно повторів пам'ятає стан
+
+#define PACKET_FLAG_ENCRYPTED 0x01  // Навантаження зашифроване
+#define PACKET_FLAG_SID 0x02        // Дескриптор тиші замість аудіокадру
+#define PACKET_FLAG_FEC 0x04        // Пакет парності для відновлення втрат (fec.h)
+#define PACKET_FLAG_BEACON 0x08     // Маяк виявлення пристроїв (discovery.h)
+
+// Вказівник на корисне навантаження всередині буфера пакета
+#define PACKET_PAYLOAD(buf) ((buf) + PACKET_HEADER_SIZE)
+
+typedef enum {
+    PACKET_CODEC_PCM16 = 0,     // 16-бітний PCM, моно
+    PACKET_CODEC_IMA_ADPCM = 1, // IMA-ADPCM, 4 біти на семпл
+} packet_codec_t;
+
+typedef enum {
+    PACKET_RATE_44100 = 0,
+    PACKET_RATE_16000 = 1,
+    PACKET_RATE_8000 = 2,
+    PACKET_RATE_COUNT,
+} packet_rate_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t flags;
+    uint8_t codec;
+    uint8_t rate;
+    uint32_t session;
+    uint16_t seq;
+    uint32_t timestamp;
+    uint16_t payload_len;
+    uint16_t talkgroup;
+} packet_header_t;
+
+// Статистика прийому за номерами послідовності
+typedef struct {
+    bool started;
+    uint16_t max_seq;           // Найбільший отриманий номер
+    uint32_t cycles;            // Кількість переповнень номера (по 65536)
+    uint32_t base_seq;          // Перший номер потоку
+    uint32_t prior_expected;    // Очікувано пакетів у попередніх потоках (інших мовців)
+    uint32_t received;          // Отримано пакетів
+    uint32_t reordered;         // Отримано не по порядку або дублікатів
+    uint32_t invalid;           // Відкинуто пакетів з некоректним заголовком
+    uint32_t replayed;          // Відкинуто повторів та застарілих пакетів
+    uint32_t auth_failed;       // Відкинуто пакетів з невірним тегом або без обов'язкового шифрування
+    uint32_t other_group;       // Відкинуто пакетів іншої розмовної групи
+    uint32_t other_talker;      // Відкинуто пакетів іншого мовця, поки говорить поточний
+} packet_rx_stats_t;
+
+// Ковзне вікно однієї сесії: бітова маска останніх прийнятих номерів.
+// Мітка часу має рухатися в тому ж напрямку, що й номер, тому пакети
+// з попереднього циклу 16-бітного номера теж відкидаються.
+typedef struct {
+    bool used;
+    uint32_t session;           // Сесія передавача, для якої ведеться вікно
+    uint16_t top_seq;           // Найбільший прийнятий номер
+    uint32_t top_timestamp;     // Мітка часу пакета з найбільшим номером
+    uint64_t bitmap;            // Біт i - прийнято пакет top_seq - i
+    int64_t last_us;            // Час останнього прийнятого пакета сесії
+} packet_replay_session_t;
+
+// Захист від повторів для потоку, у який по черзі говорять кілька передавачів:
+// власне вікно для кожної з останніх PACKET_REPLAY_SESSIONS сесій, тож мовець,
+// що повернувся після іншого, продовжує зі своїм вікном. Коли таблиця заповнена,
+// нова сесія витісняє найдовше неактивну. Сесії випадкові і не впорядковані,
+// тому невідома сесія (новий передавач або запис уже витісненої) приймається
+// лише після тиші всіх відомих протягом PACKET_SESSION_HOLDOFF_US: прокрутити
+// таблицю записаними сесіями можна не швидше за одну на цей інтервал.
+typedef struct {
+    packet_replay_session_t sessions[PACKET_REPLAY_SESSIONS];
+    bool started;
+    int64_t last_us;            // Час останнього прийнятого пакета будь-якої сесії
+} packet_replay_t;
+
+void packet_write_header(uint8_t *buf, const packet_header_t *hdr);
+bool packet_parse(const uint8_t *buf, size_t len, packet_header_t *hdr);
+uint32_t packet_rate_hz(uint8_t rate);
+void packet_nonce(const packet_header_t *hdr, uint8_t *nonce);
+
+void packet_replay_reset(packet_replay_t *window);
+bool packet_replay_check(const packet_replay_t *window, const packet_header_t *hdr, int64_t now_us);
+void packet_replay_update(packet_replay_t *window, const packet_header_t *hdr, int64_t now_us);
+
+void packet_rx_stats_update(packet_rx_stats_t *stats, uint16_t seq);
+void packet_rx_stats_restart(packet_rx_stats_t *stats);
+uint32_t packet_rx_stats_expected(const packet_rx_stats_t *stats);
+uint32_t packet_rx_stats_lost(const packet_rx_stats_t *stats);
+
+#endif /* MAIN_PACKET_H_ */
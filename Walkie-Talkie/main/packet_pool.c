@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include "packet_pool.h"
+
+bool packet_pool_init(packet_pool_t *pool, uint16_t count, uint16_t capacity) {
+    memset(pool, 0, sizeof(*pool));
+    if (count == 0 || count > PACKET_POOL_MAX_BUFFERS || capacity == 0) {
+        return false;
+    }
+
+    pool->memory = (uint8_t *)calloc(count, capacity);
+    if (!pool->memory) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        packet_buf_t *buf = &pool->bufs[i];
+        buf->storage = pool->memory + (size_t)i * capacity;
+        buf->capacity = capacity;
+        buf->pool = pool;
+        pool->free_list[i] = buf;
+    }
+    pool->count = count;
+    pool->available = count;
+    pool->stats.min_available = count;
+    portMUX_INITIALIZE(&pool->lock);
+    return true;
+}
+
+void packet_pool_free(packet_pool_t *pool) {
+    free(pool->memory);
+    pool->memory = NULL;
+    pool->count = 0;
+    pool->available = 0;
+}
+
+void packet_pool_get_stats(packet_pool_t *pool, packet_pool_stats_t *stats) {
+    portENTER_CRITICAL(&pool->lock);
+    *stats = pool->stats;
+    stats->available = pool->available;
+    portEXIT_CRITICAL(&pool->lock);
+}
+
+packet_buf_t *packet_buf_alloc(packet_pool_t *pool, uint16_t headroom) {
+    packet_buf_t *buf = NULL;
+
+    portENTER_CRITICAL(&pool->lock);
+    if (pool->available > 0 && headroom <= pool->bufs[0].capacity) {
+        buf = pool->free_list[--pool->available];
+        pool->stats.allocs++;
+        if (pool->available < pool->stats.min_available) {
+            pool->stats.min_available = pool->available;
+        }
+    } else {
+        pool->stats.exhausted++;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+
+    if (buf) {
+        buf->offset = headroom;
+        buf->len = 0;
+        buf->refs = 1;
+    }
+    return buf;
+}
+
+// Додаткове посилання, наприклад коли той самий пакет іде кільком отримувачам
+void packet_buf_ref(packet_buf_t *buf) {
+    portENTER_CRITICAL(&buf->pool->lock);
+    buf->refs++;
+    portEXIT_CRITICAL(&buf->pool->lock);
+}
+
+// Буфер повертається в пул, коли звільнено останнє посилання
+void packet_buf_release(packet_buf_t *buf) {
+    packet_pool_t *pool = buf->pool;
+
+    portENTER_CRITICAL(&pool->lock);
+    if (--buf->refs == 0) {
+        pool->free_list[pool->available++] = buf;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+}
+
+// Розширює дані на len байт перед початком (заголовок), NULL якщо не вистачає headroom
+uint8_t *packet_buf_push(packet_buf_t *buf, uint16_t len) {
+    if (len > buf->offset) {
+        return NULL;
+    }
+    buf->offset -= len;
+    buf->len += len;
+    return packet_buf_data(buf);
+}
+
+// Розширює дані на len байт в кінці (навантаження, тег), повертає початок доданої частини
+uint8_t *packet_buf_put(packet_buf_t *buf, uint16_t len) {
+    if (len > packet_buf_tailroom(buf)) {
+        return NULL;
+    }
+    uint8_t *tail = packet_buf_data(buf) + buf->len;
+    buf->len += len;
+    return tail;
+}
+
+// Відкидає len байт з початку даних (розібраний заголовок)
+uint8_t *packet_buf_pull(packet_buf_t *buf, uint16_t len) {
+    if (len > buf->len) {
+        return NULL;
+    }
+    buf->offset += len;
+    buf->len -= len;
+    return packet_buf_data(buf);
+}
@@ -0,0 +1,66 @@
+#ifndef MAIN_PACKET_POOL_H_
+#define MAIN_PACKET_POOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+// Пул буферів пакетів фіксованого розміру з лічильником посилань.
+// Буфер резервує місце перед даними під заголовок, тому кодер пише навантаження
+// одразу на своє місце, шифрування виконується на місці, а заголовок і тег
+// дописуються навколо без копіювання. Пам'ять виділяється один раз при ініціалізації.
+
+#define PACKET_POOL_MAX_BUFFERS 16
+
+typedef struct packet_pool packet_pool_t;
+
+typedef struct {
+    uint8_t *storage;           // Початок пам'яті буфера
+    uint16_t offset;            // Зсув початку даних від storage
+    uint16_t len;               // Довжина даних
+    uint16_t capacity;
+    uint8_t refs;
+    packet_pool_t *pool;
+} packet_buf_t;
+
+typedef struct {
+    uint16_t available;         // Вільних буферів зараз
+    uint16_t min_available;     // Найменша кількість вільних буферів
+    uint32_t allocs;            // Успішних виділень
+    uint32_t exhausted;         // Невдалих виділень через порожній пул
+} packet_pool_stats_t;
+
+struct packet_pool {
+    uint8_t *memory;
+    packet_buf_t bufs[PACKET_POOL_MAX_BUFFERS];
+    packet_buf_t *free_list[PACKET_POOL_MAX_BUFFERS];
+    uint16_t count;
+    uint16_t available;
+    packet_pool_stats_t stats;
+    portMUX_TYPE lock;
+};
+
+bool packet_pool_init(packet_pool_t *pool, uint16_t count, uint16_t capacity);
+void packet_pool_free(packet_pool_t *pool);
+void packet_pool_get_stats(packet_pool_t *pool, packet_pool_stats_t *stats);
+
+// Буфер з порожніми даними після headroom байт або NULL, якщо пул вичерпано
+packet_buf_t *packet_buf_alloc(packet_pool_t *pool, uint16_t headroom);
+void packet_buf_ref(packet_buf_t *buf);
+void packet_buf_release(packet_buf_t *buf);
+
+static inline uint8_t *packet_buf_data(const packet_buf_t *buf) {
+    return buf->storage + buf->offset;
+}
+
+// Вільне місце після даних
+static inline uint16_t packet_buf_tailroom(const packet_buf_t *buf) {
+    return buf->capacity - buf->offset - buf->len;
+}
+
+uint8_t *packet_buf_push(packet_buf_t *buf, uint16_t len);
+uint8_t *packet_buf_put(packet_buf_t *buf, uint16_t len);
+uint8_t *packet_buf_pull(packet_buf_t *buf, uint16_t len);
+
+#endif /* MAIN_PACKET_POOL_H_ */
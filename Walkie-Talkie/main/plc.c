@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <string.h>
+#include "plc.h"
+
+#define PLC_Q15_ONE 32768
+
+// Додає семпли в кінець історії, відкидаючи найстаріші
+static void history_append(plc_t *plc, const int16_t *pcm, size_t len) {
+    if (len >= plc->history_len) {
+        memcpy(plc->history, pcm + len - plc->history_len, plc->history_len * sizeof(int16_t));
+        return;
+    }
+    memmove(plc->history, plc->history + len, (plc->history_len - len) * sizeof(int16_t));
+    memcpy(plc->history + plc->history_len - len, pcm, len * sizeof(int16_t));
+}
+
+// Нормована кореляція кінця історії з ділянкою на lag раніше: порівнюємо corr^2/energy
+// без ділення, зберігаючи найкращу пару
+static bool better_lag(int64_t corr, int64_t energy, int64_t best_corr, int64_t best_energy) {
+    if (corr <= 0 || energy <= 0) {
+        return false;
+    }
+    if (best_corr <= 0) {
+        return true;
+    }
+    // corr^2 / energy > best_corr^2 / best_energy, у масштабі, що не переповнює int64
+    double lhs = (double)corr * corr * best_energy;
+    double rhs = (double)best_corr * best_corr * energy;
+    return lhs > rhs;
+}
+
+static int64_t correlate(const int16_t *a, const int16_t *b, size_t len, size_t step, int64_t *energy) {
+    int64_t corr = 0;
+    int64_t en = 0;
+    for (size_t i = 0; i < len; i += step) {
+        corr += (int32_t)a[i] * b[i];
+        en += (int32_t)b[i] * b[i];
+    }
+    *energy = en;
+    return corr;
+}
+
+// Грубий пошук з проріджуванням, потім уточнення на повній частоті біля знайденого періоду
+static uint16_t find_pitch(const plc_t *plc) {
+    const int16_t *end = plc->history + plc->history_len - plc->window;
+    int64_t best_corr = 0, best_energy = 0, energy;
+    uint16_t best = plc->min_lag;
+
+    for (uint16_t lag = plc->min_lag; lag <= plc->max_lag; lag += PLC_DECIMATION) {
+        int64_t corr = correlate(end, end - lag, plc->window, PLC_DECIMATION, &energy);
+        if (better_lag(corr, energy, best_corr, best_energy)) {
+            best_corr = corr;
+            best_energy = energy;
+            best = lag;
+        }
+    }
+
+    uint16_t coarse = best;
+    best_corr = 0;
+    for (int lag = coarse - PLC_DECIMATION + 1; lag <= coarse + PLC_DECIMATION - 1; lag++) {
+        if (lag < plc->min_lag || lag > plc->max_lag) {
+            continue;
+        }
+        int64_t corr = correlate(end, end - lag, plc->window, 1, &energy);
+        if (better_lag(corr, energy, best_corr, best_energy)) {
+            best_corr = corr;
+            best_energy = energy;
+            best = (uint16_t)lag;
+        }
+    }
+    return best;
+}
+
+// Підсилення на межі k-го замаскованого кадру: перший кадр без згасання, далі лінійно до нуля
+static int32_t fade_gain(uint16_t lost) {
+    if (lost <= 1) {
+        return PLC_Q15_ONE;
+    }
+    if (lost > PLC_FADE_FRAMES + 1) {
+        return 0;
+    }
+    return PLC_Q15_ONE - (int32_t)(lost - 1) * PLC_Q15_ONE / PLC_FADE_FRAMES;
+}
+
+bool plc_init(plc_t *plc, uint32_t sample_rate, size_t frame_samples) {
+    memset(plc, 0, sizeof(*plc));
+
+    plc->min_lag = sample_rate / PLC_MAX_PITCH_HZ;
+    plc->max_lag = sample_rate / PLC_MIN_PITCH_HZ;
+    plc->window = frame_samples;
+    plc->ola_len = sample_rate / 250;   // 4 мс
+    // Історії вистачає на вікно кореляції, найдовший період і його зшивання
+    plc->history_len = plc->window + plc->max_lag + plc->max_lag / 4;
+
+    plc->history = (int16_t *)calloc(plc->history_len, sizeof(int16_t));
+    plc->period = (int16_t *)calloc(plc->max_lag, sizeof(int16_t));
+    if (!plc->history || !plc->period || plc->min_lag == 0) {
+        plc_free(plc);
+        return false;
+    }
+    plc_reset(plc);
+    return true;
+}
+
+void plc_free(plc_t *plc) {
+    free(plc->history);
+    free(plc->period);
+    plc->history = NULL;
+    plc->period = NULL;
+}
+
+void plc_reset(plc_t *plc) {
+    memset(plc->history, 0, plc->history_len * sizeof(int16_t));
+    plc->lost = 0;
+    plc->pos = 0;
+    plc->pitch = plc->min_lag;
+}
+
+// Готує період для повторення: кінець періоду плавно переходить у семпли перед його
+// початком, тому при циклічному повторенні немає стрибка на межі
+static void prepare_period(plc_t *plc) {
+    uint16_t p = find_pitch(plc);
+    uint16_t blend = p / 4;
+    const int16_t *src = plc->history + plc->history_len - p;
+    const int16_t *before = src - blend;
+
+    memcpy(plc->period, src, p * sizeof(int16_t));
+    for (uint16_t k = 0; k < blend; k++) {
+        int32_t w = (int32_t)(k + 1) * PLC_Q15_ONE / (blend + 1);
+        int16_t *s = &plc->period[p - blend + k];
+        *s = (int16_t)(((int32_t)*s * (PLC_Q15_ONE - w) + (int32_t)before[k] * w) >> 15);
+    }
+
+    plc->pitch = p;
+    plc->pos = 0;
+    plc->stats.pitch = p;
+}
+
+static inline int16_t next_synth(plc_t *plc) {
+    int16_t s = plc->period[plc->pos];
+    plc->pos = plc->pos + 1 < plc->pitch ? plc->pos + 1 : 0;
+    return s;
+}
+
+void plc_conceal(plc_t *plc, int16_t *pcm, size_t len) {
+    if (plc->lost == 0) {
+        prepare_period(plc);
+        plc->stats.bursts++;
+    }
+    plc->lost++;
+    plc->stats.concealed++;
+
+    int32_t g0 = fade_gain(plc->lost - 1);
+    int32_t g1 = fade_gain(plc->lost);
+    for (size_t i = 0; i < len; i++) {
+        int32_t g = g0 + (int32_t)((int64_t)(g1 - g0) * (int64_t)i / (int64_t)len);
+        pcm[i] = (int16_t)(((int32_t)next_synth(plc) * g) >> 15);
+    }
+    history_append(plc, pcm, len);
+}
+
+// Справжній кадр; після серії втрат його початок зшивається з продовженням синтезу
+void plc_good_frame(plc_t *plc, int16_t *pcm, size_t len) {
+    if (plc->lost > 0) {
+        int32_t g = fade_gain(plc->lost);
+        size_t ola = plc->ola_len < len ? plc->ola_len : len;
+        for (size_t k = 0; k < ola; k++) {
+            int32_t w = (int32_t)(k + 1) * PLC_Q15_ONE / (int32_t)(ola + 1);
+            int32_t synth = ((int32_t)next_synth(plc) * g) >> 15;
+            pcm[k] = (int16_t)(((int32_t)pcm[k] * w + synth * (PLC_Q15_ONE - w)) >> 15);
+        }
+        plc->lost = 0;
+    }
+    history_append(plc, pcm, len);
+}
+
+// Після повного згасання маскувати нічого, викликач відтворює тишу
+bool plc_can_conceal(const plc_t *plc) {
+    return plc->lost <= PLC_FADE_FRAMES;
+}
+
+void plc_get_stats(const plc_t *plc, plc_stats_t *stats) {
+    *stats = plc->stats;
+}
@@ -0,0 +1,47 @@
+#ifndef MAIN_PLC_H_
+#define MAIN_PLC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Маскування втрачених кадрів повторенням останнього періоду основного тону
+// (за схемою G.711 Appendix I). Період шукається автокореляцією по історії
+// відтвореного сигналу, при серії втрат сигнал плавно згасає, а перший справжній
+// кадр після втрат зшивається з синтезованим перехресним згасанням.
+// Модуль не залежить від FreeRTOS.
+
+#define PLC_MIN_PITCH_HZ 60         // Найнижчий основний тон, що шукається
+#define PLC_MAX_PITCH_HZ 400        // Найвищий основний тон
+#define PLC_DECIMATION 4            // Проріджування для грубого пошуку періоду
+#define PLC_FADE_FRAMES 5           // Після першого кадру сигнал згасає за стільки кадрів
+
+typedef struct {
+    uint32_t concealed;         // Замасковано кадрів
+    uint32_t bursts;            // Серій втрат
+    uint16_t pitch;             // Останній знайдений період (семпли)
+} plc_stats_t;
+
+typedef struct {
+    int16_t *history;           // Останні відтворені семпли, найновіші в кінці
+    int16_t *period;            // Один період сигналу для повторення
+    size_t history_len;
+    size_t window;              // Вікно кореляції
+    uint16_t min_lag;
+    uint16_t max_lag;
+    uint16_t ola_len;           // Довжина зшивання при відновленні
+    uint16_t pitch;
+    uint16_t pos;               // Позиція всередині періоду
+    uint16_t lost;              // Кадрів поспіль замасковано
+    plc_stats_t stats;
+} plc_t;
+
+bool plc_init(plc_t *plc, uint32_t sample_rate, size_t frame_samples);
+void plc_free(plc_t *plc);
+void plc_reset(plc_t *plc);
+void plc_good_frame(plc_t *plc, int16_t *pcm, size_t len);
+void plc_conceal(plc_t *plc, int16_t *pcm, size_t len);
+bool plc_can_conceal(const plc_t *plc);
+void plc_get_stats(const plc_t *plc, plc_stats_t *stats);
+
+#endif /* MAIN_PLC_H_ */
@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "resampler.h"
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Модифікована функція Бесселя нульового порядку для вікна Кайзера
+static float bessel_i0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (int k = 1; k < 25; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+        if (term < 1e-9f * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Рахує фільтр для пари частот; викликається під час запуску, поза гарячими шляхами
+bool resampler_filter_init(resampler_filter_t *filter, uint32_t in_rate, uint32_t out_rate) {
+    memset(filter, 0, sizeof(*filter));
+    if (in_rate == 0 || out_rate == 0) {
+        return false;
+    }
+
+    uint32_t g = gcd(in_rate, out_rate);
+    filter->in_rate = in_rate;
+    filter->out_rate = out_rate;
+    filter->up = out_rate / g;
+    filter->down = in_rate / g;
+    filter->passthrough = (filter->up == 1 && filter->down == 1);
+    if (filter->passthrough) {
+        return true;
+    }
+
+    filter->taps = (out_rate < in_rate) ? RESAMPLER_TAPS_DOWN : RESAMPLER_TAPS_UP;
+    size_t len = (size_t)filter->up * filter->taps;
+    filter->coeffs = (int16_t *)malloc(len * sizeof(int16_t));
+    if (!filter->coeffs) {
+        return false;
+    }
+
+    // Фільтр-прототип на частоті in_rate * L: sinc з вікном Кайзера та підсиленням L
+    float fc = RESAMPLER_CUTOFF * 0.5f / (float)(filter->up > filter->down ? filter->up : filter->down);
+    float center = (len - 1) / 2.0f;
+    float i0_beta = bessel_i0(RESAMPLER_KAISER_BETA);
+    for (size_t j = 0; j < len; j++) {
+        float t = j - center;
+        float sinc = (t == 0.0f) ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * t) / ((float)M_PI * t);
+        float r = t / center;
+        float window = bessel_i0(RESAMPLER_KAISER_BETA * sqrtf(fmaxf(0.0f, 1.0f - r * r))) / i0_beta;
+        float h = sinc * window * filter->up;
+
+        // Поліфазне розкладання: фаза p містить h[p + k * L]
+        size_t phase = j % filter->up;
+        size_t k = j / filter->up;
+        int32_t q = (int32_t)lrintf(h * 32768.0f);
+        filter->coeffs[phase * filter->taps + k] = (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+    }
+    return true;
+}
+
+void resampler_filter_free(resampler_filter_t *filter) {
+    free(filter->coeffs);
+    filter->coeffs = NULL;
+}
+
+// Виділяє історію потоку; filter може бути NULL, якщо частота стане відома пізніше
+bool resampler_init(resampler_t *rs, const resampler_filter_t *filter, size_t max_in) {
+    memset(rs, 0, sizeof(*rs));
+    rs->filter = filter;
+    rs->max_in = max_in;
+    rs->work = (int16_t *)calloc(RESAMPLER_TAPS_DOWN - 1 + max_in, sizeof(int16_t));
+    return rs->work != NULL;
+}
+
+void resampler_free(resampler_t *rs) {
+    free(rs->work);
+    rs->work = NULL;
+    rs->filter = NULL;
+}
+
+// Перемикає фільтр (наприклад, після зміни профілю відправника) і скидає історію
+void resampler_set_filter(resampler_t *rs, const resampler_filter_t *filter) {
+    rs->filter = filter;
+    resampler_reset(rs);
+}
+
+void resampler_reset(resampler_t *rs) {
+    if (rs->work != NULL) {
+        memset(rs->work, 0, (RESAMPLER_TAPS_DOWN - 1) * sizeof(int16_t));
+    }
+    rs->acc = 0;
+}
+
+size_t resampler_process(resampler_t *rs, const int16_t *in, size_t in_len, int16_t *out, size_t max_out) {
+    const resampler_filter_t *f = rs->filter;
+    if (f == NULL) {
+        return 0;
+    }
+    if (f->passthrough) {
+        size_t n = in_len < max_out ? in_len : max_out;
+        memcpy(out, in, n * sizeof(int16_t));
+        rs->stats.overflowed += in_len - n;
+        return n;
+    }
+    if (in_len > rs->max_in) {
+        rs->stats.truncated += in_len - rs->max_in;
+        in_len = rs->max_in;
+    }
+
+    // Вхідний блок дописується за історією попереднього блоку
+    const size_t hist = f->taps - 1;
+    memcpy(rs->work + hist, in, in_len * sizeof(int16_t));
+
+    size_t count = 0;
+    const uint32_t end = in_len * f->up;
+    while (rs->acc < end && count < max_out) {
+        uint32_t i = rs->acc / f->up;
+        uint32_t phase = rs->acc % f->up;
+        const int16_t *h = f->coeffs + phase * f->taps;
+        const int16_t *x = rs->work + hist + i;
+
+        int32_t sum = 1 << 14;
+        for (int k = 0; k < f->taps; k++) {
+            sum += h[k] * x[-k];
+        }
+        sum >>= 15;
+        out[count++] = (int16_t)(sum > 32767 ? 32767 : (sum < -32768 ? -32768 : sum));
+        rs->acc += f->down;
+    }
+    // Вихід заповнився раніше, ніж закінчився блок: решта його семплів пропускається,
+    // але позиція йде далі по тій самій сітці, тож наступний блок не зсувається за фазою
+    if (rs->acc < end) {
+        uint32_t skipped = (end - rs->acc + f->down - 1) / f->down;
+        rs->stats.overflowed += skipped;
+        rs->acc += skipped * f->down;
+    }
+    rs->acc -= end;
+
+    memmove(rs->work, rs->work + in_len, hist * sizeof(int16_t));
+    return count;
+}
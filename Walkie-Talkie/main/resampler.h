@@ -0,0 +1,55 @@
+#ifndef MAIN_RESAMPLER_H_
+#define MAIN_RESAMPLER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Поліфазний перетворювач частоти дискретизації з раціональним коефіцієнтом L/M.
+// Фільтр для пари частот (resampler_filter_t) рахується один раз під час запуску і
+// далі лише читається, тож його спільно використовують усі потоки з цією парою.
+// Кожен потік (resampler_t) має лише власну історію відліків, розраховану на
+// найдовший фільтр, тому перемикання фільтра - заміна вказівника без виділення пам'яті.
+// Обробка - у фіксованій точці Q15.
+
+#define RESAMPLER_TAPS_DOWN 32      // Відводів на фазу при зниженні частоти
+#define RESAMPLER_TAPS_UP 16        // Відводів на фазу при підвищенні частоти
+#define RESAMPLER_KAISER_BETA 6.0f
+#define RESAMPLER_CUTOFF 0.85f      // Зріз відносно половини меншої з частот
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t up;                // L
+    uint32_t down;              // M
+    uint16_t taps;
+    bool passthrough;
+    int16_t *coeffs;            // up * taps коефіцієнтів, згруповані за фазами
+} resampler_filter_t;
+
+// Порушення меж блоку викликачем; кожне означає розрив звуку
+typedef struct {
+    uint32_t truncated;         // Відкинуто вхідних семплів понад max_in
+    uint32_t overflowed;        // Пропущено вихідних семплів, що не вмістилися в max_out
+} resampler_stats_t;
+
+typedef struct {
+    const resampler_filter_t *filter; // NULL - фільтр ще не вибрано, вихід порожній
+    int16_t *work;              // Історія (RESAMPLER_TAPS_DOWN - 1) + вхідний блок
+    size_t max_in;
+    uint32_t acc;               // Позиція наступного вихідного семпла в одиницях 1/L вхідного
+    resampler_stats_t stats;
+} resampler_t;
+
+bool resampler_filter_init(resampler_filter_t *filter, uint32_t in_rate, uint32_t out_rate);
+void resampler_filter_free(resampler_filter_t *filter);
+
+bool resampler_init(resampler_t *rs, const resampler_filter_t *filter, size_t max_in);
+void resampler_free(resampler_t *rs);
+void resampler_set_filter(resampler_t *rs, const resampler_filter_t *filter);
+void resampler_reset(resampler_t *rs);
+// Блок до max_in семплів дає до ceil(in_len * L / M) вихідних; що не вміщається
+// в max_out або max_in, відкидається і рахується в stats
+size_t resampler_process(resampler_t *rs, const int16_t *in, size_t in_len, int16_t *out, size_t max_out);
+
+#endif /* MAIN_RESAMPLER_H_ */
@@ -0,0 +1,134 @@
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "rt_sched.h"
+
+static const char *TAG = "Scheduler";
+
+static TaskHandle_t handles[RT_SCHED_MAX_TASKS];
+static int64_t last_report_us;
+
+// Перевірка таблиці: коректні ядра, пріоритети і стеки, а аудіозадачі
+// не можуть бути витіснені іншими задачами застосунку
+bool rt_sched_check(const rt_task_t *tasks, size_t count) {
+    bool ok = true;
+    UBaseType_t min_audio = configMAX_PRIORITIES;
+    UBaseType_t max_other = 0;
+
+    if (count > RT_SCHED_MAX_TASKS) {
+        ESP_LOGE(TAG, "Too many tasks: %u", (unsigned)count);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const rt_task_t *t = &tasks[i];
+        if (t->priority >= configMAX_PRIORITIES) {
+            ESP_LOGE(TAG, "%s: priority %u out of range", t->name, t->priority);
+            ok = false;
+        }
+        if (t->core != tskNO_AFFINITY && (t->core < 0 || t->core >= portNUM_PROCESSORS)) {
+            ESP_LOGE(TAG, "%s: invalid core %d", t->name, t->core);
+            ok = false;
+        }
+        if (t->stack_size < configMINIMAL_STACK_SIZE * sizeof(StackType_t)) {
+            ESP_LOGE(TAG, "%s: stack %" PRIu32 " below minimum", t->name, t->stack_size);
+            ok = false;
+        }
+        if (t->audio) {
+            min_audio = t->priority < min_audio ? t->priority : min_audio;
+            if (t->core != RT_CORE_AUDIO) {
+                ESP_LOGW(TAG, "%s: audio task is not pinned to the audio core", t->name);
+            }
+        } else {
+            max_other = t->priority > max_other ? t->priority : max_other;
+        }
+    }
+
+    if (min_audio <= max_other) {
+        ESP_LOGE(TAG, "Audio priority %u does not exceed application priority %u", min_audio, max_other);
+        ok = false;
+    }
+    return ok;
+}
+
+esp_err_t rt_sched_start(const rt_task_t *tasks, size_t count) {
+    if (!rt_sched_check(tasks, count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    last_report_us = esp_timer_get_time();
+    for (size_t i = 0; i < count; i++) {
+        const rt_task_t *t = &tasks[i];
+        if (xTaskCreatePinnedToCore(t->fn, t->name, t->stack_size, NULL, t->priority, &handles[i], t->core) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create task %s", t->name);
+            return ESP_ERR_NO_MEM;
+        }
+        // Задачі створюються по черзі, тож дескриптор доступний задачам з наступних рядків таблиці
+        if (t->handle) {
+            *t->handle = handles[i];
+        }
+        ESP_LOGI(TAG, "%s: core %d, priority %u, stack %" PRIu32, t->name, t->core, t->priority, t->stack_size);
+    }
+    return ESP_OK;
+}
+
+void rt_timing_init(rt_timing_t *timing, uint32_t budget_us) {
+    timing->busy_us = 0;
+    timing->max_us = 0;
+    timing->frames = 0;
+    timing->misses = 0;
+    timing->budget_us = budget_us;
+    portMUX_INITIALIZE(&timing->lock);
+}
+
+// Фіксує час оброблення одного кадру
+void rt_timing_record(rt_timing_t *timing, int64_t start_us, int64_t end_us) {
+    int64_t elapsed = end_us - start_us;
+
+    portENTER_CRITICAL(&timing->lock);
+    timing->busy_us += elapsed;
+    if (elapsed > timing->max_us) {
+        timing->max_us = elapsed;
+    }
+    timing->frames++;
+    if (elapsed > timing->budget_us) {
+        timing->misses++;
+    }
+    portEXIT_CRITICAL(&timing->lock);
+}
+
+// Звіт з моменту попереднього виклику: частка процесора, найдовший кадр,
+// пропущені дедлайни та мінімальний залишок стеку
+void rt_sched_report(const rt_task_t *tasks, size_t count) {
+    int64_t now = esp_timer_get_time();
+    int64_t window = now - last_report_us;
+    last_report_us = now;
+    if (window <= 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const rt_task_t *t = &tasks[i];
+        UBaseType_t stack_free = handles[i] ? uxTaskGetStackHighWaterMark(handles[i]) : 0;
+
+        if (t->timing == NULL) {
+            ESP_LOGI(TAG, "%s: stack free %u", t->name, stack_free);
+            continue;
+        }
+
+        rt_timing_t *timing = t->timing;
+        portENTER_CRITICAL(&timing->lock);
+        int64_t busy = timing->busy_us;
+        int64_t max = timing->max_us;
+        uint32_t frames = timing->frames;
+        uint32_t misses = timing->misses;
+        timing->busy_us = 0;
+        timing->max_us = 0;
+        portEXIT_CRITICAL(&timing->lock);
+
+        // Частка у десятих відсотка, щоб не використовувати float
+        uint32_t share = (uint32_t)(busy * 1000 / window);
+        ESP_LOGI(TAG, "%s: cpu %" PRIu32 ".%" PRIu32 "%%, max %" PRId64 "/%" PRIu32 " us, frames %" PRIu32 ", misses %" PRIu32 ", stack free %u",
+                 t->name, share / 10, share % 10, max, timing->budget_us, frames, misses, stack_free);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef MAIN_RT_SCHED_H_
+#define MAIN_RT_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+// Розкладка задач: пріоритет, стек і ядро кожної задачі задаються в одній таблиці.
+// Аудіозадачі закріплюються за окремим ядром і мають пріоритет вищий за решту
+// задач застосунку; таблиця перевіряється при запуску.
+// Облік часу рахує частку процесора та пропущені дедлайни аудіокадрів.
+
+#define RT_CORE_NETWORK 0           // Ядро Wi-Fi, lwIP та інтерфейсу
+#define RT_CORE_AUDIO 1             // Ядро захоплення, обробки та відтворення звуку
+#define RT_SCHED_MAX_TASKS 12
+
+typedef struct {
+    int64_t busy_us;            // Час роботи з моменту останнього звіту
+    int64_t max_us;             // Найдовший кадр з моменту останнього звіту
+    uint32_t frames;            // Оброблено кадрів
+    uint32_t misses;            // Кадрів, оброблення яких перевищило бюджет
+    uint32_t budget_us;         // Бюджет часу на кадр
+    portMUX_TYPE lock;
+} rt_timing_t;
+
+typedef struct {
+    TaskFunction_t fn;
+    const char *name;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core;
+    bool audio;                 // Задача реального часу аудіотракту
+    TaskHandle_t *handle;       // Куди зберегти дескриптор, може бути NULL
+    rt_timing_t *timing;        // Облік часу кадрів, може бути NULL
+} rt_task_t;
+
+bool rt_sched_check(const rt_task_t *tasks, size_t count);
+esp_err_t rt_sched_start(const rt_task_t *tasks, size_t count);
+void rt_sched_report(const rt_task_t *tasks, size_t count);
+
+void rt_timing_init(rt_timing_t *timing, uint32_t budget_us);
+void rt_timing_record(rt_timing_t *timing, int64_t start_us, int64_t end_us);
+
+#endif /* MAIN_RT_SCHED_H_ */
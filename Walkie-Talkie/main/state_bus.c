@@ -0,0 +1,85 @@
+#include <string.h>
+#include "state_bus.h"
+#include "esp_timer.h"
+
+void state_bus_init(state_bus_t *bus, const uint32_t initial[STATE_COUNT]) {
+    memset(bus, 0, sizeof(*bus));
+    for (int i = 0; i < STATE_COUNT; i++) {
+        bus->values[i] = initial[i];
+    }
+    portMUX_INITIALIZE(&bus->lock);
+}
+
+// Підписка задачі на зміни за маскою STATE_BUS_BIT(); викликається до запуску задач.
+// Дескриптор читається під час розсилки, тож задача може бути створена пізніше
+esp_err_t state_bus_subscribe(state_bus_t *bus, TaskHandle_t *task, uint32_t mask) {
+    if (bus->subscriber_count >= STATE_BUS_MAX_SUBSCRIBERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    bus->subscribers[bus->subscriber_count].task = task;
+    bus->subscribers[bus->subscriber_count].mask = mask;
+    bus->subscriber_count++;
+    return ESP_OK;
+}
+
+// Публікує значення стану. Повертає true і будить підписників, лише якщо значення
+// змінилося; сповіщення надсилається поза замком
+bool state_bus_set(state_bus_t *bus, state_id_t id, uint32_t value) {
+    // Швидкий шлях без замка для повторної публікації; під замком перевіряється ще раз
+    if (bus->values[id] == value) {
+        return false;
+    }
+    int64_t now_us = esp_timer_get_time();
+    bool changed = false;
+
+    portENTER_CRITICAL(&bus->lock);
+    if (bus->values[id] != value) {
+        bus->values[id] = value;
+        bus->changed_us[id] = now_us;
+        bus->changes++;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&bus->lock);
+
+    if (changed) {
+        uint32_t bit = STATE_BUS_BIT(id);
+        for (size_t i = 0; i < bus->subscriber_count; i++) {
+            TaskHandle_t task = *bus->subscribers[i].task;
+            if ((bus->subscribers[i].mask & bit) && task != NULL) {
+                xTaskNotify(task, bit, eSetBits);
+            }
+        }
+    }
+    return changed;
+}
+
+// Читання одного слова атомарне, тож гарячі шляхи (шифрування кожного кадру,
+// фільтр розмовної групи) читають значення без замка
+uint32_t state_bus_get(const state_bus_t *bus, state_id_t id) {
+    return bus->values[id];
+}
+
+// Значення разом із часом зміни, узгоджені між собою
+void state_bus_read(state_bus_t *bus, state_id_t id, state_value_t *state) {
+    portENTER_CRITICAL(&bus->lock);
+    state->value = bus->values[id];
+    state->changed_us = bus->changed_us[id];
+    portEXIT_CRITICAL(&bus->lock);
+}
+
+// Узгоджений знімок усіх станів для перемальовування інтерфейсу
+void state_bus_snapshot(state_bus_t *bus, state_value_t states[STATE_COUNT]) {
+    portENTER_CRITICAL(&bus->lock);
+    for (int i = 0; i < STATE_COUNT; i++) {
+        states[i].value = bus->values[i];
+        states[i].changed_us = bus->changed_us[i];
+    }
+    portEXIT_CRITICAL(&bus->lock);
+}
+
+uint32_t state_bus_changes(state_bus_t *bus) {
+    portENTER_CRITICAL(&bus->lock);
+    uint32_t changes = bus->changes;
+    portEXIT_CRITICAL(&bus->lock);
+    return changes;
+}
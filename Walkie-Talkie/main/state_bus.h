@@ -0,0 +1,61 @@
+#ifndef MAIN_STATE_BUS_H_
+#define MAIN_STATE_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+// Шина стану застосунку замість глобальних volatile прапорців. Кожен стан має значення
+// і час останньої зміни; публікація, що справді змінює значення, будить підписаних
+// задач бітом сповіщення (eSetBits), тож інтерфейс спить до зміни, а не опитує стани.
+// Біти шини займають старші розряди значення сповіщення і не перетинаються з подіями
+// служби кнопок, тому задача може чекати на обидва джерела одним xTaskNotifyWait.
+// Повторна публікація того ж значення (наприклад, прийом на кожен пакет) лише
+// порівнюється під замком і нікого не будить
+
+#define STATE_BUS_MAX_SUBSCRIBERS 4
+#define STATE_BUS_SHIFT 24          // Нижні розряди лишаються для INPUT_EVENT_BIT()
+
+typedef enum {
+    STATE_TRANSMIT,             // Передача ввімкнена кнопкою
+    STATE_RECEIVING,            // Надходять кадри від інших станцій
+    STATE_ENCRYPTION,           // Шифрування власних кадрів
+    STATE_TALKGROUP,            // Номер розмовної групи, PACKET_TALKGROUP_NONE - адресний режим
+    STATE_COUNT,
+} state_id_t;
+
+// Біт зміни стану у значенні сповіщення підписника
+#define STATE_BUS_BIT(id) (1u << (STATE_BUS_SHIFT + (id)))
+#define STATE_BUS_ALL (((1u << STATE_COUNT) - 1) << STATE_BUS_SHIFT)
+
+typedef struct {
+    uint32_t value;
+    int64_t changed_us;         // Час останньої зміни, 0 - значення з ініціалізації
+} state_value_t;
+
+typedef struct {
+    TaskHandle_t *task;         // Дескриптор задачі, може бути ще не створена
+    uint32_t mask;
+} state_bus_subscriber_t;
+
+typedef struct {
+    volatile uint32_t values[STATE_COUNT];
+    int64_t changed_us[STATE_COUNT];
+    uint32_t changes;           // Публікацій, що змінили значення
+    state_bus_subscriber_t subscribers[STATE_BUS_MAX_SUBSCRIBERS];
+    size_t subscriber_count;
+    portMUX_TYPE lock;
+} state_bus_t;
+
+void state_bus_init(state_bus_t *bus, const uint32_t initial[STATE_COUNT]);
+esp_err_t state_bus_subscribe(state_bus_t *bus, TaskHandle_t *task, uint32_t mask);
+bool state_bus_set(state_bus_t *bus, state_id_t id, uint32_t value);
+uint32_t state_bus_get(const state_bus_t *bus, state_id_t id);
+void state_bus_read(state_bus_t *bus, state_id_t id, state_value_t *state);
+void state_bus_snapshot(state_bus_t *bus, state_value_t states[STATE_COUNT]);
+uint32_t state_bus_changes(state_bus_t *bus);
+
+#endif /* MAIN_STATE_BUS_H_ */
@@ -0,0 +1,83 @@
+#include <string.h>
+#include "stream.h"
+
+// filter - спільний фільтр частота I2S -> rate; fec_group == 0 вимикає парність для потоку
+bool stream_tx_init(stream_tx_t *tx, const codec_t *codec, packet_rate_t rate, const resampler_filter_t *filter,
+                    size_t frame_samples, uint32_t session, uint8_t fec_group) {
+    memset(tx, 0, sizeof(*tx));
+    tx->codec = codec;
+    tx->rate = rate;
+    tx->session = session;
+    codec->reset(&tx->encoder);
+
+    size_t max_payload = codec->max_encoded_size(frame_samples);
+    if (!resampler_init(&tx->resampler, filter, frame_samples)) {
+        return false;
+    }
+    tx->use_fec = fec_group > 0;
+    if (tx->use_fec && !fec_encoder_init(&tx->fec, fec_group, max_payload)) {
+        stream_tx_free(tx);
+        return false;
+    }
+    return true;
+}
+
+void stream_tx_free(stream_tx_t *tx) {
+    resampler_free(&tx->resampler);
+    fec_encoder_free(&tx->fec);
+}
+
+bool stream_rx_init(stream_rx_t *rx, uint16_t jb_slots, size_t frame_bytes, uint32_t frame_period_us) {
+    memset(rx, 0, sizeof(*rx));
+    rx->rate = -1;
+    packet_replay_reset(&rx->replay);
+    packet_replay_reset(&rx->fec_replay);
+
+    // Фільтр перетворювача вибирається за частотою першого кадру
+    if (!jitter_buffer_init(&rx->jb, jb_slots, frame_bytes, frame_period_us) ||
+        !fec_decoder_init(&rx->fec, frame_bytes) ||
+        !resampler_init(&rx->resampler, NULL, frame_bytes / sizeof(int16_t))) {
+        stream_rx_free(rx);
+        return false;
+    }
+    return true;
+}
+
+void stream_rx_free(stream_rx_t *rx) {
+    jitter_buffer_free(&rx->jb);
+    fec_decoder_free(&rx->fec);
+    resampler_free(&rx->resampler);
+}
+
+// Дешева перевірка до дешифрування: чи може сесія зараз говорити в цьому потоці
+bool stream_rx_talker_check(const stream_rx_t *rx, uint32_t session, int64_t now_us) {
+    return !rx->has_talker || rx->talker == session || now_us - rx->talker_us >= STREAM_TALKER_HOLD_US;
+}
+
+// Після автентифікації: продовжує поточного мовця або закріплює потік за новим.
+// Стан декодера і номери попереднього мовця до нового потоку не стосуються;
+// джитер-буфер сам починає новий потік після паузи
+void stream_rx_talker_update(stream_rx_t *rx, uint32_t session, int64_t now_us) {
+    if (rx->has_talker && rx->talker != session) {
+        memset(&rx->decoder, 0, sizeof(rx->decoder));
+        packet_rx_stats_restart(&rx->stats);
+    }
+    rx->has_talker = true;
+    rx->talker = session;
+    rx->talker_us = now_us;
+}
+
+// Джитер-буфер читається під блокуванням викликача; tx може бути NULL
+void stream_get_stats(const stream_rx_t *rx, const stream_tx_t *tx, stream_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    jitter_buffer_get_stats(&rx->jb, &stats->jb);
+    stats->link = rx->stats;
+    fec_decoder_get_stats(&rx->fec, &stats->fec_rx);
+    stats->resampler_rx = rx->resampler.stats;
+    if (tx) {
+        stats->resampler_tx = tx->resampler.stats;
+    }
+    if (tx && tx->use_fec) {
+        fec_encoder_get_stats(&tx->fec, &stats->fec_tx);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MAIN_STREAM_H_
+#define MAIN_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "packet.h"
+#include "codec.h"
+#include "resampler.h"
+#include "jitter_buffer.h"
+#include "fec.h"
+
+// Стан одного аудіопотоку між двома пристроями. Передавач потоку веде номер,
+// мітку часу, стан кодера, перетворювач частоти та парність FEC; приймач - вікна
+// повторів, статистику, копії кадрів для FEC, стан декодера та джитер-буфер.
+// Клієнт має по одному потоку в кожному напрямку, сервер - пару на кожного піра.
+// У розмовній групі кілька станцій можуть надсилати кадри в той самий потік
+// прийому, тому він закріплюється за одним мовцем (сесією): кадри інших сесій
+// відкидаються ще до дешифрування, доки поточний мовець не мовчить
+// STREAM_TALKER_HOLD_US, як у рації, де канал займає один передавач.
+// Модуль не залежить від FreeRTOS, синхронізацію виконує викликач.
+
+typedef struct {
+    const codec_t *codec;
+    codec_state_t encoder;
+    packet_rate_t rate;         // Частота кодека
+    resampler_t resampler;      // Частота I2S -> частота кодека, спільний фільтр
+    uint32_t session;
+    uint16_t seq;
+    uint32_t timestamp;
+    bool use_fec;
+    fec_encoder_t fec;
+} stream_tx_t;
+
+#define STREAM_TALKER_HOLD_US PACKET_SESSION_HOLDOFF_US
+
+typedef struct {
+    jitter_buffer_t jb;
+    packet_replay_t replay;
+    packet_replay_t fec_replay; // Пакети парності повторюють номери кадрів, тому мають власне вікно
+    packet_rx_stats_t stats;
+    fec_decoder_t fec;
+    codec_state_t decoder;
+    resampler_t resampler;      // Частота потоку -> частота I2S, фільтр перемикається при зміні профілю
+    int rate;                   // Ідентифікатор частоти потоку, -1 до першого кадру
+    uint16_t talkgroup;         // Розмовна група останнього прийнятого кадру
+    bool has_talker;
+    uint32_t talker;            // Сесія мовця, якого відтворює потік
+    int64_t talker_us;          // Час його останнього автентифікованого пакета
+} stream_rx_t;
+
+// Знімок лічильників пари потоків для звіту
+typedef struct {
+    jb_stats_t jb;
+    packet_rx_stats_t link;
+    fec_decoder_stats_t fec_rx;
+    fec_encoder_stats_t fec_tx;
+    resampler_stats_t resampler_rx;
+    resampler_stats_t resampler_tx;
+} stream_stats_t;
+
+bool stream_tx_init(stream_tx_t *tx, const codec_t *codec, packet_rate_t rate, const resampler_filter_t *filter,
+                    size_t frame_samples, uint32_t session, uint8_t fec_group);
+void stream_tx_free(stream_tx_t *tx);
+
+bool stream_rx_init(stream_rx_t *rx, uint16_t jb_slots, size_t frame_bytes, uint32_t frame_period_us);
+void stream_rx_free(stream_rx_t *rx);
+bool stream_rx_talker_check(const stream_rx_t *rx, uint32_t session, int64_t now_us);
+void stream_rx_talker_update(stream_rx_t *rx, uint32_t session, int64_t now_us);
+
+void stream_get_stats(const stream_rx_t *rx, const stream_tx_t *tx, stream_stats_t *stats);
+
+#endif /* MAIN_STREAM_H_ */
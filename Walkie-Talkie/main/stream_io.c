@@ -0,0 +1,210 @@
+#include <errno.h>
+#include "stream_io.h"
+#include "esp_log.h"
+
+static const char *TAG = "Stream";
+
+// Дописує заголовок у резерв перед навантаженням, за потреби шифрує на місці і відправляє
+// на dest або, якщо dest == NULL, через підключений сокет. Тег GCM дописується після
+// навантаження, у режимі CTR тегу немає; буфер пакета звільняється в будь-якому разі
+bool stream_send_packet(const stream_link_t *link, packet_buf_t *pkt, const packet_header_t *hdr,
+                        const struct sockaddr_in *dest) {
+    uint8_t *payload = packet_buf_data(pkt);
+    uint8_t *header = packet_buf_push(pkt, PACKET_HEADER_SIZE);
+    packet_write_header(header, hdr);
+
+    bool ready = true;
+    if (hdr->flags & PACKET_FLAG_ENCRYPTED) {
+        uint8_t nonce[PACKET_NONCE_SIZE];
+        packet_nonce(hdr, nonce);
+        size_t tag_size = crypto_tag_size(link->crypto);
+        uint8_t *tag = tag_size ? packet_buf_put(pkt, tag_size) : NULL;
+        if (crypto_encrypt(link->crypto, nonce, header, PACKET_HEADER_SIZE, payload, payload, hdr->payload_len,
+                           tag) != ESP_OK) {
+            ESP_LOGE(TAG, "Encryption failed");
+            ready = false;
+        }
+    }
+
+    // Відправка даних по UDP
+    bool sent = false;
+    if (ready) {
+        int ret = dest ? transport_sendto(link->transport, dest, packet_buf_data(pkt), pkt->len)
+                       : transport_send(link->transport, packet_buf_data(pkt), pkt->len);
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Error occurred during sending: errno %d", errno);
+        }
+        sent = ret >= 0;
+    }
+    packet_buf_release(pkt);
+    return sent;
+}
+
+// Кодує кадр потоку (на частоті кодека) або дескриптор тиші одразу в буфер пакета і відправляє.
+// Пропущений кадр теж займає номер і час, тож приймач бачить справжню тривалість паузи.
+// Після останнього кадру групи FEC відправляється пакет парності з його номером і міткою часу.
+// group - номер розмовної групи в заголовку, PACKET_TALKGROUP_NONE для адресного потоку
+void stream_send_frame(stream_tx_t *tx, const stream_link_t *link, const struct sockaddr_in *dest, uint16_t group,
+                       bool encrypted, const int16_t *pcm, size_t samples, dtx_action_t action) {
+    uint16_t seq = tx->seq++;
+    uint32_t timestamp = tx->timestamp;
+    tx->timestamp += samples;
+    bool group_done = false;
+
+    if (action == DTX_SUPPRESS) {
+        group_done = tx->use_fec && fec_encoder_add(&tx->fec, seq, NULL, 0);
+    } else {
+        // Якщо пул вичерпано, кадр відкидається, лічильник веде пул
+        packet_buf_t *pkt = packet_buf_alloc(link->pool, PACKET_HEADER_SIZE);
+        uint8_t *payload = pkt ? packet_buf_data(pkt) : NULL;
+        size_t payload_len = 0;
+        if (pkt && action == DTX_SID) {
+            payload_len = dtx_write_sid(payload, dtx_level(pcm, samples));
+        } else if (pkt) {
+            payload_len = tx->codec->encode(&tx->encoder, pcm, samples, payload);
+        }
+
+        // Парність рахується по відкритому навантаженню аудіокадрів до шифрування на місці
+        if (tx->use_fec) {
+            group_done = fec_encoder_add(&tx->fec, seq, action == DTX_SEND ? payload : NULL, payload_len);
+        }
+
+        if (pkt) {
+            packet_buf_put(pkt, payload_len);
+            packet_header_t hdr = {
+                .flags = (encrypted ? PACKET_FLAG_ENCRYPTED : 0) | (action == DTX_SID ? PACKET_FLAG_SID : 0),
+                .codec = tx->codec->id,
+                .rate = tx->rate,
+                .session = tx->session,
+                .seq = seq,
+                .timestamp = timestamp,
+                .payload_len = payload_len,
+                .talkgroup = group
+            };
+            stream_send_packet(link, pkt, &hdr, dest);
+        }
+    }
+
+    packet_buf_t *parity = group_done ? packet_buf_alloc(link->pool, PACKET_HEADER_SIZE) : NULL;
+    if (parity) {
+        size_t parity_len = fec_encoder_write(&tx->fec, packet_buf_data(parity));
+        if (parity_len > 0) {
+            packet_buf_put(parity, parity_len);
+            packet_header_t hdr = {
+                .flags = (encrypted ? PACKET_FLAG_ENCRYPTED : 0) | PACKET_FLAG_FEC,
+                .codec = tx->codec->id,
+                .rate = tx->rate,
+                .session = tx->session,
+                .seq = seq,
+                .timestamp = timestamp,
+                .payload_len = parity_len,
+                .talkgroup = group
+            };
+            stream_send_packet(link, parity, &hdr, dest);
+        } else {
+            packet_buf_release(parity);
+        }
+    }
+}
+
+// Перевірка, дешифрування і декодування одного пакета потоку rx з уже розібраним
+// заголовком і поміщення кадру в його джитер-буфер. Викликач синхронізує доступ до rx
+stream_rx_result_t stream_receive_packet(stream_rx_t *rx, const stream_rx_config_t *cfg, const packet_header_t *hdr,
+                                         uint8_t *buf, size_t len, int64_t now_us, int32_t *sid_level) {
+    const codec_t *codec = codec_find(hdr->codec);
+    bool encrypted = (hdr->flags & PACKET_FLAG_ENCRYPTED) != 0;
+    bool parity = (hdr->flags & PACKET_FLAG_FEC) != 0;
+    size_t max_payload = cfg->frame_samples * sizeof(int16_t) + (parity ? FEC_HEADER_SIZE : 0);
+    if (codec == NULL || hdr->payload_len > max_payload ||
+        (encrypted && len < PACKET_HEADER_SIZE + hdr->payload_len + crypto_tag_size(cfg->crypto))) {
+        rx->stats.invalid++;
+        return STREAM_RX_DROPPED;
+    }
+    // Чужа розмовна група відкидається до дешифрування. Сервер приймає ще й адресні
+    // потоки своїх станцій, клієнт у розмовній групі чує лише її
+    bool member = hdr->talkgroup == cfg->talkgroup ||
+                  (cfg->accept_direct && hdr->talkgroup == PACKET_TALKGROUP_NONE);
+    if (!member) {
+        rx->stats.other_group++;
+        return STREAM_RX_DROPPED;
+    }
+    // З увімкненим шифруванням незахищені пакети не приймаються: інакше рішення про
+    // автентифікацію залежало б від прапорця, який виставляє сам відправник.
+    // Автентифікує лише GCM; у режимі CTR це тільки вимога конфіденційності
+    if (!encrypted && cfg->require_encryption) {
+        rx->stats.auth_failed++;
+        return STREAM_RX_DROPPED;
+    }
+    // Потік відтворює одного мовця; інші сесії чекають, доки він замовкне
+    if (!stream_rx_talker_check(rx, hdr->session, now_us)) {
+        rx->stats.other_talker++;
+        return STREAM_RX_DROPPED;
+    }
+    // Вікно повторів перевіряється до дешифрування, щоб сміттєві пакети коштували мало
+    packet_replay_t *window = parity ? &rx->fec_replay : &rx->replay;
+    if (!packet_replay_check(window, hdr, now_us)) {
+        rx->stats.replayed++;
+        return STREAM_RX_DROPPED;
+    }
+
+    // Дешифрування на місці, якщо пакет зашифрований; пакет з невірним тегом не відтворюється
+    uint8_t *payload = PACKET_PAYLOAD(buf);
+    if (encrypted) {
+        uint8_t nonce[PACKET_NONCE_SIZE];
+        packet_nonce(hdr, nonce);
+        esp_err_t ret = crypto_decrypt(cfg->crypto, nonce, buf, PACKET_HEADER_SIZE, payload,
+                                       payload, hdr->payload_len, payload + hdr->payload_len);
+        if (ret != ESP_OK) {
+            rx->stats.auth_failed++;
+            return STREAM_RX_DROPPED;
+        }
+    }
+    packet_replay_update(window, hdr, now_us);
+    stream_rx_talker_update(rx, hdr->session, now_us);
+
+    // Пакет парності не відтворюється сам, а лише повертає поодиноку втрату своєї групи
+    const uint8_t *frame = payload;
+    size_t frame_len = hdr->payload_len;
+    uint16_t frame_seq = hdr->seq;
+    if (parity) {
+        frame = fec_decoder_recover(&rx->fec, hdr->session, hdr->seq, payload, hdr->payload_len,
+                                    &frame_seq, &frame_len);
+        if (frame == NULL) {
+            return STREAM_RX_PARITY;
+        }
+    } else {
+        packet_rx_stats_update(&rx->stats, hdr->seq);
+        rx->talkgroup = hdr->talkgroup;
+    }
+
+    // Дескриптор тиші лише несе рівень комфортного шуму, у джитер-буфер він не потрапляє
+    if (hdr->flags & PACKET_FLAG_SID) {
+        if (!dtx_parse_sid(payload, hdr->payload_len, sid_level)) {
+            rx->stats.invalid++;
+            return STREAM_RX_AUDIO;
+        }
+        return STREAM_RX_SID;
+    }
+    if (!parity) {
+        fec_decoder_add(&rx->fec, hdr->session, hdr->seq, payload, hdr->payload_len);
+    }
+
+    // Декодування кадру в PCM
+    size_t samples = codec->decode(&rx->decoder, frame, frame_len, cfg->pcm, cfg->frame_samples);
+
+    // Частоту вже перевірено під час розбору заголовка
+    if (hdr->rate != rx->rate) {
+        resampler_set_filter(&rx->resampler, &cfg->filters[hdr->rate]);
+        rx->rate = hdr->rate;
+    }
+    size_t play_samples = resampler_process(&rx->resampler, cfg->pcm, samples, cfg->play_pcm, cfg->frame_samples);
+
+    // Передача кадру в джитер-буфер, звідки його забере задача відтворення чи мікшер.
+    // Відновлений кадр не враховується в оцінці джитера
+    if (parity) {
+        jitter_buffer_insert(&rx->jb, frame_seq, (uint8_t *)cfg->play_pcm, play_samples * 2);
+        return STREAM_RX_PARITY;
+    }
+    jitter_buffer_push(&rx->jb, frame_seq, (uint8_t *)cfg->play_pcm, play_samples * 2, now_us);
+    return STREAM_RX_AUDIO;
+}
@@ -0,0 +1,56 @@
+#ifndef MAIN_STREAM_IO_H_
+#define MAIN_STREAM_IO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stream.h"
+#include "transport.h"
+#include "packet_pool.h"
+#include "crypto.h"
+#include "dtx.h"
+
+// Відправка і прийом пакетів потоків (stream.h): кадр кодується одразу в буфер
+// пулу, шифрується на місці і йде в транспорт; пакет, що прийшов, проходить
+// дешеві перевірки (група, мовець, вікно повторів) до дешифрування, а
+// автентифікований кадр декодується в джитер-буфер потоку.
+// Модуль не залежить від задач і стану застосунку: ключ, транспорт, пул і умови
+// прийому передає викликач, тож увесь шлях пакета перевіряється на хості
+// через петлю транспорту.
+
+// Спільне для потоків однієї задачі відправки. Кожна задача має власну
+// криптографічну сесію, транспорт і пул спільні
+typedef struct {
+    transport_t *transport;
+    packet_pool_t *pool;
+    crypto_session_t *crypto;
+} stream_link_t;
+
+// Умови прийому і робочі буфери задачі прийому
+typedef struct {
+    crypto_session_t *crypto;
+    const resampler_filter_t *filters;  // Фільтр частота потоку -> частота I2S для кожного packet_rate_t
+    uint16_t talkgroup;                 // Розмовна група приймача, PACKET_TALKGROUP_NONE - адресний режим
+    bool accept_direct;                 // Приймати й адресні потоки поза групою (сервер)
+    bool require_encryption;            // Незашифровані пакети відкидаються
+    size_t frame_samples;               // Найбільший кадр у семплах, він же обмежує навантаження
+    int16_t *pcm;                       // Робочі буфери на frame_samples семплів
+    int16_t *play_pcm;
+} stream_rx_config_t;
+
+typedef enum {
+    STREAM_RX_DROPPED,          // Відкинуто, причина в лічильниках rx->stats
+    STREAM_RX_AUDIO,            // Автентифікований аудіопакет, кадр у джитер-буфері
+    STREAM_RX_SID,              // Автентифікований дескриптор тиші, рівень у *sid_level
+    STREAM_RX_PARITY,           // Автентифікований пакет парності; відновлений кадр у джитер-буфері
+} stream_rx_result_t;
+
+bool stream_send_packet(const stream_link_t *link, packet_buf_t *pkt, const packet_header_t *hdr,
+                        const struct sockaddr_in *dest);
+void stream_send_frame(stream_tx_t *tx, const stream_link_t *link, const struct sockaddr_in *dest, uint16_t group,
+                       bool encrypted, const int16_t *pcm, size_t samples, dtx_action_t action);
+
+stream_rx_result_t stream_receive_packet(stream_rx_t *rx, const stream_rx_config_t *cfg, const packet_header_t *hdr,
+                                         uint8_t *buf, size_t len, int64_t now_us, int32_t *sid_level);
+
+#endif /* MAIN_STREAM_IO_H_ */
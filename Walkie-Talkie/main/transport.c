@@ -0,0 +1,494 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "transport.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#define LOCK_INITIALIZER portMUX_INITIALIZER_UNLOCKED
+#define LOCK_INIT(lock) portMUX_INITIALIZE(lock)
+#define LOCK(lock) portENTER_CRITICAL(lock)
+#define UNLOCK(lock) portEXIT_CRITICAL(lock)
+#else
+#include <stdio.h>
+#include <unistd.h>
+#define ESP_LOGI(tag, fmt, ...) fprintf(stderr, "I %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define LOCK_INIT(lock) pthread_mutex_init(lock, NULL)
+#define LOCK(lock) pthread_mutex_lock(lock)
+#define UNLOCK(lock) pthread_mutex_unlock(lock)
+#endif
+
+static const char *TAG = "Transport";
+
+static int socket_backend_socket(int domain, int type, int protocol) {
+    return socket(domain, type, protocol);
+}
+
+static int socket_backend_bind(int fd, const struct sockaddr *addr, socklen_t addrlen) {
+    return bind(fd, addr, addrlen);
+}
+
+static int socket_backend_connect(int fd, const struct sockaddr *addr, socklen_t addrlen) {
+    return connect(fd, addr, addrlen);
+}
+
+static int socket_backend_setsockopt(int fd, int level, int optname, const void *optval, socklen_t optlen) {
+    return setsockopt(fd, level, optname, optval, optlen);
+}
+
+static ssize_t socket_backend_send(int fd, const void *buf, size_t len, int flags) {
+    return send(fd, buf, len, flags);
+}
+
+static ssize_t socket_backend_sendto(int fd, const void *buf, size_t len, int flags, const struct sockaddr *addr, socklen_t addrlen) {
+    return sendto(fd, buf, len, flags, addr, addrlen);
+}
+
+static ssize_t socket_backend_recvfrom(int fd, void *buf, size_t len, int flags, struct sockaddr *addr, socklen_t *addrlen) {
+    return recvfrom(fd, buf, len, flags, addr, addrlen);
+}
+
+static int socket_backend_close(int fd) {
+    return close(fd);
+}
+
+const transport_backend_t transport_socket_backend = {
+    .name = "socket",
+    .socket = socket_backend_socket,
+    .bind = socket_backend_bind,
+    .connect = socket_backend_connect,
+    .setsockopt = socket_backend_setsockopt,
+    .send = socket_backend_send,
+    .sendto = socket_backend_sendto,
+    .recvfrom = socket_backend_recvfrom,
+    .close = socket_backend_close,
+};
+
+typedef struct {
+    uint16_t len;
+    struct sockaddr_in src;
+    uint8_t data[TRANSPORT_LOOPBACK_MTU];
+} loopback_datagram_t;
+
+typedef struct {
+    bool used;
+    uint16_t port;              // Прив'язаний порт у мережевому порядку, 0 - не прив'язаний
+    bool connected;
+    struct sockaddr_in peer;
+    loopback_datagram_t *queue; // Кільце з TRANSPORT_LOOPBACK_QUEUE датаграм
+    uint8_t head;
+    uint8_t count;
+} loopback_socket_t;
+
+static loopback_socket_t loopback[TRANSPORT_LOOPBACK_SOCKETS];
+static transport_lock_t loopback_lock = LOCK_INITIALIZER;
+
+// Сокет за дескриптором; викликається під loopback_lock
+static loopback_socket_t *loopback_get(int fd) {
+    if (fd < 0 || fd >= TRANSPORT_LOOPBACK_SOCKETS || !loopback[fd].used) {
+        errno = EBADF;
+        return NULL;
+    }
+    return &loopback[fd];
+}
+
+static int loopback_socket(int domain, int type, int protocol) {
+    if (domain != AF_INET || type != SOCK_DGRAM) {
+        errno = EPROTONOSUPPORT;
+        return -1;
+    }
+    loopback_datagram_t *queue = (loopback_datagram_t *)calloc(TRANSPORT_LOOPBACK_QUEUE, sizeof(loopback_datagram_t));
+    if (queue == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    LOCK(&loopback_lock);
+    for (int fd = 0; fd < TRANSPORT_LOOPBACK_SOCKETS; fd++) {
+        if (!loopback[fd].used) {
+            memset(&loopback[fd], 0, sizeof(loopback[fd]));
+            loopback[fd].used = true;
+            loopback[fd].queue = queue;
+            UNLOCK(&loopback_lock);
+            return fd;
+        }
+    }
+    UNLOCK(&loopback_lock);
+    free(queue);
+    errno = EMFILE;
+    return -1;
+}
+
+// Петля стоїть за кількома станціями в одному процесі, тож порт може бути
+// прив'язаний кількома сокетами, як порт розмовної групи на різних пристроях:
+// кожен з них отримує свою копію датаграми
+static int loopback_bind(int fd, const struct sockaddr *addr, socklen_t addrlen) {
+    const struct sockaddr_in *in = (const struct sockaddr_in *)addr;
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    if (sock != NULL) {
+        sock->port = in->sin_port;
+    }
+    UNLOCK(&loopback_lock);
+    return sock != NULL ? 0 : -1;
+}
+
+static int loopback_connect(int fd, const struct sockaddr *addr, socklen_t addrlen) {
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    if (sock != NULL) {
+        sock->peer = *(const struct sockaddr_in *)addr;
+        sock->connected = true;
+    }
+    UNLOCK(&loopback_lock);
+    return sock != NULL ? 0 : -1;
+}
+
+// Таймаут, групи і широкомовлення петлі не потрібні: доставка йде за портом
+static int loopback_setsockopt(int fd, int level, int optname, const void *optval, socklen_t optlen) {
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    UNLOCK(&loopback_lock);
+    return sock != NULL ? 0 : -1;
+}
+
+static ssize_t loopback_sendto(int fd, const void *buf, size_t len, int flags, const struct sockaddr *addr, socklen_t addrlen) {
+    const struct sockaddr_in *dest = (const struct sockaddr_in *)addr;
+    if (len > TRANSPORT_LOOPBACK_MTU) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    if (sock == NULL) {
+        UNLOCK(&loopback_lock);
+        return -1;
+    }
+    // Неприв'язаний відправник отримує тимчасовий порт за дескриптором
+    struct sockaddr_in src = {
+        .sin_family = AF_INET,
+        .sin_port = sock->port ? sock->port : htons(49152 + fd),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    // Як і в UDP, датаграма для переповненої черги мовчки губиться
+    for (int i = 0; i < TRANSPORT_LOOPBACK_SOCKETS; i++) {
+        loopback_socket_t *rx = &loopback[i];
+        if (rx->used && rx->port == dest->sin_port && rx->count < TRANSPORT_LOOPBACK_QUEUE) {
+            loopback_datagram_t *dgram = &rx->queue[(rx->head + rx->count) % TRANSPORT_LOOPBACK_QUEUE];
+            dgram->len = len;
+            dgram->src = src;
+            memcpy(dgram->data, buf, len);
+            rx->count++;
+        }
+    }
+    UNLOCK(&loopback_lock);
+    return len;
+}
+
+static ssize_t loopback_send(int fd, const void *buf, size_t len, int flags) {
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    struct sockaddr_in peer;
+    bool connected = sock != NULL && sock->connected;
+    if (connected) {
+        peer = sock->peer;
+    }
+    UNLOCK(&loopback_lock);
+    if (!connected) {
+        if (sock != NULL) {
+            errno = ENOTCONN;
+        }
+        return -1;
+    }
+    return loopback_sendto(fd, buf, len, flags, (const struct sockaddr *)&peer, sizeof(peer));
+}
+
+// Датаграма, довша за буфер, обрізається, як у UDP
+static ssize_t loopback_recvfrom(int fd, void *buf, size_t len, int flags, struct sockaddr *addr, socklen_t *addrlen) {
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    if (sock == NULL || sock->count == 0) {
+        if (sock != NULL) {
+            errno = EAGAIN;
+        }
+        UNLOCK(&loopback_lock);
+        return -1;
+    }
+    loopback_datagram_t *dgram = &sock->queue[sock->head];
+    size_t n = dgram->len < len ? dgram->len : len;
+    memcpy(buf, dgram->data, n);
+    if (addr != NULL && addrlen != NULL && *addrlen >= sizeof(struct sockaddr_in)) {
+        memcpy(addr, &dgram->src, sizeof(struct sockaddr_in));
+        *addrlen = sizeof(struct sockaddr_in);
+    }
+    sock->head = (sock->head + 1) % TRANSPORT_LOOPBACK_QUEUE;
+    sock->count--;
+    UNLOCK(&loopback_lock);
+    return n;
+}
+
+static int loopback_close(int fd) {
+    LOCK(&loopback_lock);
+    loopback_socket_t *sock = loopback_get(fd);
+    loopback_datagram_t *queue = sock ? sock->queue : NULL;
+    if (sock != NULL) {
+        memset(sock, 0, sizeof(*sock));
+    }
+    UNLOCK(&loopback_lock);
+    free(queue);
+    return sock != NULL ? 0 : -1;
+}
+
+const transport_backend_t transport_loopback_backend = {
+    .name = "loopback",
+    .socket = loopback_socket,
+    .bind = loopback_bind,
+    .connect = loopback_connect,
+    .setsockopt = loopback_setsockopt,
+    .send = loopback_send,
+    .sendto = loopback_sendto,
+    .recvfrom = loopback_recvfrom,
+    .close = loopback_close,
+};
+
+// Пошук запису піра за адресою, новий запис створюється за потреби. Коли таблиця
+// заповнена, новий пір витісняє той, що найдовше не мав пакетів, тож адреси
+// станцій, що пішли, не займають таблицю назавжди. Викликається під блокуванням
+static transport_peer_t *find_peer(transport_t *t, uint32_t addr) {
+    transport_peer_t *slot = NULL;
+    uint32_t now = ++t->activity;
+    for (int i = 0; i < TRANSPORT_MAX_PEERS; i++) {
+        transport_peer_t *peer = &t->peers[i];
+        if (peer->used && peer->addr == addr) {
+            peer->last_active = now;
+            return peer;
+        }
+        if (slot == NULL || (slot->used && (!peer->used || now - peer->last_active > now - slot->last_active))) {
+            slot = peer;
+        }
+    }
+    if (slot->used) {
+        t->evicted++;
+    }
+    memset(slot, 0, sizeof(*slot));
+    slot->used = true;
+    slot->addr = addr;
+    slot->last_active = now;
+    return slot;
+}
+
+static void count_errno(transport_peer_t *peer, int err) {
+    peer->tx_errors++;
+    for (int i = 0; i < TRANSPORT_ERRNO_SLOTS - 1; i++) {
+        if (peer->errnos[i].count == 0) {
+            peer->errnos[i].err = err;
+        }
+        if (peer->errnos[i].err == err) {
+            peer->errnos[i].count++;
+            return;
+        }
+    }
+    peer->errnos[TRANSPORT_ERRNO_SLOTS - 1].err = -1;
+    peer->errnos[TRANSPORT_ERRNO_SLOTS - 1].count++;
+}
+
+static void account_tx(transport_t *t, uint32_t addr, int ret, int err) {
+    LOCK(&t->lock);
+    transport_peer_t *peer = find_peer(t, addr);
+    if (ret < 0) {
+        count_errno(peer, err);
+    } else {
+        peer->tx_packets++;
+        peer->tx_bytes += ret;
+    }
+    UNLOCK(&t->lock);
+}
+
+bool transport_open(transport_t *t, const transport_backend_t *backend, uint16_t port, uint32_t rx_timeout_ms) {
+    memset(t, 0, sizeof(*t));
+    t->backend = backend;
+    t->tx_sock = -1;
+    t->rx_sock = -1;
+    LOCK_INIT(&t->lock);
+
+    // Сокет для прийому прив'язується до порту один раз
+    t->rx_sock = backend->socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (t->rx_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create receive socket: errno %d", errno);
+        return false;
+    }
+
+    struct sockaddr_in local_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (backend->bind(t->rx_sock, (struct sockaddr *)&local_addr, sizeof(local_addr)) < 0) {
+        ESP_LOGE(TAG, "Unable to bind port %u: errno %d", port, errno);
+        transport_close(t);
+        return false;
+    }
+
+    // Таймаут прийому, щоб задача могла реагувати на відсутність даних
+    struct timeval timeout = {
+        .tv_sec = rx_timeout_ms / 1000,
+        .tv_usec = (rx_timeout_ms % 1000) * 1000,
+    };
+    backend->setsockopt(t->rx_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    t->tx_sock = backend->socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (t->tx_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create send socket: errno %d", errno);
+        transport_close(t);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Transport open on port %u (%s backend)", port, backend->name);
+    return true;
+}
+
+void transport_close(transport_t *t) {
+    transport_leave_group(t);
+    if (t->rx_sock >= 0) {
+        t->backend->close(t->rx_sock);
+        t->rx_sock = -1;
+    }
+    if (t->tx_sock >= 0) {
+        t->backend->close(t->tx_sock);
+        t->tx_sock = -1;
+    }
+    t->connected = false;
+}
+
+// Підключений UDP-сокет не шукає маршрут і адресу для кожного пакета
+bool transport_connect(transport_t *t, const struct sockaddr_in *peer) {
+    if (t->backend->connect(t->tx_sock, (const struct sockaddr *)peer, sizeof(*peer)) < 0) {
+        ESP_LOGE(TAG, "Unable to connect send socket: errno %d", errno);
+        t->connected = false;
+        return false;
+    }
+    t->tx_peer = *peer;
+    t->connected = true;
+    return true;
+}
+
+// Адреса розмовних груп: multicast-група, до якої приєднується сокет прийому,
+// або широкомовна адреса підмережі. Кадр групі відправляється один раз через
+// transport_sendto(), а не окремою копією кожному слухачу
+bool transport_join_group(transport_t *t, const struct sockaddr_in *group) {
+    transport_leave_group(t);
+
+    if (IN_MULTICAST(ntohl(group->sin_addr.s_addr))) {
+        struct ip_mreq mreq = {
+            .imr_multiaddr.s_addr = group->sin_addr.s_addr,
+            .imr_interface.s_addr = htonl(INADDR_ANY),
+        };
+        if (t->backend->setsockopt(t->rx_sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            ESP_LOGE(TAG, "Unable to join multicast group: errno %d", errno);
+            return false;
+        }
+        t->group_joined = true;
+
+        // Група не виходить за межі точки доступу, власні пакети не повертаються
+        uint8_t ttl = 1;
+        uint8_t loop = 0;
+        t->backend->setsockopt(t->tx_sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        t->backend->setsockopt(t->tx_sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    } else {
+        int broadcast = 1;
+        if (t->backend->setsockopt(t->tx_sock, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) < 0) {
+            ESP_LOGE(TAG, "Unable to enable broadcast: errno %d", errno);
+            return false;
+        }
+    }
+
+    t->group = *group;
+    ESP_LOGI(TAG, "Talkgroup address %s:%u", inet_ntoa(group->sin_addr), ntohs(group->sin_port));
+    return true;
+}
+
+void transport_leave_group(transport_t *t) {
+    if (t->group_joined) {
+        struct ip_mreq mreq = {
+            .imr_multiaddr.s_addr = t->group.sin_addr.s_addr,
+            .imr_interface.s_addr = htonl(INADDR_ANY),
+        };
+        t->backend->setsockopt(t->rx_sock, IPPROTO_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+        t->group_joined = false;
+    }
+}
+
+int transport_send(transport_t *t, const void *buf, size_t len) {
+    if (!t->connected) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    int ret = t->backend->send(t->tx_sock, buf, len, 0);
+    account_tx(t, t->tx_peer.sin_addr.s_addr, ret, errno);
+    return ret;
+}
+
+int transport_sendto(transport_t *t, const struct sockaddr_in *dest, const void *buf, size_t len) {
+    int ret = t->backend->sendto(t->tx_sock, buf, len, 0, (const struct sockaddr *)dest, sizeof(*dest));
+    account_tx(t, dest->sin_addr.s_addr, ret, errno);
+    return ret;
+}
+
+int transport_recv(transport_t *t, void *buf, size_t len, struct sockaddr_in *src) {
+    socklen_t socklen = sizeof(*src);
+    int ret = t->backend->recvfrom(t->rx_sock, buf, len, 0, (struct sockaddr *)src, &socklen);
+    if (ret < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN) {
+            t->rx_timeouts++;
+        } else {
+            t->rx_errors++;
+        }
+        return ret;
+    }
+
+    LOCK(&t->lock);
+    transport_peer_t *peer = find_peer(t, src->sin_addr.s_addr);
+    peer->rx_packets++;
+    peer->rx_bytes += ret;
+    UNLOCK(&t->lock);
+    return ret;
+}
+
+bool transport_get_peer(transport_t *t, uint32_t addr, transport_peer_t *out) {
+    bool found = false;
+    LOCK(&t->lock);
+    for (int i = 0; i < TRANSPORT_MAX_PEERS; i++) {
+        if (t->peers[i].used && t->peers[i].addr == addr) {
+            *out = t->peers[i];
+            found = true;
+            break;
+        }
+    }
+    UNLOCK(&t->lock);
+    return found;
+}
+
+void transport_log_stats(transport_t *t) {
+    transport_peer_t peers[TRANSPORT_MAX_PEERS];
+    LOCK(&t->lock);
+    memcpy(peers, t->peers, sizeof(peers));
+    UNLOCK(&t->lock);
+
+    ESP_LOGI(TAG, "rx timeouts %" PRIu32 ", rx errors %" PRIu32 ", evicted peers %" PRIu32,
+             t->rx_timeouts, t->rx_errors, t->evicted);
+    for (int i = 0; i < TRANSPORT_MAX_PEERS; i++) {
+        if (!peers[i].used) {
+            continue;
+        }
+        struct in_addr addr = { .s_addr = peers[i].addr };
+        ESP_LOGI(TAG, "%s: tx %" PRIu32 " pkts/%" PRIu32 " B, rx %" PRIu32 " pkts/%" PRIu32 " B, tx errors %" PRIu32,
+                 inet_ntoa(addr), peers[i].tx_packets, peers[i].tx_bytes, peers[i].rx_packets, peers[i].rx_bytes, peers[i].tx_errors);
+        for (int j = 0; j < TRANSPORT_ERRNO_SLOTS; j++) {
+            if (peers[i].errnos[j].count > 0) {
+                ESP_LOGI(TAG, "    errno %d: %" PRIu32, peers[i].errnos[j].err, peers[i].errnos[j].count);
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef MAIN_TRANSPORT_H_
+#define MAIN_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Транспорт з довготривалими сокетами: один підключений (connect) сокет для
+// відправки та один прив'язаний (bind) сокет для прийому. Сокет прийому може
+// також приєднатися до групової (multicast) або широкомовної адреси розмовних груп.
+// Системні виклики йдуть через змінний бекенд: BSD-сокети (lwIP на ESP32, POSIX
+// на інших платформах) або петля в пам'яті для перевірки без мережі.
+// Від платформи беруться лише заголовки сокетів і короткий замок лічильників пірів,
+// тож поза ESP-IDF модуль збирається з POSIX-сокетами і м'ютексом pthread.
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "lwip/sockets.h"
+typedef portMUX_TYPE transport_lock_t;
+#else
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+typedef pthread_mutex_t transport_lock_t;
+#endif
+
+#define TRANSPORT_MAX_PEERS 10          // Усі піри конференції та запас; найдовше неактивний витісняється
+#define TRANSPORT_ERRNO_SLOTS 6         // Останній слот збирає решту кодів помилок
+#define TRANSPORT_LOOPBACK_SOCKETS 8    // Сокетів у петлі
+#define TRANSPORT_LOOPBACK_QUEUE 16     // Датаграм у черзі прийому сокета петлі
+#define TRANSPORT_LOOPBACK_MTU 1500
+
+typedef struct {
+    const char *name;
+    int (*socket)(int domain, int type, int protocol);
+    int (*bind)(int fd, const struct sockaddr *addr, socklen_t addrlen);
+    int (*connect)(int fd, const struct sockaddr *addr, socklen_t addrlen);
+    int (*setsockopt)(int fd, int level, int optname, const void *optval, socklen_t optlen);
+    ssize_t (*send)(int fd, const void *buf, size_t len, int flags);
+    ssize_t (*sendto)(int fd, const void *buf, size_t len, int flags, const struct sockaddr *addr, socklen_t addrlen);
+    ssize_t (*recvfrom)(int fd, void *buf, size_t len, int flags, struct sockaddr *addr, socklen_t *addrlen);
+    int (*close)(int fd);
+} transport_backend_t;
+
+// Бекенд на BSD-сокетах (lwIP на ESP32, POSIX на інших платформах)
+extern const transport_backend_t transport_socket_backend;
+// Петля в пам'яті: датаграма доставляється всім сокетам, прив'язаним до порту
+// призначення, з адресою джерела 127.0.0.1. Прийом не блокується: порожня черга
+// повертає EAGAIN, як сокет із вичерпаним таймаутом
+extern const transport_backend_t transport_loopback_backend;
+
+typedef struct {
+    int err;
+    uint32_t count;
+} transport_errno_count_t;
+
+typedef struct {
+    bool used;
+    uint32_t addr;              // IPv4 адреса в мережевому порядку
+    uint32_t tx_packets;
+    uint32_t tx_bytes;
+    uint32_t tx_errors;
+    uint32_t rx_packets;
+    uint32_t rx_bytes;
+    uint32_t last_active;       // Значення лічильника активності транспорту при останньому пакеті
+    transport_errno_count_t errnos[TRANSPORT_ERRNO_SLOTS];
+} transport_peer_t;
+
+typedef struct {
+    const transport_backend_t *backend;
+    int tx_sock;
+    int rx_sock;
+    struct sockaddr_in tx_peer;
+    bool connected;
+    struct sockaddr_in group;   // Адреса розмовних груп
+    bool group_joined;          // Членство в multicast-групі на сокеті прийому
+    uint32_t rx_timeouts;
+    uint32_t rx_errors;
+    uint32_t activity;          // Лічильник пакетів для вибору найдовше неактивного піра
+    uint32_t evicted;           // Витіснено записів пірів
+    transport_peer_t peers[TRANSPORT_MAX_PEERS];
+    transport_lock_t lock;
+} transport_t;
+
+bool transport_open(transport_t *t, const transport_backend_t *backend, uint16_t port, uint32_t rx_timeout_ms);
+void transport_close(transport_t *t);
+bool transport_connect(transport_t *t, const struct sockaddr_in *peer);
+bool transport_join_group(transport_t *t, const struct sockaddr_in *group);
+void transport_leave_group(transport_t *t);
+int transport_send(transport_t *t, const void *buf, size_t len);
+int transport_sendto(transport_t *t, const struct sockaddr_in *dest, const void *buf, size_t len);
+int transport_recv(transport_t *t, void *buf, size_t len, struct sockaddr_in *src);
+bool transport_get_peer(transport_t *t, uint32_t addr, transport_peer_t *out);
+void transport_log_stats(transport_t *t);
+
+#endif /* MAIN_TRANSPORT_H_ */
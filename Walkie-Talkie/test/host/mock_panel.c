@@ -0,0 +1,266 @@
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "mock_panel.h"
+
+#define CMD_CASET 0x2A
+#define CMD_RASET 0x2B
+#define CMD_RAMWR 0x2C
+
+// Пам'ять і декодер спільні для всіх пристроїв: на шині одна панель
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t gram[MOCK_PANEL_HEIGHT][MOCK_PANEL_WIDTH];
+static mock_panel_stats_t stats;
+static uint32_t dc_level;
+static uint8_t command;
+static uint8_t params[4];
+static int param_count;
+static int col_start, col_end, row_start, row_end;
+static int cur_x, cur_y;
+static int pixel_high = -1;         // Старший байт пікселя, що чекає на молодший
+static spi_transaction_t *queue[MOCK_PANEL_QUEUE_SIZE];
+static int64_t queue_done_ns[MOCK_PANEL_QUEUE_SIZE];
+static int queue_head;
+static int queue_count;
+static int device;                  // Адреса слугує дескриптором пристрою
+static uint32_t clock_hz;
+static int64_t bus_free_ns;         // Коли шина закінчить останню прийняту транзакцію
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void wait_until(int64_t deadline_ns) {
+    int64_t left;
+    while ((left = deadline_ns - now_ns()) > 0) {
+        struct timespec ts = { left / 1000000000, left % 1000000000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// Час кінця транзакції на шині, що звільняється після попередніх; викликається під lock
+static int64_t bus_schedule(const spi_transaction_t *trans) {
+    int64_t start = now_ns();
+    if (bus_free_ns > start) {
+        start = bus_free_ns;
+    }
+    bus_free_ns = start + (clock_hz ? (int64_t)trans->length * 1000000000 / clock_hz : 0);
+    return bus_free_ns;
+}
+
+void mock_panel_reset(uint16_t color) {
+    pthread_mutex_lock(&lock);
+    for (int y = 0; y < MOCK_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < MOCK_PANEL_WIDTH; x++) {
+            gram[y][x] = color;
+        }
+    }
+    memset(&stats, 0, sizeof(stats));
+    command = 0;
+    param_count = 0;
+    col_start = row_start = 0;
+    col_end = MOCK_PANEL_WIDTH - 1;
+    row_end = MOCK_PANEL_HEIGHT - 1;
+    pixel_high = -1;
+    queue_head = queue_count = 0;
+    bus_free_ns = 0;
+    pthread_mutex_unlock(&lock);
+}
+
+void mock_panel_set_clock(uint32_t hz) {
+    pthread_mutex_lock(&lock);
+    clock_hz = hz;
+    pthread_mutex_unlock(&lock);
+}
+
+void mock_panel_clear_stats(void) {
+    pthread_mutex_lock(&lock);
+    memset(&stats, 0, sizeof(stats));
+    pthread_mutex_unlock(&lock);
+}
+
+void mock_panel_get_stats(mock_panel_stats_t *out) {
+    pthread_mutex_lock(&lock);
+    *out = stats;
+    pthread_mutex_unlock(&lock);
+}
+
+uint16_t mock_panel_pixel(int x, int y) {
+    pthread_mutex_lock(&lock);
+    uint16_t color = gram[y][x];
+    pthread_mutex_unlock(&lock);
+    return color;
+}
+
+static void write_pixel(uint16_t color) {
+    if (cur_y <= row_end && cur_x < MOCK_PANEL_WIDTH && cur_y < MOCK_PANEL_HEIGHT) {
+        gram[cur_y][cur_x] = color;
+    }
+    stats.pixels++;
+    if (++cur_x > col_end) {
+        cur_x = col_start;
+        cur_y++;
+    }
+}
+
+static void decode_byte(uint8_t byte) {
+    if (dc_level == 0) {
+        stats.commands++;
+        command = byte;
+        param_count = 0;
+        pixel_high = -1;
+        if (command == CMD_RAMWR) {
+            stats.windows++;
+            cur_x = col_start;
+            cur_y = row_start;
+        }
+        return;
+    }
+    switch (command) {
+    case CMD_CASET:
+    case CMD_RASET:
+        if (param_count < 4) {
+            params[param_count++] = byte;
+        }
+        if (param_count == 4) {
+            int start = params[0] << 8 | params[1];
+            int end = params[2] << 8 | params[3];
+            if (command == CMD_CASET) {
+                col_start = start;
+                col_end = end;
+            } else {
+                row_start = start;
+                row_end = end;
+            }
+        }
+        break;
+    case CMD_RAMWR:
+        if (pixel_high < 0) {
+            pixel_high = byte;
+        } else {
+            write_pixel((uint16_t)(pixel_high << 8 | byte));
+            pixel_high = -1;
+        }
+        break;
+    default:
+        // Параметри інших команд на вміст пам'яті не впливають
+        break;
+    }
+}
+
+static void execute(const spi_transaction_t *trans) {
+    const uint8_t *data = (const uint8_t *)trans->tx_buffer;
+    size_t len = trans->length / 8;
+    stats.transactions++;
+    stats.bytes += len;
+    for (size_t i = 0; i < len; i++) {
+        decode_byte(data[i]);
+    }
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    (void)gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    (void)gpio_num;
+    (void)mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num == MOCK_PANEL_DC_GPIO) {
+        pthread_mutex_lock(&lock);
+        dc_level = level;
+        pthread_mutex_unlock(&lock);
+    }
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dma_chan) {
+    (void)host;
+    (void)config;
+    (void)dma_chan;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle) {
+    (void)host;
+    if (config->queue_size > MOCK_PANEL_QUEUE_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *handle = (spi_device_handle_t)&device;
+    return ESP_OK;
+}
+
+// Блокуюча транзакція при непорожній черзі на чипі забрала б чужий результат
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    (void)handle;
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = ESP_OK;
+    int64_t done_ns = 0;
+    if (queue_count > 0) {
+        stats.violations++;
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        execute(trans);
+        done_ns = bus_schedule(trans);
+    }
+    pthread_mutex_unlock(&lock);
+    wait_until(done_ns);
+    return ret;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    return spi_device_transmit(handle, trans);
+}
+
+// Дані декодуються одразу: DC встановлено до постановки в чергу, а драйвер не
+// змінює його, поки черга не спорожніє
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t ticks) {
+    (void)handle;
+    (void)ticks;
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = ESP_OK;
+    if (queue_count == MOCK_PANEL_QUEUE_SIZE) {
+        stats.violations++;
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        execute(trans);
+        int slot = (queue_head + queue_count) % MOCK_PANEL_QUEUE_SIZE;
+        queue[slot] = trans;
+        queue_done_ns[slot] = bus_schedule(trans);
+        queue_count++;
+        if ((uint32_t)queue_count > stats.max_queued) {
+            stats.max_queued = queue_count;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t ticks) {
+    (void)handle;
+    (void)ticks;
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = ESP_OK;
+    int64_t done_ns = 0;
+    if (queue_count == 0) {
+        stats.violations++;
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        *trans = queue[queue_head];
+        done_ns = queue_done_ns[queue_head];
+        queue_head = (queue_head + 1) % MOCK_PANEL_QUEUE_SIZE;
+        queue_count--;
+    }
+    pthread_mutex_unlock(&lock);
+    wait_until(done_ns);
+    return ret;
+}
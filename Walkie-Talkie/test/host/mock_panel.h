@@ -0,0 +1,41 @@
+#ifndef TEST_HOST_MOCK_PANEL_H_
+#define TEST_HOST_MOCK_PANEL_H_
+
+#include <stdint.h>
+
+// Імітація панелі ST7789 на шині SPI для тестів драйвера дисплея.
+// Реалізує spi_master і gpio з ESP-IDF: рівень DC відділяє команди від даних,
+// CASET/RASET задають вікно, RAMWR пише пікселі у пам'ять панелі з переходом
+// на наступний рядок вікна, як у справжньому контролері. Лічильники рахують
+// транзакції і байти на шині - саме те, що коштує час на чипі.
+// Блокуюча транзакція при непорожній черзі, переповнення черги і запит
+// результату з порожньої черги рахуються як порушення протоколу.
+// З заданою частотою шина займає справжній час: блокуюча транзакція чекає
+// на свої байти, поставлені в чергу йдуть одна за одною у фоні, як DMA, а
+// результат черги видається, коли транзакція закінчилась на шині.
+
+#define MOCK_PANEL_WIDTH 240        // Пам'ять кадру ST7789
+#define MOCK_PANEL_HEIGHT 320
+#define MOCK_PANEL_DC_GPIO 16
+#define MOCK_PANEL_QUEUE_SIZE 7     // Як devcfg.queue_size у spi_master_init
+
+typedef struct {
+    uint32_t transactions;
+    uint64_t bytes;
+    uint32_t commands;
+    uint32_t windows;               // Команди RAMWR
+    uint64_t pixels;
+    uint32_t max_queued;            // Найбільше транзакцій у черзі одночасно
+    uint32_t violations;
+} mock_panel_stats_t;
+
+// Заповнює пам'ять панелі кольором, скидає вікно і лічильники
+void mock_panel_reset(uint16_t color);
+void mock_panel_clear_stats(void);
+// Частота шини в Гц, 0 - транзакції миттєві (за замовчуванням)
+void mock_panel_set_clock(uint32_t hz);
+void mock_panel_get_stats(mock_panel_stats_t *stats);
+// Координати пам'яті панелі, тобто зі зсувом дисплея
+uint16_t mock_panel_pixel(int x, int y);
+
+#endif /* TEST_HOST_MOCK_PANEL_H_ */
@@ -0,0 +1,88 @@
+#include <string.h>
+#include "station.h"
+
+const uint8_t station_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+struct sockaddr_in station_addr(uint16_t port) {
+    struct sockaddr_in sa = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    return sa;
+}
+
+bool station_open(station_t *st, uint16_t port, uint32_t session, crypto_mode_t mode, const uint8_t *key,
+                  packet_rate_t rate, uint8_t fec_group) {
+    memset(st, 0, sizeof(*st));
+    if (!resampler_filter_init(&st->tx_filter, STATION_SAMPLE_RATE, packet_rate_hz(rate))) {
+        return false;
+    }
+    for (int r = 0; r < PACKET_RATE_COUNT; r++) {
+        if (!resampler_filter_init(&st->rx_filters[r], packet_rate_hz(r), STATION_SAMPLE_RATE)) {
+            return false;
+        }
+    }
+    if (crypto_session_init(&st->crypto, mode, key ? key : station_key, 128) != ESP_OK ||
+        !packet_pool_init(&st->pool, STATION_POOL_BUFFERS, STATION_PACKET_SIZE) ||
+        !transport_open(&st->transport, &transport_loopback_backend, port, 0) ||
+        !stream_tx_init(&st->tx, &codec_ima_adpcm, rate, &st->tx_filter, STATION_FRAME_SAMPLES, session, fec_group) ||
+        !stream_rx_init(&st->rx, STATION_JB_SLOTS, STATION_FRAME_SAMPLES * 2, STATION_FRAME_PERIOD_US)) {
+        return false;
+    }
+    st->link = (stream_link_t){ &st->transport, &st->pool, &st->crypto };
+    st->config = (stream_rx_config_t){
+        .crypto = &st->crypto,
+        .filters = st->rx_filters,
+        .talkgroup = PACKET_TALKGROUP_NONE,
+        .accept_direct = true,
+        .require_encryption = true,
+        .frame_samples = STATION_FRAME_SAMPLES,
+        .pcm = st->pcm,
+        .play_pcm = st->play_pcm,
+    };
+    return true;
+}
+
+void station_close(station_t *st) {
+    stream_rx_free(&st->rx);
+    stream_tx_free(&st->tx);
+    transport_close(&st->transport);
+    packet_pool_free(&st->pool);
+    crypto_session_free(&st->crypto);
+    for (int r = 0; r < PACKET_RATE_COUNT; r++) {
+        resampler_filter_free(&st->rx_filters[r]);
+    }
+    resampler_filter_free(&st->tx_filter);
+}
+
+void station_send(station_t *st, const struct sockaddr_in *dest, uint16_t group, bool encrypted, const int16_t *pcm) {
+    size_t samples = resampler_process(&st->tx.resampler, pcm, STATION_FRAME_SAMPLES, st->codec_pcm,
+                                       STATION_FRAME_SAMPLES);
+    stream_send_frame(&st->tx, &st->link, dest, group, encrypted, st->codec_pcm, samples, DTX_SEND);
+}
+
+// Як задача прийому: нерозібраний заголовок рахується потоком як недійсний пакет
+stream_rx_result_t station_receive(station_t *st, uint8_t *buf, size_t len, int64_t now_us) {
+    packet_header_t hdr;
+    stream_rx_result_t result = STREAM_RX_DROPPED;
+    if (!packet_parse(buf, len, &hdr)) {
+        st->rx.stats.invalid++;
+    } else {
+        result = stream_receive_packet(&st->rx, &st->config, &hdr, buf, len, now_us, &st->sid_level);
+    }
+    st->results[result]++;
+    return result;
+}
+
+int station_poll(station_t *st, int64_t now_us) {
+    int accepted = 0;
+    int len;
+    struct sockaddr_in src;
+    while ((len = transport_recv(&st->transport, st->packet, sizeof(st->packet), &src)) >= 0) {
+        accepted += station_receive(st, st->packet, len, now_us) != STREAM_RX_DROPPED;
+    }
+    return accepted;
+}
@@ -0,0 +1,56 @@
+#ifndef TEST_HOST_STATION_H_
+#define TEST_HOST_STATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stream_io.h"
+
+// Станція для тестів шляху пакета: транспорт на петлі, пул буферів, криптографічна
+// сесія, фільтри частоти і пара потоків, зібрані так само, як у main.c.
+// Відправка бере кадр I2S і проходить stream_send_frame, прийом розбирає
+// датаграму і передає її в stream_receive_packet, як задача прийому.
+// Структура містить робочі буфери, на які вказує config, тож не копіюється.
+
+#define STATION_SAMPLE_RATE 44100
+#define STATION_FRAME_SAMPLES 441           // 10 мс на частоті I2S
+#define STATION_FRAME_PERIOD_US 10000
+#define STATION_JB_SLOTS 16
+#define STATION_FEC_GROUP 4
+#define STATION_POOL_BUFFERS 8
+#define STATION_PACKET_SIZE (PACKET_HEADER_SIZE + FEC_HEADER_SIZE + STATION_FRAME_SAMPLES * 2 + CRYPTO_TAG_SIZE)
+
+extern const uint8_t station_key[16];
+
+typedef struct {
+    transport_t transport;
+    packet_pool_t pool;
+    crypto_session_t crypto;
+    resampler_filter_t tx_filter;
+    resampler_filter_t rx_filters[PACKET_RATE_COUNT];
+    stream_tx_t tx;
+    stream_rx_t rx;
+    stream_link_t link;
+    stream_rx_config_t config;      // Умови прийому, тест змінює групу і шифрування
+    int16_t codec_pcm[STATION_FRAME_SAMPLES];
+    int16_t pcm[STATION_FRAME_SAMPLES];
+    int16_t play_pcm[STATION_FRAME_SAMPLES];
+    uint8_t packet[STATION_PACKET_SIZE];
+    uint32_t results[STREAM_RX_PARITY + 1];     // Лічильники за stream_rx_result_t
+    int32_t sid_level;
+} station_t;
+
+// key == NULL - station_key; fec_group 0 вимикає FEC
+bool station_open(station_t *st, uint16_t port, uint32_t session, crypto_mode_t mode, const uint8_t *key,
+                  packet_rate_t rate, uint8_t fec_group);
+void station_close(station_t *st);
+// Кадр STATION_FRAME_SAMPLES семплів I2S: перетворення частоти, кодування, шифрування, відправка
+void station_send(station_t *st, const struct sockaddr_in *dest, uint16_t group, bool encrypted, const int16_t *pcm);
+// Одна датаграма з мережі
+stream_rx_result_t station_receive(station_t *st, uint8_t *buf, size_t len, int64_t now_us);
+// Забирає всі датаграми з черги сокета; повертає кількість прийнятих (не відкинутих)
+int station_poll(station_t *st, int64_t now_us);
+
+struct sockaddr_in station_addr(uint16_t port);
+
+#endif /* TEST_HOST_STATION_H_ */
@@ -0,0 +1,20 @@
+#ifndef TEST_HOST_STUBS_GPIO_H_
+#define TEST_HOST_STUBS_GPIO_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Лише виходи; реалізація у mock_panel.c, де рівень DC відділяє команди від даних
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+#endif /* TEST_HOST_STUBS_GPIO_H_ */
@@ -0,0 +1,68 @@
+#ifndef TEST_HOST_STUBS_SPI_MASTER_H_
+#define TEST_HOST_STUBS_SPI_MASTER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+
+// Майстер SPI з ESP-IDF у межах, потрібних драйверу дисплея. Реалізація у
+// mock_panel.c: транзакції декодуються як команди ST7789, черга завершується
+// в порядку постановки
+
+typedef struct spi_device_t *spi_device_handle_t;
+
+typedef enum {
+    SPI1_HOST,
+    SPI2_HOST,
+    SPI3_HOST,
+} spi_host_device_t;
+
+#define SPI_MASTER_FREQ_20M (80 * 1000 * 1000 / 4)
+#define SPI_DMA_CH_AUTO 3
+#define SPI_DEVICE_NO_DUMMY (1 << 6)
+
+typedef struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;              // Біти
+    size_t rxlength;
+    void *user;
+    const void *tx_buffer;
+    void *rx_buffer;
+} spi_transaction_t;
+
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+} spi_bus_config_t;
+
+typedef struct {
+    int clock_speed_hz;
+    int queue_size;
+    int mode;
+    uint32_t flags;
+    int spics_io_num;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dma_chan);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t ticks);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t ticks);
+
+#endif /* TEST_HOST_STUBS_SPI_MASTER_H_ */
@@ -0,0 +1,20 @@
+#ifndef TEST_HOST_STUBS_ESP_ERR_H_
+#define TEST_HOST_STUBS_ESP_ERR_H_
+
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_INVALID_CRC 0x109
+
+#define ESP_ERROR_CHECK(x) do { if ((x) != ESP_OK) abort(); } while (0)
+
+#endif /* TEST_HOST_STUBS_ESP_ERR_H_ */
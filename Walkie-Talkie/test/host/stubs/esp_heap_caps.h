@@ -0,0 +1,16 @@
+#ifndef TEST_HOST_STUBS_ESP_HEAP_CAPS_H_
+#define TEST_HOST_STUBS_ESP_HEAP_CAPS_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// На хості будь-яка пам'ять придатна для DMA
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+#endif /* TEST_HOST_STUBS_ESP_HEAP_CAPS_H_ */
@@ -0,0 +1,18 @@
+#ifndef TEST_HOST_STUBS_ESP_LOG_H_
+#define TEST_HOST_STUBS_ESP_LOG_H_
+
+#include <stdio.h>
+
+// Помилки й попередження йдуть у stderr, решта лише перевіряється компілятором
+static inline void __attribute__((format(printf, 2, 3))) esp_log_host_discard(const char *tag, const char *fmt, ...) {
+    (void)tag;
+    (void)fmt;
+}
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) esp_log_host_discard(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) esp_log_host_discard(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) esp_log_host_discard(tag, fmt, ##__VA_ARGS__)
+
+#endif /* TEST_HOST_STUBS_ESP_LOG_H_ */
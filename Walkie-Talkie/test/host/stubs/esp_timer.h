@@ -0,0 +1,10 @@
+#ifndef TEST_HOST_STUBS_ESP_TIMER_H_
+#define TEST_HOST_STUBS_ESP_TIMER_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Монотонний час у мікросекундах від старту програми
+int64_t esp_timer_get_time(void);
+
+#endif /* TEST_HOST_STUBS_ESP_TIMER_H_ */
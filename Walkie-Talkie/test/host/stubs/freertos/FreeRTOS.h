@@ -0,0 +1,37 @@
+#ifndef TEST_HOST_STUBS_FREERTOS_H_
+#define TEST_HOST_STUBS_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+// У ESP-IDF assert приходить разом із FreeRTOSConfig.h
+#include <assert.h>
+
+// Заміна FreeRTOS для тестів на хості: лише те, що використовують модулі під тестом.
+// Задачі - потоки pthread, критична секція - м'ютекс, тік - 1 мс.
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)((uint64_t)(ms) * configTICK_RATE_HZ / 1000))
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED PTHREAD_MUTEX_INITIALIZER
+#define portMUX_INITIALIZE(mux) pthread_mutex_init((mux), NULL)
+#define portENTER_CRITICAL(mux) pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux) pthread_mutex_unlock(mux)
+
+#endif /* TEST_HOST_STUBS_FREERTOS_H_ */
@@ -0,0 +1,15 @@
+#ifndef TEST_HOST_STUBS_SEMPHR_H_
+#define TEST_HOST_STUBS_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+// Двійковий семафор: створюється порожнім, як у FreeRTOS; повторний Give
+// заповненого семафора повертає pdFAIL
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#endif /* TEST_HOST_STUBS_SEMPHR_H_ */
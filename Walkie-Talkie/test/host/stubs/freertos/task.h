@@ -0,0 +1,39 @@
+#ifndef TEST_HOST_STUBS_TASK_H_
+#define TEST_HOST_STUBS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+// Задачі та сповіщення задач поверх pthread. Семантика сповіщень як у FreeRTOS:
+// значення і прапорець очікування, xTaskNotifyWait повертає pdFALSE після тайм-ауту.
+// Головний потік отримує дескриптор при першому зверненні до xTaskGetCurrentTaskHandle.
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eNoAction,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+#define xTaskCreate(task, name, stack_depth, arg, priority, handle) \
+    xTaskCreatePinnedToCore(task, name, stack_depth, arg, priority, handle, tskNO_AFFINITY)
+
+// Підтримується лише завершення поточної задачі (NULL)
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+// Пріоритетів на хості немає, усі задачі рівні
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks);
+#define xTaskNotifyGive(task) xTaskNotify((task), 0, eIncrement)
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif /* TEST_HOST_STUBS_TASK_H_ */
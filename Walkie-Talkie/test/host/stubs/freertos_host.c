@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t entry;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t value;             // Значення сповіщення
+    bool pending;               // Сповіщення надійшло і ще не забране
+};
+
+static _Thread_local struct host_task *current_task;
+
+static int64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t start_us;
+static pthread_once_t start_once = PTHREAD_ONCE_INIT;
+
+static void start_clock(void) {
+    start_us = monotonic_us();
+}
+
+// Як і на чипі, відлік від старту програми
+int64_t esp_timer_get_time(void) {
+    pthread_once(&start_once, start_clock);
+    return monotonic_us() - start_us;
+}
+
+static void task_init(struct host_task *task) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&task->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&task->lock, NULL);
+}
+
+static void task_deinit(struct host_task *task) {
+    pthread_cond_destroy(&task->cond);
+    pthread_mutex_destroy(&task->lock);
+}
+
+static struct host_task *task_alloc(void) {
+    struct host_task *task = (struct host_task *)calloc(1, sizeof(*task));
+    if (!task) {
+        abort();
+    }
+    task_init(task);
+    return task;
+}
+
+static void task_free(struct host_task *task) {
+    task_deinit(task);
+    free(task);
+}
+
+static void *task_entry(void *arg) {
+    struct host_task *task = (struct host_task *)arg;
+    current_task = task;
+    task->entry(task->arg);
+    current_task = NULL;
+    task_free(task);
+    return NULL;
+}
+
+// Пріоритет і ядро на хості не мають значення; потік від'єднаний, як задача FreeRTOS
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    (void)core;
+    struct host_task *task = task_alloc();
+    task->entry = entry;
+    task->arg = arg;
+    // Дескриптор відомий до старту, бо задача може одразу сповістити когось із ним
+    if (handle) {
+        *handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task != NULL && task != current_task) {
+        fprintf(stderr, "vTaskDelete: only the calling task can be deleted on the host\n");
+        abort();
+    }
+    // Після видалення дескриптор недійсний, як і у FreeRTOS
+    if (current_task != NULL) {
+        task_free(current_task);
+        current_task = NULL;
+    }
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {
+        .tv_sec = ticks / configTICK_RATE_HZ,
+        .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ),
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (current_task == NULL) {
+        current_task = task_alloc();
+        current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    (void)task;
+    return 1;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    BaseType_t result = pdPASS;
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+    case eSetBits:
+        task->value |= value;
+        break;
+    case eIncrement:
+        task->value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->value = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (task->pending) {
+            result = pdFAIL;
+        } else {
+            task->value = value;
+        }
+        break;
+    case eNoAction:
+        break;
+    }
+    task->pending = true;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return result;
+}
+
+// Чекає, поки cond() стане істинною, або тайм-ауту; викликається під task->lock
+static bool wait_until(struct host_task *task, bool (*cond)(const struct host_task *), TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        while (!cond(task)) {
+            pthread_cond_wait(&task->cond, &task->lock);
+        }
+        return true;
+    }
+    int64_t deadline_us = monotonic_us() + (int64_t)ticks * (1000000 / configTICK_RATE_HZ);
+    struct timespec deadline = {
+        .tv_sec = deadline_us / 1000000,
+        .tv_nsec = (deadline_us % 1000000) * 1000,
+    };
+    while (!cond(task)) {
+        if (pthread_cond_timedwait(&task->cond, &task->lock, &deadline) == ETIMEDOUT) {
+            return cond(task);
+        }
+    }
+    return true;
+}
+
+static bool is_pending(const struct host_task *task) {
+    return task->pending;
+}
+
+static bool has_value(const struct host_task *task) {
+    return task->value != 0;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks) {
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&task->lock);
+    if (!task->pending) {
+        task->value &= ~clear_on_entry;
+    }
+    bool notified = wait_until(task, is_pending, ticks);
+    if (value) {
+        *value = task->value;
+    }
+    if (notified) {
+        task->value &= ~clear_on_exit;
+    }
+    task->pending = false;
+    pthread_mutex_unlock(&task->lock);
+    return notified ? pdTRUE : pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&task->lock);
+    wait_until(task, has_value, ticks);
+    uint32_t value = task->value;
+    if (value != 0) {
+        task->value = clear_on_exit ? 0 : value - 1;
+    }
+    task->pending = false;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+struct host_semaphore {
+    struct host_task wait;      // Той самий замок і умова, що й у сповіщень
+    bool full;
+};
+
+static bool is_full(const struct host_task *wait) {
+    return ((const struct host_semaphore *)wait)->full;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    struct host_semaphore *sem = (struct host_semaphore *)calloc(1, sizeof(*sem));
+    if (!sem) {
+        abort();
+    }
+    task_init(&sem->wait);
+    return sem;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    task_deinit(&sem->wait);
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_mutex_lock(&sem->wait.lock);
+    bool taken = wait_until(&sem->wait, is_full, ticks);
+    if (taken) {
+        sem->full = false;
+    }
+    pthread_mutex_unlock(&sem->wait.lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->wait.lock);
+    bool given = !sem->full;
+    sem->full = true;
+    pthread_cond_broadcast(&sem->wait.cond);
+    pthread_mutex_unlock(&sem->wait.lock);
+    return given ? pdTRUE : pdFALSE;
+}
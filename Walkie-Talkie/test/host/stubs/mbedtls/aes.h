@@ -0,0 +1,20 @@
+#ifndef TEST_HOST_STUBS_MBEDTLS_AES_H_
+#define TEST_HOST_STUBS_MBEDTLS_AES_H_
+
+#include <stddef.h>
+
+// Оголошення mbedtls для тестів на хості, де встановлена лише бібліотека libmbedcrypto
+// без заголовків. Контекст непрозорий: бібліотека працює з ним лише через вказівник,
+// тож досить місця з запасом і вирівнювання; поля модулі під тестом не читають
+
+typedef struct {
+    _Alignas(16) unsigned char opaque[1024];
+} mbedtls_aes_context;
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx);
+void mbedtls_aes_free(mbedtls_aes_context *ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off, unsigned char nonce_counter[16],
+                          unsigned char stream_block[16], const unsigned char *input, unsigned char *output);
+
+#endif /* TEST_HOST_STUBS_MBEDTLS_AES_H_ */
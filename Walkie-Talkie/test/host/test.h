@@ -0,0 +1,76 @@
+#ifndef TEST_HOST_TEST_H_
+#define TEST_HOST_TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <math.h>
+
+// Мінімальна оснастка тестів на хості. Невдала перевірка не зупиняє тест, а лише
+// друкує місце і рахується; програма завершується з кодом 1, якщо була хоч одна.
+// Заміри продуктивності друкуються поруч із результатами (ctest -V).
+
+static int test_failures;
+
+#define TEST_ASSERT(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_ASSERT_EQ(actual, expected) do { \
+    long long actual_ = (long long)(actual); \
+    long long expected_ = (long long)(expected); \
+    if (actual_ != expected_) { \
+        fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, actual_, expected_); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_RUN(fn) do { \
+    int failures_ = test_failures; \
+    fn(); \
+    printf("%s %s\n", failures_ == test_failures ? "PASS" : "FAIL", #fn); \
+} while (0)
+
+#define TEST_EXIT_CODE() (test_failures ? 1 : 0)
+
+static inline int64_t test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Детермінований генератор (xorshift32) для відтворюваних сигналів і сценаріїв втрат
+static inline uint32_t test_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Рівномірне число в [0, 1)
+static inline double test_rand_unit(uint32_t *state) {
+    return (test_rand(state) >> 8) / 16777216.0;
+}
+
+// Відношення сигнал/шум обробленого сигналу відносно еталона (дБ)
+static inline double test_snr_db(const int16_t *ref, const int16_t *out, size_t len) {
+    double signal = 0;
+    double noise = 0;
+    for (size_t i = 0; i < len; i++) {
+        double d = (double)out[i] - ref[i];
+        signal += (double)ref[i] * ref[i];
+        noise += d * d;
+    }
+    if (noise == 0) {
+        return INFINITY;
+    }
+    return 10 * log10(signal / noise);
+}
+
+#endif /* TEST_HOST_TEST_H_ */
@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "dsp.h"
+#include "agc.h"
+
+// АРП: вихід на цільовий рівень для тихого і гучного мовця, шумовий шлюз,
+// обмежувач без перевищення ліміту і вартість обробки 1 мс звуку
+
+#define RATE 44100
+#define FRAME 441
+#define SECONDS 3
+
+// Та сама конфігурація, що й у main.c
+static const agc_config_t config = {
+    .target_level = 3000,
+    .gate_level = 40,
+    .min_gain_q15 = DSP_GAIN_Q15(1.0),
+    .max_gain_q15 = DSP_GAIN_Q15(20.0),
+    .attack_q15 = DSP_GAIN_Q15(0.25),
+    .release_q15 = DSP_GAIN_Q15(0.03),
+    .limit = 29000,
+    .lookahead = RATE / 500,
+};
+
+// Мова-подібний запис: склади по 200 мс з паузами по 100 мс і фоновим шумом
+static void make_speech(int16_t *pcm, size_t len, double amplitude, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        double t = (double)i / RATE;
+        double syllable = fmod(t, 0.3) < 0.2 ? sin(M_PI * fmod(t, 0.3) / 0.2) : 0;
+        double v = sin(2 * M_PI * 150 * t) + 0.6 * sin(2 * M_PI * 450 * t) + 0.3 * sin(2 * M_PI * 1800 * t);
+        double noise = (test_rand_unit(&seed) - 0.5) * 20;
+        pcm[i] = (int16_t)lrint(amplitude * syllable * v + noise);
+    }
+}
+
+static double mean_abs(const int16_t *pcm, size_t len) {
+    double sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += abs(pcm[i]);
+    }
+    return sum / len;
+}
+
+static void process_frames(agc_t *agc, int16_t *pcm, size_t len) {
+    for (size_t i = 0; i + FRAME <= len; i += FRAME) {
+        agc_process(agc, pcm + i, FRAME);
+    }
+}
+
+static void test_config_rejects(void) {
+    agc_t agc;
+    agc_config_t bad = config;
+    bad.lookahead = 0;
+    TEST_ASSERT(!agc_init(&agc, &bad));
+    bad.lookahead = AGC_MAX_LOOKAHEAD + 1;
+    TEST_ASSERT(!agc_init(&agc, &bad));
+    bad = config;
+    bad.max_gain_q15 = bad.min_gain_q15 - 1;
+    TEST_ASSERT(!agc_init(&agc, &bad));
+    bad = config;
+    bad.limit = 0;
+    TEST_ASSERT(!agc_init(&agc, &bad));
+}
+
+// Тихий і гучний мовець після підлаштування звучать однаково голосно
+static void test_convergence(void) {
+    static const double amplitudes[] = {400, 1500, 5000};
+    static int16_t pcm[RATE * SECONDS];
+    double out_min = 1e9;
+    double out_max = 0;
+    for (size_t a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++) {
+        agc_t agc;
+        TEST_ASSERT(agc_init(&agc, &config));
+        make_speech(pcm, RATE * SECONDS, amplitudes[a], 1);
+        double in_level = mean_abs(pcm + RATE * (SECONDS - 1), RATE);
+        process_frames(&agc, pcm, RATE * SECONDS);
+        double out_level = mean_abs(pcm + RATE * (SECONDS - 1), RATE);
+        agc_stats_t stats;
+        agc_get_stats(&agc, &stats);
+        printf("  input level %5.0f -> output %5.0f, gain %.2f\n", in_level, out_level,
+               stats.gain_q15 / (double)DSP_Q15_ONE);
+        out_min = out_level < out_min ? out_level : out_min;
+        out_max = out_level > out_max ? out_level : out_max;
+        agc_free(&agc);
+    }
+    // Рівень рахується разом з паузами між складами, тож на виході нижче цілі,
+    // але розкид між мовцями в межах 2 дБ замість 22 дБ на вході
+    TEST_ASSERT(out_min > config.target_level * 0.4);
+    TEST_ASSERT(out_max < config.target_level * 1.2);
+    TEST_ASSERT(20 * log10(out_max / out_min) < 2);
+}
+
+// Лише шум мікрофона: шлюз закритий, підсилення мінімальне
+static void test_gate(void) {
+    static int16_t pcm[RATE];
+    agc_t agc;
+    TEST_ASSERT(agc_init(&agc, &config));
+    uint32_t seed = 5;
+    for (size_t i = 0; i < RATE; i++) {
+        pcm[i] = (int16_t)((test_rand_unit(&seed) - 0.5) * 60);
+    }
+    process_frames(&agc, pcm, RATE);
+    agc_stats_t stats;
+    agc_get_stats(&agc, &stats);
+    TEST_ASSERT(stats.gated);
+    TEST_ASSERT_EQ(stats.gain_q15, config.min_gain_q15);
+    agc_free(&agc);
+}
+
+// Раптовий крик після тихої мови при великому підсиленні: ліміт не перевищується,
+// а обмежувач знижує підсилення заздалегідь, тож жорстко обрізаних семплів майже немає
+static void test_limiter(void) {
+    static int16_t pcm[RATE * 2];
+    agc_t agc;
+    TEST_ASSERT(agc_init(&agc, &config));
+    make_speech(pcm, RATE * 2, 300, 2);
+    for (size_t i = RATE; i < RATE * 2; i++) {
+        pcm[i] = (int16_t)lrint(30000 * sin(2 * M_PI * 500 * i / RATE));
+    }
+    process_frames(&agc, pcm, RATE * 2);
+
+    int over = 0;
+    int clipped = 0;
+    for (size_t i = 0; i < RATE * 2; i++) {
+        over += abs(pcm[i]) > config.limit;
+        clipped += abs(pcm[i]) == config.limit;
+    }
+    printf("  burst: %d samples at the limit out of %d\n", clipped, RATE);
+    TEST_ASSERT_EQ(over, 0);
+    TEST_ASSERT(clipped < RATE / 100);
+    agc_free(&agc);
+}
+
+// Обмежувач затримує сигнал рівно на lookahead семплів
+static void test_lookahead_delay(void) {
+    int16_t pcm[FRAME] = {0};
+    agc_t agc;
+    agc_config_t unity = config;
+    unity.max_gain_q15 = unity.min_gain_q15;
+    TEST_ASSERT(agc_init(&agc, &unity));
+    pcm[0] = 1000;
+    agc_process(&agc, pcm, FRAME);
+    for (size_t i = 0; i < FRAME; i++) {
+        TEST_ASSERT_EQ(pcm[i], i == config.lookahead ? 1000 : 0);
+    }
+    agc_free(&agc);
+}
+
+static void test_benchmark(void) {
+    static int16_t speech[RATE * SECONDS];
+    static int16_t pcm[RATE * SECONDS];
+    agc_t agc;
+    agc_init(&agc, &config);
+    make_speech(speech, RATE * SECONDS, 1500, 3);
+
+    const int reps = 10;
+    int64_t elapsed = 0;
+    for (int r = 0; r < reps; r++) {
+        memcpy(pcm, speech, sizeof(pcm));
+        int64_t start = test_now_ns();
+        process_frames(&agc, pcm, RATE * SECONDS);
+        elapsed += test_now_ns() - start;
+    }
+    double ms_of_audio = SECONDS * 1000.0 * reps;
+    printf("  %.0f ns per 1 ms of audio at %d Hz, %.0f ns per %d-sample frame\n",
+           elapsed / ms_of_audio, RATE, elapsed / ms_of_audio * 10, FRAME);
+    agc_free(&agc);
+}
+
+int main(void) {
+    TEST_RUN(test_config_rejects);
+    TEST_RUN(test_convergence);
+    TEST_RUN(test_gate);
+    TEST_RUN(test_limiter);
+    TEST_RUN(test_lookahead_delay);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,179 @@
+#include <string.h>
+#include "test.h"
+#include "station.h"
+
+// Шлях аудіо між двома станціями через петлю транспорту: перетворення частоти,
+// кодування, FEC і шифрування GCM на відправці, розбір, автентифікація,
+// декодування і джитер-буфер на прийомі. Звук на виході порівнюється з
+// еталоном для кожного профілю частоти, поодинокі втрати в групі повертає
+// парність, а час обох половин шляху порівнюється з бюджетом кадру
+
+#define PORT_TX 5000
+#define PORT_RX 5001
+#define FRAMES 300
+#define MAX_LAG 400                 // Затримка двох перетворювачів частоти з запасом
+
+static int16_t input[FRAMES * STATION_FRAME_SAMPLES];
+static int16_t output[FRAMES * STATION_FRAME_SAMPLES];
+
+// Два тони в смузі найвужчого профілю (зріз 3.4 кГц на 8 кГц), щоб кореляція мала один максимум
+static void make_input(void) {
+    for (size_t i = 0; i < sizeof(input) / sizeof(input[0]); i++) {
+        double t = (double)i / STATION_SAMPLE_RATE;
+        input[i] = (int16_t)(6000 * sin(2 * M_PI * 440 * t) + 4000 * sin(2 * M_PI * 1250 * t));
+    }
+}
+
+// Відношення сигнал/шум виходу, вирівняного з входом за найкращою затримкою
+static double aligned_snr(size_t out_len) {
+    size_t skip = 2 * STATION_FRAME_SAMPLES;
+    size_t len = out_len - skip - MAX_LAG;
+    int best_lag = 0;
+    double best = -INFINITY;
+    for (int lag = 0; lag < MAX_LAG; lag++) {
+        double corr = 0;
+        for (size_t i = skip; i < skip + len; i++) {
+            corr += (double)output[i + lag] * input[i];
+        }
+        if (corr > best) {
+            best = corr;
+            best_lag = lag;
+        }
+    }
+    return test_snr_db(&input[skip], &output[skip + best_lag], len);
+}
+
+// Один кадр кожні 10 мс: відправка, прийом усього, що прийшло, і відтворення одного кадру
+static size_t run_link(station_t *tx, station_t *rx, uint32_t drop_period, uint32_t *dropped) {
+    struct sockaddr_in dest = station_addr(PORT_RX);
+    size_t out_len = 0;
+    uint32_t datagram = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        int64_t now_us = (int64_t)i * STATION_FRAME_PERIOD_US;
+        station_send(tx, &dest, PACKET_TALKGROUP_NONE, true, &input[i * STATION_FRAME_SAMPLES]);
+
+        int len;
+        struct sockaddr_in src;
+        while ((len = transport_recv(&rx->transport, rx->packet, sizeof(rx->packet), &src)) >= 0) {
+            packet_header_t hdr;
+            bool audio = packet_parse(rx->packet, len, &hdr) && !(hdr.flags & PACKET_FLAG_FEC);
+            // Втрачається кожен drop_period-й аудіопакет, парність доходить завжди
+            if (audio && drop_period && ++datagram % drop_period == 0) {
+                (*dropped)++;
+                continue;
+            }
+            station_receive(rx, rx->packet, len, now_us);
+        }
+
+        // Пропущений кадр заповнюється тишею, щоб вихід лишався вирівняним із входом
+        size_t bytes;
+        jb_status_t status = jitter_buffer_pop(&rx->rx.jb, (uint8_t *)&output[out_len], &bytes);
+        if (status == JB_FRAME) {
+            out_len += bytes / sizeof(int16_t);
+        } else if (status == JB_LOST) {
+            memset(&output[out_len], 0, STATION_FRAME_SAMPLES * sizeof(int16_t));
+            out_len += STATION_FRAME_SAMPLES;
+        }
+    }
+    return out_len;
+}
+
+static void test_profiles(void) {
+    static const packet_rate_t rates[] = { PACKET_RATE_44100, PACKET_RATE_16000, PACKET_RATE_8000 };
+    static const double min_snr[] = { 20, 20, 15 };
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        station_t tx;
+        station_t rx;
+        TEST_ASSERT(station_open(&tx, PORT_TX, 0x1111, CRYPTO_MODE_GCM, NULL, rates[r], STATION_FEC_GROUP));
+        TEST_ASSERT(station_open(&rx, PORT_RX, 0x2222, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, STATION_FEC_GROUP));
+
+        size_t out_len = run_link(&tx, &rx, 0, NULL);
+        // Усі кадри й пакети парності автентифіковані, жоден не загубився
+        TEST_ASSERT_EQ(rx.results[STREAM_RX_AUDIO], FRAMES);
+        TEST_ASSERT_EQ(rx.results[STREAM_RX_PARITY], FRAMES / STATION_FEC_GROUP);
+        TEST_ASSERT_EQ(rx.results[STREAM_RX_DROPPED], 0);
+        TEST_ASSERT_EQ(rx.rx.stats.received, FRAMES);
+        TEST_ASSERT_EQ(rx.rx.jb.stats.lost, 0);
+        TEST_ASSERT_EQ(rx.rx.rate, rates[r]);
+        // Відтворення відстає від прийому лише на цільову глибину буфера
+        TEST_ASSERT(out_len >= (FRAMES - 2 * JB_MIN_DEPTH) * STATION_FRAME_SAMPLES);
+
+        double snr = aligned_snr(out_len);
+        printf("  %5u Hz: %zu frames played, SNR %.1f dB\n", packet_rate_hz(rates[r]),
+               out_len / STATION_FRAME_SAMPLES, snr);
+        TEST_ASSERT(snr > min_snr[r]);
+
+        station_close(&rx);
+        station_close(&tx);
+    }
+}
+
+// Кожен дев'ятий аудіопакет губиться, тобто не більше одного на групу з чотирьох,
+// і парність повертає кожен. Відновлений кадр встигає на відтворення лише тоді,
+// коли парність приходить раніше за його чергу: на мінімальній глибині буфера
+// перші кадри групи запізнюються і рахуються як пізні, решта звучить без пропуску
+static void test_fec_recovery(void) {
+    station_t tx;
+    station_t rx;
+    TEST_ASSERT(station_open(&tx, PORT_TX, 0x1111, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, STATION_FEC_GROUP));
+    TEST_ASSERT(station_open(&rx, PORT_RX, 0x2222, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, STATION_FEC_GROUP));
+
+    uint32_t dropped = 0;
+    run_link(&tx, &rx, 9, &dropped);
+    const jb_stats_t *jb = &rx.rx.jb.stats;
+    TEST_ASSERT(dropped > 0);
+    TEST_ASSERT_EQ(rx.rx.fec.stats.recovered, dropped);
+    TEST_ASSERT_EQ(rx.rx.fec.stats.unrecoverable, 0);
+    // Кожна втрата на відтворенні - це кадр, відновлений запізно
+    TEST_ASSERT_EQ(jb->lost, jb->late_drops);
+    TEST_ASSERT(jb->lost < dropped);
+    printf("  %u of %d frames lost, all recovered: %u in time, %u too late for playout at depth %u\n", dropped,
+           FRAMES, dropped - jb->late_drops, jb->late_drops, rx.rx.jb.target_depth);
+
+    station_close(&rx);
+    station_close(&tx);
+}
+
+// Час відправки (перетворення частоти, кодування, FEC, шифрування) і прийому
+// (розбір, дешифрування, декодування, перетворення частоти, джитер-буфер) на кадр
+static void test_benchmark(void) {
+    enum { ROUNDS = 2000 };
+    station_t tx;
+    station_t rx;
+    TEST_ASSERT(station_open(&tx, PORT_TX, 0x1111, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, STATION_FEC_GROUP));
+    TEST_ASSERT(station_open(&rx, PORT_RX, 0x2222, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, STATION_FEC_GROUP));
+    struct sockaddr_in dest = station_addr(PORT_RX);
+    int16_t play[STATION_FRAME_SAMPLES];
+
+    int64_t send_ns = 0;
+    int64_t receive_ns = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        const int16_t *frame = &input[(i % FRAMES) * STATION_FRAME_SAMPLES];
+        int64_t start = test_now_ns();
+        station_send(&tx, &dest, PACKET_TALKGROUP_NONE, true, frame);
+        int64_t sent = test_now_ns();
+        station_poll(&rx, (int64_t)i * STATION_FRAME_PERIOD_US);
+        size_t bytes;
+        jitter_buffer_pop(&rx.rx.jb, (uint8_t *)play, &bytes);
+        receive_ns += test_now_ns() - sent;
+        send_ns += sent - start;
+    }
+    TEST_ASSERT_EQ(rx.results[STREAM_RX_AUDIO], ROUNDS);
+
+    double send_us = send_ns / 1e3 / ROUNDS;
+    double receive_us = receive_ns / 1e3 / ROUNDS;
+    printf("  16 kHz GCM+FEC: send %.1f us, receive %.1f us per frame (%.2f%% of %d us)\n", send_us, receive_us,
+           100 * (send_us + receive_us) / STATION_FRAME_PERIOD_US, STATION_FRAME_PERIOD_US);
+    TEST_ASSERT(send_us + receive_us < STATION_FRAME_PERIOD_US);
+
+    station_close(&rx);
+    station_close(&tx);
+}
+
+int main(void) {
+    make_input();
+    TEST_RUN(test_profiles);
+    TEST_RUN(test_fec_recovery);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,227 @@
+#include <string.h>
+#include "test.h"
+#include "codec.h"
+
+// Кодеки: точність PCM16, побітова відповідність IMA-ADPCM еталонному декодеру
+// і зафіксованому вектору, відновлення після втрати кадру, швидкість кодування
+
+#define FRAME 441                   // 10 мс при 44.1 кГц, непарна кількість семплів
+#define FRAMES 50
+
+// Мова-подібний сигнал: основний тон з гармоніками, повільна модуляція і шум
+static void make_voice(int16_t *pcm, size_t len, uint32_t rate, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        double t = (double)i / rate;
+        double env = 0.5 + 0.5 * sin(2 * M_PI * 3 * t);
+        double v = sin(2 * M_PI * 140 * t) + 0.5 * sin(2 * M_PI * 280 * t) + 0.25 * sin(2 * M_PI * 1120 * t);
+        double noise = (test_rand_unit(&seed) - 0.5) * 0.05;
+        pcm[i] = (int16_t)(9000 * env * v + 9000 * noise);
+    }
+}
+
+// Вхід зафіксованого вектора лише з цілочисельної арифметики, щоб не залежати від libm:
+// дві трикутні хвилі з огинаючою і шум
+static void make_golden(int16_t *pcm, size_t len) {
+    uint32_t seed = 0x1234567;
+    for (size_t i = 0; i < len; i++) {
+        int32_t tri1 = (int32_t)(i * 64 % 40000) - 20000;
+        int32_t tri2 = (int32_t)(i * 290 % 40000) - 20000;
+        int32_t env = (int32_t)(i % 8820) < 4410 ? (int32_t)(i % 8820) : 8820 - (int32_t)(i % 8820);
+        int32_t noise = (int32_t)(test_rand(&seed) % 2001) - 1000;
+        pcm[i] = (int16_t)(((tri1 + tri2 / 2) * env) / 4410 + noise);
+    }
+}
+
+// Еталонний декодер за специфікацією IMA/DVI ADPCM
+static const int16_t ref_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static size_t ref_decode(const uint8_t *block, size_t samples, int16_t *pcm) {
+    static const int index_adjust[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+    int predictor = (int16_t)(block[0] | (block[1] << 8));
+    int index = block[2];
+    for (size_t i = 0; i < samples; i++) {
+        uint8_t byte = block[ADPCM_BLOCK_HEADER_SIZE + i / 2];
+        int code = (i & 1) ? byte >> 4 : byte & 0x0F;
+        int step = ref_steps[index];
+        int diff = step >> 3;
+        if (code & 4) diff += step;
+        if (code & 2) diff += step >> 1;
+        if (code & 1) diff += step >> 2;
+        predictor += (code & 8) ? -diff : diff;
+        predictor = predictor > 32767 ? 32767 : predictor < -32768 ? -32768 : predictor;
+        index += index_adjust[code & 7];
+        index = index < 0 ? 0 : index > 88 ? 88 : index;
+        pcm[i] = (int16_t)predictor;
+    }
+    return samples;
+}
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void test_find(void) {
+    TEST_ASSERT(codec_find(PACKET_CODEC_PCM16) == &codec_pcm16);
+    TEST_ASSERT(codec_find(PACKET_CODEC_IMA_ADPCM) == &codec_ima_adpcm);
+    TEST_ASSERT(codec_find(0xFF) == NULL);
+}
+
+static void test_pcm16_exact(void) {
+    int16_t pcm[FRAME];
+    int16_t out[FRAME];
+    uint8_t buf[FRAME * 2];
+    codec_state_t state;
+    make_voice(pcm, FRAME, 44100, 1);
+
+    codec_pcm16.reset(&state);
+    size_t len = codec_pcm16.encode(&state, pcm, FRAME, buf);
+    TEST_ASSERT_EQ(len, codec_pcm16.max_encoded_size(FRAME));
+    TEST_ASSERT_EQ(codec_pcm16.decode(&state, buf, len, out, FRAME), FRAME);
+    TEST_ASSERT(memcmp(pcm, out, sizeof(pcm)) == 0);
+}
+
+static void test_adpcm_bit_exact(void) {
+    static int16_t pcm[FRAME * FRAMES];
+    static int16_t out[FRAME * FRAMES];
+    static int16_t ref[FRAME * FRAMES];
+    uint8_t block[ADPCM_BLOCK_SIZE(FRAME)];
+    codec_state_t enc;
+    codec_state_t dec;
+    uint32_t hash = 2166136261u;
+    make_golden(pcm, FRAME * FRAMES);
+
+    codec_ima_adpcm.reset(&enc);
+    codec_ima_adpcm.reset(&dec);
+    TEST_ASSERT_EQ(codec_ima_adpcm.max_encoded_size(FRAME), sizeof(block));
+    for (int f = 0; f < FRAMES; f++) {
+        size_t len = codec_ima_adpcm.encode(&enc, &pcm[f * FRAME], FRAME, block);
+        TEST_ASSERT_EQ(len, sizeof(block));
+        hash = fnv1a(hash, block, len);
+
+        // Заголовок блоку - стан, на якому декодер зупинився після попереднього кадру
+        if (f > 0) {
+            TEST_ASSERT_EQ((int16_t)(block[0] | (block[1] << 8)), dec.adpcm.predictor);
+            TEST_ASSERT_EQ(block[2], dec.adpcm.index);
+        }
+        TEST_ASSERT_EQ(codec_ima_adpcm.decode(&dec, block, len, &out[f * FRAME], FRAME), FRAME);
+        ref_decode(block, FRAME, &ref[f * FRAME]);
+    }
+    TEST_ASSERT(memcmp(out, ref, sizeof(out)) == 0);
+
+    // Зафіксований вектор: будь-яка зміна бітового потоку кодера видна тут
+    printf("  encoded stream FNV-1a 0x%08x\n", hash);
+    TEST_ASSERT_EQ(hash, 0xd5822a37u);
+}
+
+static void test_adpcm_quality(void) {
+    static int16_t pcm[FRAME * FRAMES];
+    static int16_t out[FRAME * FRAMES];
+    uint8_t block[ADPCM_BLOCK_SIZE(FRAME)];
+    codec_state_t enc;
+    codec_state_t dec;
+    make_voice(pcm, FRAME * FRAMES, 44100, 2);
+
+    codec_ima_adpcm.reset(&enc);
+    codec_ima_adpcm.reset(&dec);
+    for (int f = 0; f < FRAMES; f++) {
+        size_t len = codec_ima_adpcm.encode(&enc, &pcm[f * FRAME], FRAME, block);
+        codec_ima_adpcm.decode(&dec, block, len, &out[f * FRAME], FRAME);
+    }
+    // Перший кадр - наближення предиктора від нуля
+    double snr = test_snr_db(&pcm[FRAME], &out[FRAME], FRAME * (FRAMES - 1));
+    printf("  IMA-ADPCM SNR %.1f dB, %zu bytes per %d samples\n", snr, sizeof(block), FRAME);
+    TEST_ASSERT(snr > 20);
+}
+
+// Кожен блок несе стан кодера, тому декодер не залежить від втраченого кадру
+static void test_adpcm_loss_recovery(void) {
+    int16_t pcm[FRAME * 3];
+    int16_t out[FRAME];
+    int16_t ref[FRAME];
+    uint8_t blocks[3][ADPCM_BLOCK_SIZE(FRAME)];
+    codec_state_t enc;
+    codec_state_t dec;
+    make_voice(pcm, FRAME * 3, 44100, 3);
+
+    codec_ima_adpcm.reset(&enc);
+    for (int f = 0; f < 3; f++) {
+        codec_ima_adpcm.encode(&enc, &pcm[f * FRAME], FRAME, blocks[f]);
+    }
+    codec_ima_adpcm.reset(&dec);
+    codec_ima_adpcm.decode(&dec, blocks[0], sizeof(blocks[0]), out, FRAME);
+    codec_ima_adpcm.decode(&dec, blocks[2], sizeof(blocks[2]), out, FRAME);
+    ref_decode(blocks[2], FRAME, ref);
+    TEST_ASSERT(memcmp(out, ref, sizeof(out)) == 0);
+}
+
+static void test_adpcm_rejects(void) {
+    uint8_t block[ADPCM_BLOCK_SIZE(4)] = {0, 0, 89, 0, 0x12, 0x34};
+    int16_t out[8];
+    codec_state_t dec;
+    codec_ima_adpcm.reset(&dec);
+    TEST_ASSERT_EQ(codec_ima_adpcm.decode(&dec, block, sizeof(block), out, 8), 0);
+    TEST_ASSERT_EQ(codec_ima_adpcm.decode(&dec, block, ADPCM_BLOCK_HEADER_SIZE - 1, out, 8), 0);
+    block[2] = 88;
+    TEST_ASSERT_EQ(codec_ima_adpcm.decode(&dec, block, sizeof(block), out, 8), 4);
+    TEST_ASSERT_EQ(codec_ima_adpcm.decode(&dec, block, sizeof(block), out, 3), 3);
+}
+
+static void test_benchmark(void) {
+    static int16_t pcm[44100];
+    static uint8_t encoded[sizeof(pcm)];
+    static int16_t out[44100];
+    const codec_t *codecs[] = {&codec_pcm16, &codec_ima_adpcm};
+    make_voice(pcm, 44100, 44100, 4);
+
+    for (size_t c = 0; c < 2; c++) {
+        const codec_t *codec = codecs[c];
+        codec_state_t state;
+        int reps = 20;
+
+        codec->reset(&state);
+        int64_t start = test_now_ns();
+        size_t bytes = 0;
+        for (int r = 0; r < reps; r++) {
+            bytes = 0;
+            for (int f = 0; f < 100; f++) {
+                bytes += codec->encode(&state, &pcm[f * FRAME], FRAME, encoded + bytes);
+            }
+        }
+        int64_t encode_ns = test_now_ns() - start;
+
+        start = test_now_ns();
+        for (int r = 0; r < reps; r++) {
+            size_t offset = 0;
+            size_t block = codec->max_encoded_size(FRAME);
+            for (int f = 0; f < 100; f++) {
+                codec->decode(&state, encoded + offset, block, &out[f * FRAME], FRAME);
+                offset += block;
+            }
+        }
+        int64_t decode_ns = test_now_ns() - start;
+        double samples = 44100.0 * reps;
+        printf("  %-9s encode %6.1f Msamples/s, decode %6.1f Msamples/s, %zu bytes per second of audio\n",
+               codec->name, samples / encode_ns * 1000, samples / decode_ns * 1000, bytes);
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_find);
+    TEST_RUN(test_pcm16_exact);
+    TEST_RUN(test_adpcm_bit_exact);
+    TEST_RUN(test_adpcm_quality);
+    TEST_RUN(test_adpcm_loss_recovery);
+    TEST_RUN(test_adpcm_rejects);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,144 @@
+#include <stdbool.h>
+#include <string.h>
+#include "test.h"
+#include "crypto.h"
+
+// Криптографічна сесія: вектор NIST для GCM, перший блок ключового потоку CTR,
+// шифрування на місці, відмова GCM на зміненому тегу, заголовку чи шифротексті
+// (і її відсутність у CTR) та пропускна здатність обох режимів на розмірах кадрів
+
+static const uint8_t zero_key[16];
+static const uint8_t zero_nonce[CRYPTO_NONCE_SIZE];
+
+// Тестовий випадок 2 зі специфікації GCM: нульові ключ, nonce і блок відкритого тексту
+static void test_gcm_vector(void) {
+    static const uint8_t expected_ct[16] = {
+        0x03, 0x88, 0xda, 0xce, 0x60, 0xb6, 0xa3, 0x92, 0xf3, 0x28, 0xc2, 0xb9, 0x71, 0xb2, 0xfe, 0x78
+    };
+    static const uint8_t expected_tag[16] = {
+        0xab, 0x6e, 0x47, 0xd4, 0x2c, 0xec, 0x13, 0xbd, 0xf5, 0x3a, 0x67, 0xb2, 0x12, 0x57, 0xbd, 0xdf
+    };
+    crypto_session_t s;
+    TEST_ASSERT_EQ(crypto_session_init(&s, CRYPTO_MODE_GCM, zero_key, 128), ESP_OK);
+    TEST_ASSERT_EQ(crypto_tag_size(&s), CRYPTO_TAG_SIZE);
+    uint8_t buf[16] = {0};
+    uint8_t tag[CRYPTO_TAG_SIZE];
+    TEST_ASSERT_EQ(crypto_encrypt(&s, zero_nonce, NULL, 0, buf, buf, sizeof(buf), tag), ESP_OK);
+    TEST_ASSERT(memcmp(buf, expected_ct, sizeof(buf)) == 0);
+    TEST_ASSERT(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+    TEST_ASSERT_EQ(crypto_decrypt(&s, zero_nonce, NULL, 0, buf, buf, sizeof(buf), tag), ESP_OK);
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        TEST_ASSERT_EQ(buf[i], 0);
+    }
+    crypto_session_free(&s);
+}
+
+// Лічильник CTR починається з нуля: перший блок - AES(0) нульовим ключем
+static void test_ctr_keystream(void) {
+    static const uint8_t expected[16] = {
+        0x66, 0xe9, 0x4b, 0xd4, 0xef, 0x8a, 0x2c, 0x3b, 0x88, 0x4c, 0xfa, 0x59, 0xca, 0x34, 0x2b, 0x2e
+    };
+    crypto_session_t s;
+    TEST_ASSERT_EQ(crypto_session_init(&s, CRYPTO_MODE_CTR, zero_key, 128), ESP_OK);
+    TEST_ASSERT_EQ(crypto_tag_size(&s), 0);
+    uint8_t buf[16] = {0};
+    TEST_ASSERT_EQ(crypto_encrypt(&s, zero_nonce, NULL, 0, buf, buf, sizeof(buf), NULL), ESP_OK);
+    TEST_ASSERT(memcmp(buf, expected, sizeof(buf)) == 0);
+    crypto_session_free(&s);
+}
+
+// GCM відкидає зміну будь-якого автентифікованого байта; CTR розшифровує будь-що
+static void test_tamper(void) {
+    uint8_t header[18];
+    uint8_t plain[220];
+    uint32_t seed = 0xC0DE;
+    for (size_t i = 0; i < sizeof(header); i++) {
+        header[i] = (uint8_t)test_rand(&seed);
+    }
+    for (size_t i = 0; i < sizeof(plain); i++) {
+        plain[i] = (uint8_t)test_rand(&seed);
+    }
+    uint8_t nonce[CRYPTO_NONCE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0, 0};
+
+    crypto_session_t s;
+    TEST_ASSERT_EQ(crypto_session_init(&s, CRYPTO_MODE_GCM, zero_key, 128), ESP_OK);
+    uint8_t sealed[sizeof(plain)];
+    uint8_t tag[CRYPTO_TAG_SIZE];
+    TEST_ASSERT_EQ(crypto_encrypt(&s, nonce, header, sizeof(header), plain, sealed, sizeof(plain), tag), ESP_OK);
+
+    uint8_t buf[sizeof(plain)];
+    for (int target = 0; target < 4; target++) {
+        uint8_t h[sizeof(header)];
+        uint8_t t[CRYPTO_TAG_SIZE];
+        uint8_t n[CRYPTO_NONCE_SIZE];
+        memcpy(h, header, sizeof(h));
+        memcpy(t, tag, sizeof(t));
+        memcpy(n, nonce, sizeof(n));
+        memcpy(buf, sealed, sizeof(buf));
+        switch (target) {
+        case 0: buf[100] ^= 0x01; break;    // Шифротекст
+        case 1: h[5] ^= 0x80; break;        // Заголовок (AAD)
+        case 2: t[15] ^= 0x01; break;       // Тег
+        case 3: n[9] ^= 0x01; break;        // Інший номер - інший nonce
+        }
+        TEST_ASSERT_EQ(crypto_decrypt(&s, n, h, sizeof(h), buf, buf, sizeof(buf), t), ESP_ERR_INVALID_CRC);
+    }
+    memcpy(buf, sealed, sizeof(buf));
+    TEST_ASSERT_EQ(crypto_decrypt(&s, nonce, header, sizeof(header), buf, buf, sizeof(buf), tag), ESP_OK);
+    TEST_ASSERT(memcmp(buf, plain, sizeof(plain)) == 0);
+    crypto_session_free(&s);
+
+    // Без тегу змінений шифротекст проходить і змінює рівно ті самі біти відкритого тексту
+    TEST_ASSERT_EQ(crypto_session_init(&s, CRYPTO_MODE_CTR, zero_key, 128), ESP_OK);
+    memcpy(buf, plain, sizeof(buf));
+    TEST_ASSERT_EQ(crypto_encrypt(&s, nonce, NULL, 0, buf, buf, sizeof(buf), NULL), ESP_OK);
+    buf[100] ^= 0x01;
+    TEST_ASSERT_EQ(crypto_decrypt(&s, nonce, NULL, 0, buf, buf, sizeof(buf), NULL), ESP_OK);
+    TEST_ASSERT_EQ(buf[100], plain[100] ^ 0x01);
+    crypto_session_free(&s);
+}
+
+// Байти на секунду шифрування на місці й дешифрування з перевіркою тегу. Розміри -
+// кадр 10 мс IMA ADPCM на 16 і 44.1 кГц та PCM16 на 44.1 кГц
+static void test_benchmark(void) {
+    static const size_t sizes[] = { 84, 224, 882 };
+    static const char *const names[] = { "CTR", "GCM" };
+    static uint8_t buf[882];
+    uint8_t header[18] = {3};
+    uint8_t nonce[CRYPTO_NONCE_SIZE] = {0};
+    uint8_t tag[CRYPTO_TAG_SIZE];
+    double frame_us[2][3];
+
+    for (int mode = CRYPTO_MODE_CTR; mode <= CRYPTO_MODE_GCM; mode++) {
+        crypto_session_t s;
+        TEST_ASSERT_EQ(crypto_session_init(&s, (crypto_mode_t)mode, zero_key, 128), ESP_OK);
+        for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+            enum { ROUNDS = 20000 };
+            bool ok = true;
+            int64_t start = test_now_ns();
+            for (int i = 0; i < ROUNDS; i++) {
+                nonce[9] = (uint8_t)i;
+                ok &= crypto_encrypt(&s, nonce, header, sizeof(header), buf, buf, sizes[k], tag) == ESP_OK;
+                ok &= crypto_decrypt(&s, nonce, header, sizeof(header), buf, buf, sizes[k], tag) == ESP_OK;
+            }
+            double seconds = (test_now_ns() - start) / 1e9;
+            TEST_ASSERT(ok);
+            frame_us[mode][k] = seconds * 1e6 / ROUNDS;
+            printf("  %s %4zu B: %6.1f MB/s (encrypt + decrypt %.2f us)\n", names[mode], sizes[k],
+                   2.0 * sizes[k] * ROUNDS / seconds / 1e6, frame_us[mode][k]);
+        }
+        crypto_session_free(&s);
+    }
+    // Тег GCM коштує GHASH і ще один блок AES; кадр PCM16 має вкладатися в мілісекунду
+    printf("  GCM / CTR per frame: %.1fx, %.1fx, %.1fx\n", frame_us[1][0] / frame_us[0][0],
+           frame_us[1][1] / frame_us[0][1], frame_us[1][2] / frame_us[0][2]);
+    TEST_ASSERT(frame_us[1][2] < 1000);
+}
+
+int main(void) {
+    TEST_RUN(test_gcm_vector);
+    TEST_RUN(test_ctr_keystream);
+    TEST_RUN(test_tamper);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "dsp.h"
+
+// Ядра DSP: зафіксовані вектори підсилення, порівняння фільтрів з моделлю в double
+// на тих самих квантованих коефіцієнтах, АЧХ і швидкість кожного ядра
+
+#define RATE 44100
+#define LEN 4410
+
+static void make_tone(int16_t *pcm, size_t len, double freq, double amplitude) {
+    for (size_t i = 0; i < len; i++) {
+        pcm[i] = (int16_t)lrint(amplitude * sin(2 * M_PI * freq * i / RATE));
+    }
+}
+
+static double rms(const int16_t *pcm, size_t len) {
+    double sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += (double)pcm[i] * pcm[i];
+    }
+    return sqrt(sum / len);
+}
+
+static void test_gain_golden(void) {
+    static const int16_t in[] = {1000, -1000, 32767, -32768, 1, -1, 3, 0};
+    static const int16_t half[] = {500, -500, 16384, -16384, 1, 0, 2, 0};
+    static const int16_t twice[] = {2000, -2000, 32767, -32768, 2, -2, 6, 0};
+    int16_t buf[8];
+
+    memcpy(buf, in, sizeof(buf));
+    dsp_gain_q15(buf, 8, DSP_GAIN_Q15(0.5));
+    TEST_ASSERT(memcmp(buf, half, sizeof(buf)) == 0);
+
+    memcpy(buf, in, sizeof(buf));
+    dsp_gain_q15(buf, 8, DSP_GAIN_Q15(2.0));
+    TEST_ASSERT(memcmp(buf, twice, sizeof(buf)) == 0);
+
+    memcpy(buf, in, sizeof(buf));
+    dsp_gain_q15(buf, 8, DSP_Q15_ONE);
+    TEST_ASSERT(memcmp(buf, in, sizeof(buf)) == 0);
+}
+
+static void test_dc_blocker(void) {
+    static int16_t buf[RATE];
+    dsp_dc_blocker_t dc;
+    dsp_dc_blocker_init(&dc, RATE, 20);
+
+    // Модель в double з тим самим полюсом
+    double r = dc.r_q15 / (double)DSP_Q15_ONE;
+    double x1 = 0, y1 = 0;
+    make_tone(buf, RATE, 1000, 8000);
+    for (size_t i = 0; i < RATE; i++) {
+        buf[i] += 4000;
+    }
+    int16_t in[RATE];
+    memcpy(in, buf, sizeof(in));
+    dsp_dc_blocker_process(&dc, buf, RATE / 2);
+    dsp_dc_blocker_process(&dc, buf + RATE / 2, RATE / 2);
+    int max_err = 0;
+    for (size_t i = 0; i < RATE; i++) {
+        double y = in[i] - x1 + r * y1;
+        x1 = in[i];
+        y1 = y;
+        int err = abs(buf[i] - (int)lrint(y));
+        max_err = err > max_err ? err : max_err;
+    }
+    printf("  DC blocker max error against model %d LSB\n", max_err);
+    TEST_ASSERT(max_err <= 1);
+
+    // Через секунду постійна складова прибрана, тон не ослаблений
+    double mean = 0;
+    for (size_t i = RATE - LEN; i < RATE; i++) {
+        mean += buf[i];
+    }
+    mean /= LEN;
+    TEST_ASSERT(fabs(mean) < 2);
+    TEST_ASSERT(fabs(20 * log10(rms(buf + RATE - LEN, LEN) / (8000 / sqrt(2)))) < 0.1);
+}
+
+// Пряма форма I у double з квантованими коефіцієнтами фільтра; повертає відношення
+// сигналу до похибки округлення, яку полюси біля одиничного кола підсилюють (дБ)
+static double biquad_model_snr_db(const dsp_biquad_t *bq, const int16_t *in, const int16_t *out, size_t len) {
+    double b0 = bq->b0 / 16384.0, b1 = bq->b1 / 16384.0, b2 = bq->b2 / 16384.0;
+    double a1 = bq->a1 / 16384.0, a2 = bq->a2 / 16384.0;
+    double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    double signal = 0, noise = 0;
+    for (size_t i = 0; i < len; i++) {
+        double y = b0 * in[i] + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = in[i];
+        y2 = y1;
+        y1 = y;
+        signal += y * y;
+        noise += (out[i] - y) * (out[i] - y);
+    }
+    return 10 * log10(signal / noise);
+}
+
+static double biquad_gain_db(dsp_biquad_t *bq, double freq) {
+    static int16_t buf[LEN * 2];
+    make_tone(buf, LEN * 2, freq, 8000);
+    dsp_biquad_reset(bq);
+    dsp_biquad_process(bq, buf, LEN * 2);
+    return 20 * log10(rms(buf + LEN, LEN) / (8000 / sqrt(2)));
+}
+
+static void test_biquad(void) {
+    static int16_t in[LEN];
+    static int16_t out[LEN];
+    uint32_t seed = 11;
+    for (size_t i = 0; i < LEN; i++) {
+        in[i] = (int16_t)((test_rand_unit(&seed) - 0.5) * 20000);
+    }
+
+    dsp_biquad_t hp;
+    dsp_biquad_t lp;
+    dsp_biquad_init_highpass(&hp, RATE, 300, 0.707f);
+    dsp_biquad_init_lowpass(&lp, RATE, 3400, 0.707f);
+
+    memcpy(out, in, sizeof(out));
+    dsp_biquad_process(&hp, out, LEN);
+    double hp_snr = biquad_model_snr_db(&hp, in, out, LEN);
+    memcpy(out, in, sizeof(out));
+    dsp_biquad_process(&lp, out, LEN);
+    double lp_snr = biquad_model_snr_db(&lp, in, out, LEN);
+    printf("  biquad against model: highpass %.1f dB, lowpass %.1f dB\n", hp_snr, lp_snr);
+    TEST_ASSERT(hp_snr > 40);
+    TEST_ASSERT(lp_snr > 60);
+
+    double hp_50 = biquad_gain_db(&hp, 50);
+    double hp_1k = biquad_gain_db(&hp, 1000);
+    double lp_1k = biquad_gain_db(&lp, 1000);
+    double lp_10k = biquad_gain_db(&lp, 10000);
+    printf("  highpass 300 Hz: %.1f dB at 50 Hz, %.1f dB at 1 kHz; lowpass 3.4 kHz: %.1f dB at 1 kHz, %.1f dB at 10 kHz\n",
+           hp_50, hp_1k, lp_1k, lp_10k);
+    TEST_ASSERT(hp_50 < -25);
+    TEST_ASSERT(fabs(hp_1k) < 1);
+    TEST_ASSERT(fabs(lp_1k) < 1);
+    TEST_ASSERT(lp_10k < -15);
+}
+
+// Повна амплітуда з резонансним фільтром: вихід насичується, а не перевертається
+static void test_biquad_saturation(void) {
+    int16_t buf[LEN];
+    dsp_biquad_t bq;
+    dsp_biquad_init_lowpass(&bq, RATE, 1000, 4.0f);
+    make_tone(buf, LEN, 1000, 32767);
+    dsp_biquad_process(&bq, buf, LEN);
+    int saturated = 0;
+    for (size_t i = 1; i < LEN; i++) {
+        // Перехід через нуль з одного краю на інший означав би переповнення
+        TEST_ASSERT(abs(buf[i] - buf[i - 1]) < 32768);
+        saturated += buf[i] == INT16_MAX || buf[i] == INT16_MIN;
+    }
+    TEST_ASSERT(saturated > 0);
+}
+
+static void test_benchmark(void) {
+    static int16_t buf[RATE];
+    const int reps = 50;
+    make_tone(buf, RATE, 1000, 8000);
+
+    dsp_dc_blocker_t dc;
+    dsp_biquad_t bq;
+    dsp_dc_blocker_init(&dc, RATE, 20);
+    dsp_biquad_init_highpass(&bq, RATE, 300, 0.707f);
+
+    int64_t start = test_now_ns();
+    for (int r = 0; r < reps; r++) {
+        dsp_gain_q15(buf, RATE, DSP_GAIN_Q15(1.0));
+    }
+    int64_t gain_ns = test_now_ns() - start;
+    start = test_now_ns();
+    for (int r = 0; r < reps; r++) {
+        dsp_dc_blocker_process(&dc, buf, RATE);
+    }
+    int64_t dc_ns = test_now_ns() - start;
+    start = test_now_ns();
+    for (int r = 0; r < reps; r++) {
+        dsp_biquad_process(&bq, buf, RATE);
+    }
+    int64_t bq_ns = test_now_ns() - start;
+
+    double samples = (double)RATE * reps;
+    printf("  gain %.1f Msamples/s, DC blocker %.1f Msamples/s, biquad %.1f Msamples/s\n",
+           samples / gain_ns * 1000, samples / dc_ns * 1000, samples / bq_ns * 1000);
+}
+
+int main(void) {
+    TEST_RUN(test_gain_golden);
+    TEST_RUN(test_dc_blocker);
+    TEST_RUN(test_biquad);
+    TEST_RUN(test_biquad_saturation);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "codec.h"
+#include "dtx.h"
+
+// DTX: точність детектора на розмічених синтетичних записах (голосні, шиплячі, паузи
+// на тлі тихого і гучного шуму), заощаджений трафік, дескриптор тиші і комфортний шум
+
+#define RATE 44100
+#define FRAME 441
+#define CLIP_FRAMES 600
+
+typedef enum {
+    SEG_SILENCE,
+    SEG_VOICED,
+    SEG_FRICATIVE,
+} segment_t;
+
+typedef struct {
+    int start_ms;
+    segment_t type;
+    double level;               // Середній модуль мови
+} clip_segment_t;
+
+typedef struct {
+    const char *name;
+    double noise_level;         // Середній модуль фонового шуму
+    clip_segment_t segments[8];
+} clip_t;
+
+// Кожен запис закінчується тишею; сегмент триває до початку наступного
+static const clip_t clips[] = {
+    {"quiet room", 50, {
+        {0, SEG_SILENCE, 0}, {1000, SEG_VOICED, 2000}, {2000, SEG_SILENCE, 0},
+        {2500, SEG_FRICATIVE, 100}, {2800, SEG_SILENCE, 0}, {4000, SEG_VOICED, 400},
+        {5000, SEG_SILENCE, 0}, {-1, SEG_SILENCE, 0},
+    }},
+    {"street", 300, {
+        {0, SEG_SILENCE, 0}, {1500, SEG_VOICED, 3000}, {3000, SEG_SILENCE, 0},
+        {4000, SEG_VOICED, 1500}, {4600, SEG_SILENCE, 0}, {-1, SEG_SILENCE, 0},
+    }},
+};
+
+static segment_t segment_at(const clip_t *clip, int ms, double *level) {
+    segment_t type = SEG_SILENCE;
+    *level = 0;
+    for (int s = 0; clip->segments[s].start_ms >= 0; s++) {
+        if (clip->segments[s].start_ms <= ms) {
+            type = clip->segments[s].type;
+            *level = clip->segments[s].level;
+        }
+    }
+    return type;
+}
+
+// Голосні - гармоніки основного тону, шиплячі - вузькосмуговий шум біля 5 кГц;
+// рівномірний шум [-2L, 2L] має середній модуль L
+static void make_clip(const clip_t *clip, int16_t *pcm, segment_t *labels, uint32_t seed) {
+    double lp = 0;
+    for (size_t i = 0; i < (size_t)CLIP_FRAMES * FRAME; i++) {
+        double t = (double)i / RATE;
+        double level;
+        segment_t type = segment_at(clip, (int)(i * 1000 / RATE), &level);
+        if (i % FRAME == 0) {
+            labels[i / FRAME] = type;
+        }
+        double v = 0;
+        if (type == SEG_VOICED) {
+            // Середній модуль цієї суміші близько 0.9
+            v = level / 0.9 * (0.7 * sin(2 * M_PI * 130 * t) + 0.5 * sin(2 * M_PI * 390 * t) + 0.3 * sin(2 * M_PI * 910 * t));
+        } else if (type == SEG_FRICATIVE) {
+            lp += 0.2 * ((test_rand_unit(&seed) - 0.5) - lp);
+            // Середній модуль цього шуму після модуляції близько 0.05
+            v = level / 0.05 * lp * sin(2 * M_PI * 5000 * t);
+        }
+        double noise = (test_rand_unit(&seed) - 0.5) * 4 * clip->noise_level;
+        double x = v + noise;
+        pcm[i] = (int16_t)(x > 32767 ? 32767 : x < -32768 ? -32768 : lrint(x));
+    }
+}
+
+static void test_vad_accuracy(void) {
+    static int16_t pcm[CLIP_FRAMES * FRAME];
+    static segment_t labels[CLIP_FRAMES];
+    // Кадр потоку 16 кГц IMA-ADPCM у мережі разом із заголовком пакета
+    const size_t frame_bytes = PACKET_HEADER_SIZE + ADPCM_BLOCK_SIZE(160);
+    const size_t sid_bytes = PACKET_HEADER_SIZE + DTX_SID_SIZE;
+
+    for (size_t c = 0; c < sizeof(clips) / sizeof(clips[0]); c++) {
+        make_clip(&clips[c], pcm, labels, 1 + c);
+        dtx_t dtx;
+        dtx_init(&dtx);
+
+        int speech = 0, detected = 0, silence = 0, false_alarms = 0;
+        int since_speech = DTX_HANGOVER_FRAMES + 1;
+        size_t bytes = 0;
+        for (int f = 0; f < CLIP_FRAMES; f++) {
+            dtx_action_t action = dtx_process(&dtx, pcm + f * FRAME, FRAME);
+            bytes += action == DTX_SEND ? frame_bytes : action == DTX_SID ? sid_bytes : 0;
+            since_speech = labels[f] != SEG_SILENCE ? 0 : since_speech + 1;
+            if (labels[f] != SEG_SILENCE) {
+                speech++;
+                detected += action == DTX_SEND;
+            } else if (since_speech > DTX_HANGOVER_FRAMES) {
+                // Кадри утримання після мови передаються навмисно
+                silence++;
+                false_alarms += action == DTX_SEND;
+            }
+        }
+
+        dtx_stats_t stats;
+        dtx_get_stats(&dtx, &stats);
+        double saved = 100.0 * (1.0 - (double)bytes / (CLIP_FRAMES * frame_bytes));
+        printf("  %-10s speech detected %3d/%3d, false alarms %2d/%3d, %u SID, bandwidth saved %.0f%%\n",
+               clips[c].name, detected, speech, false_alarms, silence, stats.sid, saved);
+        TEST_ASSERT(detected >= speech * 97 / 100);
+        TEST_ASSERT(false_alarms <= silence * 5 / 100);
+        TEST_ASSERT_EQ(stats.frames, CLIP_FRAMES);
+        TEST_ASSERT_EQ(stats.speech + stats.sid + stats.suppressed, CLIP_FRAMES);
+        TEST_ASSERT(saved > 30);
+    }
+}
+
+// Перший кадр тиші одразу дає SID, далі раз на DTX_SID_INTERVAL кадрів
+static void test_sid_schedule(void) {
+    int16_t pcm[FRAME] = {0};
+    dtx_t dtx;
+    dtx_init(&dtx);
+    TEST_ASSERT_EQ(dtx_process(&dtx, pcm, FRAME), DTX_SID);
+    for (int f = 1; f < DTX_SID_INTERVAL * 3; f++) {
+        TEST_ASSERT_EQ(dtx_process(&dtx, pcm, FRAME), f % DTX_SID_INTERVAL == 0 ? DTX_SID : DTX_SUPPRESS);
+    }
+
+    // Мова одразу перериває тишу, утримання триває DTX_HANGOVER_FRAMES кадрів
+    int16_t loud[FRAME];
+    for (int i = 0; i < FRAME; i++) {
+        loud[i] = (int16_t)lrint(3000 * sin(2 * M_PI * 200 * i / RATE));
+    }
+    TEST_ASSERT_EQ(dtx_process(&dtx, loud, FRAME), DTX_SEND);
+    for (int f = 1; f < DTX_HANGOVER_FRAMES; f++) {
+        TEST_ASSERT_EQ(dtx_process(&dtx, pcm, FRAME), DTX_SEND);
+    }
+    TEST_ASSERT_EQ(dtx_process(&dtx, pcm, FRAME), DTX_SID);
+}
+
+static void test_sid_payload(void) {
+    uint8_t buf[DTX_SID_SIZE];
+    int32_t level;
+    TEST_ASSERT_EQ(dtx_write_sid(buf, 1234), DTX_SID_SIZE);
+    TEST_ASSERT(dtx_parse_sid(buf, DTX_SID_SIZE, &level));
+    TEST_ASSERT_EQ(level, 1234);
+    dtx_write_sid(buf, 100000);
+    dtx_parse_sid(buf, DTX_SID_SIZE, &level);
+    TEST_ASSERT_EQ(level, UINT16_MAX);
+    dtx_write_sid(buf, -5);
+    dtx_parse_sid(buf, DTX_SID_SIZE, &level);
+    TEST_ASSERT_EQ(level, 0);
+    TEST_ASSERT(!dtx_parse_sid(buf, DTX_SID_SIZE + 1, &level));
+}
+
+// Шум приймача має рівень з SID і вимикається, коли дескриптори перестають надходити
+static void test_comfort_noise(void) {
+    int16_t pcm[FRAME];
+    cng_t cng;
+    cng_init(&cng, 7);
+    cng_update(&cng, 200);
+    cng_generate(&cng, pcm, FRAME);
+    double level = dtx_level(pcm, FRAME);
+    printf("  comfort noise level %.0f for SID level 200\n", level);
+    TEST_ASSERT(fabs(level - 200) < 20);
+
+    // Новий рівень досягається плавно, без стрибка
+    cng_update(&cng, 800);
+    cng_generate(&cng, pcm, FRAME);
+    TEST_ASSERT(cng.level > 200 && cng.level < 800);
+    for (int f = 0; f < 20; f++) {
+        cng_generate(&cng, pcm, FRAME);
+    }
+    TEST_ASSERT(abs(cng.level - 800) < 8);
+
+    for (int f = 21; f < CNG_TIMEOUT_FRAMES; f++) {
+        TEST_ASSERT(cng.active);
+        cng_generate(&cng, pcm, FRAME);
+    }
+    TEST_ASSERT(!cng.active);
+}
+
+int main(void) {
+    TEST_RUN(test_vad_accuracy);
+    TEST_RUN(test_sid_schedule);
+    TEST_RUN(test_sid_payload);
+    TEST_RUN(test_comfort_noise);
+    return TEST_EXIT_CODE();
+}
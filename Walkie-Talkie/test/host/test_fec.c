@@ -0,0 +1,229 @@
+#include <string.h>
+#include "test.h"
+#include "fec.h"
+
+// XOR-парність: відновлення однієї втрати в групі, номери без аудіокадрів, переповнення
+// номера, зміна сесії та залишкові втрати проти надлишку на моделях втрат каналу
+
+#define MAX_PAYLOAD 128
+#define SESSION 0x5E55
+
+// Навантаження однозначно визначається номером, тож відновлене можна звірити
+static size_t make_payload(uint16_t seq, uint8_t *buf) {
+    size_t len = 60 + seq % 25;
+    uint32_t seed = seq + 1;
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)test_rand(&seed);
+    }
+    return len;
+}
+
+static void test_encoder_rejects(void) {
+    fec_encoder_t enc;
+    TEST_ASSERT(!fec_encoder_init(&enc, 1, MAX_PAYLOAD));
+    TEST_ASSERT(!fec_encoder_init(&enc, 3, MAX_PAYLOAD));
+    TEST_ASSERT(!fec_encoder_init(&enc, FEC_MAX_GROUP * 2, MAX_PAYLOAD));
+    TEST_ASSERT(fec_encoder_init(&enc, 4, MAX_PAYLOAD));
+    fec_encoder_free(&enc);
+}
+
+// Групу з номерами base..base+group-1 кодує encoder, decoder отримує всі кадри, крім lost;
+// gap - номер без аудіокадру (пропуск DTX), -1 якщо немає
+static const uint8_t *run_group(uint16_t base, uint8_t group, int lost, int gap,
+                                uint16_t *lost_seq, size_t *lost_len, fec_decoder_t *dec) {
+    static uint8_t parity[FEC_HEADER_SIZE + MAX_PAYLOAD];
+    fec_encoder_t enc;
+    fec_encoder_init(&enc, group, MAX_PAYLOAD);
+    size_t parity_len = 0;
+    for (int i = 0; i < group; i++) {
+        uint16_t seq = (uint16_t)(base + i);
+        uint8_t payload[MAX_PAYLOAD];
+        size_t len = make_payload(seq, payload);
+        bool done = i == gap ? fec_encoder_add(&enc, seq, NULL, 0) : fec_encoder_add(&enc, seq, payload, len);
+        if (i != lost && i != gap) {
+            fec_decoder_add(dec, SESSION, seq, payload, len);
+        }
+        if (done) {
+            parity_len = fec_encoder_write(&enc, parity);
+        }
+    }
+    fec_encoder_free(&enc);
+    return fec_decoder_recover(dec, SESSION, (uint16_t)(base + group - 1), parity, parity_len, lost_seq, lost_len);
+}
+
+static void test_single_loss(void) {
+    for (uint8_t group = 2; group <= FEC_MAX_GROUP; group *= 2) {
+        for (int lost = 0; lost < group; lost++) {
+            fec_decoder_t dec;
+            fec_decoder_init(&dec, MAX_PAYLOAD);
+            uint16_t lost_seq;
+            size_t lost_len;
+            const uint8_t *frame = run_group(1000, group, lost, -1, &lost_seq, &lost_len, &dec);
+            uint8_t expected[MAX_PAYLOAD];
+            size_t expected_len = make_payload((uint16_t)(1000 + lost), expected);
+            TEST_ASSERT(frame != NULL);
+            if (frame) {
+                TEST_ASSERT_EQ(lost_seq, 1000 + lost);
+                TEST_ASSERT_EQ(lost_len, expected_len);
+                TEST_ASSERT(memcmp(frame, expected, expected_len) == 0);
+            }
+            fec_decoder_free(&dec);
+        }
+    }
+}
+
+// Номер без аудіокадру не входить у маску і не вважається втратою
+static void test_dtx_gap_and_wrap(void) {
+    fec_decoder_t dec;
+    fec_decoder_init(&dec, MAX_PAYLOAD);
+    uint16_t lost_seq;
+    size_t lost_len;
+    const uint8_t *frame = run_group(65534, 4, 3, 1, &lost_seq, &lost_len, &dec);
+    TEST_ASSERT(frame != NULL);
+    TEST_ASSERT_EQ(lost_seq, 1);
+
+    // Без втрат відновлювати нічого
+    TEST_ASSERT(run_group(100, 4, -1, 2, &lost_seq, &lost_len, &dec) == NULL);
+    fec_decoder_stats_t stats;
+    fec_decoder_get_stats(&dec, &stats);
+    TEST_ASSERT_EQ(stats.recovered, 1);
+    TEST_ASSERT_EQ(stats.unrecoverable, 0);
+    fec_decoder_free(&dec);
+
+    // Група лише з пропусків не дає пакета парності
+    fec_encoder_t enc;
+    uint8_t parity[FEC_HEADER_SIZE + MAX_PAYLOAD];
+    fec_encoder_init(&enc, 2, MAX_PAYLOAD);
+    fec_encoder_add(&enc, 7, NULL, 0);
+    TEST_ASSERT(fec_encoder_add(&enc, 8, NULL, 0));
+    TEST_ASSERT_EQ(fec_encoder_write(&enc, parity), 0);
+    fec_encoder_free(&enc);
+}
+
+static void test_double_loss_and_session(void) {
+    static uint8_t parity[FEC_HEADER_SIZE + MAX_PAYLOAD];
+    fec_encoder_t enc;
+    fec_decoder_t dec;
+    uint8_t payload[MAX_PAYLOAD];
+    fec_encoder_init(&enc, 4, MAX_PAYLOAD);
+    fec_decoder_init(&dec, MAX_PAYLOAD);
+    size_t parity_len = 0;
+    for (uint16_t seq = 0; seq < 4; seq++) {
+        size_t len = make_payload(seq, payload);
+        if (fec_encoder_add(&enc, seq, payload, len)) {
+            parity_len = fec_encoder_write(&enc, parity);
+        }
+        if (seq >= 2) {
+            fec_decoder_add(&dec, SESSION, seq, payload, len);
+        }
+    }
+    uint16_t lost_seq;
+    size_t lost_len;
+    TEST_ASSERT(fec_decoder_recover(&dec, SESSION, 3, parity, parity_len, &lost_seq, &lost_len) == NULL);
+    fec_decoder_stats_t stats;
+    fec_decoder_get_stats(&dec, &stats);
+    TEST_ASSERT_EQ(stats.unrecoverable, 1);
+
+    // Копії іншої сесії не використовуються
+    TEST_ASSERT(fec_decoder_recover(&dec, SESSION + 1, 3, parity, parity_len, &lost_seq, &lost_len) == NULL);
+    TEST_ASSERT(fec_decoder_recover(&dec, SESSION, 3, parity, FEC_HEADER_SIZE - 1, &lost_seq, &lost_len) == NULL);
+    fec_encoder_free(&enc);
+    fec_decoder_free(&dec);
+}
+
+typedef struct {
+    const char *name;
+    double p_loss;              // Бернуллі: ймовірність втрати; Гілберт-Еліот: перехід у поганий стан
+    double p_recover;           // Гілберт-Еліот: перехід у добрий стан; 0 - модель Бернуллі
+} loss_model_t;
+
+static bool channel_lost(const loss_model_t *model, bool *bad, uint32_t *seed) {
+    double r = test_rand_unit(seed);
+    if (model->p_recover == 0) {
+        return r < model->p_loss;
+    }
+    *bad = *bad ? r >= model->p_recover : r < model->p_loss;
+    return *bad;
+}
+
+// Пакети парності проходять через той самий канал, що й аудіокадри
+static void test_loss_simulation(void) {
+    static const loss_model_t models[] = {
+        {"Bernoulli 2%", 0.02, 0},
+        {"Bernoulli 5%", 0.05, 0},
+        {"Bernoulli 10%", 0.10, 0},
+        {"GE burst 2", 0.03, 0.5},
+    };
+    const int frames = 20000;
+
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        for (uint8_t group = 2; group <= FEC_MAX_GROUP; group *= 2) {
+            fec_encoder_t enc;
+            fec_decoder_t dec;
+            fec_encoder_init(&enc, group, MAX_PAYLOAD);
+            fec_decoder_init(&dec, MAX_PAYLOAD);
+            uint32_t seed = 77 + m;
+            bool bad = false;
+            int lost = 0;
+            int residual = 0;
+            int corrupt = 0;
+            uint16_t missing[FEC_MAX_GROUP];
+            int missing_count = 0;
+
+            for (int n = 0; n < frames; n++) {
+                uint16_t seq = (uint16_t)n;
+                uint8_t payload[MAX_PAYLOAD];
+                size_t len = make_payload(seq, payload);
+                if (channel_lost(&models[m], &bad, &seed)) {
+                    lost++;
+                    missing[missing_count++] = seq;
+                } else {
+                    fec_decoder_add(&dec, SESSION, seq, payload, len);
+                }
+                if (!fec_encoder_add(&enc, seq, payload, len)) {
+                    continue;
+                }
+
+                uint8_t parity[FEC_HEADER_SIZE + MAX_PAYLOAD];
+                size_t parity_len = fec_encoder_write(&enc, parity);
+                uint16_t lost_seq;
+                size_t lost_len;
+                const uint8_t *frame = NULL;
+                if (!channel_lost(&models[m], &bad, &seed)) {
+                    frame = fec_decoder_recover(&dec, SESSION, seq, parity, parity_len, &lost_seq, &lost_len);
+                }
+                if (frame) {
+                    uint8_t expected[MAX_PAYLOAD];
+                    size_t expected_len = make_payload(lost_seq, expected);
+                    corrupt += missing_count != 1 || lost_seq != missing[0] || lost_len != expected_len ||
+                               memcmp(frame, expected, expected_len) != 0;
+                    missing_count--;
+                }
+                residual += missing_count;
+                missing_count = 0;
+            }
+
+            fec_encoder_stats_t stats;
+            fec_encoder_get_stats(&enc, &stats);
+            double overhead = 100.0 * stats.parity_bytes / stats.data_bytes;
+            printf("  %-14s group %u: lost %5.2f%% -> residual %5.2f%%, overhead %4.1f%%\n",
+                   models[m].name, group, 100.0 * lost / frames, 100.0 * residual / frames, overhead);
+            TEST_ASSERT_EQ(corrupt, 0);
+            TEST_ASSERT(residual < lost);
+            if (models[m].p_recover == 0 && group <= 4) {
+                TEST_ASSERT(residual * 2 < lost);
+            }
+            fec_encoder_free(&enc);
+            fec_decoder_free(&dec);
+        }
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_encoder_rejects);
+    TEST_RUN(test_single_loss);
+    TEST_RUN(test_dtx_gap_and_wrap);
+    TEST_RUN(test_double_loss_and_session);
+    TEST_RUN(test_loss_simulation);
+    return TEST_EXIT_CODE();
+}
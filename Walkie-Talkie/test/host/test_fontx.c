@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "fontx.h"
+
+// Шрифти FONTX: таблиця ANK у RAM після OpenFontx, читання з файлу як запасний
+// шлях, відсутній і пошкоджений файл, вбудований шрифт і швидкість отримання
+// символів з файлу проти таблиці
+
+#define FONT_W 8
+#define FONT_H 16
+#define FONT_FSZ ((FONT_W + 7) / 8 * FONT_H)
+#define ANK_HEADER 17
+
+static uint8_t glyphs[256 * FONT_FSZ];
+
+// Пише файл FONTX2 з таблицею ANK; size - скільки байтів залишити (0 - усі)
+static void write_font(const char *path, uint8_t w, size_t size) {
+    uint32_t seed = 0xF0A7;
+    for (size_t i = 0; i < sizeof(glyphs); i++) {
+        glyphs[i] = (uint8_t)test_rand(&seed);
+    }
+    uint8_t header[ANK_HEADER] = {'F', 'O', 'N', 'T', 'X', '2', 'T', 'E', 'S', 'T', '8', 'X', '1', '6', w, FONT_H, 0};
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT(f != NULL);
+    if (f == NULL) {
+        return;
+    }
+    uint8_t data[ANK_HEADER + sizeof(glyphs)];
+    memcpy(data, header, ANK_HEADER);
+    memcpy(data + ANK_HEADER, glyphs, sizeof(glyphs));
+    fwrite(data, 1, size ? size : sizeof(data), f);
+    fclose(f);
+}
+
+static char path[] = "/tmp/fontx_test_XXXXXX";
+
+static void test_ram_table(void) {
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    write_font(path, FONT_W, 0);
+
+    FontxFile fx[2];
+    InitFontx(fx, path, "");
+    TEST_ASSERT(OpenFontx(&fx[0]));
+    TEST_ASSERT(fx[0].is_ank);
+    TEST_ASSERT_EQ(fx[0].w, FONT_W);
+    TEST_ASSERT_EQ(fx[0].h, FONT_H);
+    TEST_ASSERT_EQ(fx[0].fsz, FONT_FSZ);
+    TEST_ASSERT(fx[0].glyphs != NULL);
+
+    // Із таблиці символ віддається без копіювання
+    uint8_t buffer[FontxGlyphBufSize];
+    uint8_t pw;
+    uint8_t ph;
+    for (int c = 0; c < 256; c++) {
+        const uint8_t *glyph = GetFontxGlyph(fx, (uint8_t)c, buffer, &pw, &ph);
+        TEST_ASSERT(glyph != NULL && glyph != buffer);
+        if (glyph) {
+            TEST_ASSERT(memcmp(glyph, &glyphs[c * FONT_FSZ], FONT_FSZ) == 0);
+        }
+    }
+    TEST_ASSERT(GetFontx(fx, 'A', buffer, &pw, &ph));
+    TEST_ASSERT(memcmp(buffer, &glyphs['A' * FONT_FSZ], FONT_FSZ) == 0);
+    TEST_ASSERT_EQ(pw, FONT_W);
+    TEST_ASSERT_EQ(ph, FONT_H);
+
+    // Без таблиці (не вистачило пам'яті) символи читаються з файлу
+    const uint8_t *table = fx[0].glyphs;
+    fx[0].glyphs = NULL;
+    for (int c = 0; c < 256; c++) {
+        const uint8_t *glyph = GetFontxGlyph(fx, (uint8_t)c, buffer, &pw, &ph);
+        TEST_ASSERT(glyph == buffer);
+        TEST_ASSERT(memcmp(buffer, &glyphs[c * FONT_FSZ], FONT_FSZ) == 0);
+    }
+    fx[0].glyphs = table;
+
+    CloseFontx(&fx[0]);
+    TEST_ASSERT(fx[0].glyphs == NULL);
+    TEST_ASSERT(!fx[0].opened);
+    CloseFontx(&fx[1]);
+}
+
+static void test_bad_files(void) {
+    FontxFile fx[2];
+    uint8_t buffer[FontxGlyphBufSize];
+
+    // Відсутній файл не відкривається повторно на кожен символ
+    InitFontx(fx, "/nonexistent/FONT.FNT", "");
+    TEST_ASSERT(!GetFontx(fx, 'A', buffer, NULL, NULL));
+    TEST_ASSERT(fx[0].missing);
+    TEST_ASSERT(!OpenFontx(&fx[0]));
+    CloseFontx(&fx[0]);
+    TEST_ASSERT(!fx[0].missing);
+
+    // Коротший за заголовок і символ ширший за FontxGlyphBufSize: файл закритий
+    // один раз і далі вважається відсутнім
+    write_font(path, FONT_W, 10);
+    InitFontx(fx, path, "");
+    TEST_ASSERT(!OpenFontx(&fx[0]));
+    TEST_ASSERT(fx[0].missing && !fx[0].opened);
+    CloseFontx(&fx[0]);
+
+    write_font(path, 72, 0);
+    InitFontx(fx, path, "");
+    TEST_ASSERT(!GetFontx(fx, 'A', buffer, NULL, NULL));
+    TEST_ASSERT(fx[0].missing && !fx[0].opened);
+    CloseFontx(&fx[0]);
+
+    // Обрізана таблиця: заголовок дійсний, символи лишаються у файлі
+    write_font(path, FONT_W, ANK_HEADER + 100);
+    InitFontx(fx, path, "");
+    TEST_ASSERT(OpenFontx(&fx[0]));
+    TEST_ASSERT(fx[0].glyphs == NULL);
+    TEST_ASSERT(GetFontx(fx, 1, buffer, NULL, NULL));
+    TEST_ASSERT(!GetFontx(fx, 200, buffer, NULL, NULL));
+    CloseFontx(&fx[0]);
+}
+
+static void test_embedded(void) {
+    FontxFile fx[2];
+    const FontxFont font = {"EMBED", FONT_W, FONT_H, FONT_FSZ, glyphs};
+    InitFontxEmbedded(fx, &font);
+    uint8_t buffer[FontxGlyphBufSize];
+    uint8_t pw;
+    uint8_t ph;
+    TEST_ASSERT(GetFontxGlyph(fx, 'z', buffer, &pw, &ph) == &glyphs['z' * FONT_FSZ]);
+    TEST_ASSERT_EQ(pw, FONT_W);
+    TEST_ASSERT_EQ(ph, FONT_H);
+    // Закриття вбудованого шрифту нічого не звільняє
+    CloseFontx(&fx[0]);
+    TEST_ASSERT(fx[0].glyphs == glyphs);
+}
+
+// Рядок з 24 символів, як у DrawText, доки не набереться rounds символів
+static double glyphs_per_second(FontxFile *fx, int rounds) {
+    static const char text[] = "Walkie-Talkie Channel 3!";
+    uint8_t buffer[FontxGlyphBufSize];
+    uint8_t pw;
+    uint8_t ph;
+    unsigned checksum = 0;
+    int64_t start = test_now_ns();
+    for (int i = 0; i < rounds; i++) {
+        const uint8_t *glyph = GetFontxGlyph(fx, (uint8_t)text[i % (sizeof(text) - 1)], buffer, &pw, &ph);
+        checksum += glyph[i % FONT_FSZ];
+    }
+    double seconds = (test_now_ns() - start) / 1e9;
+    TEST_ASSERT(checksum != 0);
+    return rounds / seconds;
+}
+
+static void test_benchmark(void) {
+    write_font(path, FONT_W, 0);
+    FontxFile fx[2];
+    InitFontx(fx, path, "");
+    TEST_ASSERT(OpenFontx(&fx[0]));
+    double cached = glyphs_per_second(fx, 2000000);
+
+    const uint8_t *table = fx[0].glyphs;
+    fx[0].glyphs = NULL;
+    double file = glyphs_per_second(fx, 200000);
+    fx[0].glyphs = table;
+    CloseFontx(&fx[0]);
+
+    printf("  file %.2f Mglyphs/s, RAM table %.2f Mglyphs/s (%.0fx)\n", file / 1e6, cached / 1e6, cached / file);
+    TEST_ASSERT(cached > file * 5);
+    unlink(path);
+}
+
+int main(void) {
+    TEST_RUN(test_ram_table);
+    TEST_RUN(test_bad_files);
+    TEST_RUN(test_embedded);
+    TEST_RUN(test_benchmark);
+    return TEST_EXIT_CODE();
+}
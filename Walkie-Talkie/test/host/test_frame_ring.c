@@ -0,0 +1,155 @@
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+#include "frame_ring.h"
+
+// Кільце кадрів: межі, переповнення і статистика в одному потоці,
+// потім виробник і споживач у різних потоках, як задачі захоплення і передачі
+
+#define FRAME_BYTES 64
+#define STRESS_FRAMES 200000
+
+static void test_init_rejects(void) {
+    frame_ring_t ring;
+    TEST_ASSERT(!frame_ring_init(&ring, 0, FRAME_BYTES));
+    TEST_ASSERT(!frame_ring_init(&ring, 6, FRAME_BYTES));
+    TEST_ASSERT(!frame_ring_init(&ring, FRAME_RING_MAX_SLOTS * 2, FRAME_BYTES));
+    TEST_ASSERT(!frame_ring_init(&ring, 8, 0));
+    TEST_ASSERT(frame_ring_init(&ring, 8, FRAME_BYTES));
+    frame_ring_free(&ring);
+}
+
+static void test_overrun_and_stats(void) {
+    frame_ring_t ring;
+    size_t len;
+    TEST_ASSERT(frame_ring_init(&ring, 4, FRAME_BYTES));
+    TEST_ASSERT(frame_ring_peek(&ring, &len) == NULL);
+    TEST_ASSERT_EQ(len, 0);
+
+    for (int i = 0; i < 6; i++) {
+        uint8_t *slot = frame_ring_acquire(&ring);
+        if (i < 4) {
+            TEST_ASSERT(slot != NULL);
+            slot[0] = (uint8_t)i;
+            frame_ring_commit(&ring, i + 1);
+        } else {
+            TEST_ASSERT(slot == NULL);
+        }
+    }
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(&ring, &stats);
+    TEST_ASSERT_EQ(stats.count, 4);
+    TEST_ASSERT_EQ(stats.max_count, 4);
+    TEST_ASSERT_EQ(stats.pushed, 4);
+    TEST_ASSERT_EQ(stats.overruns, 2);
+
+    // Найстаріший кадр першим; довжина не більша за розмір слота
+    uint8_t *frame = frame_ring_peek(&ring, &len);
+    TEST_ASSERT(frame != NULL && frame[0] == 0);
+    TEST_ASSERT_EQ(len, 1);
+    frame_ring_release(&ring);
+    uint8_t *slot = frame_ring_acquire(&ring);
+    TEST_ASSERT(slot != NULL);
+    frame_ring_commit(&ring, FRAME_BYTES * 2);
+
+    for (int i = 1; i < 4; i++) {
+        frame = frame_ring_peek(&ring, &len);
+        TEST_ASSERT(frame != NULL && frame[0] == i);
+        frame_ring_release(&ring);
+    }
+    frame_ring_peek(&ring, &len);
+    TEST_ASSERT_EQ(len, FRAME_BYTES);
+    frame_ring_release(&ring);
+    TEST_ASSERT_EQ(frame_ring_count(&ring), 0);
+    frame_ring_free(&ring);
+}
+
+// Кадр несе свій номер і заповнення, що від нього залежить, тож споживач бачить
+// і порушення порядку, і слот, прочитаний до того, як виробник його дописав
+static void fill_frame(uint8_t *frame, uint32_t seq, size_t len) {
+    memcpy(frame, &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < len; i++) {
+        frame[i] = (uint8_t)(seq * 31 + i);
+    }
+}
+
+static bool check_frame(const uint8_t *frame, uint32_t seq, size_t len) {
+    uint32_t got;
+    memcpy(&got, frame, sizeof(got));
+    if (got != seq || len != sizeof(seq) + seq % (FRAME_BYTES - sizeof(seq) + 1)) {
+        return false;
+    }
+    for (size_t i = sizeof(seq); i < len; i++) {
+        if (frame[i] != (uint8_t)(seq * 31 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    frame_ring_t *ring;
+    uint32_t full;              // Скільки разів виробник застав кільце заповненим
+} producer_t;
+
+static void *producer_task(void *arg) {
+    producer_t *p = (producer_t *)arg;
+    for (uint32_t seq = 0; seq < STRESS_FRAMES; seq++) {
+        uint8_t *slot;
+        while ((slot = frame_ring_acquire(p->ring)) == NULL) {
+            p->full++;
+            sched_yield();
+        }
+        size_t len = sizeof(seq) + seq % (FRAME_BYTES - sizeof(seq) + 1);
+        fill_frame(slot, seq, len);
+        frame_ring_commit(p->ring, len);
+    }
+    return NULL;
+}
+
+static void test_spsc_stress(void) {
+    frame_ring_t ring;
+    TEST_ASSERT(frame_ring_init(&ring, 8, FRAME_BYTES));
+    producer_t producer = {.ring = &ring};
+    pthread_t thread;
+
+    int64_t start = test_now_ns();
+    TEST_ASSERT(pthread_create(&thread, NULL, producer_task, &producer) == 0);
+    uint32_t expected = 0;
+    uint32_t corrupt = 0;
+    while (expected < STRESS_FRAMES) {
+        size_t len;
+        uint8_t *frame = frame_ring_peek(&ring, &len);
+        if (!frame) {
+            sched_yield();
+            continue;
+        }
+        if (!check_frame(frame, expected, len)) {
+            corrupt++;
+        }
+        frame_ring_release(&ring);
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    int64_t elapsed = test_now_ns() - start;
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(&ring, &stats);
+    printf("  %d frames in %.1f ms (%.0f ns/frame), producer found ring full %u times, max occupancy %u/8\n",
+           STRESS_FRAMES, elapsed / 1e6, (double)elapsed / STRESS_FRAMES, producer.full, stats.max_count);
+    TEST_ASSERT_EQ(corrupt, 0);
+    TEST_ASSERT_EQ(stats.pushed, STRESS_FRAMES);
+    TEST_ASSERT_EQ(stats.overruns, producer.full);
+    TEST_ASSERT_EQ(stats.count, 0);
+    TEST_ASSERT(stats.max_count <= 8);
+    frame_ring_free(&ring);
+}
+
+int main(void) {
+    TEST_RUN(test_init_rejects);
+    TEST_RUN(test_overrun_and_stats);
+    TEST_RUN(test_spsc_stress);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,330 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "jitter_buffer.h"
+
+// Джитер-буфер: порядок відтворення, втрати, запізнілі кадри, адаптація глибини,
+// а також прогін синтетичних і записаних (traces/) сценаріїв надходження:
+// затримка проти частоти провалів
+
+#define PERIOD_US 10000             // Кадр 10 мс, як у main.c
+#define SLOTS 16
+
+static void push_seq(jitter_buffer_t *jb, uint16_t seq, int64_t now_us) {
+    jitter_buffer_push(jb, seq, (const uint8_t *)&seq, sizeof(seq), now_us);
+}
+
+// Номер кадру з навантаження, -1 для будь-якого іншого результату
+static int pop_seq(jitter_buffer_t *jb, jb_status_t *status) {
+    uint16_t seq;
+    size_t len;
+    *status = jitter_buffer_pop(jb, (uint8_t *)&seq, &len);
+    return *status == JB_FRAME && len == sizeof(seq) ? seq : -1;
+}
+
+static void test_in_order(void) {
+    jitter_buffer_t jb;
+    jb_status_t status;
+    TEST_ASSERT(jitter_buffer_init(&jb, SLOTS, sizeof(uint16_t), PERIOD_US));
+
+    push_seq(&jb, 100, 0);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), -1);
+    TEST_ASSERT_EQ(status, JB_BUFFERING);
+    push_seq(&jb, 101, PERIOD_US);
+    push_seq(&jb, 102, 2 * PERIOD_US);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 100);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 101);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 102);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), -1);
+    TEST_ASSERT_EQ(status, JB_UNDERRUN);
+
+    // Продовження потоку після спустошення - справжній провал звуку
+    push_seq(&jb, 103, 4 * PERIOD_US);
+    jb_stats_t stats;
+    jitter_buffer_get_stats(&jb, &stats);
+    TEST_ASSERT_EQ(stats.played, 3);
+    TEST_ASSERT_EQ(stats.underruns, 1);
+    jitter_buffer_free(&jb);
+}
+
+static void test_reorder_and_loss(void) {
+    jitter_buffer_t jb;
+    jb_status_t status;
+    TEST_ASSERT(jitter_buffer_init(&jb, SLOTS, sizeof(uint16_t), PERIOD_US));
+
+    push_seq(&jb, 0, 0);
+    push_seq(&jb, 2, 2 * PERIOD_US);
+    push_seq(&jb, 1, 2 * PERIOD_US);
+    push_seq(&jb, 4, 4 * PERIOD_US);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 0);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 1);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 2);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), -1);
+    TEST_ASSERT_EQ(status, JB_LOST);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 4);
+
+    // Кадр 3 прийшов після того, як його місце відтворено
+    push_seq(&jb, 3, 5 * PERIOD_US);
+    push_seq(&jb, 5, 5 * PERIOD_US);
+    push_seq(&jb, 5, 5 * PERIOD_US);
+
+    jb_stats_t stats;
+    jitter_buffer_get_stats(&jb, &stats);
+    TEST_ASSERT_EQ(stats.lost, 1);
+    TEST_ASSERT_EQ(stats.late_drops, 1);
+    TEST_ASSERT_EQ(stats.duplicates, 1);
+    TEST_ASSERT_EQ(stats.depth, 1);
+    jitter_buffer_free(&jb);
+}
+
+static void test_seq_wrap(void) {
+    jitter_buffer_t jb;
+    jb_status_t status;
+    TEST_ASSERT(jitter_buffer_init(&jb, SLOTS, sizeof(uint16_t), PERIOD_US));
+
+    uint16_t seq = 65534;
+    for (int i = 0; i < 4; i++) {
+        push_seq(&jb, seq++, (int64_t)i * PERIOD_US);
+    }
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 65534);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 65535);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 0);
+    TEST_ASSERT_EQ(pop_seq(&jb, &status), 1);
+    jitter_buffer_free(&jb);
+}
+
+// Рівномірні надходження тримають мінімальну глибину, нерівномірні її збільшують
+static void test_target_adapts(void) {
+    jitter_buffer_t jb;
+    jb_stats_t stats;
+    TEST_ASSERT(jitter_buffer_init(&jb, SLOTS, sizeof(uint16_t), PERIOD_US));
+
+    for (uint16_t seq = 0; seq < 200; seq++) {
+        push_seq(&jb, seq, (int64_t)seq * PERIOD_US);
+        uint16_t out;
+        size_t len;
+        jitter_buffer_pop(&jb, (uint8_t *)&out, &len);
+    }
+    jitter_buffer_get_stats(&jb, &stats);
+    TEST_ASSERT_EQ(stats.jitter_us, 0);
+    TEST_ASSERT_EQ(stats.target_depth, JB_MIN_DEPTH);
+
+    jitter_buffer_reset(&jb);
+    for (uint16_t seq = 0; seq < 200; seq++) {
+        int64_t jitter = (seq & 1) ? 8000 : 0;
+        push_seq(&jb, seq, (int64_t)seq * PERIOD_US + jitter);
+    }
+    jitter_buffer_get_stats(&jb, &stats);
+    TEST_ASSERT(stats.jitter_us > 4000);
+    TEST_ASSERT(stats.target_depth > JB_MIN_DEPTH);
+    TEST_ASSERT(stats.target_depth <= SLOTS / 2);
+    jitter_buffer_free(&jb);
+}
+
+typedef struct {
+    uint32_t seq;               // Розширений номер, без переповнення 16 біт
+    int64_t arrival_us;
+} arrival_t;
+
+static int compare_arrival(const void *a, const void *b) {
+    int64_t d = ((const arrival_t *)a)->arrival_us - ((const arrival_t *)b)->arrival_us;
+    return d < 0 ? -1 : d > 0;
+}
+
+typedef struct {
+    double latency_ms;          // Середній час від відправлення до відтворення
+    double glitch_rate;         // Частка тактів відтворення без кадру
+    uint32_t lost;
+    uint32_t underruns;
+} trace_result_t;
+
+// Відтворює сценарій надходжень, відсортований за часом. Кадр seq відправлено в
+// момент seq * PERIOD_US; такт відтворення - той самий період, як у I2S,
+// зсунутий на половину періоду відносно відправлення
+static trace_result_t play_trace(const arrival_t *trace, size_t count) {
+    jitter_buffer_t jb;
+    jitter_buffer_init(&jb, JB_MAX_SLOTS, sizeof(uint32_t), PERIOD_US);
+    trace_result_t result = {0};
+    double latency_sum = 0;
+    uint32_t played = 0;
+    uint32_t ticks = 0;
+    size_t next = 0;
+    for (int64_t now = PERIOD_US / 2; next < count || jb.depth > 0; now += PERIOD_US) {
+        while (next < count && trace[next].arrival_us <= now) {
+            jitter_buffer_push(&jb, (uint16_t)trace[next].seq, (const uint8_t *)&trace[next].seq,
+                               sizeof(uint32_t), trace[next].arrival_us);
+            next++;
+        }
+        uint32_t seq;
+        size_t len;
+        jb_status_t status = jitter_buffer_pop(&jb, (uint8_t *)&seq, &len);
+        if (status == JB_FRAME) {
+            latency_sum += (now - (int64_t)seq * PERIOD_US) / 1000.0;
+            played++;
+        }
+        if (played > 0) {
+            ticks++;
+        }
+    }
+
+    jb_stats_t stats;
+    jitter_buffer_get_stats(&jb, &stats);
+    result.latency_ms = played ? latency_sum / played : 0;
+    result.glitch_rate = ticks ? (double)(ticks - played) / ticks : 0;
+    result.lost = stats.lost;
+    result.underruns = stats.underruns;
+    jitter_buffer_free(&jb);
+    return result;
+}
+
+// Синтетичний сценарій: затримка 2 мс плюс випадковий джитер до max_jitter_us
+// (хвіст - 5% кадрів з удвічі більшим), loss_pct відсотків губиться
+static trace_result_t replay_synthetic(uint32_t frames, int64_t max_jitter_us, int loss_pct, uint32_t seed) {
+    arrival_t *trace = malloc(frames * sizeof(*trace));
+    size_t count = 0;
+    for (uint32_t seq = 0; seq < frames; seq++) {
+        if ((int)(test_rand(&seed) % 100) < loss_pct) {
+            continue;
+        }
+        double jitter = test_rand_unit(&seed) * max_jitter_us;
+        if (test_rand(&seed) % 20 == 0) {
+            jitter *= 2;
+        }
+        trace[count].seq = seq;
+        trace[count].arrival_us = (int64_t)seq * PERIOD_US + 2000 + (int64_t)jitter;
+        count++;
+    }
+    qsort(trace, count, sizeof(*trace), compare_arrival);
+    trace_result_t result = play_trace(trace, count);
+    free(trace);
+    return result;
+}
+
+// Завантажує записаний сценарій (traces/capture_trace.py): рядки "arrival_us seq",
+// '#' - коментар. Номери розширюються через переповнення, а час зсувається так,
+// щоб найшвидший кадр мав нульову затримку: годинники відправника і приймача
+// не пов'язані, тож відома лише затримка відносно найкращого випадку
+static arrival_t *load_trace(const char *path, size_t *count) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return NULL;
+    }
+    size_t capacity = 1024;
+    arrival_t *trace = malloc(capacity * sizeof(*trace));
+    char line[128];
+    size_t n = 0;
+    uint32_t top = 0;
+    while (fgets(line, sizeof(line), f)) {
+        long long arrival;
+        unsigned seq;
+        if (line[0] == '#' || sscanf(line, "%lld %u", &arrival, &seq) != 2) {
+            continue;
+        }
+        if (n == capacity) {
+            capacity *= 2;
+            trace = realloc(trace, capacity * sizeof(*trace));
+        }
+        // Найближчий до найбільшого номер з тими ж молодшими 16 бітами
+        uint32_t ext = n ? top + (int16_t)(uint16_t)(seq - (uint16_t)top) : seq;
+        if (n == 0 || (int32_t)(ext - top) > 0) {
+            top = ext;
+        }
+        trace[n].seq = ext;
+        trace[n].arrival_us = arrival;
+        n++;
+    }
+    fclose(f);
+
+    int64_t offset = INT64_MAX;
+    for (size_t i = 0; i < n; i++) {
+        int64_t delay = trace[i].arrival_us - (int64_t)trace[i].seq * PERIOD_US;
+        if (delay < offset) {
+            offset = delay;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        trace[i].arrival_us -= offset;
+    }
+    qsort(trace, n, sizeof(*trace), compare_arrival);
+    *count = n;
+    return trace;
+}
+
+static void test_synthetic_replay(void) {
+    static const int64_t jitters_us[] = {0, 5000, 20000, 40000};
+    for (size_t i = 0; i < sizeof(jitters_us) / sizeof(jitters_us[0]); i++) {
+        trace_result_t r = replay_synthetic(3000, jitters_us[i], 0, 1234 + i);
+        printf("  jitter %3lld ms: latency %6.1f ms, glitches %5.2f%%, lost %u, underruns %u\n",
+               (long long)jitters_us[i] / 1000, r.latency_ms, r.glitch_rate * 100, r.lost, r.underruns);
+        if (jitters_us[i] == 0) {
+            TEST_ASSERT_EQ(r.lost, 0);
+            TEST_ASSERT_EQ(r.underruns, 0);
+            TEST_ASSERT(r.latency_ms < 4 * PERIOD_US / 1000.0);
+        }
+        // Буфер підлаштовується під джитер: провали лишаються рідкими
+        TEST_ASSERT(r.glitch_rate < 0.05);
+    }
+
+    trace_result_t r = replay_synthetic(3000, 5000, 5, 99);
+    printf("  jitter   5 ms, 5%% loss: latency %6.1f ms, glitches %5.2f%%, lost %u, underruns %u\n",
+           r.latency_ms, r.glitch_rate * 100, r.lost, r.underruns);
+    TEST_ASSERT(r.lost > 0);
+    TEST_ASSERT(r.glitch_rate < 0.10);
+}
+
+static void test_recorded_replay(void) {
+    static const char *traces[] = {"loopback_loaded.trace"};
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", TRACE_DIR, traces[i]);
+        size_t count;
+        arrival_t *trace = load_trace(path, &count);
+        TEST_ASSERT(trace != NULL);
+        if (trace == NULL) {
+            continue;
+        }
+        TEST_ASSERT(count > 0);
+        trace_result_t r = play_trace(trace, count);
+        printf("  %s, %zu packets: latency %6.1f ms, glitches %5.2f%%, lost %u, underruns %u\n",
+               traces[i], count, r.latency_ms, r.glitch_rate * 100, r.lost, r.underruns);
+        TEST_ASSERT(r.glitch_rate < 0.05);
+        free(trace);
+    }
+}
+
+// Розбір файлу: коментарі, переповнення номера і зсув часу
+static void test_trace_loader(void) {
+    char path[] = "/tmp/jb_trace_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    FILE *f = fdopen(fd, "w");
+    fputs("# arrival_us seq\n5000 65534\n15500 65535\n35000 1\n25000 0\n", f);
+    fclose(f);
+
+    size_t count;
+    arrival_t *trace = load_trace(path, &count);
+    unlink(path);
+    TEST_ASSERT(trace != NULL);
+    if (trace == NULL) {
+        return;
+    }
+    TEST_ASSERT_EQ(count, 4);
+    TEST_ASSERT_EQ(trace[0].seq, 65534);
+    TEST_ASSERT_EQ(trace[0].arrival_us, 65534LL * PERIOD_US);
+    TEST_ASSERT_EQ(trace[1].arrival_us - trace[0].arrival_us, 10500);
+    TEST_ASSERT_EQ(trace[2].seq, 65536);
+    TEST_ASSERT_EQ(trace[3].seq, 65537);
+    free(trace);
+}
+
+int main(void) {
+    TEST_RUN(test_in_order);
+    TEST_RUN(test_reorder_and_loss);
+    TEST_RUN(test_seq_wrap);
+    TEST_RUN(test_target_adapts);
+    TEST_RUN(test_trace_loader);
+    TEST_RUN(test_synthetic_replay);
+    TEST_RUN(test_recorded_replay);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,220 @@
+#include <string.h>
+#include "test.h"
+#include "dsp.h"
+#include "mixer.h"
+#include "conference.h"
+
+// Мікшер: "усі, крім себе" проти прямого підсумовування, насичення, вартість
+// кожного доданого учасника; таблиця конференції: приєднання, ліміт, простій і відключення
+
+#define FRAME 441
+#define MAX_PARTICIPANTS 16
+
+static void make_frame(int16_t *pcm, size_t len, int amplitude, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        pcm[i] = (int16_t)((int32_t)(test_rand(&seed) % (2 * amplitude + 1)) - amplitude);
+    }
+}
+
+// Пряме підсумовування всіх інших учасників для кожного виходу, O(N^2)
+static void naive_mix(int16_t frames[][FRAME], int n, int self, int16_t *out) {
+    for (size_t i = 0; i < FRAME; i++) {
+        int32_t sum = 0;
+        for (int p = 0; p < n; p++) {
+            if (p != self) {
+                sum += frames[p][i];
+            }
+        }
+        out[i] = dsp_sat16(sum);
+    }
+}
+
+static void test_mix_minus(void) {
+    static int16_t frames[MAX_PARTICIPANTS][FRAME];
+    int16_t out[FRAME];
+    int16_t ref[FRAME];
+    mixer_t mixer;
+    TEST_ASSERT(mixer_init(&mixer, FRAME));
+
+    // Гучні кадри, щоб частина виходів насичувалась
+    for (int n = 1; n <= MAX_PARTICIPANTS; n++) {
+        for (int p = 0; p < n; p++) {
+            make_frame(frames[p], FRAME, 12000, n * 100 + p);
+        }
+        mixer_begin(&mixer);
+        for (int p = 0; p < n; p++) {
+            mixer_add(&mixer, frames[p], FRAME);
+        }
+        TEST_ASSERT_EQ(mixer.inputs, n);
+        for (int p = 0; p < n; p++) {
+            mixer_output(&mixer, frames[p], out);
+            naive_mix(frames, n, p, ref);
+            TEST_ASSERT(memcmp(out, ref, sizeof(out)) == 0);
+        }
+        // Слухач, що мовчить, чує всіх
+        mixer_output(&mixer, NULL, out);
+        naive_mix(frames, n, -1, ref);
+        TEST_ASSERT(memcmp(out, ref, sizeof(out)) == 0);
+    }
+    mixer_free(&mixer);
+}
+
+// Насичення лише на виході: проміжна сума понад 16 біт не обрізається,
+// тож власний голос віднімається точно
+static void test_saturation(void) {
+    int16_t loud[FRAME];
+    int16_t quiet[FRAME];
+    int16_t out[FRAME];
+    mixer_t mixer;
+    mixer_init(&mixer, FRAME);
+    for (size_t i = 0; i < FRAME; i++) {
+        loud[i] = 30000;
+        quiet[i] = 1000;
+    }
+    mixer_begin(&mixer);
+    mixer_add(&mixer, loud, FRAME);
+    mixer_add(&mixer, loud, FRAME);
+    mixer_add(&mixer, quiet, FRAME);
+    mixer_output(&mixer, NULL, out);
+    TEST_ASSERT_EQ(out[0], INT16_MAX);
+    mixer_output(&mixer, loud, out);
+    TEST_ASSERT_EQ(out[0], 31000);
+    mixer_output(&mixer, quiet, out);
+    TEST_ASSERT_EQ(out[FRAME - 1], INT16_MAX);
+
+    for (size_t i = 0; i < FRAME; i++) {
+        loud[i] = -30000;
+    }
+    mixer_begin(&mixer);
+    mixer_add(&mixer, loud, FRAME);
+    mixer_add(&mixer, loud, FRAME);
+    mixer_add(&mixer, quiet, FRAME);
+    mixer_output(&mixer, loud, out);
+    TEST_ASSERT_EQ(out[0], -29000);
+    mixer_output(&mixer, quiet, out);
+    TEST_ASSERT_EQ(out[0], INT16_MIN);
+    mixer_free(&mixer);
+}
+
+// Короткий кадр доповнюється тишею
+static void test_short_frame(void) {
+    int16_t pcm[FRAME];
+    int16_t out[FRAME];
+    mixer_t mixer;
+    mixer_init(&mixer, FRAME);
+    make_frame(pcm, FRAME, 1000, 3);
+    mixer_begin(&mixer);
+    mixer_add(&mixer, pcm, 100);
+    mixer_output(&mixer, NULL, out);
+    TEST_ASSERT(memcmp(out, pcm, 100 * sizeof(int16_t)) == 0);
+    for (size_t i = 100; i < FRAME; i++) {
+        TEST_ASSERT_EQ(out[i], 0);
+    }
+    mixer_free(&mixer);
+}
+
+// Такт з N учасниками: N додавань і N виходів; приріст на учасника має бути сталим
+static void test_benchmark(void) {
+    static int16_t frames[MAX_PARTICIPANTS][FRAME];
+    static int16_t out[MAX_PARTICIPANTS][FRAME];
+    mixer_t mixer;
+    mixer_init(&mixer, FRAME);
+    for (int p = 0; p < MAX_PARTICIPANTS; p++) {
+        make_frame(frames[p], FRAME, 8000, p + 1);
+    }
+
+    const int ticks = 200;
+    for (int n = 1; n <= MAX_PARTICIPANTS; n *= 2) {
+        int64_t start = test_now_ns();
+        for (int t = 0; t < ticks; t++) {
+            mixer_begin(&mixer);
+            for (int p = 0; p < n; p++) {
+                mixer_add(&mixer, frames[p], FRAME);
+            }
+            for (int p = 0; p < n; p++) {
+                mixer_output(&mixer, frames[p], out[p]);
+            }
+        }
+        double tick_ns = (double)(test_now_ns() - start) / ticks;
+
+        start = test_now_ns();
+        for (int t = 0; t < ticks; t++) {
+            for (int p = 0; p < n; p++) {
+                naive_mix(frames, n, p, out[p]);
+            }
+        }
+        double naive_ns = (double)(test_now_ns() - start) / ticks;
+        printf("  %2d participants: %7.0f ns per 10 ms tick (%5.0f ns each), direct sum %8.0f ns\n",
+               n, tick_ns, tick_ns / n, naive_ns);
+    }
+    mixer_free(&mixer);
+}
+
+static conference_t conference;
+
+static void conference_setup(resampler_filter_t *filter) {
+    resampler_filter_init(filter, 44100, 16000);
+    const conference_config_t config = {
+        .codec = &codec_ima_adpcm,
+        .rate = PACKET_RATE_16000,
+        .tx_filter = filter,
+        .frame_samples = FRAME,
+        .frame_period_us = 10000,
+        .jb_slots = 8,
+        .fec_group = 4,
+        .idle_timeout_us = 5000000,
+    };
+    conference_init(&conference, &config);
+}
+
+static conference_peer_t *join(uint32_t addr, uint8_t mac_id, int64_t now_us) {
+    uint8_t mac[CONF_MAC_SIZE] = {0x24, 0x6f, 0x28, 0, 0, mac_id};
+    conference_streams_t *streams = conference_streams_alloc(&conference, addr);
+    conference_peer_t *peer = conference_join(&conference, addr, mac, &streams, now_us);
+    conference_streams_free(streams);
+    return peer;
+}
+
+static void test_conference_membership(void) {
+    resampler_filter_t filter;
+    conference_setup(&filter);
+
+    for (int i = 0; i < CONF_MAX_PEERS; i++) {
+        TEST_ASSERT(join(0x0A000001 + i, i, 0) != NULL);
+    }
+    TEST_ASSERT_EQ(conference_count(&conference), CONF_MAX_PEERS);
+    // Таблиця заповнена, а повторне приєднання повертає наявний запис
+    TEST_ASSERT(join(0x0A0000FF, 0xFF, 0) == NULL);
+    conference_peer_t *first = conference_find(&conference, 0x0A000001);
+    TEST_ASSERT(join(0x0A000001, 0, 100) == first);
+
+    // Відключена станція звільняє місце лише після collect
+    uint8_t mac[CONF_MAC_SIZE] = {0x24, 0x6f, 0x28, 0, 0, 1};
+    conference_leave(&conference, mac);
+    TEST_ASSERT(conference_find(&conference, 0x0A000002) == NULL);
+    TEST_ASSERT_EQ(conference_count(&conference), CONF_MAX_PEERS - 1);
+    TEST_ASSERT(join(0x0A0000FF, 0xFF, 0) == NULL);
+    conference_collect(&conference);
+    TEST_ASSERT(join(0x0A0000FF, 0xFF, 0) != NULL);
+
+    // Простій: активний пір лишається, решта відключаються
+    int64_t later = conference.config.idle_timeout_us + 1000;
+    conference_touch(&conference, 0x0A000003, later - 10);
+    TEST_ASSERT_EQ(conference_expire(&conference, later), CONF_MAX_PEERS - 1);
+    TEST_ASSERT_EQ(conference_count(&conference), 1);
+    TEST_ASSERT(conference_find(&conference, 0x0A000003) != NULL);
+
+    conference_leave_addr(&conference, 0x0A000003);
+    conference_collect(&conference);
+    TEST_ASSERT_EQ(conference_count(&conference), 0);
+    resampler_filter_free(&filter);
+}
+
+int main(void) {
+    TEST_RUN(test_mix_minus);
+    TEST_RUN(test_saturation);
+    TEST_RUN(test_short_frame);
+    TEST_RUN(test_benchmark);
+    TEST_RUN(test_conference_membership);
+    return TEST_EXIT_CODE();
+}
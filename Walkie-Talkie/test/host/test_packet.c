@@ -0,0 +1,221 @@
+#include <string.h>
+#include "test.h"
+#include "packet.h"
+
+// Заголовок пакета: формат у буфері, розбір, nonce, вікно повторів і статистика прийому
+
+static packet_header_t make_header(uint32_t session, uint16_t seq, uint32_t timestamp) {
+    packet_header_t hdr = {
+        .version = PACKET_VERSION,
+        .flags = PACKET_FLAG_ENCRYPTED,
+        .codec = PACKET_CODEC_IMA_ADPCM,
+        .rate = PACKET_RATE_16000,
+        .session = session,
+        .seq = seq,
+        .timestamp = timestamp,
+        .payload_len = 0,
+        .talkgroup = 7,
+    };
+    return hdr;
+}
+
+static void test_header_layout(void) {
+    uint8_t buf[PACKET_HEADER_SIZE + 4];
+    packet_header_t hdr = make_header(0x11223344, 0xA1B2, 0xC1C2C3C4);
+    hdr.payload_len = 4;
+    memcpy(PACKET_PAYLOAD(buf), "\xde\xad\xbe\xef", 4);
+    packet_write_header(buf, &hdr);
+
+    // Мережевий порядок байтів, навантаження одразу за заголовком у тому ж буфері
+    static const uint8_t expected[PACKET_HEADER_SIZE] = {
+        PACKET_VERSION, PACKET_FLAG_ENCRYPTED, PACKET_CODEC_IMA_ADPCM, PACKET_RATE_16000,
+        0x11, 0x22, 0x33, 0x44, 0xA1, 0xB2, 0xC1, 0xC2, 0xC3, 0xC4, 0x00, 0x04, 0x00, 0x07,
+    };
+    TEST_ASSERT(memcmp(buf, expected, PACKET_HEADER_SIZE) == 0);
+    TEST_ASSERT(memcmp(PACKET_PAYLOAD(buf), "\xde\xad\xbe\xef", 4) == 0);
+
+    packet_header_t parsed;
+    TEST_ASSERT(packet_parse(buf, sizeof(buf), &parsed));
+    TEST_ASSERT_EQ(parsed.version, PACKET_VERSION);
+    TEST_ASSERT_EQ(parsed.flags, hdr.flags);
+    TEST_ASSERT_EQ(parsed.codec, hdr.codec);
+    TEST_ASSERT_EQ(parsed.rate, hdr.rate);
+    TEST_ASSERT_EQ(parsed.session, hdr.session);
+    TEST_ASSERT_EQ(parsed.seq, hdr.seq);
+    TEST_ASSERT_EQ(parsed.timestamp, hdr.timestamp);
+    TEST_ASSERT_EQ(parsed.payload_len, 4);
+    TEST_ASSERT_EQ(parsed.talkgroup, 7);
+}
+
+static void test_parse_rejects(void) {
+    uint8_t buf[PACKET_HEADER_SIZE + 8];
+    packet_header_t hdr = make_header(1, 2, 3);
+    packet_header_t parsed;
+
+    hdr.payload_len = 8;
+    packet_write_header(buf, &hdr);
+    TEST_ASSERT(packet_parse(buf, sizeof(buf), &parsed));
+    // Навантаження не вміщується в датаграму
+    TEST_ASSERT(!packet_parse(buf, sizeof(buf) - 1, &parsed));
+    TEST_ASSERT(!packet_parse(buf, PACKET_HEADER_SIZE - 1, &parsed));
+
+    // Зайві байти за навантаженням (тег автентифікації) дозволені
+    hdr.payload_len = 4;
+    packet_write_header(buf, &hdr);
+    TEST_ASSERT(packet_parse(buf, sizeof(buf), &parsed));
+
+    buf[0] = PACKET_VERSION + 1;
+    TEST_ASSERT(!packet_parse(buf, sizeof(buf), &parsed));
+
+    hdr.rate = PACKET_RATE_COUNT;
+    packet_write_header(buf, &hdr);
+    TEST_ASSERT(!packet_parse(buf, sizeof(buf), &parsed));
+}
+
+static void test_rates(void) {
+    TEST_ASSERT_EQ(packet_rate_hz(PACKET_RATE_44100), 44100);
+    TEST_ASSERT_EQ(packet_rate_hz(PACKET_RATE_16000), 16000);
+    TEST_ASSERT_EQ(packet_rate_hz(PACKET_RATE_8000), 8000);
+    TEST_ASSERT_EQ(packet_rate_hz(PACKET_RATE_COUNT), 0);
+}
+
+// Аудіокадр, парність і маяк з тими самими полями мають різні nonce
+static void test_nonce_streams(void) {
+    packet_header_t hdr = make_header(0xCAFEBABE, 10, 1600);
+    uint8_t audio[PACKET_NONCE_SIZE];
+    uint8_t fec[PACKET_NONCE_SIZE];
+    uint8_t beacon[PACKET_NONCE_SIZE];
+
+    packet_nonce(&hdr, audio);
+    hdr.flags |= PACKET_FLAG_FEC;
+    packet_nonce(&hdr, fec);
+    hdr.flags = PACKET_FLAG_BEACON;
+    packet_nonce(&hdr, beacon);
+
+    TEST_ASSERT(memcmp(audio, "\xca\xfe\xba\xbe\x00\x00\x06\x40\x00\x0a\x00\x00", PACKET_NONCE_SIZE) == 0);
+    TEST_ASSERT(memcmp(audio, fec, PACKET_NONCE_SIZE) != 0);
+    TEST_ASSERT(memcmp(audio, beacon, PACKET_NONCE_SIZE) != 0);
+    TEST_ASSERT(memcmp(fec, beacon, PACKET_NONCE_SIZE) != 0);
+}
+
+// Перевірка і позначення, як у receive_packet після успішної автентифікації
+static bool replay_accept(packet_replay_t *window, const packet_header_t *hdr, int64_t now_us) {
+    if (!packet_replay_check(window, hdr, now_us)) {
+        return false;
+    }
+    packet_replay_update(window, hdr, now_us);
+    return true;
+}
+
+static void test_replay_window(void) {
+    packet_replay_t window;
+    memset(&window, 0, sizeof(window));
+    packet_replay_reset(&window);
+
+    packet_header_t hdr = make_header(1, 100, 100 * 160);
+    TEST_ASSERT(replay_accept(&window, &hdr, 0));
+    TEST_ASSERT(!replay_accept(&window, &hdr, 0));
+
+    // Перевпорядкування в межах вікна приймається один раз
+    packet_header_t later = make_header(1, 110, 110 * 160);
+    TEST_ASSERT(replay_accept(&window, &later, 0));
+    packet_header_t between = make_header(1, 105, 105 * 160);
+    TEST_ASSERT(replay_accept(&window, &between, 0));
+    TEST_ASSERT(!replay_accept(&window, &between, 0));
+
+    // Старіше за вікно
+    packet_header_t old = make_header(1, 110 - PACKET_REPLAY_WINDOW, (110 - PACKET_REPLAY_WINDOW) * 160);
+    TEST_ASSERT(!replay_accept(&window, &old, 0));
+
+    // Номер і мітка часу мають рухатися разом: повтор з попереднього циклу номера відкидається
+    packet_header_t wrapped = make_header(1, 111, 110 * 160 - 65536 * 160);
+    TEST_ASSERT(!replay_accept(&window, &wrapped, 0));
+
+    // Переповнення номера з правильною міткою часу
+    packet_replay_reset(&window);
+    packet_header_t top = make_header(2, 65535, 1000);
+    packet_header_t next = make_header(2, 0, 1160);
+    TEST_ASSERT(replay_accept(&window, &top, 0));
+    TEST_ASSERT(replay_accept(&window, &next, 0));
+    TEST_ASSERT(!replay_accept(&window, &top, 0));
+}
+
+// Невідома сесія лише після тиші відомих; кожна сесія має власне вікно, тож мовець,
+// що повернувся, продовжує, а його записаний трафік не проходить
+static void test_replay_sessions(void) {
+    packet_replay_t window;
+    packet_replay_reset(&window);
+
+    packet_header_t a = make_header(0xA, 1, 160);
+    packet_header_t b = make_header(0xB, 1, 160);
+    TEST_ASSERT(replay_accept(&window, &a, 0));
+    TEST_ASSERT(!packet_replay_check(&window, &b, PACKET_SESSION_HOLDOFF_US - 1));
+    packet_header_t a2 = make_header(0xA, 2, 320);
+    TEST_ASSERT(replay_accept(&window, &a2, 1000));
+    TEST_ASSERT(!packet_replay_check(&window, &b, PACKET_SESSION_HOLDOFF_US));
+    TEST_ASSERT(replay_accept(&window, &b, 1000 + PACKET_SESSION_HOLDOFF_US));
+
+    // A -> B -> A: повернення з наступним номером, повтор старого кадру A відкидається
+    int64_t now = 3 * PACKET_SESSION_HOLDOFF_US;
+    packet_header_t a3 = make_header(0xA, 3, 480);
+    TEST_ASSERT(!packet_replay_check(&window, &a2, now));
+    TEST_ASSERT(replay_accept(&window, &a3, now));
+    TEST_ASSERT(!packet_replay_check(&window, &b, now + 10 * PACKET_SESSION_HOLDOFF_US));
+
+    // Таблиця заповнюється, B лишається активним, тож наступна нова сесія витісняє A
+    for (uint32_t session = 0x100; session < 0x100 + PACKET_REPLAY_SESSIONS - 2; session++) {
+        packet_header_t hdr = make_header(session, 1, 160);
+        now += PACKET_SESSION_HOLDOFF_US;
+        TEST_ASSERT(replay_accept(&window, &hdr, now));
+    }
+    packet_header_t b2 = make_header(0xB, 2, 320);
+    TEST_ASSERT(replay_accept(&window, &b2, now));
+    packet_header_t c = make_header(0xC, 1, 160);
+    now += PACKET_SESSION_HOLDOFF_US;
+    TEST_ASSERT(replay_accept(&window, &c, now));
+    for (int i = 0; i < PACKET_REPLAY_SESSIONS; i++) {
+        TEST_ASSERT(window.sessions[i].session != 0xA);
+    }
+    TEST_ASSERT(!packet_replay_check(&window, &b2, now + 10 * PACKET_SESSION_HOLDOFF_US));
+
+    // Запис витісненої сесії - знову невідома сесія: не раніше, ніж через тишу всіх відомих
+    TEST_ASSERT(!packet_replay_check(&window, &a3, now + PACKET_SESSION_HOLDOFF_US - 1));
+    TEST_ASSERT(packet_replay_check(&window, &a3, now + PACKET_SESSION_HOLDOFF_US));
+
+    // Скидання забуває всі сесії
+    packet_replay_reset(&window);
+    TEST_ASSERT(packet_replay_check(&window, &b2, 0));
+}
+
+static void test_rx_stats(void) {
+    packet_rx_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    static const uint16_t seqs[] = {65530, 65531, 65533, 65532, 65535, 0, 3, 3};
+    for (size_t i = 0; i < sizeof(seqs) / sizeof(seqs[0]); i++) {
+        packet_rx_stats_update(&stats, seqs[i]);
+    }
+    // 65530..3 - 10 номерів, отримано 8 разом з дублікатом
+    TEST_ASSERT_EQ(packet_rx_stats_expected(&stats), 10);
+    TEST_ASSERT_EQ(stats.received, 8);
+    TEST_ASSERT_EQ(stats.reordered, 2);
+    TEST_ASSERT_EQ(packet_rx_stats_lost(&stats), 2);
+
+    // Новий мовець зі своїм простором номерів
+    packet_rx_stats_restart(&stats);
+    packet_rx_stats_update(&stats, 500);
+    packet_rx_stats_update(&stats, 502);
+    TEST_ASSERT_EQ(packet_rx_stats_expected(&stats), 13);
+    TEST_ASSERT_EQ(packet_rx_stats_lost(&stats), 3);
+}
+
+int main(void) {
+    TEST_RUN(test_header_layout);
+    TEST_RUN(test_parse_rejects);
+    TEST_RUN(test_rates);
+    TEST_RUN(test_nonce_streams);
+    TEST_RUN(test_replay_window);
+    TEST_RUN(test_replay_sessions);
+    TEST_RUN(test_rx_stats);
+    return TEST_EXIT_CODE();
+}
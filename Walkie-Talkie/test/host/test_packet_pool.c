@@ -0,0 +1,275 @@
+#include <string.h>
+#include <pthread.h>
+#include "test.h"
+#include "packet_pool.h"
+#include "codec.h"
+
+// Пул буферів пакетів: резерв під заголовок і межі буфера, посилання при розсилці
+// кільком отримувачам, вичерпання пулу під час затримки мережі, паралельні
+// виділення під критичною секцією (на хості - м'ютекс із заміни FreeRTOS) і
+// скільки байтів навантаження копіюється на кадр без шифрування: старий шлях з
+// окремими буферами кодера і прийому проти кодування і розбору на місці в буфері пулу
+
+#define FRAME 441                   // 10 мс на 44.1 кГц
+#define CAPACITY (PACKET_HEADER_SIZE + FRAME * 2 + 16)
+#define POOL_BUFFERS 8
+
+static void test_headroom(void) {
+    packet_pool_t pool;
+    TEST_ASSERT(!packet_pool_init(&pool, 0, CAPACITY));
+    TEST_ASSERT(!packet_pool_init(&pool, PACKET_POOL_MAX_BUFFERS + 1, CAPACITY));
+    TEST_ASSERT(packet_pool_init(&pool, 2, 64));
+
+    packet_buf_t *buf = packet_buf_alloc(&pool, PACKET_HEADER_SIZE);
+    TEST_ASSERT(buf != NULL);
+    uint8_t *payload = packet_buf_data(buf);
+    TEST_ASSERT(payload == buf->storage + PACKET_HEADER_SIZE);
+    TEST_ASSERT_EQ(packet_buf_tailroom(buf), 64 - PACKET_HEADER_SIZE);
+
+    // Навантаження лишається на місці, заголовок стає перед ним, тег - після
+    TEST_ASSERT(packet_buf_put(buf, 30) == payload);
+    TEST_ASSERT(packet_buf_push(buf, PACKET_HEADER_SIZE) == buf->storage);
+    TEST_ASSERT(packet_buf_put(buf, 16) == payload + 30);
+    TEST_ASSERT_EQ(buf->len, PACKET_HEADER_SIZE + 46);
+    TEST_ASSERT(packet_buf_push(buf, 1) == NULL);
+    TEST_ASSERT(packet_buf_put(buf, packet_buf_tailroom(buf) + 1) == NULL);
+    TEST_ASSERT(packet_buf_pull(buf, PACKET_HEADER_SIZE) == payload);
+    TEST_ASSERT(packet_buf_pull(buf, buf->len + 1) == NULL);
+    packet_buf_release(buf);
+
+    // Резерв, більший за буфер, - відмова, що теж рахується
+    TEST_ASSERT(packet_buf_alloc(&pool, 65) == NULL);
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&pool, &stats);
+    TEST_ASSERT_EQ(stats.available, 2);
+    TEST_ASSERT_EQ(stats.allocs, 1);
+    TEST_ASSERT_EQ(stats.exhausted, 1);
+    packet_pool_free(&pool);
+}
+
+// Сервер розсилає один пакет кільком станціям: буфер повертається після останнього звільнення
+static void test_refs(void) {
+    packet_pool_t pool;
+    TEST_ASSERT(packet_pool_init(&pool, 2, CAPACITY));
+    packet_buf_t *buf = packet_buf_alloc(&pool, 0);
+    packet_buf_ref(buf);
+    packet_buf_ref(buf);
+    packet_buf_release(buf);
+    packet_buf_release(buf);
+    TEST_ASSERT_EQ(pool.available, 1);
+    packet_buf_release(buf);
+    TEST_ASSERT_EQ(pool.available, 2);
+
+    // Вільний буфер видається знову з чистими межами
+    packet_buf_t *again = packet_buf_alloc(&pool, 4);
+    TEST_ASSERT(again == buf);
+    TEST_ASSERT_EQ(again->len, 0);
+    TEST_ASSERT_EQ(again->offset, 4);
+    TEST_ASSERT_EQ(again->refs, 1);
+    packet_buf_release(again);
+    packet_pool_free(&pool);
+}
+
+// Кадр кожен тік, мережа віддає буфер наступного тіку, але на STALL тіків
+// зупиняється (повна черга передачі): пул вичерпується, кадри відкидаються і
+// рахуються, включно з кадром тіку відновлення, бо черга звільняється вже після
+// нього. Потім усі буфери повертаються
+static void test_exhaustion(void) {
+    enum { TICKS = 100, STALL_START = 20, STALL = 20 };
+    packet_pool_t pool;
+    TEST_ASSERT(packet_pool_init(&pool, POOL_BUFFERS, CAPACITY));
+    packet_buf_t *queue[TICKS];
+    int head = 0;
+    int tail = 0;
+    uint32_t dropped = 0;
+    for (int tick = 0; tick < TICKS; tick++) {
+        packet_buf_t *pkt = packet_buf_alloc(&pool, PACKET_HEADER_SIZE);
+        if (pkt) {
+            queue[tail++] = pkt;
+        } else {
+            dropped++;
+        }
+        bool stalled = tick >= STALL_START && tick < STALL_START + STALL;
+        while (!stalled && head < tail) {
+            packet_buf_release(queue[head++]);
+        }
+    }
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&pool, &stats);
+    TEST_ASSERT_EQ(dropped, STALL - POOL_BUFFERS + 1);
+    TEST_ASSERT_EQ(stats.exhausted, dropped);
+    TEST_ASSERT_EQ(stats.allocs, TICKS - dropped);
+    TEST_ASSERT_EQ(stats.min_available, 0);
+    TEST_ASSERT_EQ(stats.available, POOL_BUFFERS);
+    printf("  %d-tick stall with %d buffers: %u frames dropped, allocs %u, exhausted %u\n", STALL, POOL_BUFFERS,
+           dropped, stats.allocs, stats.exhausted);
+    packet_pool_free(&pool);
+}
+
+// Задача відправки і задача прийому беруть буфери одночасно
+#define THREAD_ROUNDS 100000
+
+static void *alloc_loop(void *arg) {
+    packet_pool_t *pool = (packet_pool_t *)arg;
+    for (int i = 0; i < THREAD_ROUNDS; i++) {
+        packet_buf_t *buf = packet_buf_alloc(pool, PACKET_HEADER_SIZE);
+        if (buf) {
+            buf->storage[buf->offset] = (uint8_t)i;
+            packet_buf_ref(buf);
+            packet_buf_release(buf);
+            packet_buf_release(buf);
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent(void) {
+    packet_pool_t pool;
+    TEST_ASSERT(packet_pool_init(&pool, 2, CAPACITY));
+    pthread_t threads[2];
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&threads[i], NULL, alloc_loop, &pool);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&pool, &stats);
+    TEST_ASSERT_EQ(stats.available, 2);
+    TEST_ASSERT_EQ(stats.allocs, 2 * THREAD_ROUNDS);
+    TEST_ASSERT_EQ(stats.exhausted, 0);
+    packet_pool_free(&pool);
+}
+
+// Копіювання навантаження на обох шляхах рахується тут; передача через мережу
+// (запис у сокет і прийом з нього) однакова для обох і не рахується
+static uint64_t copied;
+
+static void copy(void *dst, const void *src, size_t len) {
+    memcpy(dst, src, len);
+    copied += len;
+}
+
+static uint8_t wire[CAPACITY];
+
+static packet_header_t frame_header(const codec_t *codec, uint16_t seq, size_t payload_len) {
+    packet_header_t hdr = {
+        .codec = codec->id,
+        .rate = PACKET_RATE_44100,
+        .session = 1,
+        .seq = seq,
+        .timestamp = seq * FRAME,
+        .payload_len = payload_len,
+    };
+    return hdr;
+}
+
+// Як до пулу: кодер пише в свій буфер, навантаження копіюється за заголовок;
+// прийом копіює навантаження в окремий буфер для декодера
+static void old_path(const codec_t *codec, codec_state_t *enc, codec_state_t *dec, const int16_t *pcm,
+                     int16_t *out, uint16_t seq, uint8_t *encoded_buf, uint8_t *packet_buf, uint8_t *write_buf,
+                     uint8_t *decrypted_buf) {
+    size_t payload_len = codec->encode(enc, pcm, FRAME, encoded_buf);
+    packet_header_t hdr = frame_header(codec, seq, payload_len);
+    packet_write_header(packet_buf, &hdr);
+    copy(PACKET_PAYLOAD(packet_buf), encoded_buf, payload_len);
+    size_t len = PACKET_HEADER_SIZE + payload_len;
+    memcpy(wire, packet_buf, len);
+
+    memcpy(write_buf, wire, len);
+    packet_header_t rx;
+    TEST_ASSERT(packet_parse(write_buf, len, &rx));
+    copy(decrypted_buf, PACKET_PAYLOAD(write_buf), rx.payload_len);
+    codec->decode(dec, decrypted_buf, rx.payload_len, out, FRAME);
+}
+
+// Кодування одразу в буфер пулу за резервом під заголовок, декодування з буфера прийому
+static void pool_path(const codec_t *codec, codec_state_t *enc, codec_state_t *dec, const int16_t *pcm,
+                      int16_t *out, uint16_t seq, packet_pool_t *pool, packet_buf_t *rx_buf) {
+    packet_buf_t *pkt = packet_buf_alloc(pool, PACKET_HEADER_SIZE);
+    TEST_ASSERT(pkt != NULL);
+    if (pkt == NULL) {
+        return;
+    }
+    size_t payload_len = codec->encode(enc, pcm, FRAME, packet_buf_data(pkt));
+    packet_buf_put(pkt, payload_len);
+    packet_header_t hdr = frame_header(codec, seq, payload_len);
+    packet_write_header(packet_buf_push(pkt, PACKET_HEADER_SIZE), &hdr);
+    memcpy(wire, packet_buf_data(pkt), pkt->len);
+    size_t len = pkt->len;
+    packet_buf_release(pkt);
+
+    uint8_t *write_buf = packet_buf_data(rx_buf);
+    memcpy(write_buf, wire, len);
+    packet_header_t rx;
+    TEST_ASSERT(packet_parse(write_buf, len, &rx));
+    codec->decode(dec, PACKET_PAYLOAD(write_buf), rx.payload_len, out, FRAME);
+}
+
+static void test_copy_benchmark(void) {
+    enum { ROUNDS = 20000 };
+    static const codec_t *const codecs[] = { &codec_ima_adpcm, &codec_pcm16 };
+    static uint8_t encoded_buf[FRAME * 2];
+    static uint8_t packet_buf[CAPACITY];
+    static uint8_t write_buf[CAPACITY];
+    static uint8_t decrypted_buf[FRAME * 2];
+    int16_t pcm[FRAME];
+    int16_t out_old[FRAME];
+    int16_t out_pool[FRAME];
+    for (int i = 0; i < FRAME; i++) {
+        pcm[i] = (int16_t)(8000 * sin(2 * M_PI * 440 * i / 44100.0));
+    }
+
+    packet_pool_t pool;
+    TEST_ASSERT(packet_pool_init(&pool, POOL_BUFFERS, CAPACITY));
+    packet_buf_t *rx_buf = packet_buf_alloc(&pool, 0);
+
+    for (size_t c = 0; c < sizeof(codecs) / sizeof(codecs[0]); c++) {
+        const codec_t *codec = codecs[c];
+        codec_state_t enc_old, dec_old, enc_pool, dec_pool;
+        codec->reset(&enc_old);
+        codec->reset(&dec_old);
+        codec->reset(&enc_pool);
+        codec->reset(&dec_pool);
+
+        copied = 0;
+        int64_t start = test_now_ns();
+        for (int i = 0; i < ROUNDS; i++) {
+            old_path(codec, &enc_old, &dec_old, pcm, out_old, (uint16_t)i, encoded_buf, packet_buf, write_buf,
+                     decrypted_buf);
+        }
+        double old_ns = (double)(test_now_ns() - start) / ROUNDS;
+        double old_bytes = (double)copied / ROUNDS;
+
+        copied = 0;
+        start = test_now_ns();
+        for (int i = 0; i < ROUNDS; i++) {
+            pool_path(codec, &enc_pool, &dec_pool, pcm, out_pool, (uint16_t)i, &pool, rx_buf);
+        }
+        double pool_ns = (double)(test_now_ns() - start) / ROUNDS;
+        double pool_bytes = (double)copied / ROUNDS;
+
+        // Обидва шляхи дають той самий звук
+        TEST_ASSERT(memcmp(out_old, out_pool, sizeof(out_old)) == 0);
+        TEST_ASSERT_EQ(pool_bytes, 0);
+        TEST_ASSERT_EQ(old_bytes, 2 * codec->max_encoded_size(FRAME));
+        printf("  %-9s copied per frame: %4.0f B -> %.0f B, send+receive %.2f us -> %.2f us\n", codec->name,
+               old_bytes, pool_bytes, old_ns / 1e3, pool_ns / 1e3);
+    }
+
+    packet_buf_release(rx_buf);
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&pool, &stats);
+    TEST_ASSERT_EQ(stats.exhausted, 0);
+    TEST_ASSERT_EQ(stats.min_available, POOL_BUFFERS - 2);
+    packet_pool_free(&pool);
+}
+
+int main(void) {
+    TEST_RUN(test_headroom);
+    TEST_RUN(test_refs);
+    TEST_RUN(test_exhaustion);
+    TEST_RUN(test_concurrent);
+    TEST_RUN(test_copy_benchmark);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,168 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "plc.h"
+
+// Маскування втрат: пошук періоду основного тону, згасання при довгій серії,
+// якість проти заповнення тишею на незалежних (Бернуллі) і пакетних (Гілберт-Еліот)
+// втратах та вартість маскування кадру
+
+#define RATE 44100
+#define FRAME 441
+#define FRAMES 500
+
+// Голосний з гармоніками, повільним тремоло і плавним дрейфом тону
+static void make_vowel(int16_t *pcm, size_t len, double f0) {
+    double phase = 0;
+    for (size_t i = 0; i < len; i++) {
+        double t = (double)i / RATE;
+        double env = 0.75 + 0.25 * sin(2 * M_PI * 2 * t);
+        phase += 2 * M_PI * f0 * (1 + 0.02 * sin(2 * M_PI * 0.5 * t)) / RATE;
+        pcm[i] = (int16_t)lrint(6000 * env * (sin(phase) + 0.5 * sin(2 * phase) + 0.25 * sin(3 * phase)));
+    }
+}
+
+typedef struct {
+    const char *name;
+    double p_loss;              // Бернуллі: ймовірність втрати; Гілберт-Еліот: перехід у поганий стан
+    double p_recover;           // Гілберт-Еліот: перехід у добрий стан; 0 - модель Бернуллі
+} loss_model_t;
+
+static void make_losses(const loss_model_t *model, bool *lost, int frames, uint32_t seed) {
+    bool bad = false;
+    for (int f = 0; f < frames; f++) {
+        double r = test_rand_unit(&seed);
+        if (model->p_recover == 0) {
+            lost[f] = r < model->p_loss;
+        } else {
+            bad = bad ? r >= model->p_recover : r < model->p_loss;
+            lost[f] = bad;
+        }
+    }
+    // Перші кадри завжди доходять, щоб історія була заповнена
+    for (int f = 0; f < 5; f++) {
+        lost[f] = false;
+    }
+}
+
+// Відтворення як у playback_task: маскування, поки воно можливе, далі тиша.
+// Повертає SNR відносно оригіналу і додає час маскування
+static double play(const int16_t *ref, const bool *lost, bool use_plc, int64_t *conceal_ns, int *concealed) {
+    static int16_t out[FRAMES * FRAME];
+    plc_t plc;
+    plc_init(&plc, RATE, FRAME);
+    for (int f = 0; f < FRAMES; f++) {
+        int16_t *frame = out + f * FRAME;
+        if (!lost[f]) {
+            memcpy(frame, ref + f * FRAME, FRAME * sizeof(int16_t));
+            if (use_plc) {
+                plc_good_frame(&plc, frame, FRAME);
+            }
+        } else if (use_plc && plc_can_conceal(&plc)) {
+            int64_t start = test_now_ns();
+            plc_conceal(&plc, frame, FRAME);
+            *conceal_ns += test_now_ns() - start;
+            (*concealed)++;
+        } else {
+            memset(frame, 0, FRAME * sizeof(int16_t));
+        }
+    }
+    plc_free(&plc);
+    return test_snr_db(ref, out, FRAMES * FRAME);
+}
+
+// Період шукається в межах [PLC_MIN_PITCH_HZ, PLC_MAX_PITCH_HZ]
+static void test_pitch_detection(void) {
+    static const double pitches[] = {100, 150, 220, 350};
+    int16_t pcm[FRAME * 6];
+    for (size_t p = 0; p < sizeof(pitches) / sizeof(pitches[0]); p++) {
+        plc_t plc;
+        TEST_ASSERT(plc_init(&plc, RATE, FRAME));
+        make_vowel(pcm, FRAME * 6, pitches[p]);
+        for (int f = 0; f < 5; f++) {
+            plc_good_frame(&plc, pcm + f * FRAME, FRAME);
+        }
+        plc_conceal(&plc, pcm + 5 * FRAME, FRAME);
+        plc_stats_t stats;
+        plc_get_stats(&plc, &stats);
+        // Повторення кратного періоду теж безшовне, тож кратне значення приймається
+        double expected = RATE / pitches[p];
+        double multiple = round(stats.pitch / expected);
+        printf("  %3.0f Hz: repeated %u samples, %.0f x %.1f\n", pitches[p], stats.pitch, multiple, expected);
+        TEST_ASSERT(multiple >= 1);
+        TEST_ASSERT(fabs(stats.pitch - multiple * expected) <= multiple * expected * 0.03 + 1);
+        plc_free(&plc);
+    }
+}
+
+// Довга серія: перший кадр без згасання, потім лінійно до тиші за PLC_FADE_FRAMES кадрів
+static void test_fade_out(void) {
+    int16_t pcm[FRAME * 5];
+    plc_t plc;
+    TEST_ASSERT(plc_init(&plc, RATE, FRAME));
+    make_vowel(pcm, FRAME * 5, 150);
+    for (int f = 0; f < 5; f++) {
+        plc_good_frame(&plc, pcm + f * FRAME, FRAME);
+    }
+    double prev = 1e9;
+    int16_t frame[FRAME];
+    for (int f = 0; f <= PLC_FADE_FRAMES; f++) {
+        TEST_ASSERT(plc_can_conceal(&plc));
+        plc_conceal(&plc, frame, FRAME);
+        double energy = 0;
+        for (int i = 0; i < FRAME; i++) {
+            energy += (double)frame[i] * frame[i];
+        }
+        TEST_ASSERT(f == 0 || energy < prev);
+        prev = energy;
+    }
+    TEST_ASSERT(!plc_can_conceal(&plc));
+    TEST_ASSERT(abs(frame[FRAME - 1]) < 100);
+
+    plc_stats_t stats;
+    plc_get_stats(&plc, &stats);
+    TEST_ASSERT_EQ(stats.concealed, PLC_FADE_FRAMES + 1);
+    TEST_ASSERT_EQ(stats.bursts, 1);
+
+    // Справжній кадр знову дозволяє маскування
+    plc_good_frame(&plc, pcm, FRAME);
+    TEST_ASSERT(plc_can_conceal(&plc));
+    plc_free(&plc);
+}
+
+static void test_loss_models(void) {
+    static int16_t ref[FRAMES * FRAME];
+    static bool lost[FRAMES];
+    static const loss_model_t models[] = {
+        {"Bernoulli 5%", 0.05, 0},
+        {"Bernoulli 10%", 0.10, 0},
+        {"Bernoulli 20%", 0.20, 0},
+        {"GE burst 2", 0.05, 0.5},
+        {"GE burst 4", 0.05, 0.25},
+    };
+    make_vowel(ref, FRAMES * FRAME, 140);
+
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        make_losses(&models[m], lost, FRAMES, 100 + m);
+        int lost_count = 0;
+        for (int f = 0; f < FRAMES; f++) {
+            lost_count += lost[f];
+        }
+        int64_t conceal_ns = 0;
+        int concealed = 0;
+        int zero_concealed = 0;
+        double zero_snr = play(ref, lost, false, &conceal_ns, &zero_concealed);
+        double plc_snr = play(ref, lost, true, &conceal_ns, &concealed);
+        printf("  %-14s %4.1f%% lost: zero fill %5.1f dB, PLC %5.1f dB, %d frames concealed at %.0f ns each\n",
+               models[m].name, 100.0 * lost_count / FRAMES, zero_snr, plc_snr, concealed,
+               concealed ? (double)conceal_ns / concealed : 0);
+        TEST_ASSERT(plc_snr > zero_snr + 3);
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_pitch_detection);
+    TEST_RUN(test_fade_out);
+    TEST_RUN(test_loss_models);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,145 @@
+#include <string.h>
+#include "test.h"
+#include "station.h"
+
+// Прийом підроблених, повторених і змінених пакетів: справжні датаграми станції
+// перехоплюються на петлі, змінюються і подаються в stream_receive_packet.
+// Кожен відкинутий пакет має потрапити у свій лічильник, не дійти до
+// джитер-буфера і не зсунути вікно повторів чи мовця, тож справжні пакети
+// після атаки приймаються як звичайно
+
+#define PORT_TX 5000
+#define PORT_RX 5001
+#define PORT_FORGER 5002
+
+static int16_t frame[STATION_FRAME_SAMPLES];
+
+// Відправляє кадр і забирає його датаграму з сокета приймача, не передаючи в потік
+static int capture(station_t *tx, station_t *rx, uint8_t *out) {
+    struct sockaddr_in dest = station_addr(PORT_RX);
+    struct sockaddr_in src;
+    station_send(tx, &dest, PACKET_TALKGROUP_NONE, true, frame);
+    int len = transport_recv(&rx->transport, out, STATION_PACKET_SIZE, &src);
+    TEST_ASSERT(len > PACKET_HEADER_SIZE + CRYPTO_TAG_SIZE);
+    return len;
+}
+
+// Пакет дешифрується на місці, тож у потік іде копія
+static stream_rx_result_t inject(station_t *rx, const uint8_t *pkt, int len, int64_t now_us) {
+    uint8_t buf[STATION_PACKET_SIZE];
+    memcpy(buf, pkt, len);
+    return station_receive(rx, buf, len, now_us);
+}
+
+static void test_injection(void) {
+    station_t tx;
+    station_t rx;
+    station_t forger;
+    TEST_ASSERT(station_open(&tx, PORT_TX, 0x1111, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+    TEST_ASSERT(station_open(&rx, PORT_RX, 0x2222, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+    static const uint8_t wrong_key[16] = {0xDE, 0xAD, 0xBE, 0xEF};
+    TEST_ASSERT(station_open(&forger, PORT_FORGER, 0x3333, CRYPTO_MODE_GCM, wrong_key, PACKET_RATE_16000, 0));
+    const packet_rx_stats_t *stats = &rx.rx.stats;
+    int64_t now = 0;
+
+    uint8_t first[STATION_PACKET_SIZE];
+    int first_len = capture(&tx, &rx, first);
+    TEST_ASSERT_EQ(inject(&rx, first, first_len, now), STREAM_RX_AUDIO);
+
+    // Повтор відкидається до дешифрування
+    TEST_ASSERT_EQ(inject(&rx, first, first_len, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(stats->replayed, 1);
+
+    uint8_t pkt[STATION_PACKET_SIZE];
+    int len = capture(&tx, &rx, pkt);
+    uint8_t bad[STATION_PACKET_SIZE];
+    uint32_t auth_failed = 0;
+
+    // Заголовок - додаткові дані GCM: зміна частоти, прапорця SID чи мітки часу
+    // (вона ж змінює nonce) ламає тег
+    static const struct { int offset; uint8_t mask; } header_flips[] = {
+        { 3, 0x01 },                // Частота 16 кГц -> 44.1 кГц
+        { 1, PACKET_FLAG_SID },     // Кадр видається за дескриптор тиші
+        { 13, 0x01 },               // Мітка часу
+    };
+    for (size_t i = 0; i < sizeof(header_flips) / sizeof(header_flips[0]); i++) {
+        memcpy(bad, pkt, len);
+        bad[header_flips[i].offset] ^= header_flips[i].mask;
+        TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+        TEST_ASSERT_EQ(stats->auth_failed, ++auth_failed);
+    }
+
+    // Шифротекст і тег
+    memcpy(bad, pkt, len);
+    bad[PACKET_HEADER_SIZE + 10] ^= 0x40;
+    TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+    memcpy(bad, pkt, len);
+    bad[len - 1] ^= 0x01;
+    TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+    auth_failed += 2;
+    TEST_ASSERT_EQ(stats->auth_failed, auth_failed);
+
+    // Номер далеко попереду з невірним тегом не зсуває вікно: справжній пакет проходить
+    memcpy(bad, pkt, len);
+    bad[8] ^= 0x40;
+    bad[10] ^= 0x40;
+    TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(stats->auth_failed, ++auth_failed);
+    TEST_ASSERT_EQ(inject(&rx, pkt, len, now), STREAM_RX_AUDIO);
+
+    // Зміна розмовної групи відкидається ще до дешифрування
+    uint8_t next[STATION_PACKET_SIZE];
+    len = capture(&tx, &rx, next);
+    memcpy(bad, next, len);
+    bad[17] ^= 0x05;
+    TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(stats->other_group, 1);
+
+    // Обрізаний тег і довжина навантаження більша за датаграму
+    TEST_ASSERT_EQ(inject(&rx, next, len - 1, now), STREAM_RX_DROPPED);
+    memcpy(bad, next, len);
+    bad[15] = 0xFF;
+    TEST_ASSERT_EQ(inject(&rx, bad, len, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(stats->invalid, 2);
+
+    // Незашифрований пакет, поки шифрування обов'язкове
+    uint8_t plain[STATION_PACKET_SIZE];
+    struct sockaddr_in dest = station_addr(PORT_RX);
+    struct sockaddr_in src;
+    station_send(&tx, &dest, PACKET_TALKGROUP_NONE, false, frame);
+    int plain_len = transport_recv(&rx.transport, plain, sizeof(plain), &src);
+    TEST_ASSERT_EQ(inject(&rx, plain, plain_len, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(stats->auth_failed, ++auth_failed);
+
+    // Чужий ключ: з власною сесією після тиші і з сесією, номером і міткою часу справжнього кадру
+    now += 2 * STREAM_TALKER_HOLD_US;
+    uint8_t forged[STATION_PACKET_SIZE];
+    int forged_len = capture(&forger, &rx, forged);
+    TEST_ASSERT_EQ(inject(&rx, forged, forged_len, now), STREAM_RX_DROPPED);
+    memcpy(forged + 4, next + 4, 10);
+    TEST_ASSERT_EQ(inject(&rx, forged, forged_len, now), STREAM_RX_DROPPED);
+    auth_failed += 2;
+    TEST_ASSERT_EQ(stats->auth_failed, auth_failed);
+    TEST_ASSERT(rx.rx.talker == 0x1111);
+
+    // Жоден відкинутий пакет не дійшов до потоку; справжні приймаються далі
+    TEST_ASSERT_EQ(stats->received, 2);
+    TEST_ASSERT_EQ(inject(&rx, next, len, now), STREAM_RX_AUDIO);
+    TEST_ASSERT_EQ(stats->received, 3);
+    TEST_ASSERT_EQ(rx.rx.jb.depth, 3);
+    TEST_ASSERT_EQ(rx.results[STREAM_RX_AUDIO], 3);
+    TEST_ASSERT_EQ(rx.results[STREAM_RX_DROPPED], stats->replayed + stats->auth_failed + stats->other_group +
+                                                  stats->invalid);
+
+    station_close(&forger);
+    station_close(&rx);
+    station_close(&tx);
+}
+
+int main(void) {
+    for (size_t i = 0; i < STATION_FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(8000 * sin(2 * M_PI * 700 * i / STATION_SAMPLE_RATE));
+    }
+    TEST_RUN(test_injection);
+    return TEST_EXIT_CODE();
+}
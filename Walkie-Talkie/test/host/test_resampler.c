@@ -0,0 +1,273 @@
+#include <string.h>
+#include "test.h"
+#include "resampler.h"
+
+// Поліфазний перетворювач: коефіцієнти L/M, довжина виходу, межі блоку, якість тону, придушення
+// дзеркальних частот, перемикання фільтра без виділення пам'яті і порівняння профілів
+
+#define I2S_RATE 44100
+#define FRAME_MS 10
+#define MAX_IN (I2S_RATE * FRAME_MS / 1000)
+
+static void make_tone(int16_t *pcm, size_t len, double freq, uint32_t rate, size_t offset) {
+    for (size_t i = 0; i < len; i++) {
+        pcm[i] = (int16_t)lrint(10000 * sin(2 * M_PI * freq * (double)(offset + i) / rate));
+    }
+}
+
+// Відношення тону до залишку після найкращого наближення синусом відомої частоти
+// з довільною фазою, тож затримка фільтра не впливає на результат (дБ)
+static double tone_snr_db(const int16_t *x, size_t len, double freq, uint32_t rate) {
+    double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+    for (size_t i = 0; i < len; i++) {
+        double s = sin(2 * M_PI * freq * i / rate);
+        double c = cos(2 * M_PI * freq * i / rate);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det;
+    double b = (xc * ss - xs * sc) / det;
+    double signal = 0, noise = 0;
+    for (size_t i = 0; i < len; i++) {
+        double fit = a * sin(2 * M_PI * freq * i / rate) + b * cos(2 * M_PI * freq * i / rate);
+        signal += fit * fit;
+        noise += (x[i] - fit) * (x[i] - fit);
+    }
+    return 10 * log10(signal / noise);
+}
+
+// Пропускає frames кадрів тону через перетворювач, повертає кількість вихідних семплів
+static size_t run_tone(resampler_t *rs, double freq, int frames, int16_t *out, size_t max_out) {
+    const resampler_filter_t *f = rs->filter;
+    size_t in_frame = f->in_rate * FRAME_MS / 1000;
+    int16_t in[MAX_IN];
+    size_t total = 0;
+    for (int n = 0; n < frames; n++) {
+        make_tone(in, in_frame, freq, f->in_rate, n * in_frame);
+        total += resampler_process(rs, in, in_frame, out + total, max_out - total);
+    }
+    return total;
+}
+
+static void test_filter_ratios(void) {
+    resampler_filter_t f;
+    TEST_ASSERT(resampler_filter_init(&f, 44100, 16000));
+    TEST_ASSERT_EQ(f.up, 160);
+    TEST_ASSERT_EQ(f.down, 441);
+    TEST_ASSERT_EQ(f.taps, RESAMPLER_TAPS_DOWN);
+    TEST_ASSERT(!f.passthrough);
+    resampler_filter_free(&f);
+
+    TEST_ASSERT(resampler_filter_init(&f, 8000, 44100));
+    TEST_ASSERT_EQ(f.up, 441);
+    TEST_ASSERT_EQ(f.down, 80);
+    TEST_ASSERT_EQ(f.taps, RESAMPLER_TAPS_UP);
+    resampler_filter_free(&f);
+
+    TEST_ASSERT(resampler_filter_init(&f, 44100, 44100));
+    TEST_ASSERT(f.passthrough);
+    TEST_ASSERT(f.coeffs == NULL);
+    resampler_filter_free(&f);
+
+    TEST_ASSERT(!resampler_filter_init(&f, 0, 16000));
+}
+
+// Кадр 10 мс на вході дає рівно 10 мс на виході, без дрейфу між кадрами
+static void test_frame_lengths(void) {
+    static const uint32_t rates[][2] = {{44100, 16000}, {44100, 8000}, {16000, 44100}, {8000, 44100}};
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        resampler_filter_t f;
+        resampler_t rs;
+        TEST_ASSERT(resampler_filter_init(&f, rates[r][0], rates[r][1]));
+        TEST_ASSERT(resampler_init(&rs, &f, MAX_IN));
+        int16_t in[MAX_IN] = {0};
+        int16_t out[MAX_IN];
+        size_t in_frame = rates[r][0] / 100;
+        for (int n = 0; n < 100; n++) {
+            TEST_ASSERT_EQ(resampler_process(&rs, in, in_frame, out, MAX_IN), rates[r][1] / 100);
+        }
+        resampler_free(&rs);
+        resampler_filter_free(&f);
+    }
+}
+
+// Блок, що не вмістився у вихід, обрізається, але наступні блоки лишаються на тій самій
+// сітці позицій, що й без обрізання; зайвий вхід і пропущений вихід рахуються.
+// 8 -> 44.1 кГц - кадр відправника, що заявив не ту частоту; блоки по 100 семплів
+// 44.1 -> 16 кГц закінчуються посеред періоду фаз
+static void test_block_limits(void) {
+    static const uint32_t rates[][3] = {{8000, 44100, 80}, {44100, 16000, 100}};
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        resampler_filter_t f;
+        resampler_t ref;
+        resampler_t cut;
+        TEST_ASSERT(resampler_filter_init(&f, rates[r][0], rates[r][1]));
+        TEST_ASSERT(resampler_init(&ref, &f, MAX_IN));
+        TEST_ASSERT(resampler_init(&cut, &f, MAX_IN));
+        size_t in_frame = rates[r][2];
+        int16_t in[MAX_IN];
+        int16_t ref_out[MAX_IN];
+        int16_t cut_out[MAX_IN];
+        for (int n = 0; n < 8; n++) {
+            make_tone(in, in_frame, 1000, rates[r][0], n * in_frame);
+            size_t ref_len = resampler_process(&ref, in, in_frame, ref_out, MAX_IN);
+            size_t max_out = n == 2 ? ref_len / 3 : MAX_IN;
+            size_t cut_len = resampler_process(&cut, in, in_frame, cut_out, max_out);
+            TEST_ASSERT_EQ(cut_len, n == 2 ? max_out : ref_len);
+            TEST_ASSERT(memcmp(cut_out, ref_out, cut_len * sizeof(int16_t)) == 0);
+            if (n == 2) {
+                TEST_ASSERT_EQ(cut.stats.overflowed, ref_len - max_out);
+            }
+        }
+        TEST_ASSERT_EQ(ref.stats.overflowed, 0);
+        TEST_ASSERT_EQ(cut.stats.truncated, 0);
+
+        // Блок довший за max_in обрізається до max_in
+        int16_t big[MAX_IN + 50] = {0};
+        resampler_process(&cut, big, MAX_IN + 50, cut_out, MAX_IN);
+        TEST_ASSERT_EQ(cut.stats.truncated, 50);
+        resampler_free(&cut);
+        resampler_free(&ref);
+        resampler_filter_free(&f);
+    }
+
+    // Без перетворення частоти обрізання виходу теж рахується
+    resampler_filter_t f;
+    resampler_t rs;
+    TEST_ASSERT(resampler_filter_init(&f, 44100, 44100));
+    TEST_ASSERT(resampler_init(&rs, &f, MAX_IN));
+    int16_t in[MAX_IN] = {0};
+    int16_t out[MAX_IN];
+    TEST_ASSERT_EQ(resampler_process(&rs, in, MAX_IN, out, 100), 100);
+    TEST_ASSERT_EQ(rs.stats.overflowed, MAX_IN - 100);
+    resampler_free(&rs);
+    resampler_filter_free(&f);
+}
+
+static void test_tone_quality(void) {
+    static const uint32_t rates[][2] = {{44100, 16000}, {44100, 8000}, {16000, 44100}, {8000, 44100}};
+    static int16_t out[I2S_RATE];
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        resampler_filter_t f;
+        resampler_t rs;
+        resampler_filter_init(&f, rates[r][0], rates[r][1]);
+        resampler_init(&rs, &f, MAX_IN);
+        size_t n = run_tone(&rs, 1000, 50, out, I2S_RATE);
+        // Перші кадри - заповнення історії фільтра
+        size_t skip = rates[r][1] / 100 * 2;
+        double snr = tone_snr_db(out + skip, n - skip, 1000, rates[r][1]);
+        printf("  %5u -> %5u Hz: 1 kHz tone SNR %.1f dB\n", rates[r][0], rates[r][1], snr);
+        TEST_ASSERT(snr > 40);
+        resampler_free(&rs);
+        resampler_filter_free(&f);
+    }
+}
+
+// Тон вище половини нової частоти не має дзеркалитися у смугу
+static void test_alias_rejection(void) {
+    static int16_t out[8000];
+    resampler_filter_t f;
+    resampler_t rs;
+    resampler_filter_init(&f, 44100, 8000);
+    resampler_init(&rs, &f, MAX_IN);
+    size_t n = run_tone(&rs, 6000, 50, out, 8000);
+    double energy = 0;
+    for (size_t i = 160; i < n; i++) {
+        energy += (double)out[i] * out[i];
+    }
+    double rms = sqrt(energy / (n - 160));
+    double rejection_db = 20 * log10(rms / (10000 / sqrt(2)));
+    printf("  6 kHz tone at 8 kHz output: %.1f dB\n", rejection_db);
+    TEST_ASSERT(rejection_db < -40);
+    resampler_free(&rs);
+    resampler_filter_free(&f);
+}
+
+// Історія потоку розрахована на найдовший фільтр, тож перемикання - лише вказівник
+static void test_switch_filter(void) {
+    resampler_filter_t up16;
+    resampler_filter_t up8;
+    resampler_filter_t same;
+    resampler_t rs;
+    resampler_filter_init(&up16, 16000, 44100);
+    resampler_filter_init(&up8, 8000, 44100);
+    resampler_filter_init(&same, 44100, 44100);
+
+    TEST_ASSERT(resampler_init(&rs, NULL, MAX_IN));
+    int16_t *work = rs.work;
+    int16_t in[MAX_IN];
+    int16_t out[MAX_IN];
+    make_tone(in, MAX_IN, 1000, 44100, 0);
+    TEST_ASSERT_EQ(resampler_process(&rs, in, 160, out, MAX_IN), 0);
+
+    resampler_set_filter(&rs, &up16);
+    TEST_ASSERT_EQ(resampler_process(&rs, in, 160, out, MAX_IN), 441);
+    resampler_set_filter(&rs, &up8);
+    TEST_ASSERT_EQ(resampler_process(&rs, in, 80, out, MAX_IN), 441);
+    resampler_set_filter(&rs, &same);
+    TEST_ASSERT_EQ(resampler_process(&rs, in, MAX_IN, out, MAX_IN), MAX_IN);
+    TEST_ASSERT(memcmp(in, out, sizeof(in)) == 0);
+    TEST_ASSERT(rs.work == work);
+
+    resampler_free(&rs);
+    resampler_filter_free(&up16);
+    resampler_filter_free(&up8);
+    resampler_filter_free(&same);
+}
+
+// Профілі голосу: час на кадр 10 мс у кожному напрямку і якість проходу туди й назад
+static void test_profiles_benchmark(void) {
+    static const uint32_t profiles[] = {8000, 16000, 44100};
+    static int16_t in[MAX_IN];
+    static int16_t mid[MAX_IN];
+    static int16_t out[I2S_RATE];
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        uint32_t rate = profiles[p];
+        resampler_filter_t down;
+        resampler_filter_t up;
+        resampler_t tx;
+        resampler_t rx;
+        resampler_filter_init(&down, I2S_RATE, rate);
+        resampler_filter_init(&up, rate, I2S_RATE);
+        resampler_init(&tx, &down, MAX_IN);
+        resampler_init(&rx, &up, MAX_IN);
+
+        const int frames = 100;
+        int64_t tx_ns = 0;
+        int64_t rx_ns = 0;
+        size_t total = 0;
+        for (int n = 0; n < frames; n++) {
+            make_tone(in, MAX_IN, 1000, I2S_RATE, n * MAX_IN);
+            int64_t start = test_now_ns();
+            size_t m = resampler_process(&tx, in, MAX_IN, mid, MAX_IN);
+            tx_ns += test_now_ns() - start;
+            start = test_now_ns();
+            total += resampler_process(&rx, mid, m, out + total, I2S_RATE - total);
+            rx_ns += test_now_ns() - start;
+        }
+        double snr = tone_snr_db(out + 2 * MAX_IN, total - 2 * MAX_IN, 1000, I2S_RATE);
+        printf("  profile %5u Hz: tx %7.0f ns/frame, rx %7.0f ns/frame, %4u samples/frame on air, round trip SNR %.1f dB\n",
+               rate, (double)tx_ns / frames, (double)rx_ns / frames, rate / 100, snr);
+        TEST_ASSERT(snr > 35);
+
+        resampler_free(&tx);
+        resampler_free(&rx);
+        resampler_filter_free(&down);
+        resampler_filter_free(&up);
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_filter_ratios);
+    TEST_RUN(test_frame_lengths);
+    TEST_RUN(test_block_limits);
+    TEST_RUN(test_tone_quality);
+    TEST_RUN(test_alias_rejection);
+    TEST_RUN(test_switch_filter);
+    TEST_RUN(test_profiles_benchmark);
+    return TEST_EXIT_CODE();
+}
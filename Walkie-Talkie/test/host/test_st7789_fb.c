@@ -0,0 +1,291 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test.h"
+#include "mock_panel.h"
+#include "st7789.h"
+
+// Кадровий буфер ST7789 на імітованій панелі: після кожного lcdDrawFinish пам'ять
+// панелі збігається з буфером піксель у піксель, на шину йдуть лише пошкоджені
+// області, асинхронний скид через задачу не порушує черги SPI. На шині з
+// частотою плати порівнюється, скільки займає скид усього екрана і скільки з
+// цього часу зайнятий процесор і той, хто малює.
+// Розміри і зсув як у sdkconfig плати (135x240, 52/40)
+
+#define WIDTH 135
+#define HEIGHT 240
+#define OFFSETX 52
+#define OFFSETY 40
+#define PANEL_BACKGROUND 0xA5A5
+#define SPI_HZ 20000000
+
+static TFT_t dev;
+static FontxFile fx[2];
+static uint8_t glyphs[256 * 16];
+static const FontxFont font = {"TEST8x16", 8, 16, 16, glyphs};
+
+// Псевдовипадковий шрифт 8x16: кожен символ має власний візерунок
+static void make_font(void) {
+    uint32_t seed = 0x5EED;
+    for (size_t i = 0; i < sizeof(glyphs); i++) {
+        glyphs[i] = (uint8_t)test_rand(&seed);
+    }
+    InitFontxEmbedded(fx, &font);
+}
+
+// Кількість пікселів панелі, що відрізняються від буфера; поза областю дисплея
+// панель має лишитися недоторканою
+static int panel_mismatches(void) {
+    int bad = 0;
+    for (int y = 0; y < MOCK_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < MOCK_PANEL_WIDTH; x++) {
+            int px = x - OFFSETX;
+            int py = y - OFFSETY;
+            uint16_t expected = PANEL_BACKGROUND;
+            if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
+                expected = dev._frame_buffer[py * WIDTH + px];
+            }
+            bad += mock_panel_pixel(x, y) != expected;
+        }
+    }
+    return bad;
+}
+
+// Скидає кадр і звіряє панель; повертає байти на шині за цей кадр
+static uint64_t finish(const char *what) {
+    mock_panel_stats_t before;
+    mock_panel_stats_t after;
+    mock_panel_get_stats(&before);
+    lcdDrawFinish(&dev);
+    mock_panel_get_stats(&after);
+    uint64_t bytes = after.bytes - before.bytes;
+    FLUSH_STATS_t stats;
+    lcdGetFlushStats(&dev, &stats);
+    printf("  %-24s %6llu of %u bytes (%5.1f%%), %3u transactions, %6.0f us at 20 MHz\n", what,
+           (unsigned long long)bytes, stats.full_bytes, 100.0 * bytes / stats.full_bytes,
+           after.transactions - before.transactions, bytes * 8e6 / SPI_HZ);
+    TEST_ASSERT_EQ(panel_mismatches(), 0);
+    TEST_ASSERT_EQ(after.violations, 0);
+    return bytes;
+}
+
+// Екран як у DrawText: заливка фону і чотири рядки тексту
+static void draw_screen(const char *line3, uint16_t background) {
+    lcdFillScreen(&dev, background);
+    lcdSetFontDirection(&dev, DIRECTION0);
+    lcdSetFontFill(&dev, background);
+    lcdDrawString(&dev, fx, 7, 80, (uint8_t *)"Walkie-Talkie", WHITE);
+    lcdDrawString(&dev, fx, 11, 112, (uint8_t *)"Channel 3", WHITE);
+    lcdDrawString(&dev, fx, 19, 144, (uint8_t *)line3, WHITE);
+    lcdDrawString(&dev, fx, 3, 176, (uint8_t *)"Encryption: ON", WHITE);
+}
+
+static void test_setup(void) {
+    make_font();
+    mock_panel_reset(PANEL_BACKGROUND);
+    spi_master_init(&dev, 19, 18, -1, MOCK_PANEL_DC_GPIO, -1, -1);
+    lcdInit(&dev, WIDTH, HEIGHT, OFFSETX, OFFSETY);
+    TEST_ASSERT(dev._use_frame_buffer);
+    TEST_ASSERT(dev._dirty_x1 != NULL);
+    TEST_ASSERT(dev._dma_buffer[0] != NULL);
+}
+
+static void test_partial_refresh(void) {
+    FLUSH_STATS_t stats;
+    lcdGetFlushStats(&dev, &stats);
+
+    // Вміст панелі невідомий, тож перший кадр іде повністю
+    draw_screen("Idle", BLUE);
+    TEST_ASSERT_EQ(finish("first frame"), stats.full_bytes);
+
+    // Змінене слово - лише його рядки, а не весь екран
+    draw_screen("Transmitting", BLUE);
+    uint64_t word = finish("one word changed");
+    TEST_ASSERT(word > 0 && word * 10 < stats.full_bytes);
+
+    // Перемальований без змін екран нічого не відправляє
+    lcdGetFlushStats(&dev, &stats);
+    uint32_t frames = stats.frames;
+    draw_screen("Transmitting", BLUE);
+    TEST_ASSERT_EQ(finish("identical redraw"), 0);
+    lcdGetFlushStats(&dev, &stats);
+    TEST_ASSERT_EQ(stats.frames, frames);
+
+    draw_screen("Receiving", GREEN);
+    finish("background changed");
+
+    // Розкидані зміни дають кілька вікон
+    lcdDrawPixel(&dev, 3, 3, RED);
+    lcdDrawPixel(&dev, 130, 3, RED);
+    lcdDrawFillRect(&dev, 10, 200, 20, 210, RED);
+    lcdDrawLine(&dev, 0, 230, 134, 239, YELLOW);
+    uint64_t scattered = finish("pixels, rect and line");
+    lcdGetFlushStats(&dev, &stats);
+    TEST_ASSERT(scattered < stats.full_bytes / 4);
+
+    uint16_t line[WIDTH];
+    for (int i = 0; i < WIDTH; i++) {
+        line[i] = (uint16_t)(i * 481);
+    }
+    lcdDrawMultiPixels(&dev, 0, 5, WIDTH, line);
+    finish("multi pixels");
+
+    lcdWrapArround(&dev, SCROLL_LEFT, 0, HEIGHT);
+    finish("scroll left");
+    lcdWrapArround(&dev, SCROLL_DOWN, 0, WIDTH - 1);
+    finish("scroll down");
+}
+
+// Випадкові прямокутники і пікселі; більше FLUSH_MAX_WINDOWS вікон зливаються
+static void test_random_damage(void) {
+    uint32_t seed = 2024;
+    uint64_t bytes = 0;
+    const int frames = 200;
+    for (int f = 0; f < frames; f++) {
+        int shapes = 1 + test_rand(&seed) % 24;
+        for (int s = 0; s < shapes; s++) {
+            uint16_t x1 = test_rand(&seed) % WIDTH;
+            uint16_t y1 = test_rand(&seed) % HEIGHT;
+            uint16_t x2 = x1 + test_rand(&seed) % 20;
+            uint16_t y2 = y1 + test_rand(&seed) % 20;
+            uint16_t color = (uint16_t)test_rand(&seed);
+            if (test_rand(&seed) & 1) {
+                lcdDrawFillRect(&dev, x1, y1, x2, y2, color);
+            } else {
+                lcdDrawPixel(&dev, x1, y1, color);
+            }
+        }
+        mock_panel_stats_t before;
+        mock_panel_stats_t after;
+        mock_panel_get_stats(&before);
+        lcdDrawFinish(&dev);
+        mock_panel_get_stats(&after);
+        bytes += after.bytes - before.bytes;
+        TEST_ASSERT_EQ(panel_mismatches(), 0);
+    }
+    FLUSH_STATS_t stats;
+    lcdGetFlushStats(&dev, &stats);
+    printf("  %d random frames: %.0f bytes per frame, full refresh %u\n", frames, (double)bytes / frames,
+           stats.full_bytes);
+    TEST_ASSERT(bytes < (uint64_t)stats.full_bytes * frames / 2);
+}
+
+// Без буферів DMA скид іде блокуючими транзакціями з тим самим результатом
+static void test_blocking_flush(void) {
+    uint8_t *dma[FLUSH_BUFFERS];
+    for (int i = 0; i < FLUSH_BUFFERS; i++) {
+        dma[i] = dev._dma_buffer[i];
+        dev._dma_buffer[i] = NULL;
+    }
+    draw_screen("Blocking", PURPLE);
+    finish("blocking flush");
+    for (int i = 0; i < FLUSH_BUFFERS; i++) {
+        dev._dma_buffer[i] = dma[i];
+    }
+}
+
+// Задача скиду: черга не глибша за FLUSH_BUFFERS, зміни під час скиду
+// потрапляють у наступний кадр
+static void test_async_flush(void) {
+    mock_panel_clear_stats();
+    draw_screen("Async", CYAN);
+    FLUSH_HANDLE_t first = lcdDrawFinishAsync(&dev);
+    TEST_ASSERT(first != 0);
+    lcdDrawString(&dev, fx, 19, 208, (uint8_t *)"in flight", RED);
+    FLUSH_HANDLE_t second = lcdDrawFinishAsync(&dev);
+    TEST_ASSERT(second == first + 1);
+    TEST_ASSERT(lcdFlushWait(&dev, first, 0));
+    TEST_ASSERT(lcdFlushWait(&dev, second, pdMS_TO_TICKS(2000)));
+
+    // Нічого не змінилось - новий скид не ставиться
+    TEST_ASSERT_EQ(lcdDrawFinishAsync(&dev), second);
+    TEST_ASSERT_EQ(panel_mismatches(), 0);
+
+    for (int round = 0; round < 50; round++) {
+        lcdDrawFillRect(&dev, round, round, round + 40, round + 60, (uint16_t)(round * 1311));
+        lcdDrawFinishAsync(&dev);
+    }
+    TEST_ASSERT(lcdFlushWait(&dev, dev._flush_queued, pdMS_TO_TICKS(2000)));
+    TEST_ASSERT_EQ(panel_mismatches(), 0);
+
+    mock_panel_stats_t stats;
+    mock_panel_get_stats(&stats);
+    TEST_ASSERT(stats.max_queued <= FLUSH_BUFFERS);
+    TEST_ASSERT_EQ(stats.violations, 0);
+
+    // Рядок, змінений і повернутий під час скиду, відправляється знову:
+    // задача могла прочитати проміжний стан
+    uint16_t color = dev._frame_buffer[0];
+    dev._flush_busy = true;
+    lcdDrawPixel(&dev, 0, 0, (uint16_t)~color);
+    lcdDrawPixel(&dev, 0, 0, color);
+    dev._flush_busy = false;
+    TEST_ASSERT(finish("changed during flush") > 0);
+    TEST_ASSERT_EQ(finish("nothing changed"), 0);
+}
+
+// Заливка всього екрана іншим кольором, кожен раз скид повного кадру.
+// Повертає середній час, на який блокується виклик, і статистику останнього скиду
+static int64_t full_screen_flush(bool async, FLUSH_STATS_t *stats) {
+    enum { ROUNDS = 4 };
+    static const uint16_t colors[] = { RED, BLUE };
+    int64_t caller_ns = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        lcdFillScreen(&dev, colors[round % 2]);
+        int64_t start = test_now_ns();
+        if (async) {
+            FLUSH_HANDLE_t handle = lcdDrawFinishAsync(&dev);
+            caller_ns += test_now_ns() - start;
+            TEST_ASSERT(lcdFlushWait(&dev, handle, pdMS_TO_TICKS(2000)));
+        } else {
+            lcdDrawFinish(&dev);
+            caller_ns += test_now_ns() - start;
+        }
+        TEST_ASSERT_EQ(panel_mismatches(), 0);
+    }
+    lcdGetFlushStats(&dev, stats);
+    TEST_ASSERT_EQ(stats->last_bytes, stats->full_bytes);
+    return caller_ns / ROUNDS / 1000;
+}
+
+static void test_flush_timing(void) {
+    mock_panel_set_clock(SPI_HZ);
+    static const char *const names[] = { "blocking transactions", "lcdDrawFinish", "lcdDrawFinishAsync" };
+    int64_t caller_us[3];
+    FLUSH_STATS_t stats[3];
+
+    uint8_t *dma[FLUSH_BUFFERS];
+    for (int i = 0; i < FLUSH_BUFFERS; i++) {
+        dma[i] = dev._dma_buffer[i];
+        dev._dma_buffer[i] = NULL;
+    }
+    caller_us[0] = full_screen_flush(false, &stats[0]);
+    for (int i = 0; i < FLUSH_BUFFERS; i++) {
+        dev._dma_buffer[i] = dma[i];
+    }
+    caller_us[1] = full_screen_flush(false, &stats[1]);
+    caller_us[2] = full_screen_flush(true, &stats[2]);
+    mock_panel_set_clock(0);
+
+    double bus_us = stats[1].full_bytes * 8e6 / SPI_HZ;
+    for (int i = 0; i < 3; i++) {
+        printf("  %-22s full frame %6lld us (bus %.0f us), CPU busy %5lld us, caller blocked %6lld us\n",
+               names[i], (long long)stats[i].last_us, bus_us, (long long)stats[i].last_busy_us,
+               (long long)caller_us[i]);
+        TEST_ASSERT(stats[i].last_us >= bus_us);
+    }
+    // Буфери DMA заповнюються, поки шина передає попередній, тож процесор
+    // вільний більшу частину скиду; асинхронний виклик не чекає на шину взагалі
+    TEST_ASSERT(stats[1].last_busy_us < stats[1].last_us / 2);
+    TEST_ASSERT(stats[2].last_busy_us < stats[2].last_us / 2);
+    TEST_ASSERT(caller_us[2] < stats[2].last_us / 10);
+}
+
+int main(void) {
+    TEST_RUN(test_setup);
+    TEST_RUN(test_partial_refresh);
+    TEST_RUN(test_random_damage);
+    TEST_RUN(test_blocking_flush);
+    TEST_RUN(test_async_flush);
+    TEST_RUN(test_flush_timing);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,251 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test.h"
+#include "mock_panel.h"
+#include "st7789.h"
+
+// Символи пакетами без кадрового буфера: на імітованій панелі результат збігається
+// з попереднім попіксельним малюванням у всіх чотирьох напрямках, із заливкою і
+// підкресленням, біля країв і за ними, а транзакцій SPI у рази менше.
+// Еталон - перенесений сюди старий lcdDrawChar, що малює у пам'ять і рахує
+// транзакції, які зробили б його lcdDrawPixel і lcdDrawFillRect
+
+#define WIDTH 135
+#define HEIGHT 240
+#define OFFSETX 52
+#define OFFSETY 40
+#define PANEL_BACKGROUND 0xA5A5
+#define PIXEL_TRANSACTIONS 6        // CASET, адреса, RASET, адреса, RAMWR, колір
+
+static TFT_t dev;
+static FontxFile fx[2];
+static uint8_t glyphs[256 * 16];
+static const FontxFont font = {"TEST8x16", 8, 16, 16, glyphs};
+
+static uint16_t ref[HEIGHT][WIDTH];
+static uint64_t ref_transactions;
+
+// Шрифт 8x16, розміщений як справжні: тіло символу в рядках 2-12 і стовпцях 0-6,
+// решта клітинки - поля. Тіло псевдовипадкове, приблизно половина точок
+static void make_font(void) {
+    uint32_t seed = 0x5EED;
+    memset(glyphs, 0, sizeof(glyphs));
+    for (int c = 0; c < 256; c++) {
+        for (int row = 2; row <= 12; row++) {
+            glyphs[c * 16 + row] = (uint8_t)test_rand(&seed) & 0xFE;
+        }
+    }
+    InitFontxEmbedded(fx, &font);
+}
+
+static void ref_pixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (x >= WIDTH || y >= HEIGHT) {
+        return;
+    }
+    ref[y][x] = color;
+    ref_transactions += PIXEL_TRANSACTIONS;
+}
+
+// Старий lcdDrawFillRect: одне вікно і по транзакції на стовпець
+static void ref_fill(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color) {
+    if (x1 >= WIDTH || y1 >= HEIGHT) {
+        return;
+    }
+    if (x2 >= WIDTH) {
+        x2 = WIDTH - 1;
+    }
+    if (y2 >= HEIGHT) {
+        y2 = HEIGHT - 1;
+    }
+    for (int y = y1; y <= y2; y++) {
+        for (int x = x1; x <= x2; x++) {
+            ref[y][x] = color;
+        }
+    }
+    ref_transactions += 5;
+    for (int x = x1; x <= x2; x++) {
+        ref_transactions += (y2 - y1 + 1 + 511) / 512;
+    }
+}
+
+// Попереднє попіксельне малювання символу, зокрема його особливості в
+// повернутих напрямках
+static int ref_draw_char(uint16_t x, uint16_t y, uint8_t ascii, uint16_t color) {
+    const uint8_t *fonts = &glyphs[ascii * 16];
+    const uint8_t pw = 8;
+    const uint8_t ph = 16;
+    int16_t xd1 = 0, yd1 = 0, xd2 = 0, yd2 = 0;
+    uint16_t xss = 0, yss = 0;
+    int16_t xsd = 0, ysd = 0;
+    int16_t next = 0;
+    uint16_t x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+    if (dev._font_direction == 0) {
+        xd1 = +1; yd1 = +1; xss = x; yss = y - (ph - 1); xsd = 1; next = x + pw;
+        x0 = x; y0 = y - (ph - 1); x1 = x + (pw - 1); y1 = y;
+    } else if (dev._font_direction == 2) {
+        xd1 = -1; yd1 = -1; xss = x; yss = y + ph + 1; xsd = 1; next = x - pw;
+        x0 = x - (pw - 1); y0 = y; x1 = x; y1 = y + (ph - 1);
+    } else if (dev._font_direction == 1) {
+        xd2 = -1; yd2 = +1; xss = x + ph; yss = y; ysd = 1; next = y + pw;
+        x0 = x; y0 = y; x1 = x + (ph - 1); y1 = y + (pw - 1);
+    } else if (dev._font_direction == 3) {
+        xd2 = +1; yd2 = -1; xss = x - (ph - 1); yss = y; ysd = 1; next = y - pw;
+        x0 = x - (ph - 1); y0 = y - (pw - 1); x1 = x; y1 = y;
+    }
+    if (dev._font_fill) {
+        ref_fill(x0, y0, x1, y1, dev._font_fill_color);
+    }
+    int ofs = 0;
+    uint16_t xx = xss;
+    uint16_t yy = yss;
+    for (int h = 0; h < ph; h++) {
+        if (xsd) xx = xss;
+        if (ysd) yy = yss;
+        int bits = pw;
+        for (int w = 0; w < (pw + 4) / 8; w++) {
+            uint16_t mask = 0x80;
+            for (int bit = 0; bit < 8; bit++) {
+                bits--;
+                if (bits < 0) continue;
+                if (fonts[ofs] & mask) {
+                    ref_pixel(xx, yy, color);
+                }
+                if ((h == ph - 2 || h == ph - 1) && dev._font_underline) {
+                    ref_pixel(xx, yy, dev._font_underline_color);
+                }
+                xx = xx + xd1;
+                yy = yy + yd2;
+                mask = mask >> 1;
+            }
+            ofs++;
+        }
+        yy = yy + yd1;
+        xx = xx + xd2;
+    }
+    if (next < 0) next = 0;
+    return next;
+}
+
+static void ref_draw_string(uint16_t x, uint16_t y, const char *text, uint16_t color) {
+    for (const char *c = text; *c; c++) {
+        if (dev._font_direction == 0 || dev._font_direction == 2) {
+            x = ref_draw_char(x, y, (uint8_t)*c, color);
+        } else {
+            y = ref_draw_char(x, y, (uint8_t)*c, color);
+        }
+    }
+}
+
+static int panel_mismatches(void) {
+    int bad = 0;
+    for (int y = 0; y < MOCK_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < MOCK_PANEL_WIDTH; x++) {
+            int px = x - OFFSETX;
+            int py = y - OFFSETY;
+            uint16_t expected = PANEL_BACKGROUND;
+            if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
+                expected = ref[py][px];
+            }
+            bad += mock_panel_pixel(x, y) != expected;
+        }
+    }
+    return bad;
+}
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+} position_t;
+
+// Середина екрана, вихід за правий/нижній край і за лівий/верхній (перенос через 0)
+static const position_t positions[4][3] = {
+    [DIRECTION0] = {{20, 120}, {100, 239}, {3, 8}},
+    [DIRECTION90] = {{60, 40}, {125, 200}, {0, 0}},
+    [DIRECTION180] = {{110, 120}, {134, 230}, {30, 3}},
+    [DIRECTION270] = {{60, 200}, {5, 100}, {134, 30}},
+};
+
+static void test_directions(void) {
+    static const char *text = "Walkie-Talkie 3!";
+    for (int dir = DIRECTION0; dir <= DIRECTION270; dir++) {
+        for (int mode = 0; mode < 4; mode++) {
+            bool fill = mode & 1;
+            bool underline = mode & 2;
+            // [0] - на екрані, [1] - біля країв
+            uint64_t transactions[2] = {0, 0};
+            uint64_t reference[2] = {0, 0};
+            int mismatches = 0;
+            for (int p = 0; p < 3; p++) {
+                mock_panel_reset(PANEL_BACKGROUND);
+                for (int y = 0; y < HEIGHT; y++) {
+                    for (int x = 0; x < WIDTH; x++) {
+                        ref[y][x] = PANEL_BACKGROUND;
+                    }
+                }
+                lcdSetFontDirection(&dev, dir);
+                if (fill) {
+                    lcdSetFontFill(&dev, BLUE);
+                } else {
+                    lcdUnsetFontFill(&dev);
+                }
+                if (underline) {
+                    lcdSetFontUnderLine(&dev, RED);
+                } else {
+                    lcdUnsetFontUnderLine(&dev);
+                }
+                const position_t *pos = &positions[dir][p];
+                ref_transactions = 0;
+                ref_draw_string(pos->x, pos->y, text, WHITE);
+                lcdDrawString(&dev, fx, pos->x, pos->y, (uint8_t *)text, WHITE);
+
+                mock_panel_stats_t stats;
+                mock_panel_get_stats(&stats);
+                transactions[p > 0] += stats.transactions;
+                reference[p > 0] += ref_transactions;
+                mismatches += panel_mismatches();
+                TEST_ASSERT_EQ(stats.violations, 0);
+            }
+            printf("  %3d%-15s on screen %4llu transactions, per-pixel %5llu (%4.1fx); "
+                   "at edges %4llu, per-pixel %5llu (%4.1fx)\n",
+                   dir * 90, fill ? (underline ? " fill underline" : " fill") : (underline ? " underline" : ""),
+                   (unsigned long long)transactions[0], (unsigned long long)reference[0],
+                   (double)reference[0] / transactions[0], (unsigned long long)transactions[1],
+                   (unsigned long long)reference[1], (double)reference[1] / transactions[1]);
+            TEST_ASSERT_EQ(mismatches, 0);
+            // Прозорий символ іде відрізками, десь удвічі менше транзакцій, ніж
+            // попіксельно. Клітинка із заливкою - одним вікном і відрізками того, що
+            // повернуті напрямки малюють поза нею; виграш у десятки разів у DrawText
+            // дає саме заливка кольором фону
+            TEST_ASSERT(transactions[0] * 3 <= reference[0] * 2);
+            TEST_ASSERT(transactions[1] < reference[1]);
+            if (fill) {
+                TEST_ASSERT(transactions[0] * 10 <= reference[0]);
+            }
+        }
+    }
+}
+
+// lcdDrawString повертає позицію наступного символу, як і раніше
+static void test_advance(void) {
+    lcdUnsetFontFill(&dev);
+    lcdUnsetFontUnderLine(&dev);
+    lcdSetFontDirection(&dev, DIRECTION0);
+    TEST_ASSERT_EQ(lcdDrawString(&dev, fx, 10, 50, (uint8_t *)"abc", WHITE), 34);
+    lcdSetFontDirection(&dev, DIRECTION90);
+    TEST_ASSERT_EQ(lcdDrawString(&dev, fx, 10, 50, (uint8_t *)"abc", WHITE), 74);
+    lcdSetFontDirection(&dev, DIRECTION180);
+    TEST_ASSERT_EQ(lcdDrawString(&dev, fx, 10, 50, (uint8_t *)"abc", WHITE), 0);
+    lcdSetFontDirection(&dev, DIRECTION270);
+    TEST_ASSERT_EQ(lcdDrawString(&dev, fx, 10, 50, (uint8_t *)"abc", WHITE), 26);
+}
+
+int main(void) {
+    make_font();
+    mock_panel_reset(PANEL_BACKGROUND);
+    spi_master_init(&dev, 19, 18, -1, MOCK_PANEL_DC_GPIO, -1, -1);
+    lcdInit(&dev, WIDTH, HEIGHT, OFFSETX, OFFSETY);
+    TEST_ASSERT(!dev._use_frame_buffer);
+    TEST_RUN(test_directions);
+    TEST_RUN(test_advance);
+    return TEST_EXIT_CODE();
+}
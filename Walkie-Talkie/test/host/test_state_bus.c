@@ -0,0 +1,169 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "test.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "state_bus.h"
+
+// Шина стану поверх заміни FreeRTOS на pthread: сповіщення лише про справжні зміни
+// і лише за маскою підписника, мітки часу, затримка пробудження задачі інтерфейсу
+// проти опитування раз на 200 мс і узгодженість лічильника при паралельній публікації
+
+#define UI_POLL_MS 200
+#define LATENCY_ROUNDS 200
+#define PUBLISH_ROUNDS 20000
+
+static const uint32_t initial[STATE_COUNT] = {
+    [STATE_TRANSMIT] = false,
+    [STATE_RECEIVING] = false,
+    [STATE_ENCRYPTION] = true,
+    [STATE_TALKGROUP] = 3,
+};
+
+static state_bus_t bus;
+
+// Забирає сповіщення поточної задачі без очікування; 0 - сповіщень не було
+static uint32_t take_events(void) {
+    uint32_t events = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &events, 0) != pdTRUE) {
+        return 0;
+    }
+    return events;
+}
+
+static void test_publish_and_mask(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TaskHandle_t not_started = NULL;
+    state_bus_init(&bus, initial);
+    TEST_ASSERT_EQ(state_bus_subscribe(&bus, &self, STATE_BUS_BIT(STATE_TRANSMIT) | STATE_BUS_BIT(STATE_TALKGROUP)), ESP_OK);
+    TEST_ASSERT_EQ(state_bus_subscribe(&bus, &not_started, STATE_BUS_ALL), ESP_OK);
+    take_events();
+
+    TEST_ASSERT_EQ(state_bus_get(&bus, STATE_ENCRYPTION), true);
+    TEST_ASSERT_EQ(state_bus_get(&bus, STATE_TALKGROUP), 3);
+
+    // Та сама величина нікого не будить
+    TEST_ASSERT(!state_bus_set(&bus, STATE_TALKGROUP, 3));
+    TEST_ASSERT_EQ(take_events(), 0);
+
+    int64_t before = esp_timer_get_time();
+    TEST_ASSERT(state_bus_set(&bus, STATE_TRANSMIT, true));
+    TEST_ASSERT_EQ(take_events(), STATE_BUS_BIT(STATE_TRANSMIT));
+    state_value_t value;
+    state_bus_read(&bus, STATE_TRANSMIT, &value);
+    TEST_ASSERT_EQ(value.value, true);
+    TEST_ASSERT(value.changed_us >= before && value.changed_us <= esp_timer_get_time());
+
+    // Стан поза маскою змінюється, але цю задачу не будить
+    TEST_ASSERT(state_bus_set(&bus, STATE_RECEIVING, true));
+    TEST_ASSERT_EQ(take_events(), 0);
+
+    // Кілька змін до пробудження зливаються в одне сповіщення з усіма бітами
+    state_bus_set(&bus, STATE_TRANSMIT, false);
+    state_bus_set(&bus, STATE_TALKGROUP, 5);
+    TEST_ASSERT_EQ(take_events(), STATE_BUS_BIT(STATE_TRANSMIT) | STATE_BUS_BIT(STATE_TALKGROUP));
+    TEST_ASSERT_EQ(state_bus_changes(&bus), 4);
+
+    state_value_t states[STATE_COUNT];
+    state_bus_snapshot(&bus, states);
+    TEST_ASSERT_EQ(states[STATE_TALKGROUP].value, 5);
+    TEST_ASSERT_EQ(states[STATE_ENCRYPTION].changed_us, 0);
+
+    for (int i = 2; i < STATE_BUS_MAX_SUBSCRIBERS; i++) {
+        TEST_ASSERT_EQ(state_bus_subscribe(&bus, &self, 0), ESP_OK);
+    }
+    TEST_ASSERT_EQ(state_bus_subscribe(&bus, &self, 0), ESP_ERR_NO_MEM);
+}
+
+static TaskHandle_t ui_handle;
+static TaskHandle_t test_handle;
+static atomic_int ui_wakeups;
+static atomic_llong ui_latency_total;
+static atomic_llong ui_latency_max;
+
+// Задача інтерфейсу як display_task: спить до зміни стану, читає знімок, підтверджує
+static void ui_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        uint32_t events;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        state_value_t states[STATE_COUNT];
+        state_bus_snapshot(&bus, states);
+        int64_t latency = now - states[STATE_RECEIVING].changed_us;
+        atomic_fetch_add(&ui_latency_total, latency);
+        if (latency > atomic_load(&ui_latency_max)) {
+            atomic_store(&ui_latency_max, latency);
+        }
+        atomic_fetch_add(&ui_wakeups, 1);
+        xTaskNotifyGive(test_handle);
+    }
+}
+
+static void test_ui_wakeup_latency(void) {
+    test_handle = xTaskGetCurrentTaskHandle();
+    state_bus_init(&bus, initial);
+    state_bus_subscribe(&bus, &ui_handle, STATE_BUS_BIT(STATE_RECEIVING));
+    TEST_ASSERT_EQ(xTaskCreate(ui_task, "ui", 4096, NULL, 5, &ui_handle), pdPASS);
+
+    for (int round = 0; round < LATENCY_ROUNDS; round++) {
+        state_bus_set(&bus, STATE_RECEIVING, round & 1 ? false : true);
+        // Прийом публікує той самий стан на кожен пакет - це не має будити інтерфейс
+        for (int packet = 0; packet < 50; packet++) {
+            state_bus_set(&bus, STATE_RECEIVING, round & 1 ? false : true);
+        }
+        TEST_ASSERT(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) > 0);
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    int wakeups = atomic_load(&ui_wakeups);
+    printf("  %d changes, %d UI wakeups for %d publications, latency avg %.0f us, max %lld us (polling: up to %d ms)\n",
+           LATENCY_ROUNDS, wakeups, LATENCY_ROUNDS * 51, (double)atomic_load(&ui_latency_total) / wakeups,
+           (long long)atomic_load(&ui_latency_max), UI_POLL_MS);
+    TEST_ASSERT_EQ(wakeups, LATENCY_ROUNDS);
+    TEST_ASSERT(atomic_load(&ui_latency_max) < UI_POLL_MS * 1000);
+}
+
+typedef struct {
+    state_id_t id;
+    TaskHandle_t done;
+} publisher_t;
+
+static void publisher_task(void *arg) {
+    publisher_t *p = (publisher_t *)arg;
+    for (int i = 1; i <= PUBLISH_ROUNDS; i++) {
+        state_bus_set(&bus, p->id, i);
+    }
+    xTaskNotifyGive(p->done);
+    vTaskDelete(NULL);
+}
+
+// Дві задачі публікують різні стани одночасно: жодна зміна не губиться
+static void test_concurrent_publishers(void) {
+    uint32_t zero[STATE_COUNT] = {0};
+    state_bus_init(&bus, zero);
+    publisher_t a = {STATE_TALKGROUP, xTaskGetCurrentTaskHandle()};
+    publisher_t b = {STATE_TRANSMIT, xTaskGetCurrentTaskHandle()};
+    xTaskCreate(publisher_task, "pub_a", 4096, &a, 5, NULL);
+    xTaskCreate(publisher_task, "pub_b", 4096, &b, 5, NULL);
+    int done = 0;
+    while (done < 2) {
+        uint32_t taken = ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(5000));
+        TEST_ASSERT(taken > 0);
+        if (taken == 0) {
+            break;
+        }
+        done++;
+    }
+    TEST_ASSERT_EQ(state_bus_changes(&bus), 2 * PUBLISH_ROUNDS);
+    TEST_ASSERT_EQ(state_bus_get(&bus, STATE_TALKGROUP), PUBLISH_ROUNDS);
+    TEST_ASSERT_EQ(state_bus_get(&bus, STATE_TRANSMIT), PUBLISH_ROUNDS);
+}
+
+int main(void) {
+    TEST_RUN(test_publish_and_mask);
+    TEST_RUN(test_ui_wakeup_latency);
+    TEST_RUN(test_concurrent_publishers);
+    return TEST_EXIT_CODE();
+}
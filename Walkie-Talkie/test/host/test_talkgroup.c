@@ -0,0 +1,158 @@
+#include <string.h>
+#include "test.h"
+#include "station.h"
+
+// Розмовні групи на петлі транспорту: кілька станцій слухають один порт групи,
+// кадр відправляється групі один раз і доходить до кожного слухача, а приймає
+// його лише станція з тією ж групою (адресні кадри - якщо вона їх приймає).
+// Мовці в одному потоці по черзі, A -> B -> A: повернення A не глушиться
+// вікном повторів, а записані кадри обох мовців не проходять
+
+#define PORT_TX 5000
+#define PORT_RX 5001
+#define PORT_TX2 5002
+#define PORT_GROUP 5010
+#define GROUP_A 1
+#define GROUP_B 2
+
+static int16_t frame[STATION_FRAME_SAMPLES];
+
+static void test_group_delivery(void) {
+    station_t tx;
+    station_t rx[3];
+    static const uint16_t groups[3] = { GROUP_A, GROUP_A, GROUP_B };
+    struct sockaddr_in group_addr = station_addr(PORT_GROUP);
+    inet_aton("239.255.0.1", &group_addr.sin_addr);
+    TEST_ASSERT(station_open(&tx, PORT_TX, 0x1111, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(station_open(&rx[i], PORT_GROUP, 0x2000 + i, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+        TEST_ASSERT(transport_join_group(&rx[i].transport, &group_addr));
+        rx[i].config.talkgroup = groups[i];
+    }
+    // Третя станція слухає лише свою групу
+    rx[2].config.accept_direct = false;
+
+    enum { FRAMES = 10 };
+    int64_t now = 0;
+    for (int f = 0; f < FRAMES; f++, now += STATION_FRAME_PERIOD_US) {
+        station_send(&tx, &group_addr, GROUP_A, true, frame);
+        for (int i = 0; i < 3; i++) {
+            station_poll(&rx[i], now);
+        }
+    }
+    // Кожен слухач отримав кожну датаграму, прийняли лише учасники групи A
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQ(rx[i].results[STREAM_RX_AUDIO], FRAMES);
+        TEST_ASSERT_EQ(rx[i].rx.stats.received, FRAMES);
+        TEST_ASSERT_EQ(rx[i].rx.jb.depth, FRAMES);
+        TEST_ASSERT(rx[i].rx.talker == 0x1111);
+        TEST_ASSERT_EQ(rx[i].rx.talkgroup, GROUP_A);
+    }
+    TEST_ASSERT_EQ(rx[2].results[STREAM_RX_AUDIO], 0);
+    TEST_ASSERT_EQ(rx[2].results[STREAM_RX_DROPPED], FRAMES);
+    TEST_ASSERT_EQ(rx[2].rx.stats.other_group, FRAMES);
+    TEST_ASSERT_EQ(rx[2].rx.jb.depth, 0);
+
+    // Кадр групі B: тепер відкидають перші дві станції
+    station_send(&tx, &group_addr, GROUP_B, true, frame);
+    // Адресний кадр на порт групи: приймають ті, що приймають адресні
+    station_send(&tx, &group_addr, PACKET_TALKGROUP_NONE, true, frame);
+    for (int i = 0; i < 3; i++) {
+        station_poll(&rx[i], now);
+    }
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQ(rx[i].results[STREAM_RX_AUDIO], FRAMES + 1);
+        TEST_ASSERT_EQ(rx[i].rx.stats.other_group, 1);
+    }
+    TEST_ASSERT_EQ(rx[2].results[STREAM_RX_AUDIO], 1);
+    TEST_ASSERT_EQ(rx[2].rx.stats.other_group, FRAMES + 1);
+    TEST_ASSERT_EQ(rx[2].rx.talkgroup, GROUP_B);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQ(rx[i].rx.stats.auth_failed, 0);
+        TEST_ASSERT_EQ(rx[i].rx.stats.replayed, 0);
+        printf("  listener %d (group %u%s): %u accepted, %u other group\n", i, groups[i],
+               rx[i].config.accept_direct ? " + direct" : "", rx[i].results[STREAM_RX_AUDIO],
+               rx[i].rx.stats.other_group);
+    }
+
+    for (int i = 2; i >= 0; i--) {
+        station_close(&rx[i]);
+    }
+    station_close(&tx);
+}
+
+// Відправляє кадр і забирає його датаграму з сокета приймача, не передаючи в потік
+static int capture(station_t *tx, station_t *rx, uint8_t *out) {
+    struct sockaddr_in dest = station_addr(PORT_RX);
+    struct sockaddr_in src;
+    station_send(tx, &dest, PACKET_TALKGROUP_NONE, true, frame);
+    int len = transport_recv(&rx->transport, out, STATION_PACKET_SIZE, &src);
+    TEST_ASSERT(len > PACKET_HEADER_SIZE + CRYPTO_TAG_SIZE);
+    return len;
+}
+
+// Пакет дешифрується на місці, тож у потік іде копія
+static stream_rx_result_t inject(station_t *rx, const uint8_t *pkt, int len, int64_t now_us) {
+    uint8_t buf[STATION_PACKET_SIZE];
+    memcpy(buf, pkt, len);
+    return station_receive(rx, buf, len, now_us);
+}
+
+// Кожна сесія веде власне вікно повторів, тож A після паузи продовжує,
+// а записані раніше кадри A і B не проходять
+static void test_talker_return(void) {
+    station_t a;
+    station_t b;
+    station_t rx;
+    TEST_ASSERT(station_open(&a, PORT_TX, 0xA, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+    TEST_ASSERT(station_open(&b, PORT_TX2, 0xB, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+    TEST_ASSERT(station_open(&rx, PORT_RX, 0x2222, CRYPTO_MODE_GCM, NULL, PACKET_RATE_16000, 0));
+
+    uint8_t recorded_a[STATION_PACKET_SIZE];
+    uint8_t recorded_b[STATION_PACKET_SIZE];
+    uint8_t pkt[STATION_PACKET_SIZE];
+    int64_t now = 0;
+    int len_a = capture(&a, &rx, recorded_a);
+    TEST_ASSERT_EQ(inject(&rx, recorded_a, len_a, now), STREAM_RX_AUDIO);
+
+    // B перебиває A лише після тиші
+    int len = capture(&b, &rx, pkt);
+    TEST_ASSERT_EQ(inject(&rx, pkt, len, now + 1000), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(rx.rx.stats.other_talker, 1);
+    now += STREAM_TALKER_HOLD_US;
+    int len_b = capture(&b, &rx, recorded_b);
+    TEST_ASSERT_EQ(inject(&rx, recorded_b, len_b, now), STREAM_RX_AUDIO);
+    TEST_ASSERT(rx.rx.talker == 0xB);
+
+    // A повертається і говорить далі
+    now += STREAM_TALKER_HOLD_US;
+    for (int i = 0; i < 10; i++) {
+        len = capture(&a, &rx, pkt);
+        TEST_ASSERT_EQ(inject(&rx, pkt, len, now), STREAM_RX_AUDIO);
+        now += STATION_FRAME_PERIOD_US;
+    }
+    TEST_ASSERT(rx.rx.talker == 0xA);
+    TEST_ASSERT_EQ(rx.rx.stats.other_talker, 1);
+
+    // Старий кадр A - повтор; кадр B після тиші A теж, а не чужий мовець
+    TEST_ASSERT_EQ(inject(&rx, recorded_a, len_a, now), STREAM_RX_DROPPED);
+    now += STREAM_TALKER_HOLD_US;
+    TEST_ASSERT_EQ(inject(&rx, recorded_b, len_b, now), STREAM_RX_DROPPED);
+    TEST_ASSERT_EQ(rx.rx.stats.replayed, 2);
+    TEST_ASSERT_EQ(rx.rx.stats.other_talker, 1);
+    TEST_ASSERT_EQ(rx.rx.stats.auth_failed, 0);
+    TEST_ASSERT_EQ(rx.results[STREAM_RX_AUDIO], 12);
+
+    station_close(&rx);
+    station_close(&b);
+    station_close(&a);
+}
+
+int main(void) {
+    for (size_t i = 0; i < STATION_FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(8000 * sin(2 * M_PI * 700 * i / STATION_SAMPLE_RATE));
+    }
+    TEST_RUN(test_group_delivery);
+    TEST_RUN(test_talker_return);
+    return TEST_EXIT_CODE();
+}
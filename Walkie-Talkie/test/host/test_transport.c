@@ -0,0 +1,143 @@
+#include <string.h>
+#include <errno.h>
+#include "test.h"
+#include "transport.h"
+
+// Транспорт поверх петлі в пам'яті: прийом і передача без мережі, доставка
+// кожному сокету спільного порту, облік по пірах і витіснення найдовше неактивного піра
+
+#define PORT_A 5000
+#define PORT_B 5001
+
+static struct sockaddr_in make_addr(uint32_t addr, uint16_t port) {
+    struct sockaddr_in sa = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(addr),
+    };
+    return sa;
+}
+
+static void test_loopback_send_receive(void) {
+    transport_t a;
+    transport_t b;
+    TEST_ASSERT(transport_open(&a, &transport_loopback_backend, PORT_A, 10));
+    TEST_ASSERT(transport_open(&b, &transport_loopback_backend, PORT_B, 10));
+
+    char buf[16];
+    struct sockaddr_in src;
+    TEST_ASSERT(transport_recv(&a, buf, sizeof(buf), &src) < 0);
+    TEST_ASSERT_EQ(a.rx_timeouts, 1);
+
+    struct sockaddr_in dest = make_addr(INADDR_LOOPBACK, PORT_A);
+    TEST_ASSERT_EQ(transport_sendto(&b, &dest, "hello", 5), 5);
+    TEST_ASSERT_EQ(transport_recv(&a, buf, sizeof(buf), &src), 5);
+    TEST_ASSERT(memcmp(buf, "hello", 5) == 0);
+    TEST_ASSERT_EQ(ntohl(src.sin_addr.s_addr), INADDR_LOOPBACK);
+
+    // Адресна передача після connect; довша датаграма обрізається, як в UDP
+    TEST_ASSERT(transport_connect(&b, &dest));
+    TEST_ASSERT_EQ(transport_send(&b, "walkie", 6), 6);
+    TEST_ASSERT_EQ(transport_recv(&a, buf, 4, &src), 4);
+    TEST_ASSERT(memcmp(buf, "walk", 4) == 0);
+
+    transport_peer_t peer;
+    TEST_ASSERT(transport_get_peer(&a, htonl(INADDR_LOOPBACK), &peer));
+    TEST_ASSERT_EQ(peer.rx_packets, 2);
+    TEST_ASSERT_EQ(peer.rx_bytes, 9);
+    TEST_ASSERT(transport_get_peer(&b, htonl(INADDR_LOOPBACK), &peer));
+    TEST_ASSERT_EQ(peer.tx_packets, 2);
+
+    transport_close(&a);
+    transport_close(&b);
+}
+
+// Переповнена черга прийому губить датаграми, як сокет із заповненим буфером
+static void test_loopback_queue_full(void) {
+    transport_t a;
+    transport_t b;
+    TEST_ASSERT(transport_open(&a, &transport_loopback_backend, PORT_A, 10));
+    TEST_ASSERT(transport_open(&b, &transport_loopback_backend, PORT_B, 10));
+
+    struct sockaddr_in dest = make_addr(INADDR_LOOPBACK, PORT_A);
+    for (int i = 0; i < TRANSPORT_LOOPBACK_QUEUE + 4; i++) {
+        uint8_t seq = (uint8_t)i;
+        TEST_ASSERT_EQ(transport_sendto(&b, &dest, &seq, 1), 1);
+    }
+    int received = 0;
+    uint8_t seq;
+    struct sockaddr_in src;
+    while (transport_recv(&a, &seq, 1, &src) == 1) {
+        TEST_ASSERT_EQ(seq, received);
+        received++;
+    }
+    TEST_ASSERT_EQ(received, TRANSPORT_LOOPBACK_QUEUE);
+
+    transport_close(&a);
+    transport_close(&b);
+}
+
+// Кілька станцій на одному порту, як слухачі розмовної групи: кожна отримує копію,
+// а після закриття однієї інші приймають далі
+static void test_loopback_shared_port(void) {
+    transport_t a;
+    transport_t b;
+    transport_t tx;
+    TEST_ASSERT(transport_open(&a, &transport_loopback_backend, PORT_A, 10));
+    TEST_ASSERT(transport_open(&b, &transport_loopback_backend, PORT_A, 10));
+    TEST_ASSERT(transport_open(&tx, &transport_loopback_backend, PORT_B, 10));
+
+    struct sockaddr_in dest = make_addr(INADDR_LOOPBACK, PORT_A);
+    char buf[16];
+    struct sockaddr_in src;
+    TEST_ASSERT_EQ(transport_sendto(&tx, &dest, "group", 5), 5);
+    TEST_ASSERT_EQ(transport_recv(&a, buf, sizeof(buf), &src), 5);
+    TEST_ASSERT(memcmp(buf, "group", 5) == 0);
+    TEST_ASSERT_EQ(transport_recv(&b, buf, sizeof(buf), &src), 5);
+    TEST_ASSERT(memcmp(buf, "group", 5) == 0);
+    TEST_ASSERT(transport_recv(&a, buf, sizeof(buf), &src) < 0);
+    TEST_ASSERT(transport_recv(&b, buf, sizeof(buf), &src) < 0);
+
+    transport_close(&a);
+    TEST_ASSERT_EQ(transport_sendto(&tx, &dest, "again", 5), 5);
+    TEST_ASSERT_EQ(transport_recv(&b, buf, sizeof(buf), &src), 5);
+    TEST_ASSERT(memcmp(buf, "again", 5) == 0);
+
+    transport_close(&b);
+    transport_close(&tx);
+}
+
+static void test_peer_eviction(void) {
+    transport_t t;
+    TEST_ASSERT(transport_open(&t, &transport_loopback_backend, PORT_A, 10));
+
+    uint32_t base = 0x0A000001;
+    for (uint32_t i = 0; i < TRANSPORT_MAX_PEERS; i++) {
+        struct sockaddr_in dest = make_addr(base + i, PORT_B);
+        transport_sendto(&t, &dest, "x", 1);
+    }
+    TEST_ASSERT_EQ(t.evicted, 0);
+
+    // Перший пір знову активний, тож витісняється другий
+    struct sockaddr_in first = make_addr(base, PORT_B);
+    transport_sendto(&t, &first, "x", 1);
+    struct sockaddr_in extra = make_addr(base + TRANSPORT_MAX_PEERS, PORT_B);
+    transport_sendto(&t, &extra, "x", 1);
+    TEST_ASSERT_EQ(t.evicted, 1);
+
+    transport_peer_t peer;
+    TEST_ASSERT(transport_get_peer(&t, htonl(base), &peer));
+    TEST_ASSERT_EQ(peer.tx_packets, 2);
+    TEST_ASSERT(!transport_get_peer(&t, htonl(base + 1), &peer));
+    TEST_ASSERT(transport_get_peer(&t, htonl(base + TRANSPORT_MAX_PEERS), &peer));
+
+    transport_close(&t);
+}
+
+int main(void) {
+    TEST_RUN(test_loopback_send_receive);
+    TEST_RUN(test_loopback_queue_full);
+    TEST_RUN(test_loopback_shared_port);
+    TEST_RUN(test_peer_eviction);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Record a packet arrival trace for the jitter buffer replay test.
+
+Listens on the audio UDP port and writes one line per packet:
+    <arrival_us> <seq>
+arrival_us is a monotonic receive time in microseconds, relative to the
+first packet; seq is the 16-bit sequence number from the packet header
+(packet.h). Point a transmitting device at this host to record over
+Wi-Fi. With --send the script also runs a paced sender on the same
+host, one header-only packet per period, for captures without hardware.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import threading
+import time
+
+HEADER = struct.Struct('>BBBBIHIHH')    # packet.h, 18 bytes
+PACKET_VERSION = 3
+
+
+def send(host, port, period_us, count):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    start = time.monotonic_ns()
+    for seq in range(count):
+        # Absolute deadlines, as the I2S clock paces the device's send task
+        deadline = start + seq * period_us * 1000
+        delay = deadline - time.monotonic_ns()
+        if delay > 0:
+            time.sleep(delay / 1e9)
+        sock.sendto(HEADER.pack(PACKET_VERSION, 0, 0, 0, 0x5EED, seq & 0xFFFF, seq * 441, 0, 0),
+                    (host, port))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('output', help='trace file to write')
+    parser.add_argument('--port', type=int, default=1234)
+    parser.add_argument('--count', type=int, default=3000, help='packets to record')
+    parser.add_argument('--send', metavar='HOST', help='also send paced packets to HOST')
+    parser.add_argument('--period-us', type=int, default=10000)
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('', args.port))
+    sock.settimeout(2.0)
+    if args.send:
+        threading.Thread(target=send, args=(args.send, args.port, args.period_us, args.count),
+                         daemon=True).start()
+
+    lines = []
+    first = None
+    try:
+        while len(lines) < args.count:
+            data = sock.recv(2048)
+            now = time.monotonic_ns() // 1000
+            if len(data) < HEADER.size or data[0] != PACKET_VERSION:
+                continue
+            seq = HEADER.unpack_from(data)[5]
+            if first is None:
+                first = now
+            lines.append(f'{now - first} {seq}\n')
+    except socket.timeout:
+        print(f'timed out after {len(lines)} packets', file=sys.stderr)
+
+    with open(args.output, 'w') as f:
+        f.write(f'# arrival_us seq, period {args.period_us} us, {len(lines)} packets\n')
+        f.writelines(lines)
+
+
+if __name__ == '__main__':
+    main()